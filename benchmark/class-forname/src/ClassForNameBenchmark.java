@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class ClassForNameBenchmark {
+    public static final int NUM_THREADS = 4;
+
+    // Classes defined by the boot class loader, found in the boot image class tables.
+    public static final String[] bootClassNames = {
+        "java.lang.Object", "java.lang.String", "java.lang.Integer", "java.lang.Thread",
+        "java.util.ArrayList", "java.util.HashMap", "java.util.Collections",
+        "java.util.concurrent.ConcurrentHashMap",
+    };
+
+    // Classes defined by the class loader of the benchmark.
+    public static final String[] appClassNames = {
+        "ClassForNameBenchmark", "ClassForNameBenchmark$A", "ClassForNameBenchmark$B",
+        "ClassForNameBenchmark$C",
+    };
+
+    static class A {}
+    static class B {}
+    static class C {}
+
+    public void timeBootClasses(int count) throws Exception {
+        ClassLoader loader = ClassForNameBenchmark.class.getClassLoader();
+        for (int i = 0; i < count; ++i) {
+            $noinline$forName(bootClassNames, loader);
+        }
+    }
+
+    public void timeAppClasses(int count) throws Exception {
+        ClassLoader loader = ClassForNameBenchmark.class.getClassLoader();
+        for (int i = 0; i < count; ++i) {
+            $noinline$forName(appClassNames, loader);
+        }
+    }
+
+    public void timeBootClassesMultithreaded(int count) throws Exception {
+        $noinline$forNameInThreads(bootClassNames, count);
+    }
+
+    public void timeAppClassesMultithreaded(int count) throws Exception {
+        $noinline$forNameInThreads(appClassNames, count);
+    }
+
+    static void $noinline$forNameInThreads(final String[] names, final int count)
+            throws Exception {
+        final ClassLoader loader = ClassForNameBenchmark.class.getClassLoader();
+        Thread[] threads = new Thread[NUM_THREADS];
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            threads[t] = new Thread() {
+                public void run() {
+                    try {
+                        for (int i = 0; i < count; ++i) {
+                            $noinline$forName(names, loader);
+                        }
+                    } catch (ClassNotFoundException e) {
+                        throw new Error(e);
+                    }
+                }
+            };
+        }
+        for (Thread thread : threads) {
+            thread.start();
+        }
+        for (Thread thread : threads) {
+            thread.join();
+        }
+    }
+
+    static void $noinline$forName(String[] names, ClassLoader loader)
+            throws ClassNotFoundException {
+        for (String name : names) {
+            if (Class.forName(name, false, loader) == null) { throw new Error(); }
+        }
+    }
+}
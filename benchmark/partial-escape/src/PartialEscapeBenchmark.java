@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Method;
+
+public class PartialEscapeBenchmark {
+    static class Range {
+        int start;
+        int end;
+    }
+
+    static class Cursor {
+        int position;
+        int limit;
+    }
+
+    public void timeBuilderEscapingOnThrow(int count) {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += checkedLength(i & 1023, (i & 1023) + 16);
+        }
+        result = sum;
+    }
+
+    public void timeCursorEscapingOnEarlyReturn(int count) {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += advance(i & 1023, 2048);
+        }
+        result = sum;
+    }
+
+    private static int checkedLength(int start, int end) {
+        Range r = new Range();
+        r.start = start;
+        r.end = end;
+        if (r.end < r.start) {
+            throw new IllegalArgumentException(describe(r));
+        }
+        return r.end - r.start;
+    }
+
+    private static int advance(int position, int limit) {
+        Cursor c = new Cursor();
+        c.position = position;
+        c.limit = limit;
+        if (c.position >= c.limit) {
+            sLastExhausted = c;
+            return -1;
+        }
+        c.position += 8;
+        return c.limit - c.position;
+    }
+
+    private static String describe(Range r) {
+        return "[" + r.start + ", " + r.end + ")";
+    }
+
+    static Cursor sLastExhausted;
+    int result;
+
+    // Allocation counter kinds of dalvik.system.VMDebug, for the current thread.
+    private static final int KIND_THREAD_ALLOCATED_OBJECTS = 1 << 16;
+    private static final int KIND_THREAD_ALLOCATED_BYTES = 1 << 17;
+    private static final int RESET_ALL = 0xffffffff;
+
+    // The time benchmarks cannot report allocations, run this class directly to print the
+    // objects and bytes allocated per call along with the time. With partial escape analysis
+    // the hot paths should not allocate at all.
+    public static void main(String[] args) throws Exception {
+        final int count = (args.length > 0) ? Integer.parseInt(args[0]) : 1000000;
+        final PartialEscapeBenchmark benchmark = new PartialEscapeBenchmark();
+        // Warm up, so that the measured code is JIT compiled.
+        for (int i = 0; i < 10; ++i) {
+            benchmark.timeBuilderEscapingOnThrow(count);
+            benchmark.timeCursorEscapingOnEarlyReturn(count);
+        }
+        measure("BuilderEscapingOnThrow", count,
+                () -> benchmark.timeBuilderEscapingOnThrow(count));
+        measure("CursorEscapingOnEarlyReturn", count,
+                () -> benchmark.timeCursorEscapingOnEarlyReturn(count));
+    }
+
+    private static void measure(String name, int count, Runnable body) throws Exception {
+        Class<?> vmDebug = Class.forName("dalvik.system.VMDebug");
+        Method startAllocCounting = vmDebug.getDeclaredMethod("startAllocCounting");
+        Method stopAllocCounting = vmDebug.getDeclaredMethod("stopAllocCounting");
+        Method resetAllocCount = vmDebug.getDeclaredMethod("resetAllocCount", Integer.TYPE);
+        Method getAllocCount = vmDebug.getDeclaredMethod("getAllocCount", Integer.TYPE);
+
+        resetAllocCount.invoke(null, RESET_ALL);
+        startAllocCounting.invoke(null);
+        long start = System.nanoTime();
+        body.run();
+        long elapsed = System.nanoTime() - start;
+        stopAllocCounting.invoke(null);
+        int objects = (Integer) getAllocCount.invoke(null, KIND_THREAD_ALLOCATED_OBJECTS);
+        int bytes = (Integer) getAllocCount.invoke(null, KIND_THREAD_ALLOCATED_BYTES);
+        System.out.printf("%s: %.1f ns, %.3f objects, %.1f bytes per call%n",
+                          name,
+                          (double) elapsed / count,
+                          (double) objects / count,
+                          (double) bytes / count);
+    }
+}
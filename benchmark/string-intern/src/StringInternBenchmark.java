@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class StringInternBenchmark {
+    public static final int NUM_THREADS = 4;
+    public static final int NUM_STRINGS = 64;
+
+    // Strings found in the boot image intern tables. The copies are not interned,
+    // so that each `String.intern()` call searches the intern table.
+    public static final String[] bootImageStrings = {
+        "java.lang.Object", "java.lang.String", "toString", "hashCode", "equals", "length",
+        "value", "count", "size", "name", "get", "set", "add", "remove", "clear", "close",
+    };
+    public static final String[] bootImageStringCopies = copyOf(bootImageStrings);
+
+    // Strings interned at runtime, found in the intern table of the app. These lookups are
+    // also done without the intern table lock, only strings that are not found take it.
+    public static final String[] appStrings = makeAppStrings();
+    public static final String[] appStringCopies = copyOf(appStrings);
+
+    public void timeInternBootImageStrings(int count) {
+        for (int i = 0; i < count; ++i) {
+            $noinline$intern(bootImageStringCopies);
+        }
+    }
+
+    public void timeInternAppStrings(int count) {
+        for (int i = 0; i < count; ++i) {
+            $noinline$intern(appStringCopies);
+        }
+    }
+
+    // Lock-free lookups, the threads do not contend.
+    public void timeInternBootImageStringsMultithreaded(int count) throws Exception {
+        $noinline$internInThreads(bootImageStringCopies, count);
+    }
+
+    // Lock-free lookups in the runtime intern tables, the threads do not contend.
+    public void timeInternAppStringsMultithreaded(int count) throws Exception {
+        $noinline$internInThreads(appStringCopies, count);
+    }
+
+    static void $noinline$internInThreads(final String[] strings, final int count)
+            throws Exception {
+        Thread[] threads = new Thread[NUM_THREADS];
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            threads[t] = new Thread() {
+                public void run() {
+                    for (int i = 0; i < count; ++i) {
+                        $noinline$intern(strings);
+                    }
+                }
+            };
+        }
+        for (Thread thread : threads) {
+            thread.start();
+        }
+        for (Thread thread : threads) {
+            thread.join();
+        }
+    }
+
+    static void $noinline$intern(String[] strings) {
+        for (String s : strings) {
+            if (s.intern() == null) { throw new Error(); }
+        }
+    }
+
+    static String[] makeAppStrings() {
+        String[] strings = new String[NUM_STRINGS];
+        for (int i = 0; i < NUM_STRINGS; ++i) {
+            strings[i] = ("StringInternBenchmark_" + i).intern();
+        }
+        return strings;
+    }
+
+    static String[] copyOf(String[] strings) {
+        String[] copies = new String[strings.length];
+        for (int i = 0; i < strings.length; ++i) {
+            copies[i] = new String(strings[i].toCharArray());
+        }
+        return copies;
+    }
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+public class UtfConversionBenchmark {
+  public UtfConversionBenchmark() {
+    // Make sure to link methods before benchmark starts.
+    System.loadLibrary("artbenchmark");
+    timeCountModifiedUtf8CharsAscii(1);
+    timeCountModifiedUtf8CharsNonAscii(1);
+    timeConvertModifiedUtf8ToUtf16Ascii(1);
+    timeConvertModifiedUtf8ToUtf16NonAscii(1);
+    timeConvertUtf16ToModifiedUtf8Ascii(1);
+    timeConvertUtf16ToModifiedUtf8NonAscii(1);
+  }
+
+  // Each benchmark processes typical dex file strings, such as descriptors and method
+  // names. The "Ascii" variants use ASCII strings only, which take the bulk fast paths.
+  // The "NonAscii" variants place a non-ASCII character in the middle of each string.
+  public native void timeCountModifiedUtf8CharsAscii(int reps);
+  public native void timeCountModifiedUtf8CharsNonAscii(int reps);
+  public native void timeConvertModifiedUtf8ToUtf16Ascii(int reps);
+  public native void timeConvertModifiedUtf8ToUtf16NonAscii(int reps);
+  public native void timeConvertUtf16ToModifiedUtf8Ascii(int reps);
+  public native void timeConvertUtf16ToModifiedUtf8NonAscii(int reps);
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "jni.h"
+
+#include "base/logging.h"
+#include "dex/utf.h"
+
+namespace art {
+namespace {
+
+// Strings of the lengths usually found in dex files.
+static const char* const kAsciiStrings[] = {
+    "I",
+    "<init>",
+    "toString",
+    "Ljava/lang/Object;",
+    "Landroid/content/Context;",
+    "(Ljava/lang/String;ILjava/lang/Object;)V",
+    "Lcom/example/application/feature/impl/SomeLongClassNameWithManyWords$Inner;",
+    "The quick brown fox jumps over the lazy dog, again and again and again.",
+};
+
+struct Utf8String {
+  std::string utf8;
+  size_t utf16_length;
+};
+
+static std::vector<Utf8String> MakeUtf8Strings(bool non_ascii) {
+  std::vector<Utf8String> result;
+  for (const char* s : kAsciiStrings) {
+    std::string utf8(s);
+    if (non_ascii) {
+      // U+00E9 (LATIN SMALL LETTER E WITH ACUTE) encodes as two bytes.
+      utf8.insert(utf8.size() / 2u, "\xc3\xa9");
+    }
+    result.push_back({utf8, CountModifiedUtf8Chars(utf8.data(), utf8.size())});
+  }
+  return result;
+}
+
+static std::vector<std::vector<uint16_t>> MakeUtf16Strings(bool non_ascii) {
+  std::vector<std::vector<uint16_t>> result;
+  for (const Utf8String& s : MakeUtf8Strings(non_ascii)) {
+    std::vector<uint16_t> utf16(s.utf16_length);
+    ConvertModifiedUtf8ToUtf16(utf16.data(), utf16.size(), s.utf8.data(), s.utf8.size());
+    result.push_back(std::move(utf16));
+  }
+  return result;
+}
+
+static void TimeCountModifiedUtf8Chars(jint reps, bool non_ascii) {
+  std::vector<Utf8String> strings = MakeUtf8Strings(non_ascii);
+  size_t total = 0u;
+  for (jint i = 0; i < reps; ++i) {
+    for (const Utf8String& s : strings) {
+      total += CountModifiedUtf8Chars(s.utf8.data(), s.utf8.size());
+    }
+  }
+  CHECK_NE(total, 0u);
+}
+
+static void TimeConvertModifiedUtf8ToUtf16(jint reps, bool non_ascii) {
+  std::vector<Utf8String> strings = MakeUtf8Strings(non_ascii);
+  std::vector<uint16_t> out;
+  for (jint i = 0; i < reps; ++i) {
+    for (const Utf8String& s : strings) {
+      out.resize(s.utf16_length);
+      ConvertModifiedUtf8ToUtf16(out.data(), out.size(), s.utf8.data(), s.utf8.size());
+    }
+  }
+  CHECK(!out.empty());
+}
+
+static void TimeConvertUtf16ToModifiedUtf8(jint reps, bool non_ascii) {
+  std::vector<std::vector<uint16_t>> strings = MakeUtf16Strings(non_ascii);
+  std::vector<size_t> byte_counts;
+  for (const std::vector<uint16_t>& s : strings) {
+    byte_counts.push_back(CountModifiedUtf8BytesInUtf16(s.data(), s.size()));
+  }
+  std::string out;
+  for (jint i = 0; i < reps; ++i) {
+    for (size_t j = 0; j != strings.size(); ++j) {
+      out.resize(byte_counts[j]);
+      ConvertUtf16ToModifiedUtf8(out.data(), out.size(), strings[j].data(), strings[j].size());
+    }
+  }
+  CHECK(!out.empty());
+}
+
+extern "C" JNIEXPORT void JNICALL Java_UtfConversionBenchmark_timeCountModifiedUtf8CharsAscii(
+    JNIEnv*, jobject, jint reps) {
+  TimeCountModifiedUtf8Chars(reps, /*non_ascii=*/ false);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_UtfConversionBenchmark_timeCountModifiedUtf8CharsNonAscii(
+    JNIEnv*, jobject, jint reps) {
+  TimeCountModifiedUtf8Chars(reps, /*non_ascii=*/ true);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_UtfConversionBenchmark_timeConvertModifiedUtf8ToUtf16Ascii(JNIEnv*, jobject, jint reps) {
+  TimeConvertModifiedUtf8ToUtf16(reps, /*non_ascii=*/ false);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_UtfConversionBenchmark_timeConvertModifiedUtf8ToUtf16NonAscii(JNIEnv*, jobject, jint reps) {
+  TimeConvertModifiedUtf8ToUtf16(reps, /*non_ascii=*/ true);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_UtfConversionBenchmark_timeConvertUtf16ToModifiedUtf8Ascii(JNIEnv*, jobject, jint reps) {
+  TimeConvertUtf16ToModifiedUtf8(reps, /*non_ascii=*/ false);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_UtfConversionBenchmark_timeConvertUtf16ToModifiedUtf8NonAscii(JNIEnv*, jobject, jint reps) {
+  TimeConvertUtf16ToModifiedUtf8(reps, /*non_ascii=*/ true);
+}
+
+}  // namespace
+}  // namespace art
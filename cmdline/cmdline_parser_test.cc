@@ -237,6 +237,9 @@ TEST_F(CmdlineParserTest, TestSimpleSuccesses) {
   EXPECT_SINGLE_PARSE_VALUE(false, "-XX:DisableHSpaceCompactForOOM", M::EnableHSpaceCompactForOOM);
   EXPECT_SINGLE_PARSE_VALUE(0.5, "-XX:HeapTargetUtilization=0.5", M::HeapTargetUtilization);
   EXPECT_SINGLE_PARSE_VALUE(5u, "-XX:ParallelGCThreads=5", M::ParallelGCThreads);
+  EXPECT_SINGLE_PARSE_VALUE(
+      60000u, "-XX:RuntimeImageUpdateIntervalMs=60000", M::RuntimeImageUpdateIntervalMs);
+  EXPECT_SINGLE_PARSE_VALUE(true, "-XX:DexPrefetchPlan=true", M::DexPrefetchPlan);
 }  // TEST_F
 
 TEST_F(CmdlineParserTest, TestSimpleFailures) {
@@ -472,6 +475,12 @@ TEST_F(CmdlineParserTest, TestJitOptions) {
     EXPECT_SINGLE_PARSE_VALUE(true, "-Xusejit:true", M::UseJitCompilation);
     EXPECT_SINGLE_PARSE_VALUE(false, "-Xusejit:false", M::UseJitCompilation);
   }
+  {
+    EXPECT_SINGLE_PARSE_VALUE(
+        true, "-Xjitbatchcompilation:true", M::UseJitBatchCompilation);
+    EXPECT_SINGLE_PARSE_VALUE(
+        false, "-Xjitbatchcompilation:false", M::UseJitBatchCompilation);
+  }
   {
     EXPECT_SINGLE_PARSE_VALUE(
         MemoryKiB(16 * KB), "-Xjitinitialsize:16K", M::JITCodeCacheInitialCapacity);
@@ -524,6 +533,7 @@ TEST_F(CmdlineParserTest, TestVerify) {
   EXPECT_SINGLE_PARSE_VALUE(verifier::VerifyMode::kEnable,   "-Xverify:remote",   M::Verify);
   EXPECT_SINGLE_PARSE_VALUE(verifier::VerifyMode::kEnable,   "-Xverify:all",      M::Verify);
   EXPECT_SINGLE_PARSE_VALUE(verifier::VerifyMode::kSoftFail, "-Xverify:softfail", M::Verify);
+  EXPECT_SINGLE_PARSE_VALUE(verifier::VerifyMode::kLazy,     "-Xverify:lazy",     M::Verify);
 }
 
 TEST_F(CmdlineParserTest, TestIgnoreUnrecognized) {
@@ -30,6 +30,7 @@ struct CodeItem;
 }  // namespace dex
 namespace jit {
 class JitCodeCache;
+class JitCommitBatch;
 class JitLogger;
 class JitMemoryRegion;
 }  // namespace jit
@@ -78,7 +79,8 @@ class Compiler {
                           [[maybe_unused]] jit::JitMemoryRegion* region,
                           [[maybe_unused]] ArtMethod* method,
                           [[maybe_unused]] CompilationKind compilation_kind,
-                          [[maybe_unused]] jit::JitLogger* jit_logger)
+                          [[maybe_unused]] jit::JitLogger* jit_logger,
+                          [[maybe_unused]] jit::JitCommitBatch* batch)
       REQUIRES_SHARED(Locks::mutator_lock_) {
     return false;
   }
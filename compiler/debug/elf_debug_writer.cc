@@ -37,6 +37,8 @@
 #include "jit/debugger_interface.h"
 #include "oat/oat.h"
 #include "stream/vector_output_stream.h"
+#include "thread-current-inl.h"
+#include "thread_pool.h"
 
 namespace art HIDDEN {
 namespace debug {
@@ -118,7 +120,8 @@ static std::vector<uint8_t> MakeMiniDebugInfoInternal(
     size_t text_section_size,
     typename ElfTypes::Addr dex_section_address,
     size_t dex_section_size,
-    const DebugInfo& debug_info) {
+    const DebugInfo& debug_info,
+    ThreadPool* thread_pool) {
   std::vector<uint8_t> buffer;
   buffer.reserve(KB);
   VectorOutputStream out("Mini-debug-info ELF file", &buffer);
@@ -141,7 +144,22 @@ static std::vector<uint8_t> MakeMiniDebugInfoInternal(
   CHECK(builder->Good());
   std::vector<uint8_t> compressed_buffer;
   compressed_buffer.reserve(buffer.size() / 4);
-  XzCompress(ArrayRef<const uint8_t>(buffer), &compressed_buffer);
+  if (thread_pool != nullptr) {
+    auto for_each_block = [thread_pool](size_t count, const std::function<void(size_t)>& fn) {
+      Thread* self = Thread::Current();
+      for (size_t i = 0; i != count; ++i) {
+        thread_pool->AddTask(self, new FunctionTask([&fn, i]([[maybe_unused]] Thread* thread) {
+          fn(i);
+        }));
+      }
+      thread_pool->StartWorkers(self);
+      thread_pool->Wait(self, /* do_work= */ true, /* may_hold_locks= */ false);
+      thread_pool->StopWorkers(self);
+    };
+    XzCompressBlocks(ArrayRef<const uint8_t>(buffer), &compressed_buffer, for_each_block);
+  } else {
+    XzCompress(ArrayRef<const uint8_t>(buffer), &compressed_buffer);
+  }
   return compressed_buffer;
 }
 
@@ -152,7 +170,8 @@ std::vector<uint8_t> MakeMiniDebugInfo(
     size_t text_section_size,
     uint64_t dex_section_address,
     size_t dex_section_size,
-    const DebugInfo& debug_info) {
+    const DebugInfo& debug_info,
+    ThreadPool* thread_pool) {
   if (Is64BitInstructionSet(isa)) {
     return MakeMiniDebugInfoInternal<ElfTypes64>(isa,
                                                  features,
@@ -160,7 +179,8 @@ std::vector<uint8_t> MakeMiniDebugInfo(
                                                  text_section_size,
                                                  dex_section_address,
                                                  dex_section_size,
-                                                 debug_info);
+                                                 debug_info,
+                                                 thread_pool);
   } else {
     return MakeMiniDebugInfoInternal<ElfTypes32>(isa,
                                                  features,
@@ -168,7 +188,8 @@ std::vector<uint8_t> MakeMiniDebugInfo(
                                                  text_section_size,
                                                  dex_section_address,
                                                  dex_section_size,
-                                                 debug_info);
+                                                 debug_info,
+                                                 thread_pool);
   }
 }
 
@@ -29,6 +29,7 @@
 
 namespace art HIDDEN {
 class OatHeader;
+class ThreadPool;
 struct JITCodeEntry;
 namespace mirror {
 class Class;
@@ -41,6 +42,8 @@ EXPORT void WriteDebugInfo(
     ElfBuilder<ElfTypes>* builder,
     const DebugInfo& debug_info);
 
+// The compression of the mini-debug-info is done in parallel by `thread_pool` if not null.
+// The output does not depend on it.
 EXPORT std::vector<uint8_t> MakeMiniDebugInfo(
     InstructionSet isa,
     const InstructionSetFeatures* features,
@@ -48,7 +51,8 @@ EXPORT std::vector<uint8_t> MakeMiniDebugInfo(
     size_t text_section_size,
     uint64_t dex_section_address,
     size_t dex_section_size,
-    const DebugInfo& debug_info);
+    const DebugInfo& debug_info,
+    ThreadPool* thread_pool = nullptr);
 
 std::vector<uint8_t> MakeElfFileForJIT(
     InstructionSet isa,
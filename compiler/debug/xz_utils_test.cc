@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "elf/xz_utils.h"
+
+#include <random>
+
+#include "base/array_ref.h"
+#include "base/common_art_test.h"
+
+namespace art HIDDEN {
+namespace debug {
+
+class XzUtilsTest : public CommonArtTest {};
+
+TEST_F(XzUtilsTest, CompressBlocks) {
+  // Compressible data that spans several blocks, with a partial last block.
+  std::vector<uint8_t> data(3 * kXzDefaultBlockSize + 123u);
+  std::minstd_rand random(42u);
+  for (uint8_t& value : data) {
+    value = static_cast<uint8_t>(random() % 16u);
+  }
+  ArrayRef<const uint8_t> src(data);
+
+  std::vector<uint8_t> expected;
+  XzCompress(src, &expected);
+
+  // Compress the blocks in reverse order to check that the order does not matter.
+  std::vector<uint8_t> compressed;
+  XzCompressBlocks(src, &compressed, [](size_t count, const std::function<void(size_t)>& fn) {
+    for (size_t i = count; i != 0u; --i) {
+      fn(i - 1u);
+    }
+  });
+  EXPECT_EQ(expected, compressed);
+
+  std::vector<uint8_t> decompressed;
+  XzDecompress(ArrayRef<const uint8_t>(compressed), &decompressed);
+  EXPECT_EQ(data, decompressed);
+}
+
+}  // namespace debug
+}  // namespace art
@@ -41,6 +41,7 @@ CompilerOptions::CompilerOptions()
     : compiler_filter_(CompilerFilter::kDefaultCompilerFilter),
       huge_method_threshold_(kDefaultHugeMethodThreshold),
       inline_max_code_units_(kUnsetInlineMaxCodeUnits),
+      compile_time_budget_ms_(0u),
       instruction_set_(kRuntimeISA == InstructionSet::kArm ? InstructionSet::kThumb2 : kRuntimeISA),
       instruction_set_features_(nullptr),
       no_inline_from_(),
@@ -56,6 +57,7 @@ CompilerOptions::CompilerOptions()
       generate_debug_info_(kDefaultGenerateDebugInfo),
       generate_mini_debug_info_(kDefaultGenerateMiniDebugInfo),
       generate_build_id_(false),
+      huge_page_hot_code_(false),
       implicit_null_checks_(false),
       implicit_so_checks_(true),
       implicit_suspend_checks_(false),
@@ -131,6 +131,12 @@ class CompilerOptions final {
   size_t GetInlineMaxCodeUnits() const {
     return inline_max_code_units_;
   }
+
+  // Time a method can spend in the optimization passes before the optional ones are
+  // skipped. Zero means no budget.
+  size_t GetCompileTimeBudgetMs() const {
+    return compile_time_budget_ms_;
+  }
   void SetInlineMaxCodeUnits(size_t units) {
     inline_max_code_units_ = units;
   }
@@ -172,6 +178,10 @@ class CompilerOptions final {
     return generate_build_id_;
   }
 
+  bool GetHugePageHotCode() const {
+    return huge_page_hot_code_;
+  }
+
   bool GetImplicitNullChecks() const {
     return implicit_null_checks_;
   }
@@ -388,6 +398,7 @@ class CompilerOptions final {
   CompilerFilter::Filter compiler_filter_;
   size_t huge_method_threshold_;
   size_t inline_max_code_units_;
+  size_t compile_time_budget_ms_;
 
   InstructionSet instruction_set_;
   std::unique_ptr<const InstructionSetFeatures> instruction_set_features_;
@@ -418,6 +429,7 @@ class CompilerOptions final {
   bool generate_debug_info_;
   bool generate_mini_debug_info_;
   bool generate_build_id_;
+  bool huge_page_hot_code_;
   bool implicit_null_checks_;
   bool implicit_so_checks_;
   bool implicit_suspend_checks_;
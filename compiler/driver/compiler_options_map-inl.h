@@ -58,9 +58,11 @@ inline bool ReadCompilerOptions(Base& map, CompilerOptions* options, std::string
   map.AssignIfExists(Base::CompileArtTest, &options->compile_art_test_);
   map.AssignIfExists(Base::HugeMethodMaxThreshold, &options->huge_method_threshold_);
   map.AssignIfExists(Base::InlineMaxCodeUnitsThreshold, &options->inline_max_code_units_);
+  map.AssignIfExists(Base::CompileTimeBudgetMs, &options->compile_time_budget_ms_);
   map.AssignIfExists(Base::GenerateDebugInfo, &options->generate_debug_info_);
   map.AssignIfExists(Base::GenerateMiniDebugInfo, &options->generate_mini_debug_info_);
   map.AssignIfExists(Base::GenerateBuildID, &options->generate_build_id_);
+  map.AssignIfExists(Base::HugePageHotCode, &options->huge_page_hot_code_);
   if (map.Exists(Base::Debuggable)) {
     options->debuggable_ = true;
   }
@@ -139,6 +141,12 @@ NO_INLINE void AddCompilerOptionsArgumentParserOptions(Builder& b) {
                     "A zero value will disable inlining. Honored only by Optimizing. Has priority\n"
                     "over the --compiler-filter option. Intended for development/experimental use.")
           .IntoKey(Map::InlineMaxCodeUnitsThreshold)
+      .Define("--compile-time-budget-ms=_")
+          .template WithType<unsigned int>()
+          .WithHelp("the time a method can spend in Optimizing before the remaining optional\n"
+                    "optimization passes are skipped. A zero value (the default) disables the\n"
+                    "budget. Ignored when determinism is forced.")
+          .IntoKey(Map::CompileTimeBudgetMs)
 
       .Define({"--generate-debug-info", "-g", "--no-generate-debug-info"})
           .WithValues({true, true, false})
@@ -159,6 +167,13 @@ NO_INLINE void AddCompilerOptionsArgumentParserOptions(Builder& b) {
                     "content (and thus stable across identical builds)")
           .IntoKey(Map::GenerateBuildID)
 
+      .Define({"--huge-page-hot-code", "--no-huge-page-hot-code"})
+          .WithValues({true, false})
+          .WithHelp("Place the profile-hot methods at the start of the code, in a region aligned\n"
+                    "to and sized in multiples of the huge page size, so that the runtime can map\n"
+                    "it with transparent huge pages (disabled by default).")
+          .IntoKey(Map::HugePageHotCode)
+
       .Define({"--deduplicate-code=_"})
           .template WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
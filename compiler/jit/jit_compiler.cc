@@ -175,8 +175,11 @@ JitCompiler::~JitCompiler() {
   }
 }
 
-bool JitCompiler::CompileMethod(
-    Thread* self, JitMemoryRegion* region, ArtMethod* method, CompilationKind compilation_kind) {
+bool JitCompiler::CompileMethod(Thread* self,
+                                JitMemoryRegion* region,
+                                ArtMethod* method,
+                                CompilationKind compilation_kind,
+                                JitCommitBatch* batch) {
   SCOPED_TRACE << "JIT compiling "
                << method->PrettyMethod()
                << " (kind=" << compilation_kind << ")";
@@ -202,7 +205,7 @@ bool JitCompiler::CompileMethod(
     JitCodeCache* const code_cache = jit->GetCodeCache();
     metrics::AutoTimer timer{runtime->GetMetrics()->JitMethodCompileTotalTime()};
     success = compiler_->JitCompile(
-        self, code_cache, region, method, compilation_kind, jit_logger_.get());
+        self, code_cache, region, method, compilation_kind, jit_logger_.get(), batch);
     uint64_t duration_us = timer.Stop();
     VLOG(jit) << "Compilation of " << method->PrettyMethod() << " took "
               << PrettyDuration(UsToNs(duration_us));
@@ -32,6 +32,7 @@ class Thread;
 
 namespace jit {
 
+class JitCommitBatch;
 class JitLogger;
 class JitMemoryRegion;
 
@@ -41,8 +42,11 @@ class JitCompiler : public JitCompilerInterface {
   virtual ~JitCompiler();
 
   // Compilation entrypoint. Returns whether the compilation succeeded.
-  bool CompileMethod(
-      Thread* self, JitMemoryRegion* region, ArtMethod* method, CompilationKind kind)
+  bool CompileMethod(Thread* self,
+                     JitMemoryRegion* region,
+                     ArtMethod* method,
+                     CompilationKind kind,
+                     JitCommitBatch* batch)
       REQUIRES_SHARED(Locks::mutator_lock_) override;
 
   const CompilerOptions& GetCompilerOptions() const {
@@ -902,7 +902,7 @@ void CodeGenerator::BlockIfInRegister(Location location, bool is_out) const {
 
 void CodeGenerator::AllocateLocations(HInstruction* instruction) {
   for (HEnvironment* env = instruction->GetEnvironment(); env != nullptr; env = env->GetParent()) {
-    env->AllocateLocations();
+    env->AllocateLocations(GetGraph()->GetAllocator());
   }
   instruction->Accept(GetLocationBuilder());
   DCHECK(CheckTypeConsistency(instruction));
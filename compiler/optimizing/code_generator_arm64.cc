@@ -4800,11 +4800,18 @@ void CodeGeneratorARM64::MaybeGenerateInlineCacheCheck(HInstruction* instruction
     if (cache != nullptr) {
       uint64_t address = reinterpret_cast64<uint64_t>(cache);
       vixl::aarch64::Label done;
+      vixl::aarch64::Label update_cache;
       __ Mov(x8, address);
       __ Ldr(w9, MemOperand(x8, InlineCache::ClassesOffset().Int32Value()));
-      // Fast path for a monomorphic cache.
+      // Fast path for a monomorphic cache: only count the receiver. The runtime
+      // entrypoint counts the receivers of the other entries.
       __ Cmp(klass.W(), w9);
-      __ B(eq, &done);
+      __ B(ne, &update_cache);
+      __ Ldr(w9, MemOperand(x8, InlineCache::CountsOffset().Int32Value()));
+      __ Add(w9, w9, 1);
+      __ Str(w9, MemOperand(x8, InlineCache::CountsOffset().Int32Value()));
+      __ B(&done);
+      __ Bind(&update_cache);
       InvokeRuntime(kQuickUpdateInlineCache, instruction, instruction->GetDexPc());
       __ Bind(&done);
     } else {
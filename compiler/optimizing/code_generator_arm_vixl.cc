@@ -3701,13 +3701,20 @@ void CodeGeneratorARMVIXL::MaybeGenerateInlineCacheCheck(HInstruction* instructi
     if (cache != nullptr) {
       uint32_t address = reinterpret_cast32<uint32_t>(cache);
       vixl32::Label done;
+      vixl32::Label update_cache;
       UseScratchRegisterScope temps(GetVIXLAssembler());
       temps.Exclude(ip);
       __ Mov(r4, address);
       __ Ldr(ip, MemOperand(r4, InlineCache::ClassesOffset().Int32Value()));
-      // Fast path for a monomorphic cache.
+      // Fast path for a monomorphic cache: only count the receiver. The runtime
+      // entrypoint counts the receivers of the other entries.
       __ Cmp(klass, ip);
-      __ B(eq, &done, /* is_far_target= */ false);
+      __ B(ne, &update_cache, /* is_far_target= */ false);
+      __ Ldr(ip, MemOperand(r4, InlineCache::CountsOffset().Int32Value()));
+      __ Add(ip, ip, 1);
+      __ Str(ip, MemOperand(r4, InlineCache::CountsOffset().Int32Value()));
+      __ B(&done);
+      __ Bind(&update_cache);
       InvokeRuntime(kQuickUpdateInlineCache, instruction, instruction->GetDexPc());
       __ Bind(&done);
     } else {
@@ -6787,6 +6787,7 @@ void CodeGeneratorRISCV64::MaybeGenerateInlineCacheCheck(HInstruction* instructi
     if (cache != nullptr) {
       uint64_t address = reinterpret_cast64<uint64_t>(cache);
       Riscv64Label done;
+      Riscv64Label update_cache;
       // The `art_quick_update_inline_cache` expects the inline cache in T5.
       XRegister ic_reg = T5;
       ScratchRegisterScope srs(GetAssembler());
@@ -6798,9 +6799,15 @@ void CodeGeneratorRISCV64::MaybeGenerateInlineCacheCheck(HInstruction* instructi
         ScratchRegisterScope srs2(GetAssembler());
         XRegister tmp = srs2.AllocateXRegister();
         __ Loadd(tmp, ic_reg, InlineCache::ClassesOffset().Int32Value());
-        // Fast path for a monomorphic cache.
-        __ Beq(klass, tmp, &done);
+        // Fast path for a monomorphic cache: only count the receiver. The runtime
+        // entrypoint counts the receivers of the other entries.
+        __ Bne(klass, tmp, &update_cache);
+        __ Loadwu(tmp, ic_reg, InlineCache::CountsOffset().Int32Value());
+        __ Addiw(tmp, tmp, 1);
+        __ Storew(tmp, ic_reg, InlineCache::CountsOffset().Int32Value());
+        __ J(&done);
       }
+      __ Bind(&update_cache);
       InvokeRuntime(kQuickUpdateInlineCache, instruction, instruction->GetDexPc());
       __ Bind(&done);
     } else {
@@ -2873,10 +2873,15 @@ void CodeGeneratorX86::MaybeGenerateInlineCacheCheck(HInstruction* instruction,
       }
       Register temp = EBP;
       NearLabel done;
+      NearLabel update_cache;
       __ movl(temp, Immediate(address));
-      // Fast path for a monomorphic cache.
+      // Fast path for a monomorphic cache: only count the receiver. The runtime
+      // entrypoint counts the receivers of the other entries.
       __ cmpl(klass, Address(temp, InlineCache::ClassesOffset().Int32Value()));
-      __ j(kEqual, &done);
+      __ j(kNotEqual, &update_cache);
+      __ addl(Address(temp, InlineCache::CountsOffset().Int32Value()), Immediate(1));
+      __ jmp(&done);
+      __ Bind(&update_cache);
       GenerateInvokeRuntime(GetThreadOffset<kX86PointerSize>(kQuickUpdateInlineCache).Int32Value());
       __ Bind(&done);
     } else {
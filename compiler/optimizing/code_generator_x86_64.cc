@@ -3160,10 +3160,15 @@ void CodeGeneratorX86_64::MaybeGenerateInlineCacheCheck(HInstruction* instructio
     if (cache != nullptr) {
       uint64_t address = reinterpret_cast64<uint64_t>(cache);
       NearLabel done;
+      NearLabel update_cache;
       __ movq(CpuRegister(TMP), Immediate(address));
-      // Fast path for a monomorphic cache.
+      // Fast path for a monomorphic cache: only count the receiver. The runtime
+      // entrypoint counts the receivers of the other entries.
       __ cmpl(Address(CpuRegister(TMP), InlineCache::ClassesOffset().Int32Value()), klass);
-      __ j(kEqual, &done);
+      __ j(kNotEqual, &update_cache);
+      __ addl(Address(CpuRegister(TMP), InlineCache::CountsOffset().Int32Value()), Immediate(1));
+      __ jmp(&done);
+      __ Bind(&update_cache);
       GenerateInvokeRuntime(
           GetThreadOffset<kX86_64PointerSize>(kQuickUpdateInlineCache).Int32Value());
       __ Bind(&done);
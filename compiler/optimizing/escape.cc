@@ -16,6 +16,8 @@
 
 #include "escape.h"
 
+#include <algorithm>
+
 #include "nodes.h"
 
 namespace art HIDDEN {
@@ -150,4 +152,121 @@ bool DoesNotEscape(HInstruction* reference, NoEscapeCheck& no_escape) {
   return is_singleton_and_not_returned;
 }
 
+// Limit on the number of blocks in an escape region. Regions are expected to be small
+// error-handling paths; bailing out on large ones keeps the analysis cheap.
+static constexpr size_t kMaxEscapeRegionBlocks = 64;
+
+// Returns whether the blocks dominated by 'entry' (including 'entry') form a region
+// that can only be left by exiting the method.
+static bool IsExitOnlyRegion(HBasicBlock* entry) {
+  HGraph* graph = entry->GetGraph();
+  ScopedArenaAllocator allocator(graph->GetArenaStack());
+  ScopedArenaVector<HBasicBlock*> worklist(allocator.Adapter(kArenaAllocMisc));
+  worklist.push_back(entry);
+  size_t visited_blocks = 0u;
+  while (!worklist.empty()) {
+    HBasicBlock* block = worklist.back();
+    worklist.pop_back();
+    if (++visited_blocks > kMaxEscapeRegionBlocks) {
+      return false;
+    }
+    for (HBasicBlock* successor : block->GetSuccessors()) {
+      if (!successor->IsExitBlock() && !entry->Dominates(successor)) {
+        return false;
+      }
+    }
+    for (HBasicBlock* dominated : block->GetDominatedBlocks()) {
+      worklist.push_back(dominated);
+    }
+  }
+  return true;
+}
+
+// Returns the closest dominator of 'block' (including 'block' itself) that is strictly
+// dominated by 'allocation_block' and is the entry of an exit-only region, or null.
+static HBasicBlock* FindEscapeRegion(HBasicBlock* allocation_block, HBasicBlock* block) {
+  for (HBasicBlock* current = block;
+       current != nullptr && current != allocation_block;
+       current = current->GetDominator()) {
+    // A loop header would execute the materialization on every iteration.
+    if (!current->IsLoopHeader() && IsExitOnlyRegion(current)) {
+      return current;
+    }
+  }
+  return nullptr;
+}
+
+bool CalculatePartialEscape(HInstruction* reference,
+                            /*out*/ ScopedArenaVector<HBasicBlock*>* materialization_blocks) {
+  DCHECK(materialization_blocks->empty());
+  if (!reference->IsNewInstance() || reference->AsNewInstance()->IsFinalizable()) {
+    return false;
+  }
+  HBasicBlock* allocation_block = reference->GetBlock();
+  if (allocation_block->GetGraph()->HasTryCatch()) {
+    // Exceptional control flow is not represented by the regions computed below.
+    return false;
+  }
+
+  bool success = true;
+  LambdaEscapeVisitor visitor([&](HInstruction* escape) -> bool {
+    if (escape->IsPhi()) {
+      // Phi inputs flow along edges, we cannot tell the region from the user alone.
+      success = false;
+      return false;
+    }
+    HBasicBlock* region = FindEscapeRegion(allocation_block, escape->GetBlock());
+    if (region == nullptr) {
+      success = false;
+      return false;
+    }
+    if (std::find(materialization_blocks->begin(), materialization_blocks->end(), region) ==
+        materialization_blocks->end()) {
+      materialization_blocks->push_back(region);
+    }
+    return true;
+  });
+  VisitEscapes(reference, visitor);
+  if (!success || materialization_blocks->empty()) {
+    materialization_blocks->clear();
+    return false;
+  }
+
+  // Only keep the outermost regions; nested ones are covered by their enclosing region.
+  auto is_nested = [&](HBasicBlock* region) {
+    return std::any_of(materialization_blocks->begin(),
+                       materialization_blocks->end(),
+                       [region](HBasicBlock* other) {
+                         return other != region && other->Dominates(region);
+                       });
+  };
+  materialization_blocks->erase(std::remove_if(materialization_blocks->begin(),
+                                               materialization_blocks->end(),
+                                               is_nested),
+                                materialization_blocks->end());
+
+  auto is_in_region = [&](HBasicBlock* block) {
+    return std::any_of(materialization_blocks->begin(),
+                       materialization_blocks->end(),
+                       [block](HBasicBlock* region) { return region->Dominates(block); });
+  };
+  // Outside of the regions the reference must behave like a singleton whose field values
+  // can be copied to the materialized object.
+  for (const HUseListNode<HInstruction*>& use : reference->GetUses()) {
+    HInstruction* user = use.GetUser();
+    if (is_in_region(user->GetBlock())) {
+      continue;
+    }
+    bool is_field_access_on_reference =
+        (user->IsInstanceFieldGet() || user->IsInstanceFieldSet()) &&
+        use.GetIndex() == 0u &&
+        !user->GetFieldInfo().IsVolatile();
+    if (!is_field_access_on_reference && !user->IsConstructorFence()) {
+      materialization_blocks->clear();
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace art
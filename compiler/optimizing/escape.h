@@ -18,9 +18,11 @@
 #define ART_COMPILER_OPTIMIZING_ESCAPE_H_
 
 #include "base/macros.h"
+#include "base/scoped_arena_containers.h"
 
 namespace art HIDDEN {
 
+class HBasicBlock;
 class HInstruction;
 
 /*
@@ -146,6 +148,24 @@ inline bool DoesNotEscape(HInstruction* reference,
   return DoesNotEscape(reference, esc);
 }
 
+/*
+ * Performs partial escape analysis on the given instruction, typically a reference to an
+ * allocation that `CalculateEscape` considers escaping. The method returns true if every
+ * escape of the reference happens in an "escape region": a dominator subtree, strictly
+ * dominated by the allocation, from which control flow can only leave the method (e.g. an
+ * error path ending in a throw). In that case the entry blocks of the (non-nested) regions
+ * are stored in 'materialization_blocks'.
+ *
+ * All other uses of the reference are guaranteed to be plain field accesses of a
+ * non-volatile field on the reference itself or constructor fences. Therefore, if a copy
+ * of the object is materialized at the entry of each region and the uses inside the
+ * regions are redirected to that copy, the original allocation no longer escapes.
+ *
+ * Only non-finalizable HNewInstance references in graphs without try/catch are handled.
+ */
+bool CalculatePartialEscape(HInstruction* reference,
+                            /*out*/ ScopedArenaVector<HBasicBlock*>* materialization_blocks);
+
 }  // namespace art
 
 #endif  // ART_COMPILER_OPTIMIZING_ESCAPE_H_
@@ -76,6 +76,17 @@ static constexpr bool kUseAOTInlineCaches = true;
 // Controls the use of inlining try catches.
 static constexpr bool kInlineTryCatches = true;
 
+// Controls speculative inlining of the dominant receivers of megamorphic calls in JIT mode,
+// based on the receiver counts collected in the inline caches.
+static constexpr bool kSpeculateMegamorphicCalls = true;
+
+// Minimum share, in percent, of the receivers recorded for a megamorphic call that a class
+// must account for to be speculatively inlined.
+static constexpr uint32_t kMegamorphicDominantReceiverPercent = 30;
+
+// Minimum number of receivers recorded for a megamorphic call before we trust its counts.
+static constexpr uint32_t kMegamorphicMinimumReceiverCount = 100;
+
 // We check for line numbers to make sure the DepthString implementation
 // aligns the output nicely.
 #define LOG_INTERNAL(msg) \
@@ -630,12 +641,15 @@ bool HInliner::TryInlineFromInlineCache(HInvoke* invoke_instruction)
   }
 
   StackHandleScope<InlineCache::kIndividualCacheSize> classes(Thread::Current());
+  // Receiver counts, only available from runtime inline caches.
+  uint32_t counts[InlineCache::kIndividualCacheSize] = {};
   // The Zygote JIT compiles based on a profile, so we shouldn't use runtime inline caches
   // for it.
-  InlineCacheType inline_cache_type =
-      (Runtime::Current()->IsAotCompiler() || Runtime::Current()->IsZygote())
-          ? GetInlineCacheAOT(invoke_instruction, &classes)
-          : GetInlineCacheJIT(invoke_instruction, &classes);
+  const bool use_aot_inline_cache =
+      Runtime::Current()->IsAotCompiler() || Runtime::Current()->IsZygote();
+  InlineCacheType inline_cache_type = use_aot_inline_cache
+      ? GetInlineCacheAOT(invoke_instruction, &classes)
+      : GetInlineCacheJIT(invoke_instruction, &classes, counts);
 
   switch (inline_cache_type) {
     case kInlineCacheNoData: {
@@ -668,11 +682,16 @@ bool HInliner::TryInlineFromInlineCache(HInvoke* invoke_instruction)
     }
 
     case kInlineCacheMegamorphic: {
+      MaybeRecordStat(stats_, MethodCompilationStat::kMegamorphicCall);
+      if (kSpeculateMegamorphicCalls &&
+          !use_aot_inline_cache &&
+          TryInlineMegamorphicCall(invoke_instruction, classes, counts)) {
+        return true;
+      }
       LOG_FAIL_NO_STAT()
           << "Interface or virtual call to "
           << invoke_instruction->GetMethodReference().PrettyMethod()
           << " is megamorphic and not inlined";
-      MaybeRecordStat(stats_, MethodCompilationStat::kMegamorphicCall);
       return false;
     }
 
@@ -689,7 +708,8 @@ bool HInliner::TryInlineFromInlineCache(HInvoke* invoke_instruction)
 
 HInliner::InlineCacheType HInliner::GetInlineCacheJIT(
     HInvoke* invoke_instruction,
-    /*out*/StackHandleScope<InlineCache::kIndividualCacheSize>* classes) {
+    /*out*/StackHandleScope<InlineCache::kIndividualCacheSize>* classes,
+    /*out*/uint32_t* counts) {
   DCHECK(codegen_->GetCompilerOptions().IsJitCompiler());
 
   ArtMethod* caller = graph_->GetArtMethod();
@@ -727,7 +747,7 @@ HInliner::InlineCacheType HInliner::GetInlineCacheJIT(
     // Bail for now.
     return kInlineCacheNoData;
   }
-  Runtime::Current()->GetJit()->GetCodeCache()->CopyInlineCacheInto(*cache, classes);
+  Runtime::Current()->GetJit()->GetCodeCache()->CopyInlineCacheInto(*cache, classes, counts);
   return GetInlineCacheType(*classes);
 }
 
@@ -1022,11 +1042,14 @@ static void MaybeReplaceAndRemove(HInstruction* new_instruction, HInstruction* o
 
 bool HInliner::TryInlinePolymorphicCall(
     HInvoke* invoke_instruction,
-    const StackHandleScope<InlineCache::kIndividualCacheSize>& classes) {
+    const StackHandleScope<InlineCache::kIndividualCacheSize>& classes,
+    bool is_megamorphic) {
   DCHECK(invoke_instruction->IsInvokeVirtual() || invoke_instruction->IsInvokeInterface())
       << invoke_instruction->DebugName();
 
-  if (TryInlinePolymorphicCallToSameTarget(invoke_instruction, classes)) {
+  // For megamorphic calls `classes` only holds the dominant receivers, so the same target
+  // optimization, which deoptimizes on other receivers, does not apply.
+  if (!is_megamorphic && TryInlinePolymorphicCallToSameTarget(invoke_instruction, classes)) {
     return true;
   }
 
@@ -1059,7 +1082,7 @@ bool HInliner::TryInlinePolymorphicCall(
 
     // In monomorphic cases when UseOnlyPolymorphicInliningWithNoDeopt() is true, we call
     // `TryInlinePolymorphicCall` even though we are monomorphic.
-    const bool actually_monomorphic = number_of_types == 1;
+    const bool actually_monomorphic = number_of_types == 1 && !is_megamorphic;
     DCHECK_IMPLIES(actually_monomorphic, UseOnlyPolymorphicInliningWithNoDeopt());
 
     // We only want to limit recursive polymorphic cases, not monomorphic ones.
@@ -1090,8 +1113,10 @@ bool HInliner::TryInlinePolymorphicCall(
                     << " has inlined " << ArtMethod::PrettyMethod(method);
 
       // If we have inlined all targets before, and this receiver is the last seen,
-      // we deoptimize instead of keeping the original invoke instruction.
+      // we deoptimize instead of keeping the original invoke instruction. Megamorphic
+      // calls always keep the original invoke for the receivers we did not inline.
       bool deoptimize = !UseOnlyPolymorphicInliningWithNoDeopt() &&
+          !is_megamorphic &&
           all_targets_inlined &&
           (i + 1 == number_of_types);
 
@@ -1118,13 +1143,62 @@ bool HInliner::TryInlinePolymorphicCall(
     return false;
   }
 
-  MaybeRecordStat(stats_, MethodCompilationStat::kInlinedPolymorphicCall);
+  MaybeRecordStat(stats_,
+                  is_megamorphic ? MethodCompilationStat::kInlinedSpeculativeMegamorphicCall
+                                 : MethodCompilationStat::kInlinedPolymorphicCall);
 
   // Lazily run type propagation to get the guards typed.
   run_extra_type_propagation_ = true;
   return true;
 }
 
+bool HInliner::TryInlineMegamorphicCall(
+    HInvoke* invoke_instruction,
+    const StackHandleScope<InlineCache::kIndividualCacheSize>& classes,
+    const uint32_t* counts) {
+  DCHECK(codegen_->GetCompilerOptions().IsJitCompiler());
+  DCHECK_EQ(classes.Size(), InlineCache::kIndividualCacheSize);
+
+  // The last entry of a megamorphic cache also accumulates all the receivers that did not fit
+  // in the cache, so it is only used for the total. The counts are racy estimates, which is
+  // fine for a heuristic.
+  uint64_t total = 0u;
+  for (size_t i = 0; i != InlineCache::kIndividualCacheSize; ++i) {
+    total += counts[i];
+  }
+  if (total < kMegamorphicMinimumReceiverCount) {
+    LOG_FAIL_NO_STAT()
+        << "Megamorphic call to " << invoke_instruction->GetMethodReference().PrettyMethod()
+        << " does not have enough receiver counts to speculate";
+    return false;
+  }
+
+  // Keep the dominant receivers, most frequent first so that the most likely type guard is
+  // tested first.
+  std::array<size_t, InlineCache::kIndividualCacheSize - 1u> dominant;
+  size_t number_of_dominant = 0u;
+  for (size_t i = 0; i != InlineCache::kIndividualCacheSize - 1u; ++i) {
+    if (static_cast<uint64_t>(counts[i]) * 100u >= total * kMegamorphicDominantReceiverPercent) {
+      dominant[number_of_dominant++] = i;
+    }
+  }
+  if (number_of_dominant == 0u) {
+    LOG_FAIL_NO_STAT()
+        << "Megamorphic call to " << invoke_instruction->GetMethodReference().PrettyMethod()
+        << " has no dominant receiver";
+    return false;
+  }
+  std::sort(dominant.begin(),
+            dominant.begin() + number_of_dominant,
+            [counts](size_t lhs, size_t rhs) { return counts[lhs] > counts[rhs]; });
+
+  StackHandleScope<InlineCache::kIndividualCacheSize> dominant_classes(Thread::Current());
+  for (size_t i = 0; i != number_of_dominant; ++i) {
+    dominant_classes.NewHandle(classes.GetReference(dominant[i])->AsClass());
+  }
+  return TryInlinePolymorphicCall(invoke_instruction, dominant_classes, /*is_megamorphic=*/ true);
+}
+
 void HInliner::CreateDiamondPatternForPolymorphicInline(HInstruction* compare,
                                                         HInstruction* return_replacement,
                                                         HInstruction* invoke_instruction) {
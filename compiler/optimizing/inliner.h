@@ -194,9 +194,11 @@ class HInliner : public HOptimization {
   // Try getting the inline cache from JIT code cache.
   // Return true if the inline cache was successfully allocated and the
   // invoke info was found in the profile info.
+  // If `counts` is not null, it receives the receiver count of each entry of `classes`.
   InlineCacheType GetInlineCacheJIT(
       HInvoke* invoke_instruction,
-      /*out*/StackHandleScope<InlineCache::kIndividualCacheSize>* classes)
+      /*out*/StackHandleScope<InlineCache::kIndividualCacheSize>* classes,
+      /*out*/uint32_t* counts = nullptr)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Try getting the inline cache from AOT offline profile.
@@ -220,9 +222,20 @@ class HInliner : public HOptimization {
                                 const StackHandleScope<InlineCache::kIndividualCacheSize>& classes)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // Try to inline targets of a polymorphic call.
+  // Try to inline targets of a polymorphic call. If `is_megamorphic` is true, `classes` only
+  // holds some of the receivers and the original invoke is always kept as the fallback.
   bool TryInlinePolymorphicCall(HInvoke* invoke_instruction,
-                                const StackHandleScope<InlineCache::kIndividualCacheSize>& classes)
+                                const StackHandleScope<InlineCache::kIndividualCacheSize>& classes,
+                                bool is_megamorphic = false)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Try to inline the dominant receivers of a megamorphic call, based on the receiver
+  // counts of the JIT inline cache. If successful, the code in the graph will look like:
+  // if (receiver.getClass() == dominant) ... // inlined code
+  // else invoke
+  bool TryInlineMegamorphicCall(HInvoke* invoke_instruction,
+                                const StackHandleScope<InlineCache::kIndividualCacheSize>& classes,
+                                const uint32_t* counts)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
   bool TryInlinePolymorphicCallToSameTarget(
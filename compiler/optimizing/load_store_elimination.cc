@@ -2897,6 +2897,153 @@ void LSEVisitor::FinishFullLSE() {
   }
 }
 
+// Limit on the number of copies of a partially escaping allocation, so that
+// we do not trade one allocation on the hot path for a lot of cold code.
+static constexpr size_t kMaxPartialEscapeMaterializations = 4u;
+
+// Materializes a copy of `new_instance` at the start of `block`, copying the values of the
+// fields in `fields` and redirecting all uses of `new_instance` dominated by `block`.
+static void MaterializeAllocation(HNewInstance* new_instance,
+                                  HBasicBlock* block,
+                                  const ScopedArenaVector<const FieldInfo*>& fields,
+                                  bool needs_constructor_fence,
+                                  OptimizingCompilerStats* stats) {
+  HGraph* graph = block->GetGraph();
+  ArenaAllocator* allocator = graph->GetAllocator();
+  HInstruction* cursor = block->GetFirstInstruction();
+  HNewInstance* materialization = new_instance->Clone(allocator)->AsNewInstance();
+  materialization->SetPartialMaterialization();
+  block->InsertInstructionBefore(materialization, cursor);
+  // The environment of the original allocation is valid here as it dominates `block`.
+  materialization->CopyEnvironmentFrom(new_instance->GetEnvironment());
+  for (const FieldInfo* field : fields) {
+    // Read the current value from the original object. These loads are replaced by the
+    // known heap values when LSE processes the now non-escaping original allocation.
+    HInstanceFieldGet* load = new (allocator) HInstanceFieldGet(new_instance,
+                                                               field->GetField(),
+                                                               field->GetFieldType(),
+                                                               field->GetFieldOffset(),
+                                                               /*is_volatile=*/ false,
+                                                               field->GetFieldIndex(),
+                                                               field->GetDeclaringClassDefIndex(),
+                                                               field->GetDexFile(),
+                                                               new_instance->GetDexPc());
+    if (load->GetType() == DataType::Type::kReference) {
+      load->SetReferenceTypeInfo(graph->GetInexactObjectRti());
+    }
+    block->InsertInstructionBefore(load, cursor);
+    HInstanceFieldSet* store = new (allocator) HInstanceFieldSet(materialization,
+                                                                 load,
+                                                                 field->GetField(),
+                                                                 field->GetFieldType(),
+                                                                 field->GetFieldOffset(),
+                                                                 /*is_volatile=*/ false,
+                                                                 field->GetFieldIndex(),
+                                                                 field->GetDeclaringClassDefIndex(),
+                                                                 field->GetDexFile(),
+                                                                 new_instance->GetDexPc());
+    block->InsertInstructionBefore(store, cursor);
+  }
+  if (needs_constructor_fence) {
+    HConstructorFence* fence =
+        new (allocator) HConstructorFence(materialization, new_instance->GetDexPc(), allocator);
+    block->InsertInstructionBefore(fence, cursor);
+  }
+  new_instance->ReplaceUsesDominatedBy(cursor, materialization, /*strictly_dominated=*/ false);
+  new_instance->ReplaceEnvUsesDominatedBy(materialization, materialization);
+  MaybeRecordStat(stats, MethodCompilationStat::kPartialAllocationMoved);
+}
+
+// Returns whether an HDeoptimize outside of `regions` can observe `new_instance`, which keeps
+// LSE from removing it even once it no longer escapes.
+static bool IsDeoptVisibleOutside(HNewInstance* new_instance,
+                                  const ScopedArenaVector<HBasicBlock*>& regions) {
+  for (const HUseListNode<HEnvironment*>& use : new_instance->GetEnvUses()) {
+    HInstruction* holder = use.GetUser()->GetHolder();
+    if (holder->IsDeoptimize() &&
+        std::none_of(regions.begin(),
+                     regions.end(),
+                     [holder](HBasicBlock* region) {
+                       return region->Dominates(holder->GetBlock());
+                     })) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Partial escape analysis: allocations that escape only on paths leaving the method (typically
+// error paths ending in a throw) are materialized on those paths only. The original allocation
+// then no longer escapes and is removed, together with its loads and stores, by full LSE.
+// Only allocations that full LSE removes once they stop escaping are materialized, otherwise
+// the copies would only add code. Returns whether any allocation was materialized.
+static bool MaterializePartialEscapes(HGraph* graph,
+                                      const HeapLocationCollector& heap_location_collector,
+                                      OptimizingCompilerStats* stats) {
+  ScopedArenaAllocator allocator(graph->GetArenaStack());
+  ScopedArenaVector<HNewInstance*> candidates(allocator.Adapter(kArenaAllocLSE));
+  for (HBasicBlock* block : graph->GetReversePostOrder()) {
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      if (!it.Current()->IsNewInstance()) {
+        continue;
+      }
+      HNewInstance* new_instance = it.Current()->AsNewInstance();
+      // LSE only removes allocations whose fields it tracks and which cannot throw.
+      ReferenceInfo* ref_info = heap_location_collector.FindReferenceInfoOf(new_instance);
+      if (ref_info != nullptr &&
+          !ref_info->IsSingleton() &&
+          heap_location_collector.InstructionEligibleForLSERemoval(new_instance)) {
+        candidates.push_back(new_instance);
+      }
+    }
+  }
+
+  ScopedArenaVector<HBasicBlock*> materialization_blocks(allocator.Adapter(kArenaAllocLSE));
+  ScopedArenaVector<const FieldInfo*> fields(allocator.Adapter(kArenaAllocLSE));
+  bool materialized = false;
+  for (HNewInstance* new_instance : candidates) {
+    materialization_blocks.clear();
+    if (!CalculatePartialEscape(new_instance, &materialization_blocks) ||
+        materialization_blocks.size() > kMaxPartialEscapeMaterializations ||
+        IsDeoptVisibleOutside(new_instance, materialization_blocks)) {
+      continue;
+    }
+    MaybeRecordStat(stats, MethodCompilationStat::kPartialLSEPossible);
+
+    // Collect the fields written to the object outside of the escape regions. Other fields
+    // hold default values which the materialized object gets from the allocation.
+    fields.clear();
+    bool needs_constructor_fence = false;
+    for (const HUseListNode<HInstruction*>& use : new_instance->GetUses()) {
+      HInstruction* user = use.GetUser();
+      auto dominates_user = [user](HBasicBlock* block) {
+        return block->Dominates(user->GetBlock());
+      };
+      if (std::any_of(materialization_blocks.begin(),
+                      materialization_blocks.end(),
+                      dominates_user)) {
+        continue;
+      } else if (user->IsConstructorFence()) {
+        needs_constructor_fence = true;
+      } else if (user->IsInstanceFieldSet() && use.GetIndex() == 0u) {
+        const FieldInfo* field = &user->AsInstanceFieldSet()->GetFieldInfo();
+        auto same_offset = [field](const FieldInfo* other) {
+          return other->GetFieldOffset().Uint32Value() == field->GetFieldOffset().Uint32Value();
+        };
+        if (std::none_of(fields.begin(), fields.end(), same_offset)) {
+          fields.push_back(field);
+        }
+      }
+    }
+
+    for (HBasicBlock* block : materialization_blocks) {
+      MaterializeAllocation(new_instance, block, fields, needs_constructor_fence, stats);
+    }
+    materialized = true;
+  }
+  return materialized;
+}
+
 // The LSEVisitor is a ValueObject (indirectly through base classes) and therefore
 // cannot be directly allocated with an arena allocator, so we need to wrap it.
 class LSEVisitorWrapper : public DeletableArenaObject<kArenaAllocLSE> {
@@ -2920,15 +3067,6 @@ bool LoadStoreElimination::Run() {
     // Skip this optimization.
     return false;
   }
-  ScopedArenaAllocator allocator(graph_->GetArenaStack());
-  LoadStoreAnalysis lsa(graph_, stats_, &allocator);
-  lsa.Run();
-  const HeapLocationCollector& heap_location_collector = lsa.GetHeapLocationCollector();
-  if (heap_location_collector.GetNumberOfHeapLocations() == 0) {
-    // No HeapLocation information from LSA, skip this optimization.
-    return false;
-  }
-
   // Currently load_store analysis can't handle predicated load/stores; specifically pairs of
   // memory operations with different predicates.
   // TODO: support predicated SIMD.
@@ -2936,8 +3074,31 @@ bool LoadStoreElimination::Run() {
     return false;
   }
 
+  {
+    ScopedArenaAllocator allocator(graph_->GetArenaStack());
+    LoadStoreAnalysis lsa(graph_, stats_, &allocator);
+    lsa.Run();
+    const HeapLocationCollector& heap_location_collector = lsa.GetHeapLocationCollector();
+    if (heap_location_collector.GetNumberOfHeapLocations() == 0) {
+      // No HeapLocation information from LSA, skip this optimization.
+      return false;
+    }
+
+    if (!MaterializePartialEscapes(graph_, heap_location_collector, stats_)) {
+      std::unique_ptr<LSEVisitorWrapper> lse_visitor(
+          new (&allocator) LSEVisitorWrapper(graph_, heap_location_collector, stats_));
+      lse_visitor->Run();
+      return true;
+    }
+  }
+
+  // The materialized allocations no longer escape, analyze the graph again so that LSE sees
+  // them as singletons. Do not record the reference stats twice.
+  ScopedArenaAllocator allocator(graph_->GetArenaStack());
+  LoadStoreAnalysis lsa(graph_, /*stats=*/ nullptr, &allocator);
+  lsa.Run();
   std::unique_ptr<LSEVisitorWrapper> lse_visitor(
-      new (&allocator) LSEVisitorWrapper(graph_, heap_location_collector, stats_));
+      new (&allocator) LSEVisitorWrapper(graph_, lsa.GetHeapLocationCollector(), stats_));
   lse_visitor->Run();
   return true;
 }
@@ -2428,4 +2428,207 @@ TEST_F(LoadStoreEliminationTest, DISABLED_PartialLoadPreserved6) {
   EXPECT_INS_RETAINED(call_left);
   EXPECT_INS_RETAINED(call_entry);
 }
+
+// // ENTRY
+// obj = new Obj();
+// obj.field = 1;
+// if (parameter_value) {
+//   // LEFT
+//   // Only escape, on a path leaving the method.
+//   call_func(obj);
+//   return 0;
+// } else {
+//   // RIGHT
+//   // Eliminated together with the allocation and the write in ENTRY.
+//   return obj.field;
+// }
+// EXIT
+TEST_F(LoadStoreEliminationTest, PartialEscapeMaterialized) {
+  CreateGraph();
+  AdjacencyListGraph blks(SetupFromAdjacencyList("entry",
+                                                 "exit",
+                                                 {{"entry", "left"},
+                                                  {"entry", "right"},
+                                                  {"left", "exit"},
+                                                  {"right", "exit"}}));
+#define GET_BLOCK(name) HBasicBlock* name = blks.Get(#name)
+  GET_BLOCK(entry);
+  GET_BLOCK(exit);
+  GET_BLOCK(left);
+  GET_BLOCK(right);
+#undef GET_BLOCK
+  HInstruction* bool_value = MakeParam(DataType::Type::kBool);
+  HInstruction* c0 = graph_->GetIntConstant(0);
+  HInstruction* c1 = graph_->GetIntConstant(1);
+
+  HInstruction* cls = MakeClassLoad();
+  HInstruction* new_inst = MakeNewInstance(cls);
+  HInstruction* write_entry = MakeIFieldSet(new_inst, c1, MemberOffset(32));
+  HInstruction* if_inst = new (GetAllocator()) HIf(bool_value);
+  entry->AddInstruction(cls);
+  entry->AddInstruction(new_inst);
+  entry->AddInstruction(write_entry);
+  entry->AddInstruction(if_inst);
+  ManuallyBuildEnvFor(cls, {});
+  new_inst->CopyEnvironmentFrom(cls->GetEnvironment());
+
+  HInstruction* call_left = MakeInvoke(DataType::Type::kVoid, { new_inst });
+  HInstruction* return_left = new (GetAllocator()) HReturn(c0);
+  left->AddInstruction(call_left);
+  left->AddInstruction(return_left);
+  call_left->CopyEnvironmentFrom(cls->GetEnvironment());
+
+  HInstruction* read_right = MakeIFieldGet(new_inst, DataType::Type::kInt32, MemberOffset(32));
+  HInstruction* return_right = new (GetAllocator()) HReturn(read_right);
+  right->AddInstruction(read_right);
+  right->AddInstruction(return_right);
+
+  SetupExit(exit);
+
+  PerformLSE(blks);
+
+  EXPECT_INS_REMOVED(new_inst);
+  EXPECT_INS_REMOVED(write_entry);
+  EXPECT_INS_REMOVED(read_right);
+  EXPECT_INS_EQ(return_right->InputAt(0), c1);
+  EXPECT_INS_RETAINED(call_left);
+
+  // The object is materialized in LEFT with the value of the field at that point.
+  HInstruction* materialization = call_left->InputAt(0);
+  ASSERT_TRUE(materialization->IsNewInstance());
+  EXPECT_TRUE(materialization->AsNewInstance()->IsPartialMaterialization());
+  EXPECT_EQ(materialization->GetBlock(), left);
+  HInstruction* write_left = materialization->GetNext();
+  ASSERT_TRUE(write_left->IsInstanceFieldSet());
+  EXPECT_INS_EQ(write_left->InputAt(0), materialization);
+  EXPECT_INS_EQ(write_left->InputAt(1), c1);
+  EXPECT_EQ(write_left->GetNext(), call_left);
+}
+
+// // ENTRY
+// obj = new Obj();
+// obj.field = 1;
+// if (parameter_value) {
+//   // LEFT
+//   call_func(obj);
+// }
+// // BRETURN
+// // The escaping path rejoins the non-escaping one, no materialization.
+// return obj.field;
+// EXIT
+TEST_F(LoadStoreEliminationTest, PartialEscapeRejoiningNotMaterialized) {
+  CreateGraph();
+  AdjacencyListGraph blks(SetupFromAdjacencyList("entry",
+                                                 "exit",
+                                                 {{"entry", "left"},
+                                                  {"entry", "breturn"},
+                                                  {"left", "breturn"},
+                                                  {"breturn", "exit"}}));
+#define GET_BLOCK(name) HBasicBlock* name = blks.Get(#name)
+  GET_BLOCK(entry);
+  GET_BLOCK(exit);
+  GET_BLOCK(breturn);
+  GET_BLOCK(left);
+#undef GET_BLOCK
+  HInstruction* bool_value = MakeParam(DataType::Type::kBool);
+  HInstruction* c1 = graph_->GetIntConstant(1);
+
+  HInstruction* cls = MakeClassLoad();
+  HInstruction* new_inst = MakeNewInstance(cls);
+  HInstruction* write_entry = MakeIFieldSet(new_inst, c1, MemberOffset(32));
+  HInstruction* if_inst = new (GetAllocator()) HIf(bool_value);
+  entry->AddInstruction(cls);
+  entry->AddInstruction(new_inst);
+  entry->AddInstruction(write_entry);
+  entry->AddInstruction(if_inst);
+  ManuallyBuildEnvFor(cls, {});
+  new_inst->CopyEnvironmentFrom(cls->GetEnvironment());
+
+  HInstruction* call_left = MakeInvoke(DataType::Type::kVoid, { new_inst });
+  HInstruction* goto_left = new (GetAllocator()) HGoto();
+  left->AddInstruction(call_left);
+  left->AddInstruction(goto_left);
+  call_left->CopyEnvironmentFrom(cls->GetEnvironment());
+
+  HInstruction* read_bottom = MakeIFieldGet(new_inst, DataType::Type::kInt32, MemberOffset(32));
+  HInstruction* return_exit = new (GetAllocator()) HReturn(read_bottom);
+  breturn->AddInstruction(read_bottom);
+  breturn->AddInstruction(return_exit);
+
+  SetupExit(exit);
+
+  PerformLSE(blks);
+
+  EXPECT_INS_RETAINED(new_inst);
+  EXPECT_INS_RETAINED(write_entry);
+  EXPECT_INS_RETAINED(read_bottom);
+  EXPECT_INS_EQ(call_left->InputAt(0), new_inst);
+}
+
+// // ENTRY
+// obj = new Obj();  // Needs an access check, cannot be removed.
+// obj.field = 1;
+// if (parameter_value) {
+//   // LEFT
+//   call_func(obj);
+//   return 0;
+// } else {
+//   // RIGHT
+//   return obj.field;
+// }
+// EXIT
+TEST_F(LoadStoreEliminationTest, PartialEscapeNotRemovableNotMaterialized) {
+  CreateGraph();
+  AdjacencyListGraph blks(SetupFromAdjacencyList("entry",
+                                                 "exit",
+                                                 {{"entry", "left"},
+                                                  {"entry", "right"},
+                                                  {"left", "exit"},
+                                                  {"right", "exit"}}));
+#define GET_BLOCK(name) HBasicBlock* name = blks.Get(#name)
+  GET_BLOCK(entry);
+  GET_BLOCK(exit);
+  GET_BLOCK(left);
+  GET_BLOCK(right);
+#undef GET_BLOCK
+  HInstruction* bool_value = MakeParam(DataType::Type::kBool);
+  HInstruction* c0 = graph_->GetIntConstant(0);
+  HInstruction* c1 = graph_->GetIntConstant(1);
+
+  HLoadClass* cls = MakeClassLoad();
+  HInstruction* new_inst = new (GetAllocator()) HNewInstance(cls,
+                                                             /* dex_pc= */ 0u,
+                                                             cls->GetTypeIndex(),
+                                                             graph_->GetDexFile(),
+                                                             /* finalizable= */ false,
+                                                             kQuickAllocObjectWithChecks);
+  HInstruction* write_entry = MakeIFieldSet(new_inst, c1, MemberOffset(32));
+  HInstruction* if_inst = new (GetAllocator()) HIf(bool_value);
+  entry->AddInstruction(cls);
+  entry->AddInstruction(new_inst);
+  entry->AddInstruction(write_entry);
+  entry->AddInstruction(if_inst);
+  ManuallyBuildEnvFor(cls, {});
+  new_inst->CopyEnvironmentFrom(cls->GetEnvironment());
+
+  HInstruction* call_left = MakeInvoke(DataType::Type::kVoid, { new_inst });
+  HInstruction* return_left = new (GetAllocator()) HReturn(c0);
+  left->AddInstruction(call_left);
+  left->AddInstruction(return_left);
+  call_left->CopyEnvironmentFrom(cls->GetEnvironment());
+
+  HInstruction* read_right = MakeIFieldGet(new_inst, DataType::Type::kInt32, MemberOffset(32));
+  HInstruction* return_right = new (GetAllocator()) HReturn(read_right);
+  right->AddInstruction(read_right);
+  right->AddInstruction(return_right);
+
+  SetupExit(exit);
+
+  PerformLSE(blks);
+
+  // LSE would keep the original allocation, so it is not copied into LEFT.
+  EXPECT_INS_RETAINED(new_inst);
+  EXPECT_INS_RETAINED(write_entry);
+  EXPECT_INS_EQ(call_left->InputAt(0), new_inst);
+}
 }  // namespace art
@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <array>
+#include <memory>
 #include <type_traits>
 
 #include "art_method.h"
@@ -2063,40 +2064,44 @@ class SideEffects : public ValueObject {
 };
 
 // A HEnvironment object contains the values of virtual registers at a given location.
+// An environment is created for every instruction that can throw or deoptimize, so it
+// is kept compact: the vreg records are allocated together with the environment, in a
+// single arena allocation, and the locations are only allocated for the environments
+// that survive until code generation.
 class HEnvironment : public ArenaObject<kArenaAllocEnvironment> {
  public:
-  ALWAYS_INLINE HEnvironment(ArenaAllocator* allocator,
-                             size_t number_of_vregs,
-                             ArtMethod* method,
-                             uint32_t dex_pc,
-                             HInstruction* holder)
-      : vregs_(number_of_vregs, allocator->Adapter(kArenaAllocEnvironmentVRegs)),
-        locations_(allocator->Adapter(kArenaAllocEnvironmentLocations)),
-        parent_(nullptr),
-        method_(method),
-        dex_pc_(dex_pc),
-        holder_(holder) {
-  }
-
-  ALWAYS_INLINE HEnvironment(ArenaAllocator* allocator,
-                             const HEnvironment& to_copy,
-                             HInstruction* holder)
-      : HEnvironment(allocator,
-                     to_copy.Size(),
-                     to_copy.GetMethod(),
-                     to_copy.GetDexPc(),
-                     holder) {}
-
-  void AllocateLocations() {
-    DCHECK(locations_.empty());
-    locations_.resize(vregs_.size());
+  static HEnvironment* Create(ArenaAllocator* allocator,
+                              size_t number_of_vregs,
+                              ArtMethod* method,
+                              uint32_t dex_pc,
+                              HInstruction* holder) {
+    // The vreg records are stored right after the `HEnvironment` itself.
+    static_assert(IsAligned<alignof(HUserRecord<HEnvironment*>)>(sizeof(HEnvironment)));
+    static_assert(IsAligned<alignof(HUserRecord<HEnvironment*>)>(ArenaAllocator::kAlignment));
+    size_t alloc_size = sizeof(HEnvironment) + number_of_vregs * sizeof(HUserRecord<HEnvironment*>);
+    void* storage = allocator->Alloc(alloc_size, kArenaAllocEnvironment);
+    return new (storage) HEnvironment(number_of_vregs, method, dex_pc, holder);
+  }
+
+  static HEnvironment* Create(ArenaAllocator* allocator,
+                              const HEnvironment& to_copy,
+                              HInstruction* holder) {
+    return Create(allocator, to_copy.Size(), to_copy.GetMethod(), to_copy.GetDexPc(), holder);
+  }
+
+  void AllocateLocations(ArenaAllocator* allocator) {
+    DCHECK(locations_ == nullptr);
+    if (Size() != 0u) {
+      locations_ = allocator->AllocArray<Location>(Size(), kArenaAllocEnvironmentLocations);
+      std::uninitialized_fill_n(locations_, Size(), Location());
+    }
   }
 
   void SetAndCopyParentChain(ArenaAllocator* allocator, HEnvironment* parent) {
     if (parent_ != nullptr) {
       parent_->SetAndCopyParentChain(allocator, parent);
     } else {
-      parent_ = new (allocator) HEnvironment(allocator, *parent, holder_);
+      parent_ = Create(allocator, *parent, holder_);
       parent_->CopyFrom(parent);
       if (parent->GetParent() != nullptr) {
         parent_->SetAndCopyParentChain(allocator, parent->GetParent());
@@ -2113,11 +2118,13 @@ class HEnvironment : public ArenaObject<kArenaAllocEnvironment> {
   void CopyFromWithLoopPhiAdjustment(HEnvironment* env, HBasicBlock* loop_header);
 
   void SetRawEnvAt(size_t index, HInstruction* instruction) {
-    vregs_[index] = HUserRecord<HEnvironment*>(instruction);
+    DCHECK_LT(index, Size());
+    GetVRegs()[index] = HUserRecord<HEnvironment*>(instruction);
   }
 
   HInstruction* GetInstructionAt(size_t index) const {
-    return vregs_[index].GetInstruction();
+    DCHECK_LT(index, Size());
+    return GetVRegs()[index].GetInstruction();
   }
 
   void RemoveAsUserOfInput(size_t index) const;
@@ -2127,15 +2134,19 @@ class HEnvironment : public ArenaObject<kArenaAllocEnvironment> {
   // HInstruction::ReplaceInput.
   void ReplaceInput(HInstruction* replacement, size_t index);
 
-  size_t Size() const { return vregs_.size(); }
+  size_t Size() const { return number_of_vregs_; }
 
   HEnvironment* GetParent() const { return parent_; }
 
   void SetLocationAt(size_t index, Location location) {
+    DCHECK(locations_ != nullptr);
+    DCHECK_LT(index, Size());
     locations_[index] = location;
   }
 
   Location GetLocationAt(size_t index) const {
+    DCHECK(locations_ != nullptr);
+    DCHECK_LT(index, Size());
     return locations_[index];
   }
 
@@ -2174,15 +2185,39 @@ class HEnvironment : public ArenaObject<kArenaAllocEnvironment> {
   }
 
  private:
-  ArenaVector<HUserRecord<HEnvironment*>> vregs_;
-  ArenaVector<Location> locations_;
-  HEnvironment* parent_;
-  ArtMethod* method_;
+  ALWAYS_INLINE HEnvironment(size_t number_of_vregs,
+                             ArtMethod* method,
+                             uint32_t dex_pc,
+                             HInstruction* holder)
+      : number_of_vregs_(dchecked_integral_cast<uint32_t>(number_of_vregs)),
+        dex_pc_(dex_pc),
+        holder_(holder),
+        parent_(nullptr),
+        method_(method),
+        locations_(nullptr) {
+    std::uninitialized_fill_n(GetVRegs(), number_of_vregs_, HUserRecord<HEnvironment*>());
+  }
+
+  HUserRecord<HEnvironment*>* GetVRegs() {
+    return reinterpret_cast<HUserRecord<HEnvironment*>*>(this + 1);
+  }
+
+  const HUserRecord<HEnvironment*>* GetVRegs() const {
+    return reinterpret_cast<const HUserRecord<HEnvironment*>*>(this + 1);
+  }
+
+  const uint32_t number_of_vregs_;
   const uint32_t dex_pc_;
 
   // The instruction that holds this environment.
   HInstruction* const holder_;
 
+  HEnvironment* parent_;
+  ArtMethod* method_;
+
+  // Locations assigned to the vregs, allocated in `AllocateLocations()`.
+  Location* locations_;
+
   friend class HInstruction;
 
   DISALLOW_COPY_AND_ASSIGN(HEnvironment);
@@ -2514,7 +2549,7 @@ class HInstruction : public ArenaObject<kArenaAllocInstruction> {
   void CopyEnvironmentFrom(HEnvironment* environment) {
     DCHECK(environment_ == nullptr);
     ArenaAllocator* allocator = GetBlock()->GetGraph()->GetAllocator();
-    environment_ = new (allocator) HEnvironment(allocator, *environment, this);
+    environment_ = HEnvironment::Create(allocator, *environment, this);
     environment_->CopyFrom(environment);
     if (environment->GetParent() != nullptr) {
       environment_->SetAndCopyParentChain(allocator, environment->GetParent());
@@ -2525,7 +2560,7 @@ class HInstruction : public ArenaObject<kArenaAllocInstruction> {
                                                 HBasicBlock* block) {
     DCHECK(environment_ == nullptr);
     ArenaAllocator* allocator = GetBlock()->GetGraph()->GetAllocator();
-    environment_ = new (allocator) HEnvironment(allocator, *environment, this);
+    environment_ = HEnvironment::Create(allocator, *environment, this);
     environment_->CopyFromWithLoopPhiAdjustment(environment, block);
     if (environment->GetParent() != nullptr) {
       environment_->SetAndCopyParentChain(allocator, environment->GetParent());
@@ -2777,7 +2812,7 @@ class HInstruction : public ArenaObject<kArenaAllocInstruction> {
     for (auto env_use_node = env_uses_.begin(); env_use_node != env_fixup_end; ++env_use_node) {
       HEnvironment* user = env_use_node->GetUser();
       size_t input_index = env_use_node->GetIndex();
-      user->vregs_[input_index] = HUserRecord<HEnvironment*>(this, before_env_use_node);
+      user->GetVRegs()[input_index] = HUserRecord<HEnvironment*>(this, before_env_use_node);
       before_env_use_node = env_use_node;
     }
   }
@@ -2787,8 +2822,8 @@ class HInstruction : public ArenaObject<kArenaAllocInstruction> {
     if (next != env_uses_.end()) {
       HEnvironment* next_user = next->GetUser();
       size_t next_index = next->GetIndex();
-      DCHECK(next_user->vregs_[next_index].GetInstruction() == this);
-      next_user->vregs_[next_index] = HUserRecord<HEnvironment*>(this, before_env_use_node);
+      DCHECK(next_user->GetVRegs()[next_index].GetInstruction() == this);
+      next_user->GetVRegs()[next_index] = HUserRecord<HEnvironment*>(this, before_env_use_node);
     }
   }
 
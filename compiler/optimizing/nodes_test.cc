@@ -164,7 +164,7 @@ TEST_F(NodeTest, RemoveInstruction) {
   first_block->AddSuccessor(exit_block);
   exit_block->AddInstruction(new (GetAllocator()) HExit());
 
-  HEnvironment* environment = new (GetAllocator()) HEnvironment(
+  HEnvironment* environment = HEnvironment::Create(
       GetAllocator(), 1, graph->GetArtMethod(), 0, null_check);
   null_check->SetRawEnvironment(environment);
   environment->SetRawEnvAt(0, parameter);
@@ -240,7 +240,7 @@ TEST_F(NodeTest, ParentEnvironment) {
   ASSERT_TRUE(parameter1->HasUses());
   ASSERT_TRUE(parameter1->GetUses().HasExactlyOneElement());
 
-  HEnvironment* environment = new (GetAllocator()) HEnvironment(
+  HEnvironment* environment = HEnvironment::Create(
       GetAllocator(), 1, graph->GetArtMethod(), 0, with_environment);
   HInstruction* const array[] = { parameter1 };
 
@@ -250,13 +250,13 @@ TEST_F(NodeTest, ParentEnvironment) {
   ASSERT_TRUE(parameter1->HasEnvironmentUses());
   ASSERT_TRUE(parameter1->GetEnvUses().HasExactlyOneElement());
 
-  HEnvironment* parent1 = new (GetAllocator()) HEnvironment(
+  HEnvironment* parent1 = HEnvironment::Create(
       GetAllocator(), 1, graph->GetArtMethod(), 0, nullptr);
   parent1->CopyFrom(ArrayRef<HInstruction* const>(array));
 
   ASSERT_EQ(parameter1->GetEnvUses().SizeSlow(), 2u);
 
-  HEnvironment* parent2 = new (GetAllocator()) HEnvironment(
+  HEnvironment* parent2 = HEnvironment::Create(
       GetAllocator(), 1, graph->GetArtMethod(), 0, nullptr);
   parent2->CopyFrom(ArrayRef<HInstruction* const>(array));
   parent1->SetAndCopyParentChain(GetAllocator(), parent2);
@@ -269,4 +269,53 @@ TEST_F(NodeTest, ParentEnvironment) {
   ASSERT_EQ(parameter1->GetEnvUses().SizeSlow(), 6u);
 }
 
+TEST_F(NodeTest, EnvironmentStorage) {
+  HGraph* graph = CreateGraph();
+  HBasicBlock* entry = new (GetAllocator()) HBasicBlock(graph);
+  graph->AddBlock(entry);
+  graph->SetEntryBlock(entry);
+  HInstruction* parameter1 = new (GetAllocator()) HParameterValue(
+      graph->GetDexFile(), dex::TypeIndex(0), 0, DataType::Type::kReference);
+  HInstruction* parameter2 = new (GetAllocator()) HParameterValue(
+      graph->GetDexFile(), dex::TypeIndex(0), 1, DataType::Type::kInt32);
+  HInstruction* with_environment = new (GetAllocator()) HNullCheck(parameter1, 0);
+  entry->AddInstruction(parameter1);
+  entry->AddInstruction(parameter2);
+  entry->AddInstruction(with_environment);
+  entry->AddInstruction(new (GetAllocator()) HExit());
+
+  HEnvironment* environment = HEnvironment::Create(
+      GetAllocator(), 3, graph->GetArtMethod(), 0, with_environment);
+  ASSERT_EQ(environment->Size(), 3u);
+  for (size_t i = 0; i != environment->Size(); ++i) {
+    ASSERT_TRUE(environment->GetInstructionAt(i) == nullptr);
+  }
+
+  // The vreg records live right after the environment and must not overlap the next
+  // allocation.
+  HEnvironment* copy = HEnvironment::Create(GetAllocator(), *environment, with_environment);
+  HInstruction* const array[] = { parameter1, nullptr, parameter2 };
+  environment->CopyFrom(ArrayRef<HInstruction* const>(array));
+  copy->CopyFrom(environment);
+  with_environment->SetRawEnvironment(copy);
+  for (size_t i = 0; i != environment->Size(); ++i) {
+    ASSERT_EQ(environment->GetInstructionAt(i), array[i]);
+    ASSERT_EQ(copy->GetInstructionAt(i), array[i]);
+  }
+  ASSERT_EQ(parameter2->GetEnvUses().SizeSlow(), 2u);
+
+  copy->ReplaceInput(parameter1, 2u);
+  ASSERT_EQ(copy->GetInstructionAt(2u), parameter1);
+  ASSERT_EQ(environment->GetInstructionAt(2u), parameter2);
+  ASSERT_TRUE(parameter2->GetEnvUses().HasExactlyOneElement());
+
+  copy->AllocateLocations(GetAllocator());
+  for (size_t i = 0; i != copy->Size(); ++i) {
+    ASSERT_TRUE(copy->GetLocationAt(i).IsInvalid());
+  }
+  copy->SetLocationAt(1u, Location::RegisterLocation(0));
+  ASSERT_TRUE(copy->GetLocationAt(1u).IsRegister());
+  ASSERT_TRUE(copy->GetLocationAt(2u).IsInvalid());
+}
+
 }  // namespace art
@@ -30,6 +30,7 @@
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "base/scoped_arena_allocator.h"
+#include "base/time_utils.h"
 #include "base/timing_logger.h"
 #include "builder.h"
 #include "code_generator.h"
@@ -52,6 +53,7 @@
 #include "nodes.h"
 #include "oat/oat_quick_method_header.h"
 #include "optimizing/write_barrier_elimination.h"
+#include "pass_profile.h"
 #include "prepare_for_register_allocation.h"
 #include "profiling_info_builder.h"
 #include "reference_type_propagation.h"
@@ -82,7 +84,9 @@ class PassObserver : public ValueObject {
   PassObserver(HGraph* graph,
                CodeGenerator* codegen,
                std::ostream* visualizer_output,
-               const CompilerOptions& compiler_options)
+               const CompilerOptions& compiler_options,
+               OptimizingCompilerStats* stats,
+               PassProfile* pass_profile)
       : graph_(graph),
         last_seen_graph_size_(0),
         cached_method_name_(),
@@ -94,7 +98,21 @@ class PassObserver : public ValueObject {
         visualizer_enabled_(!compiler_options.GetDumpCfgFileName().empty()),
         visualizer_(&visualizer_oss_, graph, codegen),
         codegen_(codegen),
-        graph_in_bad_state_(false) {
+        graph_in_bad_state_(false),
+        pass_profile_(pass_profile),
+        // A budget makes the generated code depend on the machine load.
+        compile_time_budget_(compiler_options.IsForceDeterminism()
+                                 ? 0u
+                                 : MsToNs(compiler_options.GetCompileTimeBudgetMs()),
+                             stats),
+        start_time_ns_(0u),
+        start_cpu_time_ns_(0u),
+        pass_start_time_ns_(0u),
+        pass_start_cpu_time_ns_(0u) {
+    if (pass_profile_ != nullptr || compile_time_budget_.HasBudget()) {
+      start_time_ns_ = NanoTime();
+      start_cpu_time_ns_ = ThreadCpuNanoTime();
+    }
     if (timing_logger_enabled_ || visualizer_enabled_) {
       if (!IsVerboseMethod(compiler_options, GetMethodName())) {
         timing_logger_enabled_ = visualizer_enabled_ = false;
@@ -107,6 +125,15 @@ class PassObserver : public ValueObject {
   }
 
   ~PassObserver() {
+    if (pass_profile_ != nullptr) {
+      size_t arena_peak_bytes =
+          graph_->GetAllocator()->BytesUsed() + graph_->GetArenaStack()->ApproximatePeakBytes();
+      pass_profile_->AddMethod(GetMethodName(),
+                               NanoTime() - start_time_ns_,
+                               ThreadCpuNanoTime() - start_cpu_time_ns_,
+                               arena_peak_bytes,
+                               compile_time_budget_.IsExceeded());
+    }
     if (timing_logger_enabled_) {
       LOG(INFO) << "TIMINGS " << GetMethodName();
       LOG(INFO) << Dumpable<TimingLogger>(timing_logger_);
@@ -126,6 +153,17 @@ class PassObserver : public ValueObject {
 
   void SetGraphInBadState() { graph_in_bad_state_ = true; }
 
+  // Returns whether `pass` should run, given the compile time budget of the method.
+  bool ShouldRunPass(OptimizationPass pass) {
+    if (!compile_time_budget_.HasBudget() || CompileTimeBudget::IsRequiredPass(pass)) {
+      return true;
+    }
+    if (compile_time_budget_.UpdateElapsedTime(NanoTime() - start_time_ns_)) {
+      VLOG(compiler) << "Compile time budget exceeded for " << GetMethodName();
+    }
+    return !compile_time_budget_.IsExceeded();
+  }
+
   const char* GetMethodName() {
     // PrettyMethod() is expensive, so we delay calling it until we actually have to.
     if (cached_method_name_.empty()) {
@@ -145,6 +183,10 @@ class PassObserver : public ValueObject {
     if (timing_logger_enabled_) {
       timing_logger_.StartTiming(pass_name);
     }
+    if (pass_profile_ != nullptr) {
+      pass_start_time_ns_ = NanoTime();
+      pass_start_cpu_time_ns_ = ThreadCpuNanoTime();
+    }
   }
 
   void FlushVisualizer() {
@@ -159,6 +201,11 @@ class PassObserver : public ValueObject {
     if (timing_logger_enabled_) {
       timing_logger_.EndTiming();
     }
+    if (pass_profile_ != nullptr) {
+      pass_profile_->AddPass(pass_name,
+                             NanoTime() - pass_start_time_ns_,
+                             ThreadCpuNanoTime() - pass_start_cpu_time_ns_);
+    }
     if (visualizer_enabled_) {
       visualizer_.DumpGraph(pass_name, /* is_after_pass= */ true, graph_in_bad_state_);
       FlushVisualizer();
@@ -217,6 +264,16 @@ class PassObserver : public ValueObject {
   // expected to validate.
   bool graph_in_bad_state_;
 
+  // Where to record the time spent in each pass, or null.
+  PassProfile* const pass_profile_;
+
+  CompileTimeBudget compile_time_budget_;
+
+  uint64_t start_time_ns_;
+  uint64_t start_cpu_time_ns_;
+  uint64_t pass_start_time_ns_;
+  uint64_t pass_start_cpu_time_ns_;
+
   friend PassScope;
 
   DISALLOW_COPY_AND_ASSIGN(PassObserver);
@@ -278,7 +335,8 @@ class OptimizingCompiler final : public Compiler {
                   jit::JitMemoryRegion* region,
                   ArtMethod* method,
                   CompilationKind compilation_kind,
-                  jit::JitLogger* jit_logger)
+                  jit::JitLogger* jit_logger,
+                  jit::JitCommitBatch* batch)
       override
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -305,7 +363,8 @@ class OptimizingCompiler final : public Compiler {
     pass_changes[static_cast<size_t>(OptimizationPass::kNone)] = true;
     bool change = false;
     for (size_t i = 0; i < length; ++i) {
-      if (pass_changes[static_cast<size_t>(definitions[i].depends_on)]) {
+      if (pass_changes[static_cast<size_t>(definitions[i].depends_on)] &&
+          pass_observer->ShouldRunPass(definitions[i].pass)) {
         // Execute the pass and record whether it changed anything.
         PassScope scope(optimizations[i]->GetPassName(), pass_observer);
         bool pass_change = optimizations[i]->Run();
@@ -380,6 +439,9 @@ class OptimizingCompiler final : public Compiler {
 
   std::unique_ptr<OptimizingCompilerStats> compilation_stats_;
 
+  // Time spent in each pass, collected along with the compilation stats.
+  std::unique_ptr<PassProfile> pass_profile_;
+
   std::unique_ptr<std::ostream> visualizer_output_;
 
   DISALLOW_COPY_AND_ASSIGN(OptimizingCompiler);
@@ -400,6 +462,7 @@ OptimizingCompiler::OptimizingCompiler(const CompilerOptions& compiler_options,
   }
   if (compiler_options.GetDumpStats()) {
     compilation_stats_.reset(new OptimizingCompilerStats());
+    pass_profile_.reset(new PassProfile());
   }
 }
 
@@ -407,6 +470,11 @@ OptimizingCompiler::~OptimizingCompiler() {
   if (compilation_stats_.get() != nullptr) {
     compilation_stats_->Log();
   }
+  if (pass_profile_ != nullptr) {
+    std::ostringstream oss;
+    pass_profile_->Dump(oss);
+    LOG(INFO) << oss.str();
+  }
 }
 
 void OptimizingCompiler::DumpInstructionSetFeaturesToCfg() const {
@@ -852,7 +920,9 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
   PassObserver pass_observer(graph,
                              codegen.get(),
                              visualizer_output_.get(),
-                             compiler_options);
+                             compiler_options,
+                             compilation_stats_.get(),
+                             pass_profile_.get());
 
   {
     VLOG(compiler) << "Building " << pass_observer.GetMethodName();
@@ -1003,7 +1073,9 @@ CodeGenerator* OptimizingCompiler::TryCompileIntrinsic(
   PassObserver pass_observer(graph,
                              codegen.get(),
                              visualizer_output_.get(),
-                             compiler_options);
+                             compiler_options,
+                             compilation_stats_.get(),
+                             pass_profile_.get());
 
   {
     VLOG(compiler) << "Building intrinsic graph " << pass_observer.GetMethodName();
@@ -1257,7 +1329,8 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                                     jit::JitMemoryRegion* region,
                                     ArtMethod* method,
                                     CompilationKind compilation_kind,
-                                    jit::JitLogger* jit_logger) {
+                                    jit::JitLogger* jit_logger,
+                                    jit::JitCommitBatch* batch) {
   const CompilerOptions& compiler_options = GetCompilerOptions();
   DCHECK(compiler_options.IsJitCompiler());
   DCHECK_EQ(compiler_options.IsJitCompilerForSharedCode(), code_cache->IsSharedRegion(*region));
@@ -1354,7 +1427,8 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                             debug_info,
                             /* is_full_debug_info= */ compiler_options.GetGenerateDebugInfo(),
                             compilation_kind,
-                            cha_single_implementation_list)) {
+                            cha_single_implementation_list,
+                            batch)) {
       code_cache->Free(self, region, reserved_code.data(), reserved_data.data());
       return false;
     }
@@ -1466,16 +1540,34 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                           debug_info,
                           /* is_full_debug_info= */ compiler_options.GetGenerateDebugInfo(),
                           compilation_kind,
-                          codegen->GetGraph()->GetCHASingleImplementationList())) {
+                          codegen->GetGraph()->GetCHASingleImplementationList(),
+                          batch)) {
     CHECK_EQ(CodeInfo::HasShouldDeoptimizeFlag(stack_map.data()),
              codegen->GetGraph()->HasShouldDeoptimizeFlag());
     code_cache->Free(self, region, reserved_code.data(), reserved_data.data());
     return false;
   }
 
-  Runtime::Current()->GetJit()->AddMemoryUsage(method, allocator.BytesUsed());
-  if (jit_logger != nullptr) {
-    jit_logger->WriteLog(code, codegen->GetAssembler()->CodeSize(), method);
+  size_t memory_usage = allocator.BytesUsed();
+  size_t code_size = codegen->GetAssembler()->CodeSize();
+  if (batch != nullptr) {
+    // The code is only published once the whole batch is committed, and may still be
+    // discarded. Account for it and log it then.
+    batch->SetCommitCallback(
+        self,
+        method,
+        [method, code, code_size, memory_usage, jit_logger]()
+            REQUIRES_SHARED(Locks::mutator_lock_) {
+          Runtime::Current()->GetJit()->AddMemoryUsage(method, memory_usage);
+          if (jit_logger != nullptr) {
+            jit_logger->WriteLog(code, code_size, method);
+          }
+        });
+  } else {
+    Runtime::Current()->GetJit()->AddMemoryUsage(method, memory_usage);
+    if (jit_logger != nullptr) {
+      jit_logger->WriteLog(code, code_size, method);
+    }
   }
 
   if (kArenaAllocatorCountAllocations) {
@@ -69,8 +69,10 @@ enum class MethodCompilationStat {
   kNotCompiledIrreducibleLoopAndStringInit,
   kNotCompiledPhiEquivalentInOsr,
   kNotCompiledFrameTooBig,
+  kCompileTimeBudgetExceeded,
   kInlinedMonomorphicCall,
   kInlinedPolymorphicCall,
+  kInlinedSpeculativeMegamorphicCall,
   kMonomorphicCall,
   kPolymorphicCall,
   kMegamorphicCall,
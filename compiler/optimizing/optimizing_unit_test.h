@@ -326,7 +326,7 @@ class OptimizingUnitTestHelper {
 
   HEnvironment* ManuallyBuildEnvFor(HInstruction* instruction,
                                     ArenaVector<HInstruction*>* current_locals) {
-    HEnvironment* environment = new (GetAllocator()) HEnvironment(
+    HEnvironment* environment = HEnvironment::Create(
         (GetAllocator()),
         current_locals->size(),
         graph_->GetArtMethod(),
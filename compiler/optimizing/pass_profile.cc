@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pass_profile.h"
+
+#include <algorithm>
+#include <ostream>
+
+#include "base/histogram-inl.h"
+#include "base/time_utils.h"
+#include "base/utils.h"
+#include "thread-current-inl.h"
+
+namespace art HIDDEN {
+
+PassProfile::PassProfile()
+    : lock_("Optimizing compiler pass profile lock", kGenericBottomLock),
+      method_times_("Method compile times", 16, 64),
+      max_arena_peak_bytes_(0u),
+      methods_over_budget_(0u) {}
+
+void PassProfile::AddPass(const char* pass_name, uint64_t wall_time_ns, uint64_t cpu_time_ns) {
+  MutexLock mu(Thread::Current(), lock_);
+  PassTimes& times = passes_[pass_name];
+  ++times.count;
+  times.wall_time_ns += wall_time_ns;
+  times.cpu_time_ns += cpu_time_ns;
+  times.max_wall_time_ns = std::max(times.max_wall_time_ns, wall_time_ns);
+}
+
+void PassProfile::AddMethod(const std::string& method_name,
+                            uint64_t wall_time_ns,
+                            uint64_t cpu_time_ns,
+                            size_t arena_peak_bytes,
+                            bool exceeded_budget) {
+  MutexLock mu(Thread::Current(), lock_);
+  method_times_.AdjustAndAddValue(wall_time_ns);
+  max_arena_peak_bytes_ = std::max(max_arena_peak_bytes_, arena_peak_bytes);
+  if (exceeded_budget) {
+    ++methods_over_budget_;
+  }
+  if (slowest_methods_.size() == kNumberOfSlowestMethods &&
+      slowest_methods_.back().wall_time_ns >= wall_time_ns) {
+    return;
+  }
+  auto it = std::upper_bound(
+      slowest_methods_.begin(),
+      slowest_methods_.end(),
+      wall_time_ns,
+      [](uint64_t time, const MethodTimes& method) { return time > method.wall_time_ns; });
+  slowest_methods_.insert(it, {method_name, wall_time_ns, cpu_time_ns, arena_peak_bytes});
+  if (slowest_methods_.size() > kNumberOfSlowestMethods) {
+    slowest_methods_.pop_back();
+  }
+}
+
+void PassProfile::Dump(std::ostream& os) {
+  MutexLock mu(Thread::Current(), lock_);
+  if (method_times_.SampleSize() == 0u) {
+    return;
+  }
+  os << "Pass profile of " << method_times_.SampleSize() << " methods, "
+     << methods_over_budget_ << " over the compile time budget, "
+     << "maximum arena peak " << PrettySize(max_arena_peak_bytes_) << "\n";
+
+  std::vector<std::pair<std::string, PassTimes>> passes(passes_.begin(), passes_.end());
+  std::sort(passes.begin(), passes.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.second.wall_time_ns > rhs.second.wall_time_ns;
+  });
+  os << "Passes by total wall time:\n";
+  for (const auto& [pass_name, times] : passes) {
+    os << "  " << pass_name << ": " << PrettyDuration(times.wall_time_ns) << " wall, "
+       << PrettyDuration(times.cpu_time_ns) << " cpu, " << times.count << " runs, max "
+       << PrettyDuration(times.max_wall_time_ns) << "\n";
+  }
+
+  os << "Slowest methods:\n";
+  for (const MethodTimes& method : slowest_methods_) {
+    os << "  " << method.method_name << ": " << PrettyDuration(method.wall_time_ns) << " wall, "
+       << PrettyDuration(method.cpu_time_ns) << " cpu, "
+       << PrettySize(method.arena_peak_bytes) << " arena peak\n";
+  }
+
+  Histogram<uint64_t>::CumulativeData data;
+  method_times_.CreateHistogram(&data);
+  method_times_.PrintConfidenceIntervals(os, 0.99, data);
+}
+
+bool CompileTimeBudget::UpdateElapsedTime(uint64_t elapsed_ns) {
+  if (exceeded_ || !HasBudget() || elapsed_ns <= budget_ns_) {
+    return false;
+  }
+  exceeded_ = true;
+  MaybeRecordStat(stats_, MethodCompilationStat::kCompileTimeBudgetExceeded);
+  return true;
+}
+
+bool CompileTimeBudget::IsRequiredPass(OptimizationPass pass) {
+  switch (pass) {
+    case OptimizationPass::kInstructionSimplifier:
+    case OptimizationPass::kAggressiveInstructionSimplifier:
+#ifdef ART_ENABLE_CODEGEN_arm
+    case OptimizationPass::kCriticalNativeAbiFixupArm:
+#endif
+#ifdef ART_ENABLE_CODEGEN_riscv64
+    case OptimizationPass::kCriticalNativeAbiFixupRiscv64:
+#endif
+#ifdef ART_ENABLE_CODEGEN_x86
+    case OptimizationPass::kPcRelativeFixupsX86:
+#endif
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace art
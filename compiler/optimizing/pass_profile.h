@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_PASS_PROFILE_H_
+#define ART_COMPILER_OPTIMIZING_PASS_PROFILE_H_
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/histogram.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "optimization.h"
+#include "optimizing_compiler_stats.h"
+
+namespace art HIDDEN {
+
+// Aggregates where the optimizing compiler spends its time over all the compiled methods:
+// the wall and CPU time of each pass, and the slowest methods with their arena memory peak.
+// Methods are compiled on several threads, so all the accesses are synchronized.
+class PassProfile {
+ public:
+  // Number of methods listed in the report of the slowest methods.
+  static constexpr size_t kNumberOfSlowestMethods = 10;
+
+  PassProfile();
+
+  void AddPass(const char* pass_name, uint64_t wall_time_ns, uint64_t cpu_time_ns)
+      REQUIRES(!lock_);
+
+  void AddMethod(const std::string& method_name,
+                 uint64_t wall_time_ns,
+                 uint64_t cpu_time_ns,
+                 size_t arena_peak_bytes,
+                 bool exceeded_budget)
+      REQUIRES(!lock_);
+
+  // Print the passes sorted by total wall time, the slowest methods, and a histogram of
+  // the method compile times.
+  void Dump(std::ostream& os) REQUIRES(!lock_);
+
+ private:
+  struct PassTimes {
+    size_t count = 0u;
+    uint64_t wall_time_ns = 0u;
+    uint64_t cpu_time_ns = 0u;
+    uint64_t max_wall_time_ns = 0u;
+  };
+
+  struct MethodTimes {
+    std::string method_name;
+    uint64_t wall_time_ns;
+    uint64_t cpu_time_ns;
+    size_t arena_peak_bytes;
+  };
+
+  Mutex lock_;
+  std::map<std::string, PassTimes> passes_ GUARDED_BY(lock_);
+  // Sorted by decreasing wall time.
+  std::vector<MethodTimes> slowest_methods_ GUARDED_BY(lock_);
+  Histogram<uint64_t> method_times_ GUARDED_BY(lock_);
+  size_t max_arena_peak_bytes_ GUARDED_BY(lock_);
+  size_t methods_over_budget_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(PassProfile);
+};
+
+// The compile time budget of a method. Once the method has spent its budget, the optional
+// passes are skipped and only the passes required by the code generators still run.
+class CompileTimeBudget {
+ public:
+  // A zero `budget_ns` means that the method has no budget.
+  CompileTimeBudget(uint64_t budget_ns, OptimizingCompilerStats* stats)
+      : budget_ns_(budget_ns), stats_(stats), exceeded_(false) {}
+
+  bool HasBudget() const { return budget_ns_ != 0u; }
+
+  bool IsExceeded() const { return exceeded_; }
+
+  // Check the time spent compiling the method so far against the budget. Returns true if
+  // the budget is exceeded for the first time, in which case the method is counted in the
+  // compilation stats.
+  bool UpdateElapsedTime(uint64_t elapsed_ns);
+
+  // Returns whether the code generators rely on `pass`, which must then run even if the
+  // method exceeded its budget.
+  static bool IsRequiredPass(OptimizationPass pass);
+
+ private:
+  const uint64_t budget_ns_;
+  OptimizingCompilerStats* const stats_;
+  bool exceeded_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompileTimeBudget);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_PASS_PROFILE_H_
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pass_profile.h"
+
+#include <sstream>
+#include <string>
+
+#include "base/macros.h"
+#include "gtest/gtest.h"
+
+namespace art HIDDEN {
+
+class PassProfileTest : public testing::Test {
+ protected:
+  static std::string Dump(PassProfile* profile) {
+    std::ostringstream oss;
+    profile->Dump(oss);
+    return oss.str();
+  }
+};
+
+TEST_F(PassProfileTest, Empty) {
+  PassProfile profile;
+  profile.AddPass("gvn", 100u, 100u);
+  // Nothing is reported before a method has been compiled.
+  EXPECT_EQ("", Dump(&profile));
+}
+
+TEST_F(PassProfileTest, AggregatePasses) {
+  PassProfile profile;
+  profile.AddPass("gvn", 100u, 50u);
+  profile.AddPass("licm", 1000u, 1000u);
+  profile.AddPass("gvn", 300u, 100u);
+  profile.AddMethod("void Main.foo()", 2000u, 2000u, 1024u, /*exceeded_budget=*/ false);
+  profile.AddMethod("void Main.bar()", 5000u, 4000u, 4096u, /*exceeded_budget=*/ true);
+  std::string dump = Dump(&profile);
+
+  EXPECT_NE(std::string::npos,
+            dump.find("Pass profile of 2 methods, 1 over the compile time budget")) << dump;
+  // Both runs of a pass are aggregated, and the passes are sorted by total wall time.
+  size_t gvn = dump.find("  gvn: ");
+  size_t licm = dump.find("  licm: ");
+  ASSERT_NE(std::string::npos, gvn) << dump;
+  ASSERT_NE(std::string::npos, licm) << dump;
+  EXPECT_LT(licm, gvn);
+  std::string gvn_line = dump.substr(gvn, dump.find('\n', gvn) - gvn);
+  EXPECT_NE(std::string::npos, gvn_line.find("2 runs")) << gvn_line;
+  EXPECT_EQ(std::string::npos, dump.find("  gvn: ", gvn + 1u));
+  // The slowest method comes first.
+  size_t foo = dump.find("  void Main.foo(): ");
+  size_t bar = dump.find("  void Main.bar(): ");
+  ASSERT_NE(std::string::npos, foo) << dump;
+  ASSERT_NE(std::string::npos, bar) << dump;
+  EXPECT_LT(bar, foo);
+}
+
+TEST_F(PassProfileTest, SlowestMethodsCap) {
+  PassProfile profile;
+  constexpr size_t kNumberOfMethods = PassProfile::kNumberOfSlowestMethods + 5u;
+  for (size_t i = 0; i != kNumberOfMethods; ++i) {
+    // Add the methods in an order that is neither sorted nor reverse sorted.
+    size_t index = (i * 7u) % kNumberOfMethods;
+    profile.AddMethod("m" + std::to_string(index),
+                      (index + 1u) * 1000u,
+                      (index + 1u) * 1000u,
+                      0u,
+                      /*exceeded_budget=*/ false);
+  }
+  std::string dump = Dump(&profile);
+
+  EXPECT_NE(std::string::npos, dump.find("Pass profile of 15 methods")) << dump;
+  // Only the slowest methods are listed, slowest first.
+  size_t previous = 0u;
+  for (size_t index = kNumberOfMethods; index != 0u; ) {
+    --index;
+    size_t pos = dump.find("  m" + std::to_string(index) + ": ");
+    if (index >= kNumberOfMethods - PassProfile::kNumberOfSlowestMethods) {
+      ASSERT_NE(std::string::npos, pos) << index << "\n" << dump;
+      EXPECT_LT(previous, pos);
+      previous = pos;
+    } else {
+      EXPECT_EQ(std::string::npos, pos) << index << "\n" << dump;
+    }
+  }
+}
+
+TEST_F(PassProfileTest, NoCompileTimeBudget) {
+  OptimizingCompilerStats stats;
+  CompileTimeBudget budget(/*budget_ns=*/ 0u, &stats);
+  EXPECT_FALSE(budget.HasBudget());
+  EXPECT_FALSE(budget.UpdateElapsedTime(UINT64_C(1) << 40));
+  EXPECT_FALSE(budget.IsExceeded());
+  EXPECT_EQ(0u, stats.GetStat(MethodCompilationStat::kCompileTimeBudgetExceeded));
+}
+
+TEST_F(PassProfileTest, CompileTimeBudgetExceeded) {
+  OptimizingCompilerStats stats;
+  CompileTimeBudget budget(/*budget_ns=*/ 1000u, &stats);
+  EXPECT_TRUE(budget.HasBudget());
+  EXPECT_FALSE(budget.UpdateElapsedTime(500u));
+  EXPECT_FALSE(budget.UpdateElapsedTime(1000u));
+  EXPECT_FALSE(budget.IsExceeded());
+
+  // The method is counted once, when it first exceeds the budget.
+  EXPECT_TRUE(budget.UpdateElapsedTime(1500u));
+  EXPECT_TRUE(budget.IsExceeded());
+  EXPECT_FALSE(budget.UpdateElapsedTime(2000u));
+  EXPECT_TRUE(budget.IsExceeded());
+  EXPECT_EQ(1u, stats.GetStat(MethodCompilationStat::kCompileTimeBudgetExceeded));
+
+  // Once over budget, only the passes the code generators rely on still run.
+  EXPECT_TRUE(CompileTimeBudget::IsRequiredPass(OptimizationPass::kInstructionSimplifier));
+  EXPECT_FALSE(CompileTimeBudget::IsRequiredPass(OptimizationPass::kGlobalValueNumbering));
+  EXPECT_FALSE(CompileTimeBudget::IsRequiredPass(OptimizationPass::kInliner));
+}
+
+}  // namespace art
@@ -130,11 +130,11 @@ class SchedulerTest : public CommonCompilerTest, public OptimizingUnitTestHelper
       block1->AddInstruction(instr);
     }
 
-    HEnvironment* environment = new (GetAllocator()) HEnvironment(GetAllocator(),
-                                                                  2,
-                                                                  graph_->GetArtMethod(),
-                                                                  0,
-                                                                  div_check);
+    HEnvironment* environment = HEnvironment::Create(GetAllocator(),
+                                                     2,
+                                                     graph_->GetArtMethod(),
+                                                     0,
+                                                     div_check);
     div_check->SetRawEnvironment(environment);
     environment->SetRawEnvAt(0, add2);
     add2->AddEnvUseAt(div_check->GetEnvironment(), 0);
@@ -96,22 +96,22 @@ TEST_F(SsaLivenessAnalysisTest, TestAput) {
   HBasicBlock* block = CreateSuccessor(entry_);
   HInstruction* null_check = new (GetAllocator()) HNullCheck(array, 0);
   block->AddInstruction(null_check);
-  HEnvironment* null_check_env = new (GetAllocator()) HEnvironment(GetAllocator(),
-                                                                   /* number_of_vregs= */ 5,
-                                                                   /* method= */ nullptr,
-                                                                   /* dex_pc= */ 0u,
-                                                                   null_check);
+  HEnvironment* null_check_env = HEnvironment::Create(GetAllocator(),
+                                                      /* number_of_vregs= */ 5,
+                                                      /* method= */ nullptr,
+                                                      /* dex_pc= */ 0u,
+                                                      null_check);
   null_check_env->CopyFrom(ArrayRef<HInstruction* const>(args));
   null_check->SetRawEnvironment(null_check_env);
   HInstruction* length = new (GetAllocator()) HArrayLength(array, 0);
   block->AddInstruction(length);
   HInstruction* bounds_check = new (GetAllocator()) HBoundsCheck(index, length, /* dex_pc= */ 0u);
   block->AddInstruction(bounds_check);
-  HEnvironment* bounds_check_env = new (GetAllocator()) HEnvironment(GetAllocator(),
-                                                                     /* number_of_vregs= */ 5,
-                                                                     /* method= */ nullptr,
-                                                                     /* dex_pc= */ 0u,
-                                                                     bounds_check);
+  HEnvironment* bounds_check_env = HEnvironment::Create(GetAllocator(),
+                                                        /* number_of_vregs= */ 5,
+                                                        /* method= */ nullptr,
+                                                        /* dex_pc= */ 0u,
+                                                        bounds_check);
   bounds_check_env->CopyFrom(ArrayRef<HInstruction* const>(args));
   bounds_check->SetRawEnvironment(bounds_check_env);
   HInstruction* array_set =
@@ -165,11 +165,11 @@ TEST_F(SsaLivenessAnalysisTest, TestDeoptimize) {
   HBasicBlock* block = CreateSuccessor(entry_);
   HInstruction* null_check = new (GetAllocator()) HNullCheck(array, 0);
   block->AddInstruction(null_check);
-  HEnvironment* null_check_env = new (GetAllocator()) HEnvironment(GetAllocator(),
-                                                                   /* number_of_vregs= */ 5,
-                                                                   /* method= */ nullptr,
-                                                                   /* dex_pc= */ 0u,
-                                                                   null_check);
+  HEnvironment* null_check_env = HEnvironment::Create(GetAllocator(),
+                                                      /* number_of_vregs= */ 5,
+                                                      /* method= */ nullptr,
+                                                      /* dex_pc= */ 0u,
+                                                      null_check);
   null_check_env->CopyFrom(ArrayRef<HInstruction* const>(args));
   null_check->SetRawEnvironment(null_check_env);
   HInstruction* length = new (GetAllocator()) HArrayLength(array, 0);
@@ -180,11 +180,11 @@ TEST_F(SsaLivenessAnalysisTest, TestDeoptimize) {
   HInstruction* deoptimize = new(GetAllocator()) HDeoptimize(
       GetAllocator(), ae, DeoptimizationKind::kBlockBCE, /* dex_pc= */ 0u);
   block->AddInstruction(deoptimize);
-  HEnvironment* deoptimize_env = new (GetAllocator()) HEnvironment(GetAllocator(),
-                                                                   /* number_of_vregs= */ 5,
-                                                                   /* method= */ nullptr,
-                                                                   /* dex_pc= */ 0u,
-                                                                   deoptimize);
+  HEnvironment* deoptimize_env = HEnvironment::Create(GetAllocator(),
+                                                      /* number_of_vregs= */ 5,
+                                                      /* method= */ nullptr,
+                                                      /* dex_pc= */ 0u,
+                                                      deoptimize);
   deoptimize_env->CopyFrom(ArrayRef<HInstruction* const>(args));
   deoptimize->SetRawEnvironment(deoptimize_env);
   HInstruction* array_set =
@@ -75,6 +75,7 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
     auto it = keys_.find(hashed_in_key);
     if (it != keys_.end()) {
       DCHECK(it->Key() != nullptr);
+      it->IncrementRefCount();
       return it->Key();
     }
     const StoreKey* store_key = alloc_.Copy(in_key);
@@ -82,6 +83,22 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
     return store_key;
   }
 
+  void Release(Thread* self, size_t hash, const InKey& in_key) REQUIRES(!lock_) {
+    const StoreKey* store_key = nullptr;
+    {
+      MutexLock lock(self, lock_);
+      HashedKey<InKey> hashed_in_key(hash, &in_key);
+      auto it = keys_.find(hashed_in_key);
+      DCHECK(it != keys_.end());
+      if (it->DecrementRefCount() != 0u) {
+        return;
+      }
+      store_key = it->Key();
+      keys_.erase(it);
+    }
+    alloc_.Destroy(store_key);
+  }
+
   size_t Size(Thread* self) {
     MutexLock lock(self, lock_);
     return keys_.size();
@@ -119,8 +136,8 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
   template <typename T>
   class HashedKey {
    public:
-    HashedKey() : hash_(0u), key_(nullptr) { }
-    HashedKey(size_t hash, const T* key) : hash_(hash), key_(key) { }
+    HashedKey() : hash_(0u), key_(nullptr), ref_count_(0u) { }
+    HashedKey(size_t hash, const T* key) : hash_(hash), key_(key), ref_count_(1u) { }
 
     size_t Hash() const {
       return hash_;
@@ -138,9 +155,19 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
       key_ = nullptr;
     }
 
+    void IncrementRefCount() {
+      ++ref_count_;
+    }
+
+    size_t DecrementRefCount() {
+      DCHECK_NE(ref_count_, 0u);
+      return --ref_count_;
+    }
+
    private:
     size_t hash_;
     const T* key_;
+    size_t ref_count_;
   };
 
   class ShardEmptyFn {
@@ -208,6 +235,20 @@ const StoreKey* DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::A
   return shards_[shard_bin]->Add(self, shard_hash, key);
 }
 
+template <typename InKey,
+          typename StoreKey,
+          typename Alloc,
+          typename HashType,
+          typename HashFunc,
+          HashType kShard>
+void DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Release(
+    Thread* self, const InKey& key) {
+  HashType raw_hash = HashFunc()(key);
+  HashType shard_hash = raw_hash / kShard;
+  HashType shard_bin = raw_hash % kShard;
+  shards_[shard_bin]->Release(self, shard_hash, key);
+}
+
 template <typename InKey,
           typename StoreKey,
           typename Alloc,
@@ -39,8 +39,13 @@ template <typename InKey,
 class DedupeSet {
  public:
   // Add a new key to the dedupe set if not present. Return the equivalent deduplicated stored key.
+  // Each call adds a reference to the stored key.
   const StoreKey* Add(Thread* self, const InKey& key);
 
+  // Remove a reference to the stored key equivalent to `key`, and destroy the stored key once
+  // it has no references left.
+  void Release(Thread* self, const InKey& key);
+
   DedupeSet(const char* set_name, const Alloc& alloc);
 
   ~DedupeSet();
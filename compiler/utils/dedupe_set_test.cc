@@ -89,4 +89,38 @@ TEST(DedupeSetTest, Test) {
   }
 }
 
+TEST(DedupeSetTest, Release) {
+  Thread* self = Thread::Current();
+  DedupeSetTestAlloc alloc;
+  DedupeSet<ArrayRef<const uint8_t>,
+            std::vector<uint8_t>,
+            DedupeSetTestAlloc,
+            size_t,
+            DedupeSetTestHashFunc> deduplicator("test", alloc);
+  uint8_t raw_test1[] = { 10u, 20u, 30u, 45u };
+  uint8_t raw_test2[] = { 10u, 22u, 30u, 47u };
+  ArrayRef<const uint8_t> test1(raw_test1);
+  ArrayRef<const uint8_t> test2(raw_test2);
+
+  const std::vector<uint8_t>* array1 = deduplicator.Add(self, test1);
+  ASSERT_EQ(array1, deduplicator.Add(self, test1));
+  ASSERT_NE(array1, deduplicator.Add(self, test2));
+  ASSERT_EQ(2u, deduplicator.Size(self));
+
+  // The first key has two references and stays until both are released.
+  deduplicator.Release(self, test1);
+  ASSERT_EQ(2u, deduplicator.Size(self));
+  ASSERT_TRUE(std::equal(test1.begin(), test1.end(), array1->begin()));
+  deduplicator.Release(self, test1);
+  ASSERT_EQ(1u, deduplicator.Size(self));
+
+  deduplicator.Release(self, test2);
+  ASSERT_EQ(0u, deduplicator.Size(self));
+
+  // A released key can be added again.
+  const std::vector<uint8_t>* array3 = deduplicator.Add(self, test1);
+  ASSERT_TRUE(std::equal(test1.begin(), test1.end(), array3->begin()));
+  ASSERT_EQ(1u, deduplicator.Size(self));
+}
+
 }  // namespace art
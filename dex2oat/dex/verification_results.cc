@@ -27,31 +27,32 @@
 
 namespace art {
 
-VerificationResults::VerificationResults()
-    : uncompilable_methods_lock_("compiler uncompilable methods lock"),
-      rejected_classes_lock_("compiler rejected classes lock") {}
+VerificationResults::VerificationResults() {}
 
 // Non-inline version of the destructor, as it does some implicit work not worth
 // inlining.
 VerificationResults::~VerificationResults() {}
 
 void VerificationResults::AddRejectedClass(ClassReference ref) {
+  Shard<ClassReference>& shard = rejected_classes_[GetShardIndex(ref)];
   {
-    WriterMutexLock mu(Thread::Current(), rejected_classes_lock_);
-    rejected_classes_.insert(ref);
+    WriterMutexLock mu(Thread::Current(), shard.lock);
+    shard.refs.insert(ref);
   }
   DCHECK(IsClassRejected(ref));
 }
 
 bool VerificationResults::IsClassRejected(ClassReference ref) const {
-  ReaderMutexLock mu(Thread::Current(), rejected_classes_lock_);
-  return rejected_classes_.find(ref) != rejected_classes_.end();
+  const Shard<ClassReference>& shard = rejected_classes_[GetShardIndex(ref)];
+  ReaderMutexLock mu(Thread::Current(), shard.lock);
+  return shard.refs.find(ref) != shard.refs.end();
 }
 
 void VerificationResults::AddUncompilableMethod(MethodReference ref) {
+  Shard<MethodReference>& shard = uncompilable_methods_[GetShardIndex(ref)];
   {
-    WriterMutexLock mu(Thread::Current(), uncompilable_methods_lock_);
-    uncompilable_methods_.insert(ref);
+    WriterMutexLock mu(Thread::Current(), shard.lock);
+    shard.refs.insert(ref);
   }
   DCHECK(IsUncompilableMethod(ref));
 }
@@ -59,18 +60,20 @@ void VerificationResults::AddUncompilableMethod(MethodReference ref) {
 void VerificationResults::AddUncompilableClass(ClassReference ref) {
   const DexFile& dex_file = *ref.dex_file;
   const dex::ClassDef& class_def = dex_file.GetClassDef(ref.ClassDefIdx());
-  WriterMutexLock mu(Thread::Current(), uncompilable_methods_lock_);
+  Thread* self = Thread::Current();
   ClassAccessor accessor(dex_file, class_def);
   for (const ClassAccessor::Method& method : accessor.GetMethods()) {
     MethodReference method_ref(&dex_file, method.GetIndex());
-    uncompilable_methods_.insert(method_ref);
+    Shard<MethodReference>& shard = uncompilable_methods_[GetShardIndex(method_ref)];
+    WriterMutexLock mu(self, shard.lock);
+    shard.refs.insert(method_ref);
   }
 }
 
 bool VerificationResults::IsUncompilableMethod(MethodReference ref) const {
-  ReaderMutexLock mu(Thread::Current(), uncompilable_methods_lock_);
-  return uncompilable_methods_.find(ref) != uncompilable_methods_.end();
+  const Shard<MethodReference>& shard = uncompilable_methods_[GetShardIndex(ref)];
+  ReaderMutexLock mu(Thread::Current(), shard.lock);
+  return shard.refs.find(ref) != shard.refs.end();
 }
 
-
 }  // namespace art
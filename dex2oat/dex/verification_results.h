@@ -17,6 +17,7 @@
 #ifndef ART_DEX2OAT_DEX_VERIFICATION_RESULTS_H_
 #define ART_DEX2OAT_DEX_VERIFICATION_RESULTS_H_
 
+#include <array>
 #include <set>
 
 #include "base/macros.h"
@@ -36,22 +37,33 @@ class VerificationResults {
   VerificationResults();
   ~VerificationResults();
 
-  void AddRejectedClass(ClassReference ref) REQUIRES(!rejected_classes_lock_);
-  bool IsClassRejected(ClassReference ref) const REQUIRES(!rejected_classes_lock_);
+  void AddRejectedClass(ClassReference ref);
+  bool IsClassRejected(ClassReference ref) const;
 
-  void AddUncompilableClass(ClassReference ref) REQUIRES(!uncompilable_methods_lock_);
-  void AddUncompilableMethod(MethodReference ref) REQUIRES(!uncompilable_methods_lock_);
-  bool IsUncompilableMethod(MethodReference ref) const REQUIRES(!uncompilable_methods_lock_);
+  void AddUncompilableClass(ClassReference ref);
+  void AddUncompilableMethod(MethodReference ref);
+  bool IsUncompilableMethod(MethodReference ref) const;
 
  private:
-  // TODO: External locking during CompilerDriver::PreCompile(), no locking during compilation.
-  mutable ReaderWriterMutex uncompilable_methods_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
-  std::set<MethodReference> uncompilable_methods_ GUARDED_BY(uncompilable_methods_lock_);
-
-  // Rejected classes.
-  // TODO: External locking during CompilerDriver::PreCompile(), no locking during compilation.
-  mutable ReaderWriterMutex rejected_classes_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
-  std::set<ClassReference> rejected_classes_ GUARDED_BY(rejected_classes_lock_);
+  // The references are spread over shards, each with its own lock, so that the verification
+  // and compilation threads do not all contend on the same lock.
+  static constexpr size_t kNumShards = 16u;
+
+  template <typename RefType>
+  struct Shard {
+    Shard() : lock("compiler verification results lock", kDefaultMutexLevel) {}
+
+    // TODO: External locking during CompilerDriver::PreCompile(), no locking during compilation.
+    mutable ReaderWriterMutex lock DEFAULT_MUTEX_ACQUIRED_AFTER;
+    std::set<RefType> refs GUARDED_BY(lock);
+  };
+
+  static size_t GetShardIndex(const DexFileReference& ref) {
+    return (reinterpret_cast<uintptr_t>(ref.dex_file) / 8u + ref.index) % kNumShards;
+  }
+
+  std::array<Shard<MethodReference>, kNumShards> uncompilable_methods_;
+  std::array<Shard<ClassReference>, kNumShards> rejected_classes_;
 
   friend class verifier::VerifierDepsTest;
 };
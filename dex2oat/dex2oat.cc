@@ -82,6 +82,7 @@
 #include "driver/compiler_driver.h"
 #include "driver/compiler_options.h"
 #include "driver/compiler_options_map-inl.h"
+#include "driver/incremental_compilation.h"
 #include "gc/space/image_space.h"
 #include "gc/space/space-inl.h"
 #include "gc/verification.h"
@@ -109,6 +110,7 @@
 #include "scoped_thread_state_change-inl.h"
 #include "stream/buffered_output_stream.h"
 #include "stream/file_output_stream.h"
+#include "thread_pool.h"
 #include "vdex_file.h"
 #include "verifier/verifier_deps.h"
 
@@ -129,6 +131,9 @@ using gc::space::ImageSpace;
 static constexpr size_t kDefaultMinDexFilesForSwap = 2;
 static constexpr size_t kDefaultMinDexFileCumulativeSizeForSwap = 20 * MB;
 
+// Default total size of the state files kept in a --compiled-method-cache-dir.
+static constexpr size_t kDefaultCompiledMethodCacheMaxSize = 256 * MB;
+
 // Compiler filter override for very large apps.
 static constexpr CompilerFilter::Filter kLargeAppFilter = CompilerFilter::kVerify;
 
@@ -847,6 +852,10 @@ class Dex2Oat final {
       Usage("--preloaded-classes and --preloaded-classes-fds should not be both specified");
     }
 
+    if (!incremental_state_filename_.empty() && !compiled_method_cache_dir_.empty()) {
+      Usage("--incremental-state and --compiled-method-cache-dir should not be both specified");
+    }
+
     if (!cpu_set_.empty()) {
       SetCpuAffinity(cpu_set_);
     }
@@ -1113,6 +1122,9 @@ class Dex2Oat final {
     AssignTrueIfExists(args, M::ForceAllowOjInlines, &force_allow_oj_inlines_);
     AssignIfExists(args, M::PublicSdk, &public_sdk_);
     AssignIfExists(args, M::ApexVersions, &apex_versions_argument_);
+    AssignIfExists(args, M::IncrementalState, &incremental_state_filename_);
+    AssignIfExists(args, M::CompiledMethodCacheDir, &compiled_method_cache_dir_);
+    AssignIfExists(args, M::CompiledMethodCacheMaxSize, &compiled_method_cache_max_size_);
 
     if (compact_dex_level_ != CompactDexLevel::kCompactDexLevelNone) {
       LOG(WARNING) << "Obsolete flag --compact-dex-level ignored";
@@ -1921,6 +1933,10 @@ class Dex2Oat final {
       driver_->SetClasspathDexFiles(class_loader_context_->FlattenOpenedDexFiles());
     }
 
+    if (!incremental_state_filename_.empty() || !compiled_method_cache_dir_.empty()) {
+      LoadIncrementalCompilation();
+    }
+
     const bool compile_individually = ShouldCompileDexFilesIndividually();
     if (compile_individually) {
       // Set the compiler driver in the callbacks so that we can avoid re-verification.
@@ -1937,12 +1953,142 @@ class Dex2Oat final {
         /*apply=*/ !IsBootImage(), /*initial_value=*/ 123456789u ^ GetCombinedChecksums());
 
     // Invoke the compilation.
+    jobject class_loader = nullptr;
     if (compile_individually) {
       CompileDexFilesIndividually();
       // Return a null classloader since we already freed released it.
-      return nullptr;
+    } else {
+      class_loader = CompileDexFiles(dex_files);
+    }
+    if (incremental_compilation_ != nullptr) {
+      StoreIncrementalCompilation();
+    }
+    return class_loader;
+  }
+
+  // Describe the compiler options and the environment that the compiled code depends on,
+  // i.e. the boot image and the class loader context. The dex files being compiled and the
+  // profile data are not included as `IncrementalCompilation` keys each method by its own
+  // dex file and profile data. Output locations and options that do not affect the
+  // generated code are left out so that they can differ between invocations.
+  std::string GetIncrementalCompilationFingerprint() {
+    static constexpr const char* kIgnoredOptionPrefixes[] = {
+        "--dex-file=", "--dex-fd=", "--dex-location=", "--zip-", "--oat-", "--output-vdex",
+        "--input-vdex", "--dm-", "--app-image-", "--image=", "--image-fd=", "--profile-file",
+        "--swap-", "-j", "--cpu-set=", "--dump-", "--timing", "--watchdog", "--invocation-file=",
+        "--class-loader-context-fds=", "--classpath-dir=", "--compilation-reason=",
+        "--incremental-state=", "--compiled-method-cache-",
+    };
+    std::ostringstream oss;
+    oss << "oat-version=" << reinterpret_cast<const char*>(OatHeader::kOatVersion.data()) << '\n';
+    oss << "isa=" << compiler_options_->GetInstructionSet()
+        << " features=" << compiler_options_->GetInstructionSetFeatures()->GetFeatureString()
+        << '\n';
+    for (int i = 1; i < original_argc; ++i) {
+      const char* arg = original_argv[i];
+      auto ignored = [&](const char* prefix) { return android::base::StartsWith(arg, prefix); };
+      if (std::none_of(std::begin(kIgnoredOptionPrefixes),
+                       std::end(kIgnoredOptionPrefixes),
+                       ignored)) {
+        oss << "arg=" << arg << '\n';
+      }
+    }
+    for (const auto& [key, value] : *key_value_store_) {
+      if (key != OatHeader::kDex2OatCmdLineKey && key != OatHeader::kCompilationReasonKey) {
+        oss << "key=" << key << '=' << value << '\n';
+      }
+    }
+    // Image classes affect code generation only for the boot image and its extensions. For
+    // apps they come from the profile and only select the classes put in the app image.
+    if (IsBootImage() || IsBootImageExtension()) {
+      std::vector<std::string> image_classes(compiler_options_->image_classes_.begin(),
+                                             compiler_options_->image_classes_.end());
+      std::sort(image_classes.begin(), image_classes.end());
+      for (const std::string& descriptor : image_classes) {
+        oss << "image-class=" << descriptor << '\n';
+      }
+    }
+    return oss.str();
+  }
+
+  void LoadIncrementalCompilation() {
+    TimingLogger::ScopedTiming t("Load incremental compilation state", timings_);
+    // Linker patches may reference the dex files being compiled, the boot class path and
+    // the class path.
+    std::vector<const DexFile*> dex_files = compiler_options_->GetDexFilesForOatFile();
+    const std::vector<const DexFile*>& boot_class_path =
+        Runtime::Current()->GetClassLinker()->GetBootClassPath();
+    dex_files.insert(dex_files.end(), boot_class_path.begin(), boot_class_path.end());
+    if (!IsBootImage() && !IsBootImageExtension()) {
+      std::vector<const DexFile*> class_path = class_loader_context_->FlattenOpenedDexFiles();
+      dex_files.insert(dex_files.end(), class_path.begin(), class_path.end());
+    }
+    incremental_compilation_.reset(
+        new IncrementalCompilation(GetIncrementalCompilationFingerprint(), std::move(dex_files)));
+    std::string error_msg;
+    if (!incremental_state_filename_.empty()) {
+      if (!incremental_compilation_->Load(incremental_state_filename_, &error_msg)) {
+        LOG(WARNING) << "Ignoring incremental compilation state: " << error_msg;
+      }
+    } else {
+      for (const DexFile* dex_file : compiler_options_->GetDexFilesForOatFile()) {
+        std::string filename = GetCompiledMethodCacheFilename(dex_file);
+        if (!incremental_compilation_->Load(filename, &error_msg)) {
+          LOG(WARNING) << "Ignoring compiled method cache file: " << error_msg;
+        }
+      }
     }
-    return CompileDexFiles(dex_files);
+    VLOG(compiler) << "Loaded " << incremental_compilation_->GetNumberOfLoadedMethods()
+                   << " methods for incremental compilation";
+    driver_->SetIncrementalCompilation(incremental_compilation_.get());
+  }
+
+  // The compiled method cache keeps a state file for each dex file, so that dex files
+  // shared by different sets of inputs, for example the unchanged dex files of an app
+  // update, share cached code.
+  std::string GetCompiledMethodCacheFilename(const DexFile* dex_file) const {
+    return compiled_method_cache_dir_ + "/" + incremental_compilation_->GetFingerprintHash() +
+           "-" + IncrementalCompilation::GetDexFileKey(dex_file) + ".cmc";
+  }
+
+  void StoreIncrementalCompilation() {
+    TimingLogger::ScopedTiming t("Store incremental compilation state", timings_);
+    const ProfileCompilationInfo* profile_compilation_info = profile_compilation_info_.get();
+    for (const DexFile* dex_file : compiler_options_->GetDexFilesForOatFile()) {
+      for (uint32_t method_idx = 0, size = dex_file->NumMethodIds(); method_idx != size;
+           ++method_idx) {
+        MethodReference method_ref(dex_file, method_idx);
+        CompiledMethod* compiled_method = driver_->GetCompiledMethod(method_ref);
+        if (compiled_method != nullptr) {
+          incremental_compilation_->Add(
+              driver_->GetCompiledMethodStorage(),
+              method_ref,
+              compiled_method,
+              IncrementalCompilation::GetProfileKey(profile_compilation_info, method_ref));
+        }
+      }
+    }
+    size_t hits = incremental_compilation_->GetNumberOfReusedMethods();
+    size_t misses = incremental_compilation_->GetNumberOfMissedMethods();
+    LOG(INFO) << "Compiled method cache: " << hits << " hits, " << misses << " misses ("
+              << (hits + misses != 0u ? hits * 100u / (hits + misses) : 0u) << "% hit rate), "
+              << incremental_compilation_->GetNumberOfAddedMethods() << " methods stored";
+    std::string error_msg;
+    if (!incremental_state_filename_.empty()) {
+      if (!incremental_compilation_->Store(
+              incremental_state_filename_, /*dex_file=*/ nullptr, &error_msg)) {
+        LOG(WARNING) << "Failed to store incremental compilation state: " << error_msg;
+      }
+      return;
+    }
+    for (const DexFile* dex_file : compiler_options_->GetDexFilesForOatFile()) {
+      if (!incremental_compilation_->Store(
+              GetCompiledMethodCacheFilename(dex_file), dex_file, &error_msg)) {
+        LOG(WARNING) << "Failed to store compiled method cache file: " << error_msg;
+      }
+    }
+    IncrementalCompilation::TrimCacheDirectory(compiled_method_cache_dir_,
+                                               compiled_method_cache_max_size_);
   }
 
   // Create the class loader, use it to compile, and return.
@@ -2089,7 +2235,8 @@ class Dex2Oat final {
                                                   oat_filenames_,
                                                   dex_file_oat_index_map_,
                                                   class_loader,
-                                                  dirty_image_objects_.get()));
+                                                  dirty_image_objects_.get(),
+                                                  thread_count_));
 
       // We need to prepare method offsets in the image address space for resolving linker patches.
       TimingLogger::ScopedTiming t2("dex2oat Prepare image address space", timings_);
@@ -2111,9 +2258,14 @@ class Dex2Oat final {
       TimingLogger::ScopedTiming t2("dex2oat Write VDEX", timings_);
       DCHECK(IsBootImage() || IsBootImageExtension() || oat_files_.size() == 1u);
       verifier::VerifierDeps* verifier_deps = callbacks_->GetVerifierDeps();
+      // Encoding the verifier deps of large apps takes a while, so use the other threads.
+      std::unique_ptr<ThreadPool> thread_pool;
+      if (verifier_deps != nullptr && thread_count_ > 1u) {
+        thread_pool.reset(ThreadPool::Create("Vdex writer thread pool", thread_count_ - 1u));
+      }
       for (size_t i = 0, size = oat_files_.size(); i != size; ++i) {
         File* vdex_file = vdex_files_[i].get();
-        if (!oat_writers_[i]->FinishVdexFile(vdex_file, verifier_deps)) {
+        if (!oat_writers_[i]->FinishVdexFile(vdex_file, verifier_deps, thread_pool.get())) {
           LOG(ERROR) << "Failed to finish VDEX file " << vdex_file->GetPath();
           return false;
         }
@@ -2211,6 +2363,9 @@ class Dex2Oat final {
         VLOG(compiler) << "Oat file written successfully: " << oat_filenames_[i];
 
         oat_writer.reset();
+        // The code of this oat file has been written and its layout is known to the image
+        // writer and the patcher, so its compiled methods are no longer needed.
+        driver_->FreeCompiledMethods(dex_files_per_oat_file_[i]);
         // We may still need the ELF writer later for stripping.
       }
     }
@@ -2655,7 +2810,8 @@ class Dex2Oat final {
     elf_writers_.reserve(oat_files_.size());
     oat_writers_.reserve(oat_files_.size());
     for (const std::unique_ptr<File>& oat_file : oat_files_) {
-      elf_writers_.emplace_back(linker::CreateElfWriterQuick(*compiler_options_, oat_file.get()));
+      elf_writers_.emplace_back(
+          linker::CreateElfWriterQuick(*compiler_options_, oat_file.get(), thread_count_));
       elf_writers_.back()->Start();
       bool do_oat_writer_layout = DoDexLayoutOptimizations() || DoOatLayoutOptimizations();
       oat_writers_.emplace_back(new linker::OatWriter(
@@ -3035,6 +3191,13 @@ class Dex2Oat final {
   // argument.
   std::string apex_versions_argument_;
 
+  // File holding the compiled code of a previous invocation, see --incremental-state.
+  std::string incremental_state_filename_;
+  // Directory holding such files for any inputs, see --compiled-method-cache-dir.
+  std::string compiled_method_cache_dir_;
+  size_t compiled_method_cache_max_size_ = kDefaultCompiledMethodCacheMaxSize;
+  std::unique_ptr<IncrementalCompilation> incremental_compilation_;
+
   // Whether or we attempted to load the profile (if given).
   bool profile_load_attempted_;
 
@@ -447,6 +447,24 @@ Parser CreateDex2oatArgumentParser() {
           .WithHelp("Compiles dex files individually, unloading classes in between compiling each"
                     " file.")
           .IntoKey(M::CompileIndividually)
+      .Define("--incremental-state=_")
+          .WithType<std::string>()
+          .WithHelp("Specify a file that holds the compiled code of a previous invocation with\n"
+                    "the same options. Methods whose dex file and profile data are unchanged are\n"
+                    "not compiled again and the file is updated with the code of this invocation.")
+          .IntoKey(M::IncrementalState)
+      .Define("--compiled-method-cache-dir=_")
+          .WithType<std::string>()
+          .WithHelp("Specify a directory shared by invocations to cache compiled code in, with a\n"
+                    "file for each dex file keyed by its contents and the compiler options. Like\n"
+                    "--incremental-state but the files are chosen based on the inputs.")
+          .IntoKey(M::CompiledMethodCacheDir)
+      .Define("--compiled-method-cache-max-size=_")
+          .WithType<unsigned int>()
+          .WithHelp("Specify the maximum total size in bytes of the files kept in the\n"
+                    "--compiled-method-cache-dir. The least recently used files are deleted\n"
+                    "first. Default: 256 MiB.")
+          .IntoKey(M::CompiledMethodCacheMaxSize)
       .Define("--public-sdk=_")
           .WithType<std::string>()
           .IntoKey(M::PublicSdk)
@@ -66,11 +66,16 @@ inline const LengthPrefixedArray<T>* CompiledMethodStorage::AllocateOrDeduplicat
   }
 }
 
-template <typename T>
-inline void CompiledMethodStorage::ReleaseArrayIfNotDeduplicated(
-    const LengthPrefixedArray<T>* array) {
-  if (array != nullptr && !DedupeEnabled()) {
+template <typename T, typename DedupeSetType>
+inline void CompiledMethodStorage::ReleaseOrDereferenceArray(const LengthPrefixedArray<T>* array,
+                                                             DedupeSetType* dedupe_set) {
+  if (array == nullptr) {
+    return;
+  } else if (!DedupeEnabled()) {
     ReleaseArray(swap_space_.get(), array);
+  } else {
+    // Deduplicated arrays are shared, release the array only with its last reference.
+    dedupe_set->Release(Thread::Current(), ArrayRef<const T>(&array->At(0), array->size()));
   }
 }
 
@@ -180,7 +185,7 @@ const LengthPrefixedArray<uint8_t>* CompiledMethodStorage::DeduplicateCode(
 }
 
 void CompiledMethodStorage::ReleaseCode(const LengthPrefixedArray<uint8_t>* code) {
-  ReleaseArrayIfNotDeduplicated(code);
+  ReleaseOrDereferenceArray(code, &dedupe_code_);
 }
 
 size_t CompiledMethodStorage::UniqueCodeEntries() const {
@@ -194,7 +199,7 @@ const LengthPrefixedArray<uint8_t>* CompiledMethodStorage::DeduplicateVMapTable(
 }
 
 void CompiledMethodStorage::ReleaseVMapTable(const LengthPrefixedArray<uint8_t>* table) {
-  ReleaseArrayIfNotDeduplicated(table);
+  ReleaseOrDereferenceArray(table, &dedupe_vmap_table_);
 }
 
 size_t CompiledMethodStorage::UniqueVMapTableEntries() const {
@@ -208,7 +213,7 @@ const LengthPrefixedArray<uint8_t>* CompiledMethodStorage::DeduplicateCFIInfo(
 }
 
 void CompiledMethodStorage::ReleaseCFIInfo(const LengthPrefixedArray<uint8_t>* cfi_info) {
-  ReleaseArrayIfNotDeduplicated(cfi_info);
+  ReleaseOrDereferenceArray(cfi_info, &dedupe_cfi_info_);
 }
 
 size_t CompiledMethodStorage::UniqueCFIInfoEntries() const {
@@ -223,7 +228,7 @@ const LengthPrefixedArray<linker::LinkerPatch>* CompiledMethodStorage::Deduplica
 
 void CompiledMethodStorage::ReleaseLinkerPatches(
     const LengthPrefixedArray<linker::LinkerPatch>* linker_patches) {
-  ReleaseArrayIfNotDeduplicated(linker_patches);
+  ReleaseOrDereferenceArray(linker_patches, &dedupe_linker_patches_);
 }
 
 size_t CompiledMethodStorage::UniqueLinkerPatchesEntries() const {
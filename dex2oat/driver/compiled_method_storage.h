@@ -104,8 +104,8 @@ class CompiledMethodStorage final : public CompiledCodeStorage {
   const LengthPrefixedArray<T>* AllocateOrDeduplicateArray(const ArrayRef<const T>& data,
                                                            DedupeSetType* dedupe_set);
 
-  template <typename T>
-  void ReleaseArrayIfNotDeduplicated(const LengthPrefixedArray<T>* array);
+  template <typename T, typename DedupeSetType>
+  void ReleaseOrDereferenceArray(const LengthPrefixedArray<T>* array, DedupeSetType* dedupe_set);
 
   // DeDuplication data structures.
   template <typename ContentType>
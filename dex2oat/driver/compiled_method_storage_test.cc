@@ -98,4 +98,46 @@ TEST(CompiledMethodStorage, Deduplicate) {
   }
 }
 
+TEST(CompiledMethodStorage, ReleaseDeduplicated) {
+  CompiledMethodStorage storage(/* swap_fd= */ -1);
+  ASSERT_TRUE(storage.DedupeEnabled());
+
+  const uint8_t raw_code[] = { 1u, 2u, 3u };
+  const uint8_t raw_vmap_table[] = { 2, 4, 6 };
+  const uint8_t raw_cfi_info[] = { 1, 3, 5 };
+  const linker::LinkerPatch raw_patches[] = {
+      linker::LinkerPatch::IntrinsicReferencePatch(0u, 0u, 0u),
+  };
+  auto create_method = [&]() {
+    return CompiledMethod::SwapAllocCompiledMethod(
+        &storage,
+        InstructionSet::kNone,
+        ArrayRef<const uint8_t>(raw_code),
+        ArrayRef<const uint8_t>(raw_vmap_table),
+        ArrayRef<const uint8_t>(raw_cfi_info),
+        ArrayRef<const linker::LinkerPatch>(raw_patches));
+  };
+  CompiledMethod* method1 = create_method();
+  CompiledMethod* method2 = create_method();
+  ASSERT_EQ(method1->GetQuickCode().data(), method2->GetQuickCode().data());
+  ASSERT_EQ(1u, storage.UniqueCodeEntries());
+  ASSERT_EQ(1u, storage.UniqueVMapTableEntries());
+  ASSERT_EQ(1u, storage.UniqueCFIInfoEntries());
+  ASSERT_EQ(1u, storage.UniqueLinkerPatchesEntries());
+
+  // The shared data stays alive as long as a compiled method references it.
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, method1);
+  ASSERT_EQ(1u, storage.UniqueCodeEntries());
+  ASSERT_TRUE(std::equal(std::begin(raw_code),
+                         std::end(raw_code),
+                         method2->GetQuickCode().begin()));
+
+  // Releasing the last reference frees the deduplicated data.
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, method2);
+  ASSERT_EQ(0u, storage.UniqueCodeEntries());
+  ASSERT_EQ(0u, storage.UniqueVMapTableEntries());
+  ASSERT_EQ(0u, storage.UniqueCFIInfoEntries());
+  ASSERT_EQ(0u, storage.UniqueLinkerPatchesEntries());
+}
+
 }  // namespace art
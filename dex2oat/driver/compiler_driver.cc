@@ -59,6 +59,7 @@
 #include "gc/space/image_space.h"
 #include "gc/space/space.h"
 #include "handle_scope-inl.h"
+#include "incremental_compilation.h"
 #include "intrinsics_enum.h"
 #include "intrinsics_list.h"
 #include "jni/jni_internal.h"
@@ -266,6 +267,7 @@ CompilerDriver::CompilerDriver(
       parallel_thread_count_(thread_count),
       stats_(new AOTCompilationStats),
       compiled_method_storage_(swap_fd),
+      incremental_compilation_(nullptr),
       max_arena_alloc_(0) {
   DCHECK(compiler_options_ != nullptr);
 
@@ -508,15 +510,25 @@ static void CompileMethodQuick(
       compile = compile && ShouldCompileBasedOnProfile(compiler_options, profile_index, method_ref);
 
       if (compile) {
-        // NOTE: if compiler declines to compile this method, it will return null.
-        compiled_method = driver->GetCompiler()->Compile(code_item,
-                                                         access_flags,
-                                                         invoke_type,
-                                                         class_def_idx,
-                                                         method_idx,
-                                                         class_loader,
-                                                         dex_file,
-                                                         dex_cache);
+        IncrementalCompilation* incremental_compilation = driver->GetIncrementalCompilation();
+        if (incremental_compilation != nullptr) {
+          compiled_method = incremental_compilation->Reuse(
+              driver->GetCompiledMethodStorage(),
+              method_ref,
+              IncrementalCompilation::GetProfileKey(
+                  compiler_options.GetProfileCompilationInfo(), method_ref));
+        }
+        if (compiled_method == nullptr) {
+          // NOTE: if compiler declines to compile this method, it will return null.
+          compiled_method = driver->GetCompiler()->Compile(code_item,
+                                                           access_flags,
+                                                           invoke_type,
+                                                           class_def_idx,
+                                                           method_idx,
+                                                           class_loader,
+                                                           dex_file,
+                                                           dex_cache);
+        }
         ProfileMethodsCheck check_type = compiler_options.CheckProfiledMethodsCompiled();
         if (UNLIKELY(check_type != ProfileMethodsCheck::kNone)) {
           DCHECK(ShouldCompileBasedOnProfile(compiler_options, profile_index, method_ref));
@@ -559,12 +571,13 @@ static void CompileMethodQuick(
 void CompilerDriver::Resolve(jobject class_loader,
                              const std::vector<const DexFile*>& dex_files,
                              TimingLogger* timings) {
-  // Resolution allocates classes and needs to run single-threaded to be deterministic.
-  bool force_determinism = GetCompilerOptions().IsForceDeterminism();
-  ThreadPool* resolve_thread_pool = force_determinism
-                                     ? single_thread_pool_.get()
-                                     : parallel_thread_pool_.get();
-  size_t resolve_thread_count = force_determinism ? 1U : parallel_thread_count_;
+  // Resolution allocates classes and needs to run single-threaded to be deterministic
+  // if the heap is part of the output.
+  bool parallel = CanChangeRuntimeStateInParallel();
+  ThreadPool* resolve_thread_pool = parallel
+                                     ? parallel_thread_pool_.get()
+                                     : single_thread_pool_.get();
+  size_t resolve_thread_count = parallel ? parallel_thread_count_ : 1U;
 
   for (size_t i = 0; i != dex_files.size(); ++i) {
     const DexFile* dex_file = dex_files[i];
@@ -734,6 +747,13 @@ inline void CompilerDriver::CheckThreadPools() {
   DCHECK(single_thread_pool_ != nullptr);
 }
 
+bool CompilerDriver::CanChangeRuntimeStateInParallel() const {
+  // Without an image, the results of these phases that reach the output, i.e. class statuses,
+  // verification results and VerifierDeps, do not depend on the order in which classes are
+  // processed, except for the ids of the VerifierDeps extra strings which are sorted.
+  return !GetCompilerOptions().IsForceDeterminism() || !GetCompilerOptions().IsGeneratingImage();
+}
+
 static void EnsureVerifiedOrVerifyAtRuntime(jobject jclass_loader,
                                             const std::vector<const DexFile*>& dex_files) {
   ScopedObjectAccess soa(Thread::Current());
@@ -1838,11 +1858,12 @@ void CompilerDriver::Verify(jobject jclass_loader,
     }
   }
 
-  // Verification updates VerifierDeps and needs to run single-threaded to be deterministic.
-  bool force_determinism = GetCompilerOptions().IsForceDeterminism();
+  // Verification loads classes and needs to run single-threaded to be deterministic
+  // if the heap is part of the output. The VerifierDeps are made deterministic below.
+  bool parallel = CanChangeRuntimeStateInParallel();
   ThreadPool* verify_thread_pool =
-      force_determinism ? single_thread_pool_.get() : parallel_thread_pool_.get();
-  size_t verify_thread_count = force_determinism ? 1U : parallel_thread_count_;
+      parallel ? parallel_thread_pool_.get() : single_thread_pool_.get();
+  size_t verify_thread_count = parallel ? parallel_thread_count_ : 1U;
   for (const DexFile* dex_file : dex_files) {
     CHECK(dex_file != nullptr);
     VerifyDexFile(jclass_loader,
@@ -1854,12 +1875,20 @@ void CompilerDriver::Verify(jobject jclass_loader,
   }
 
   if (main_verifier_deps != nullptr) {
-    // Merge all VerifierDeps into the main one.
+    // Merge all VerifierDeps into the main one. The per-thread deps are merged in parallel
+    // over ranges of class defs, which needs the workers' threads to be done with them.
+    std::vector<std::unique_ptr<verifier::VerifierDeps>> thread_deps;
     for (ThreadPoolWorker* worker : parallel_thread_pool_->GetWorkers()) {
-      std::unique_ptr<verifier::VerifierDeps> thread_deps(worker->GetThread()->GetVerifierDeps());
+      thread_deps.emplace_back(worker->GetThread()->GetVerifierDeps());
       worker->GetThread()->SetVerifierDeps(nullptr);  // We just took ownership.
-      main_verifier_deps->MergeWith(std::move(thread_deps),
-                                    GetCompilerOptions().GetDexFilesForOatFile());
+    }
+    main_verifier_deps->MergeWith(std::move(thread_deps),
+                                  GetCompilerOptions().GetDexFilesForOatFile(),
+                                  parallel_thread_pool_.get());
+    if (GetCompilerOptions().IsForceDeterminism()) {
+      // The ids of strings that are not in the dex files were assigned in the order
+      // in which the verifier threads encountered them.
+      main_verifier_deps->SortExtraStrings(GetCompilerOptions().GetDexFilesForOatFile());
     }
     Thread::Current()->SetVerifierDeps(nullptr);
   }
@@ -2530,12 +2559,13 @@ void CompilerDriver::InitializeClasses(jobject jni_class_loader,
                                        TimingLogger* timings) {
   TimingLogger::ScopedTiming t("InitializeNoClinit", timings);
 
-  // Initialization allocates objects and needs to run single-threaded to be deterministic.
-  bool force_determinism = GetCompilerOptions().IsForceDeterminism();
-  ThreadPool* init_thread_pool = force_determinism
-                                     ? single_thread_pool_.get()
-                                     : parallel_thread_pool_.get();
-  size_t init_thread_count = force_determinism ? 1U : parallel_thread_count_;
+  // Initialization allocates objects and needs to run single-threaded to be deterministic
+  // if the heap is part of the output.
+  bool parallel = CanChangeRuntimeStateInParallel();
+  ThreadPool* init_thread_pool = parallel
+                                     ? parallel_thread_pool_.get()
+                                     : single_thread_pool_.get();
+  size_t init_thread_count = parallel ? parallel_thread_count_ : 1U;
 
   ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
   ParallelCompilationManager context(class_linker, jni_class_loader, this, &dex_file, dex_files,
@@ -2781,6 +2811,22 @@ void CompilerDriver::RecordClassStatus(const ClassReference& ref, ClassStatus st
   } while (result != ClassStateTable::kInsertResultSuccess);
 }
 
+void CompilerDriver::FreeCompiledMethods(const std::vector<const DexFile*>& dex_files) {
+  for (const DexFile* dex_file : dex_files) {
+    if (!compiled_methods_.HaveDexFile(dex_file)) {
+      continue;
+    }
+    for (uint32_t method_idx = 0, size = dex_file->NumMethodIds(); method_idx != size; ++method_idx) {
+      CompiledMethod* compiled_method = nullptr;
+      compiled_methods_.Remove(MethodReference(dex_file, method_idx), &compiled_method);
+      if (compiled_method != nullptr) {
+        CompiledMethod::ReleaseSwapAllocatedCompiledMethod(GetCompiledMethodStorage(),
+                                                           compiled_method);
+      }
+    }
+  }
+}
+
 CompiledMethod* CompilerDriver::GetCompiledMethod(MethodReference ref) const {
   CompiledMethod* compiled_method = nullptr;
   compiled_methods_.Get(ref, &compiled_method);
@@ -63,6 +63,7 @@ class CompilerOptions;
 class DexCompilationUnit;
 class DexFile;
 template<class T> class Handle;
+class IncrementalCompilation;
 struct InlineIGetIPutData;
 class InstructionSetFeatures;
 class InternTable;
@@ -140,6 +141,11 @@ class CompilerDriver {
   // Add a compiled method.
   void AddCompiledMethod(const MethodReference& method_ref, CompiledMethod* const compiled_method);
   CompiledMethod* RemoveCompiledMethod(const MethodReference& method_ref);
+  // Release the compiled methods of `dex_files`. Used once the oat file they were
+  // compiled into has been written, so that multi-image compilations do not keep the
+  // compiled methods of all oat files alive until the end. Deduplicated code and data
+  // is freed with the last compiled method referencing it.
+  void FreeCompiledMethods(const std::vector<const DexFile*>& dex_files);
 
   // Resolve compiling method's class. Returns null on failure.
   ObjPtr<mirror::Class> ResolveCompilingMethodsClass(const ScopedObjectAccess& soa,
@@ -226,6 +232,16 @@ class CompilerDriver {
     return &compiled_method_storage_;
   }
 
+  // Use compiled code saved by a previous invocation for methods that do not need to be
+  // compiled again. The caller retains ownership.
+  void SetIncrementalCompilation(IncrementalCompilation* incremental_compilation) {
+    incremental_compilation_ = incremental_compilation;
+  }
+
+  IncrementalCompilation* GetIncrementalCompilation() const {
+    return incremental_compilation_;
+  }
+
  private:
   void LoadImageClasses(TimingLogger* timings, /*inout*/ HashSet<std::string>* image_classes)
       REQUIRES(!Locks::mutator_lock_);
@@ -293,6 +309,12 @@ class CompilerDriver {
 
   void CheckThreadPools();
 
+  // Whether resolution, verification and class initialization may use the parallel thread
+  // pool. These phases change the runtime state in an order that depends on the thread
+  // interleaving, so with --force-determinism they run single-threaded when that state
+  // becomes part of the output, i.e. when generating an image.
+  bool CanChangeRuntimeStateInParallel() const;
+
   // Resolve const string literals that are loaded from dex code. If only_startup_strings is
   // specified, only methods that are marked startup in the profile are resolved.
   void ResolveConstStrings(const std::vector<const DexFile*>& dex_files,
@@ -332,6 +354,8 @@ class CompilerDriver {
 
   CompiledMethodStorage compiled_method_storage_;
 
+  IncrementalCompilation* incremental_compilation_;
+
   size_t max_arena_alloc_;
 
   friend class CommonCompilerDriverTest;
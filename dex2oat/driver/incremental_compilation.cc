@@ -0,0 +1,744 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "incremental_compilation.h"
+
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <string_view>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+#include <android-base/strings.h>
+
+#include "base/bit_utils.h"
+#include "base/casts.h"
+#include "base/leb128.h"
+#include "base/os.h"
+#include "base/unix_file/fd_file.h"
+#include "compiled_method-inl.h"
+#include "compiled_method_storage.h"
+#include "dex/dex_file.h"
+#include "profile/profile_compilation_info.h"
+
+namespace art {
+
+using android::base::StringPrintf;
+
+// Bump the version whenever the encoding below or the meaning of saved data changes.
+static constexpr uint8_t kMagic[] = { 'i', 'c', 's', '\n' };
+static constexpr uint8_t kVersion[] = { '0', '0', '2', '\0' };
+
+// Value of the encoded target dex file for linker patches without one.
+static constexpr uint32_t kNoDexFile = 0u;
+
+static void EncodeBytes(std::vector<uint8_t>* out, ArrayRef<const uint8_t> data) {
+  EncodeUnsignedLeb128(out, dchecked_integral_cast<uint32_t>(data.size()));
+  out->insert(out->end(), data.begin(), data.end());
+}
+
+static void EncodeString(std::vector<uint8_t>* out, std::string_view str) {
+  EncodeBytes(out, ArrayRef<const uint8_t>(reinterpret_cast<const uint8_t*>(str.data()),
+                                           str.size()));
+}
+
+static bool HasThunk(const linker::LinkerPatch& patch) {
+  switch (patch.GetType()) {
+    case linker::LinkerPatch::Type::kCallRelative:
+    case linker::LinkerPatch::Type::kCallEntrypoint:
+    case linker::LinkerPatch::Type::kBakerReadBarrierBranch:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static const DexFile* GetTargetDexFile(const linker::LinkerPatch& patch) {
+  using Type = linker::LinkerPatch::Type;
+  switch (patch.GetType()) {
+    case Type::kMethodRelative:
+    case Type::kMethodBssEntry:
+    case Type::kJniEntrypointRelative:
+    case Type::kCallRelative:
+      return patch.TargetMethod().dex_file;
+    case Type::kTypeRelative:
+    case Type::kTypeBssEntry:
+    case Type::kPublicTypeBssEntry:
+    case Type::kPackageTypeBssEntry:
+      return patch.TargetTypeDexFile();
+    case Type::kStringRelative:
+    case Type::kStringBssEntry:
+      return patch.TargetStringDexFile();
+    case Type::kMethodTypeBssEntry:
+      return patch.TargetProtoDexFile();
+    default:
+      return nullptr;
+  }
+}
+
+class IncrementalCompilation::Reader {
+ public:
+  explicit Reader(ArrayRef<const uint8_t> data)
+      : ptr_(data.data()), end_(data.data() + data.size()) {}
+
+  bool ReadUint32(/*out*/ uint32_t* value) {
+    return DecodeUnsignedLeb128Checked(&ptr_, end_, value);
+  }
+
+  bool ReadBytes(/*out*/ ArrayRef<const uint8_t>* data) {
+    uint32_t size;
+    if (!ReadUint32(&size) || size > static_cast<size_t>(end_ - ptr_)) {
+      return false;
+    }
+    *data = ArrayRef<const uint8_t>(ptr_, size);
+    ptr_ += size;
+    return true;
+  }
+
+  bool ReadBytes(/*out*/ std::vector<uint8_t>* data) {
+    ArrayRef<const uint8_t> bytes;
+    if (!ReadBytes(&bytes)) {
+      return false;
+    }
+    data->assign(bytes.begin(), bytes.end());
+    return true;
+  }
+
+  bool ReadString(/*out*/ std::string* str) {
+    ArrayRef<const uint8_t> bytes;
+    if (!ReadBytes(&bytes)) {
+      return false;
+    }
+    str->assign(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return true;
+  }
+
+  bool ReadRaw(size_t size, /*out*/ ArrayRef<const uint8_t>* data) {
+    if (size > static_cast<size_t>(end_ - ptr_)) {
+      return false;
+    }
+    *data = ArrayRef<const uint8_t>(ptr_, size);
+    ptr_ += size;
+    return true;
+  }
+
+  bool IsAtEnd() const {
+    return ptr_ == end_;
+  }
+
+  const uint8_t* GetPosition() const {
+    return ptr_;
+  }
+
+ private:
+  const uint8_t* ptr_;
+  const uint8_t* const end_;
+};
+
+IncrementalCompilation::IncrementalCompilation(std::string fingerprint,
+                                               std::vector<const DexFile*> dex_files)
+    : fingerprint_(std::move(fingerprint)),
+      dex_files_(std::move(dex_files)),
+      dex_file_indexes_(),
+      dex_files_by_key_(),
+      entries_(),
+      number_of_loaded_methods_(0u),
+      number_of_reused_methods_(0u),
+      number_of_missed_methods_(0u),
+      number_of_added_methods_(0u) {
+  for (size_t i = 0, size = dex_files_.size(); i != size; ++i) {
+    dex_file_indexes_.Overwrite(dex_files_[i], dchecked_integral_cast<uint32_t>(i));
+    dex_files_by_key_.Overwrite(GetDexFileKey(dex_files_[i]), dex_files_[i]);
+  }
+}
+
+std::string IncrementalCompilation::GetDexFileKey(const DexFile* dex_file) {
+  std::string key = StringPrintf("%08x-", dex_file->GetLocationChecksum());
+  for (uint8_t byte : dex_file->GetSha1()) {
+    key += StringPrintf("%02x", byte);
+  }
+  return key;
+}
+
+bool IncrementalCompilation::Load(const std::string& filename, std::string* error_msg) {
+  if (!OS::FileExists(filename.c_str())) {
+    return true;
+  }
+  std::string data;
+  if (!android::base::ReadFileToString(filename, &data)) {
+    *error_msg = StringPrintf("Failed to read incremental compilation state '%s': %s",
+                              filename.c_str(),
+                              strerror(errno));
+    return false;
+  }
+  return Decode(ArrayRef<const uint8_t>(reinterpret_cast<const uint8_t*>(data.data()),
+                                        data.size()),
+                error_msg);
+}
+
+bool IncrementalCompilation::Store(const std::string& filename,
+                                   const DexFile* dex_file,
+                                   std::string* error_msg) const {
+  std::vector<uint8_t> data = Encode(dex_file);
+  // Write to a temporary file first so that an interrupted write does not leave a truncated
+  // state behind. The name is unique so that concurrent invocations sharing a cache directory
+  // do not write to the same file.
+  std::string tmp_filename = StringPrintf("%s.%d.tmp", filename.c_str(), getpid());
+  std::unique_ptr<File> file(OS::CreateEmptyFile(tmp_filename.c_str()));
+  if (file == nullptr) {
+    *error_msg = StringPrintf("Failed to create '%s': %s", tmp_filename.c_str(), strerror(errno));
+    return false;
+  }
+  if (!file->WriteFully(data.data(), data.size())) {
+    *error_msg = StringPrintf("Failed to write '%s': %s", tmp_filename.c_str(), strerror(errno));
+    file->Erase(/*unlink=*/ true);
+    return false;
+  }
+  if (file->FlushCloseOrErase() != 0) {
+    *error_msg = StringPrintf("Failed to flush '%s': %s", tmp_filename.c_str(), strerror(errno));
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  if (rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    *error_msg = StringPrintf("Failed to rename '%s' to '%s': %s",
+                              tmp_filename.c_str(),
+                              filename.c_str(),
+                              strerror(errno));
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::vector<uint8_t> IncrementalCompilation::Encode(const DexFile* dex_file) const {
+  auto is_encoded = [&](const std::pair<uint32_t, uint32_t>& key) {
+    return dex_file == nullptr || dex_files_[key.first] == dex_file;
+  };
+  // Record the dex files referenced by the saved methods in a table, in the order of
+  // `dex_files_` so that the encoding is deterministic.
+  std::vector<uint32_t> dex_file_table_indexes(dex_files_.size(), kNoDexFile);
+  auto use_dex_file = [&](const DexFile* target_dex_file) {
+    if (target_dex_file != nullptr) {
+      dex_file_table_indexes[dex_file_indexes_.Get(target_dex_file)] = 1u;
+    }
+  };
+  size_t number_of_entries = 0u;
+  for (const auto& [key, entry] : entries_) {
+    if (!is_encoded(key)) {
+      continue;
+    }
+    ++number_of_entries;
+    use_dex_file(dex_files_[key.first]);
+    for (const linker::LinkerPatch& patch : entry.patches) {
+      use_dex_file(GetTargetDexFile(patch));
+    }
+    for (const Thunk& thunk : entry.thunks) {
+      use_dex_file(GetTargetDexFile(thunk.patch));
+    }
+  }
+  std::vector<uint8_t> data;
+  data.insert(data.end(), std::begin(kMagic), std::end(kMagic));
+  data.insert(data.end(), std::begin(kVersion), std::end(kVersion));
+  EncodeString(&data, fingerprint_);
+  uint32_t dex_file_table_size = 0u;
+  std::vector<uint8_t> dex_file_table;
+  for (size_t i = 0, size = dex_files_.size(); i != size; ++i) {
+    if (dex_file_table_indexes[i] != kNoDexFile) {
+      // Encoded indexes are biased by one, see `kNoDexFile`.
+      ++dex_file_table_size;
+      dex_file_table_indexes[i] = dex_file_table_size;
+      EncodeString(&dex_file_table, GetDexFileKey(dex_files_[i]));
+    }
+  }
+  EncodeUnsignedLeb128(&data, dex_file_table_size);
+  data.insert(data.end(), dex_file_table.begin(), dex_file_table.end());
+  EncodeUnsignedLeb128(&data, dchecked_integral_cast<uint32_t>(number_of_entries));
+  for (const auto& [key, entry] : entries_) {
+    if (!is_encoded(key)) {
+      continue;
+    }
+    EncodeUnsignedLeb128(&data, dex_file_table_indexes[key.first]);
+    EncodeUnsignedLeb128(&data, key.second);
+    EncodeBytes(&data, ArrayRef<const uint8_t>(entry.profile_key));
+    EncodeUnsignedLeb128(&data, static_cast<uint32_t>(entry.instruction_set));
+    EncodeBytes(&data, ArrayRef<const uint8_t>(entry.code));
+    EncodeBytes(&data, ArrayRef<const uint8_t>(entry.vmap_table));
+    EncodeBytes(&data, ArrayRef<const uint8_t>(entry.cfi_info));
+    EncodeUnsignedLeb128(&data, entry.is_intrinsic ? 1u : 0u);
+    EncodeUnsignedLeb128(&data, dchecked_integral_cast<uint32_t>(entry.patches.size()));
+    for (const linker::LinkerPatch& patch : entry.patches) {
+      EncodePatch(patch, dex_file_table_indexes, &data);
+    }
+    EncodeUnsignedLeb128(&data, dchecked_integral_cast<uint32_t>(entry.thunks.size()));
+    for (const Thunk& thunk : entry.thunks) {
+      EncodePatch(thunk.patch, dex_file_table_indexes, &data);
+      EncodeBytes(&data, ArrayRef<const uint8_t>(thunk.code));
+      EncodeString(&data, thunk.debug_name);
+    }
+  }
+  return data;
+}
+
+std::string IncrementalCompilation::GetFingerprintHash() const {
+  // 64-bit FNV-1a. Collisions are harmless as the full fingerprint is compared when loading.
+  uint64_t hash = UINT64_C(0xcbf29ce484222325);
+  for (char c : fingerprint_) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * UINT64_C(0x100000001b3);
+  }
+  return StringPrintf("%016" PRIx64, hash);
+}
+
+void IncrementalCompilation::TrimCacheDirectory(const std::string& dir, uint64_t max_size) {
+  std::unique_ptr<DIR, int (*)(DIR*)> cache_dir(opendir(dir.c_str()), closedir);
+  if (cache_dir == nullptr) {
+    PLOG(WARNING) << "Failed to open compiled method cache directory '" << dir << "'";
+    return;
+  }
+  struct CacheFile {
+    std::string filename;
+    struct timespec mtime;
+    uint64_t size;
+  };
+  std::vector<CacheFile> cache_files;
+  uint64_t total_size = 0u;
+  for (struct dirent* e = readdir(cache_dir.get()); e != nullptr; e = readdir(cache_dir.get())) {
+    // Skip the temporary files of invocations that are still writing their state.
+    if (!android::base::EndsWith(e->d_name, ".cmc")) {
+      continue;
+    }
+    std::string filename = dir + "/" + e->d_name;
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) {
+      // Deleted by another invocation.
+      continue;
+    }
+    cache_files.push_back({filename, st.st_mtim, static_cast<uint64_t>(st.st_size)});
+    total_size += static_cast<uint64_t>(st.st_size);
+  }
+  if (total_size <= max_size) {
+    return;
+  }
+  std::sort(cache_files.begin(),
+            cache_files.end(),
+            [](const CacheFile& lhs, const CacheFile& rhs) {
+              return std::make_pair(lhs.mtime.tv_sec, lhs.mtime.tv_nsec) <
+                     std::make_pair(rhs.mtime.tv_sec, rhs.mtime.tv_nsec);
+            });
+  for (const CacheFile& cache_file : cache_files) {
+    if (total_size <= max_size) {
+      break;
+    }
+    if (unlink(cache_file.filename.c_str()) != 0 && errno != ENOENT) {
+      PLOG(WARNING) << "Failed to delete '" << cache_file.filename << "'";
+      continue;
+    }
+    total_size -= cache_file.size;
+  }
+}
+
+bool IncrementalCompilation::Decode(ArrayRef<const uint8_t> data, std::string* error_msg) {
+  Reader reader(data);
+  ArrayRef<const uint8_t> magic;
+  ArrayRef<const uint8_t> version;
+  if (!reader.ReadRaw(sizeof(kMagic), &magic) ||
+      !std::equal(magic.begin(), magic.end(), kMagic) ||
+      !reader.ReadRaw(sizeof(kVersion), &version)) {
+    *error_msg = "Invalid incremental compilation state header";
+    return false;
+  }
+  ArrayRef<const uint8_t> fingerprint;
+  if (!std::equal(version.begin(), version.end(), kVersion) ||
+      !reader.ReadBytes(&fingerprint) ||
+      fingerprint != ArrayRef<const uint8_t>(
+          reinterpret_cast<const uint8_t*>(fingerprint_.data()), fingerprint_.size())) {
+    // Saved by a different version of dex2oat or with different options. Nothing to reuse.
+    return true;
+  }
+  // Map the dex file table to the known dex files with the same contents, if any.
+  uint32_t dex_file_table_size;
+  if (!reader.ReadUint32(&dex_file_table_size)) {
+    *error_msg = "Truncated incremental compilation state";
+    return false;
+  }
+  std::vector<const DexFile*> dex_file_table;
+  for (uint32_t i = 0; i != dex_file_table_size; ++i) {
+    std::string key;
+    if (!reader.ReadString(&key)) {
+      *error_msg = "Truncated incremental compilation state";
+      return false;
+    }
+    auto it = dex_files_by_key_.find(key);
+    dex_file_table.push_back(it != dex_files_by_key_.end() ? it->second : nullptr);
+  }
+  uint32_t number_of_entries;
+  if (!reader.ReadUint32(&number_of_entries)) {
+    *error_msg = "Truncated incremental compilation state";
+    return false;
+  }
+  std::map<std::pair<uint32_t, uint32_t>, Entry> entries;
+  for (uint32_t i = 0; i != number_of_entries; ++i) {
+    const DexFile* dex_file;
+    uint32_t method_index;
+    bool missing_dex_file = false;
+    Entry entry;
+    if (!DecodeEntry(
+            &reader, dex_file_table, &dex_file, &method_index, &missing_dex_file, &entry)) {
+      *error_msg = StringPrintf("Invalid incremental compilation state entry %u", i);
+      return false;
+    }
+    if (!missing_dex_file) {
+      entries.emplace(std::make_pair(dex_file_indexes_.Get(dex_file), method_index),
+                      std::move(entry));
+    }
+  }
+  if (!reader.IsAtEnd()) {
+    *error_msg = "Trailing data in incremental compilation state";
+    return false;
+  }
+  // Methods decoded earlier, for example from the state of another dex file, take precedence.
+  entries_.merge(entries);
+  number_of_loaded_methods_ = entries_.size();
+  return true;
+}
+
+bool IncrementalCompilation::DecodeEntry(Reader* reader,
+                                         const std::vector<const DexFile*>& dex_file_table,
+                                         /*out*/ const DexFile** dex_file,
+                                         /*out*/ uint32_t* method_index,
+                                         /*out*/ bool* missing_dex_file,
+                                         Entry* entry) const {
+  uint32_t dex_index;
+  uint32_t instruction_set;
+  uint32_t is_intrinsic;
+  uint32_t number_of_patches;
+  if (!reader->ReadUint32(&dex_index) ||
+      dex_index == kNoDexFile ||
+      dex_index > dex_file_table.size() ||
+      !reader->ReadUint32(method_index)) {
+    return false;
+  }
+  *dex_file = dex_file_table[dex_index - 1u];
+  if (*dex_file == nullptr) {
+    // The method's own dex file changed. Decode the rest of the entry to skip it.
+    *missing_dex_file = true;
+  } else if (*method_index >= (*dex_file)->NumMethodIds()) {
+    return false;
+  }
+  if (!reader->ReadBytes(&entry->profile_key) ||
+      !reader->ReadUint32(&instruction_set) ||
+      instruction_set > static_cast<uint32_t>(InstructionSet::kLast) ||
+      !reader->ReadBytes(&entry->code) ||
+      !reader->ReadBytes(&entry->vmap_table) ||
+      !reader->ReadBytes(&entry->cfi_info) ||
+      !reader->ReadUint32(&is_intrinsic) ||
+      !reader->ReadUint32(&number_of_patches)) {
+    return false;
+  }
+  entry->instruction_set = static_cast<InstructionSet>(instruction_set);
+  entry->is_intrinsic = (is_intrinsic != 0u);
+  for (uint32_t i = 0; i != number_of_patches; ++i) {
+    if (!DecodePatch(reader, dex_file_table, missing_dex_file, &entry->patches)) {
+      return false;
+    }
+  }
+  uint32_t number_of_thunks;
+  if (!reader->ReadUint32(&number_of_thunks)) {
+    return false;
+  }
+  for (uint32_t i = 0; i != number_of_thunks; ++i) {
+    std::vector<linker::LinkerPatch> thunk_patch;
+    std::vector<uint8_t> code;
+    std::string debug_name;
+    if (!DecodePatch(reader, dex_file_table, missing_dex_file, &thunk_patch) ||
+        !reader->ReadBytes(&code) ||
+        code.empty() ||
+        !reader->ReadString(&debug_name)) {
+      return false;
+    }
+    if (!thunk_patch.empty()) {
+      if (!HasThunk(thunk_patch[0])) {
+        return false;
+      }
+      entry->thunks.push_back(Thunk{thunk_patch[0], std::move(code), std::move(debug_name)});
+    }
+  }
+  return true;
+}
+
+void IncrementalCompilation::EncodePatch(const linker::LinkerPatch& patch,
+                                         const std::vector<uint32_t>& dex_file_table_indexes,
+                                         std::vector<uint8_t>* out) const {
+  using Type = linker::LinkerPatch::Type;
+  uint32_t data1 = 0u;
+  uint32_t data2 = 0u;
+  switch (patch.GetType()) {
+    case Type::kIntrinsicReference:
+      data1 = patch.PcInsnOffset();
+      data2 = patch.IntrinsicData();
+      break;
+    case Type::kDataBimgRelRo:
+      data1 = patch.PcInsnOffset();
+      data2 = patch.BootImageOffset();
+      break;
+    case Type::kMethodRelative:
+    case Type::kMethodBssEntry:
+    case Type::kJniEntrypointRelative:
+      data1 = patch.PcInsnOffset();
+      data2 = patch.TargetMethod().index;
+      break;
+    case Type::kCallRelative:
+      data2 = patch.TargetMethod().index;
+      break;
+    case Type::kTypeRelative:
+    case Type::kTypeBssEntry:
+    case Type::kPublicTypeBssEntry:
+    case Type::kPackageTypeBssEntry:
+      data1 = patch.PcInsnOffset();
+      data2 = patch.TargetTypeIndex().index_;
+      break;
+    case Type::kStringRelative:
+    case Type::kStringBssEntry:
+      data1 = patch.PcInsnOffset();
+      data2 = patch.TargetStringIndex().index_;
+      break;
+    case Type::kMethodTypeBssEntry:
+      data1 = patch.PcInsnOffset();
+      data2 = patch.TargetProtoIndex().index_;
+      break;
+    case Type::kCallEntrypoint:
+      data1 = patch.EntrypointOffset();
+      break;
+    case Type::kBakerReadBarrierBranch:
+      data1 = patch.GetBakerCustomValue1();
+      data2 = patch.GetBakerCustomValue2();
+      break;
+  }
+  const DexFile* target_dex_file = GetTargetDexFile(patch);
+  uint32_t dex_index = (target_dex_file != nullptr)
+      ? dex_file_table_indexes[dex_file_indexes_.Get(target_dex_file)]
+      : kNoDexFile;
+  EncodeUnsignedLeb128(out, static_cast<uint32_t>(patch.GetType()));
+  EncodeUnsignedLeb128(out, dchecked_integral_cast<uint32_t>(patch.LiteralOffset()));
+  EncodeUnsignedLeb128(out, dex_index);
+  EncodeUnsignedLeb128(out, data1);
+  EncodeUnsignedLeb128(out, data2);
+}
+
+bool IncrementalCompilation::DecodePatch(Reader* reader,
+                                         const std::vector<const DexFile*>& dex_file_table,
+                                         /*inout*/ bool* missing_dex_file,
+                                         std::vector<linker::LinkerPatch>* patches) {
+  using Type = linker::LinkerPatch::Type;
+  using LinkerPatch = linker::LinkerPatch;
+  uint32_t type;
+  uint32_t literal_offset;
+  uint32_t dex_index;
+  uint32_t data1;
+  uint32_t data2;
+  if (!reader->ReadUint32(&type) ||
+      type > static_cast<uint32_t>(Type::kBakerReadBarrierBranch) ||
+      !reader->ReadUint32(&literal_offset) ||
+      !IsUint<24>(literal_offset) ||
+      !reader->ReadUint32(&dex_index) ||
+      dex_index > dex_file_table.size() ||
+      !reader->ReadUint32(&data1) ||
+      !reader->ReadUint32(&data2)) {
+    return false;
+  }
+  switch (static_cast<Type>(type)) {
+    case Type::kIntrinsicReference:
+      patches->push_back(LinkerPatch::IntrinsicReferencePatch(literal_offset, data1, data2));
+      return true;
+    case Type::kDataBimgRelRo:
+      patches->push_back(LinkerPatch::DataBimgRelRoPatch(literal_offset, data1, data2));
+      return true;
+    case Type::kCallEntrypoint:
+      patches->push_back(LinkerPatch::CallEntrypointPatch(literal_offset, data1));
+      return true;
+    case Type::kBakerReadBarrierBranch:
+      patches->push_back(LinkerPatch::BakerReadBarrierBranchPatch(literal_offset, data1, data2));
+      return true;
+    default:
+      break;
+  }
+  // The remaining patches reference dex files.
+  if (dex_index == kNoDexFile) {
+    return false;
+  }
+  const DexFile* dex_file = dex_file_table[dex_index - 1u];
+  if (dex_file == nullptr) {
+    // The referenced dex file changed, so the saved method cannot be reused.
+    *missing_dex_file = true;
+    return true;
+  }
+  switch (static_cast<Type>(type)) {
+    case Type::kMethodRelative:
+      patches->push_back(LinkerPatch::RelativeMethodPatch(literal_offset, dex_file, data1, data2));
+      break;
+    case Type::kMethodBssEntry:
+      patches->push_back(LinkerPatch::MethodBssEntryPatch(literal_offset, dex_file, data1, data2));
+      break;
+    case Type::kJniEntrypointRelative:
+      patches->push_back(
+          LinkerPatch::RelativeJniEntrypointPatch(literal_offset, dex_file, data1, data2));
+      break;
+    case Type::kCallRelative:
+      patches->push_back(LinkerPatch::RelativeCodePatch(literal_offset, dex_file, data2));
+      break;
+    case Type::kTypeRelative:
+      patches->push_back(LinkerPatch::RelativeTypePatch(literal_offset, dex_file, data1, data2));
+      break;
+    case Type::kTypeBssEntry:
+      patches->push_back(LinkerPatch::TypeBssEntryPatch(literal_offset, dex_file, data1, data2));
+      break;
+    case Type::kPublicTypeBssEntry:
+      patches->push_back(
+          LinkerPatch::PublicTypeBssEntryPatch(literal_offset, dex_file, data1, data2));
+      break;
+    case Type::kPackageTypeBssEntry:
+      patches->push_back(
+          LinkerPatch::PackageTypeBssEntryPatch(literal_offset, dex_file, data1, data2));
+      break;
+    case Type::kStringRelative:
+      patches->push_back(LinkerPatch::RelativeStringPatch(literal_offset, dex_file, data1, data2));
+      break;
+    case Type::kStringBssEntry:
+      patches->push_back(LinkerPatch::StringBssEntryPatch(literal_offset, dex_file, data1, data2));
+      break;
+    case Type::kMethodTypeBssEntry:
+      patches->push_back(
+          LinkerPatch::MethodTypeBssEntryPatch(literal_offset, dex_file, data1, data2));
+      break;
+    default:
+      LOG(FATAL) << "Unexpected patch type: " << static_cast<Type>(type);
+      UNREACHABLE();
+  }
+  return true;
+}
+
+CompiledMethod* IncrementalCompilation::Reuse(CompiledMethodStorage* storage,
+                                              MethodReference method_ref,
+                                              const std::vector<uint8_t>& profile_key) {
+  auto dex_it = dex_file_indexes_.find(method_ref.dex_file);
+  if (dex_it == dex_file_indexes_.end()) {
+    return nullptr;
+  }
+  auto it = entries_.find(std::make_pair(dex_it->second, method_ref.index));
+  if (it == entries_.end() || it->second.profile_key != profile_key) {
+    number_of_missed_methods_.fetch_add(1u, std::memory_order_relaxed);
+    return nullptr;
+  }
+  const Entry& entry = it->second;
+  for (const Thunk& thunk : entry.thunks) {
+    if (storage->GetThunkCode(thunk.patch).empty()) {
+      storage->SetThunkCode(thunk.patch, ArrayRef<const uint8_t>(thunk.code), thunk.debug_name);
+    }
+  }
+  number_of_reused_methods_.fetch_add(1u, std::memory_order_relaxed);
+  return storage->CreateCompiledMethod(entry.instruction_set,
+                                       ArrayRef<const uint8_t>(entry.code),
+                                       ArrayRef<const uint8_t>(entry.vmap_table),
+                                       ArrayRef<const uint8_t>(entry.cfi_info),
+                                       ArrayRef<const linker::LinkerPatch>(entry.patches),
+                                       entry.is_intrinsic);
+}
+
+void IncrementalCompilation::Add(CompiledMethodStorage* storage,
+                                 MethodReference method_ref,
+                                 const CompiledMethod* compiled_method,
+                                 const std::vector<uint8_t>& profile_key) {
+  auto dex_it = dex_file_indexes_.find(method_ref.dex_file);
+  if (dex_it == dex_file_indexes_.end()) {
+    return;
+  }
+  Entry entry;
+  ArrayRef<const linker::LinkerPatch> patches = compiled_method->GetPatches();
+  for (const linker::LinkerPatch& patch : patches) {
+    const DexFile* target_dex_file = GetTargetDexFile(patch);
+    if (target_dex_file != nullptr &&
+        dex_file_indexes_.find(target_dex_file) == dex_file_indexes_.end()) {
+      return;
+    }
+    // Thunks are generated by the code generator while compiling the method, so they must
+    // be saved with it to be available when the method is reused.
+    std::string debug_name;
+    ArrayRef<const uint8_t> thunk_code =
+        HasThunk(patch) ? storage->GetThunkCode(patch, &debug_name) : ArrayRef<const uint8_t>();
+    if (!thunk_code.empty()) {
+      entry.thunks.push_back(
+          Thunk{patch, std::vector<uint8_t>(thunk_code.begin(), thunk_code.end()), debug_name});
+    }
+  }
+  entry.profile_key = profile_key;
+  entry.instruction_set = compiled_method->GetInstructionSet();
+  ArrayRef<const uint8_t> code = compiled_method->GetQuickCode();
+  entry.code.assign(code.begin(), code.end());
+  ArrayRef<const uint8_t> vmap_table = compiled_method->GetVmapTable();
+  entry.vmap_table.assign(vmap_table.begin(), vmap_table.end());
+  ArrayRef<const uint8_t> cfi_info = compiled_method->GetCFIInfo();
+  entry.cfi_info.assign(cfi_info.begin(), cfi_info.end());
+  entry.is_intrinsic = compiled_method->IsIntrinsic();
+  entry.patches.assign(patches.begin(), patches.end());
+  // Replace the loaded method, if any. Loaded methods that are not compiled again, for
+  // example because they are not in the profile of this invocation, are kept so that the
+  // saved state covers the union of invocations.
+  entries_.insert_or_assign(std::make_pair(dex_it->second, method_ref.index), std::move(entry));
+  ++number_of_added_methods_;
+}
+
+std::vector<uint8_t> IncrementalCompilation::GetProfileKey(
+    const ProfileCompilationInfo* profile_compilation_info, MethodReference method_ref) {
+  std::vector<uint8_t> key;
+  if (profile_compilation_info == nullptr) {
+    return key;
+  }
+  ProfileCompilationInfo::MethodHotness hotness =
+      profile_compilation_info->GetMethodHotness(method_ref);
+  EncodeUnsignedLeb128(&key, hotness.GetFlags());
+  const ProfileCompilationInfo::InlineCacheMap* inline_caches = hotness.GetInlineCacheMap();
+  if (inline_caches == nullptr) {
+    return key;
+  }
+  // Classes are recorded by descriptor, in descriptor order, as their type indexes in the
+  // profile can refer to extra descriptors that are numbered differently in another profile.
+  EncodeUnsignedLeb128(&key, dchecked_integral_cast<uint32_t>(inline_caches->size()));
+  std::vector<std::string_view> descriptors;
+  for (const auto& [dex_pc, dex_pc_data] : *inline_caches) {
+    EncodeUnsignedLeb128(&key, dex_pc);
+    EncodeUnsignedLeb128(&key, (dex_pc_data.is_missing_types ? 1u : 0u) |
+                               (dex_pc_data.is_megamorphic ? 2u : 0u));
+    EncodeUnsignedLeb128(&key, dchecked_integral_cast<uint32_t>(dex_pc_data.classes.size()));
+    descriptors.clear();
+    for (dex::TypeIndex type_index : dex_pc_data.classes) {
+      descriptors.push_back(
+          profile_compilation_info->GetTypeDescriptor(method_ref.dex_file, type_index));
+    }
+    std::sort(descriptors.begin(), descriptors.end());
+    for (std::string_view descriptor : descriptors) {
+      EncodeString(&key, descriptor);
+    }
+  }
+  return key;
+}
+
+}  // namespace art
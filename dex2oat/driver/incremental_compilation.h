@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_DEX2OAT_DRIVER_INCREMENTAL_COMPILATION_H_
+#define ART_DEX2OAT_DRIVER_INCREMENTAL_COMPILATION_H_
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arch/instruction_set.h"
+#include "base/array_ref.h"
+#include "base/macros.h"
+#include "base/safe_map.h"
+#include "dex/method_reference.h"
+#include "linker/linker_patch.h"
+
+namespace art {
+
+class CompiledMethod;
+class CompiledMethodStorage;
+class DexFile;
+class ProfileCompilationInfo;
+
+// Compiled code saved by a previous dex2oat invocation, to be reused instead of compiling
+// the same methods again. The state is either kept in a file given by the caller or in a
+// cache directory shared by invocations, with a file for each dex file named after the
+// fingerprint hash and the dex file key.
+//
+// The state records a fingerprint of the compiler options and of the environment that
+// the code is compiled against, i.e. the boot image and the class path, and is ignored
+// if the fingerprint differs. Each saved method is then keyed by the identity of its own
+// dex file, i.e. its checksum and SHA-1, and by its profile data, i.e. its hotness flags
+// and inline caches. Dex files referenced by linker patches are recorded by identity too,
+// so a method is compiled again when its dex file, a dex file it references or its own
+// profile data changes, while methods of other, unchanged dex files are still reused.
+class IncrementalCompilation {
+ public:
+  // The `dex_files` are used to encode the target dex files of linker patches. They must
+  // include every dex file that a linker patch can reference, i.e. the dex files being
+  // compiled, the boot class path and the class path.
+  IncrementalCompilation(std::string fingerprint, std::vector<const DexFile*> dex_files);
+
+  // Load the saved state from a file. A missing file or a state saved for a different
+  // fingerprint is not an error but leaves no methods to reuse.
+  bool Load(const std::string& filename, std::string* error_msg);
+
+  // Write the methods recorded with `Add()` and the loaded methods that were not replaced
+  // by `Add()` to a file, replacing any previous state. If `dex_file` is not null, only
+  // the methods of that dex file are written.
+  bool Store(const std::string& filename, const DexFile* dex_file, std::string* error_msg) const;
+
+  // Decode saved state produced by `Encode()`. Saved methods of dex files that are not
+  // known to this object or that reference such dex files are dropped.
+  bool Decode(ArrayRef<const uint8_t> data, std::string* error_msg);
+
+  // Encode the methods to be saved, see `Store()`.
+  std::vector<uint8_t> Encode(const DexFile* dex_file = nullptr) const;
+
+  // Return a hash of the fingerprint, used to name the state files in a cache directory.
+  std::string GetFingerprintHash() const;
+
+  // Return the key identifying the contents of `dex_file` across invocations.
+  static std::string GetDexFileKey(const DexFile* dex_file);
+
+  // Delete the least recently used state files in a cache directory until their total size
+  // is at most `max_size`. State files are written again whenever they are used, so their
+  // modification time tells when they were last used.
+  static void TrimCacheDirectory(const std::string& dir, uint64_t max_size);
+
+  // Return a copy of the saved compiled method for `method_ref` if its profile data matches
+  // `profile_key`, null otherwise. Thread-safe once the state has been loaded.
+  CompiledMethod* Reuse(CompiledMethodStorage* storage,
+                        MethodReference method_ref,
+                        const std::vector<uint8_t>& profile_key);
+
+  // Record a compiled method to be saved. Methods with linker patches referencing dex files
+  // that are not known to this object are not recorded. Not thread-safe.
+  void Add(CompiledMethodStorage* storage,
+           MethodReference method_ref,
+           const CompiledMethod* compiled_method,
+           const std::vector<uint8_t>& profile_key);
+
+  // Return the profile data that influences the compilation of `method_ref`, encoded so
+  // that it can be compared with the data recorded in a previous invocation.
+  static std::vector<uint8_t> GetProfileKey(const ProfileCompilationInfo* profile_compilation_info,
+                                            MethodReference method_ref);
+
+  size_t GetNumberOfLoadedMethods() const {
+    return number_of_loaded_methods_;
+  }
+
+  size_t GetNumberOfReusedMethods() const {
+    return number_of_reused_methods_.load(std::memory_order_relaxed);
+  }
+
+  size_t GetNumberOfMissedMethods() const {
+    return number_of_missed_methods_.load(std::memory_order_relaxed);
+  }
+
+  size_t GetNumberOfAddedMethods() const {
+    return number_of_added_methods_;
+  }
+
+ private:
+  struct Thunk {
+    linker::LinkerPatch patch;
+    std::vector<uint8_t> code;
+    std::string debug_name;
+  };
+
+  struct Entry {
+    std::vector<uint8_t> profile_key;
+    InstructionSet instruction_set;
+    std::vector<uint8_t> code;
+    std::vector<uint8_t> vmap_table;
+    std::vector<uint8_t> cfi_info;
+    bool is_intrinsic;
+    std::vector<linker::LinkerPatch> patches;
+    std::vector<Thunk> thunks;
+  };
+
+  class Reader;
+
+  // Encode a linker patch, with target dex files given as indexes into the table of dex
+  // files of the encoded state. `dex_file_table_indexes` is indexed like `dex_files_`.
+  void EncodePatch(const linker::LinkerPatch& patch,
+                   const std::vector<uint32_t>& dex_file_table_indexes,
+                   std::vector<uint8_t>* out) const;
+  static bool DecodePatch(Reader* reader,
+                          const std::vector<const DexFile*>& dex_file_table,
+                          /*inout*/ bool* missing_dex_file,
+                          std::vector<linker::LinkerPatch>* patches);
+  bool DecodeEntry(Reader* reader,
+                   const std::vector<const DexFile*>& dex_file_table,
+                   /*out*/ const DexFile** dex_file,
+                   /*out*/ uint32_t* method_index,
+                   /*out*/ bool* missing_dex_file,
+                   Entry* entry) const;
+
+  const std::string fingerprint_;
+  const std::vector<const DexFile*> dex_files_;
+  SafeMap<const DexFile*, uint32_t> dex_file_indexes_;
+  SafeMap<std::string, const DexFile*> dex_files_by_key_;
+
+  // The loaded methods and the methods recorded with `Add()`, keyed by the index of their
+  // dex file in `dex_files_` and method index.
+  std::map<std::pair<uint32_t, uint32_t>, Entry> entries_;
+  size_t number_of_loaded_methods_;
+  std::atomic<size_t> number_of_reused_methods_;
+  std::atomic<size_t> number_of_missed_methods_;
+  size_t number_of_added_methods_;
+
+  DISALLOW_COPY_AND_ASSIGN(IncrementalCompilation);
+};
+
+}  // namespace art
+
+#endif  // ART_DEX2OAT_DRIVER_INCREMENTAL_COMPILATION_H_
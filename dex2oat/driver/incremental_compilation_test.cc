@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "incremental_compilation.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <android-base/file.h>
+#include <gtest/gtest.h>
+
+#include "base/common_art_test.h"
+#include "base/os.h"
+#include "compiled_method-inl.h"
+#include "compiled_method_storage.h"
+#include "dex/dex_file.h"
+#include "profile/profile_compilation_info.h"
+
+namespace art {
+
+class IncrementalCompilationTest : public CommonArtTest {};
+
+TEST_F(IncrementalCompilationTest, ReuseSavedMethod) {
+  std::unique_ptr<const DexFile> dex_file = OpenTestDexFile("Main");
+  ASSERT_TRUE(dex_file != nullptr);
+  ASSERT_GE(dex_file->NumMethodIds(), 2u);
+  const std::vector<const DexFile*> dex_files = { dex_file.get() };
+  MethodReference method_ref(dex_file.get(), 1u);
+  const std::vector<uint8_t> profile_key = { 1u, 2u };
+
+  CompiledMethodStorage storage(/* swap_fd= */ -1);
+  const uint8_t raw_code[] = { 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u, 9u, 10u, 11u, 12u, 13u, 14u, 15u };
+  const uint8_t raw_vmap_table[] = { 2u, 4u, 6u };
+  const uint8_t raw_cfi_info[] = { 1u, 3u, 5u };
+  const uint8_t raw_thunk_code[] = { 8u, 6u, 4u, 2u };
+  const linker::LinkerPatch raw_patches[] = {
+      linker::LinkerPatch::IntrinsicReferencePatch(0u, 0u, 7u),
+      linker::LinkerPatch::RelativeMethodPatch(4u, dex_file.get(), 0u, 1u),
+      linker::LinkerPatch::MethodTypeBssEntryPatch(8u, dex_file.get(), 4u, 0u),
+      linker::LinkerPatch::CallEntrypointPatch(12u, 0x100u),
+  };
+  ArrayRef<const linker::LinkerPatch> patches(raw_patches);
+  storage.SetThunkCode(raw_patches[3], ArrayRef<const uint8_t>(raw_thunk_code), "thunk");
+  CompiledMethod* compiled_method =
+      storage.CreateCompiledMethod(InstructionSet::kArm64,
+                                   ArrayRef<const uint8_t>(raw_code),
+                                   ArrayRef<const uint8_t>(raw_vmap_table),
+                                   ArrayRef<const uint8_t>(raw_cfi_info),
+                                   patches,
+                                   /* is_intrinsic= */ false);
+
+  IncrementalCompilation saved("fingerprint", dex_files);
+  saved.Add(&storage, method_ref, compiled_method, profile_key);
+  EXPECT_EQ(1u, saved.GetNumberOfAddedMethods());
+  std::vector<uint8_t> data = saved.Encode();
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, compiled_method);
+
+  // A different fingerprint leaves nothing to reuse.
+  std::string error_msg;
+  IncrementalCompilation other("other fingerprint", dex_files);
+  ASSERT_TRUE(other.Decode(ArrayRef<const uint8_t>(data), &error_msg)) << error_msg;
+  EXPECT_EQ(0u, other.GetNumberOfLoadedMethods());
+
+  // Truncated data is rejected.
+  IncrementalCompilation truncated("fingerprint", dex_files);
+  EXPECT_FALSE(truncated.Decode(ArrayRef<const uint8_t>(data).SubArray(0u, data.size() - 1u),
+                                &error_msg));
+
+  CompiledMethodStorage new_storage(/* swap_fd= */ -1);
+  IncrementalCompilation loaded("fingerprint", dex_files);
+  ASSERT_TRUE(loaded.Decode(ArrayRef<const uint8_t>(data), &error_msg)) << error_msg;
+  EXPECT_EQ(1u, loaded.GetNumberOfLoadedMethods());
+
+  // Changed profile data or a different method means compiling again.
+  EXPECT_TRUE(loaded.Reuse(&new_storage, method_ref, /* profile_key= */ {}) == nullptr);
+  EXPECT_TRUE(loaded.Reuse(&new_storage, MethodReference(dex_file.get(), 0u), profile_key) ==
+              nullptr);
+  EXPECT_EQ(0u, loaded.GetNumberOfReusedMethods());
+  EXPECT_EQ(2u, loaded.GetNumberOfMissedMethods());
+
+  CompiledMethod* reused = loaded.Reuse(&new_storage, method_ref, profile_key);
+  ASSERT_TRUE(reused != nullptr);
+  EXPECT_EQ(1u, loaded.GetNumberOfReusedMethods());
+  EXPECT_EQ(InstructionSet::kArm64, reused->GetInstructionSet());
+  EXPECT_EQ(ArrayRef<const uint8_t>(raw_code), reused->GetQuickCode());
+  EXPECT_EQ(ArrayRef<const uint8_t>(raw_vmap_table), reused->GetVmapTable());
+  EXPECT_EQ(ArrayRef<const uint8_t>(raw_cfi_info), reused->GetCFIInfo());
+  EXPECT_FALSE(reused->IsIntrinsic());
+  EXPECT_TRUE(patches == reused->GetPatches());
+  std::string debug_name;
+  EXPECT_EQ(ArrayRef<const uint8_t>(raw_thunk_code),
+            new_storage.GetThunkCode(raw_patches[3], &debug_name));
+  EXPECT_EQ("thunk", debug_name);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&new_storage, reused);
+}
+
+TEST_F(IncrementalCompilationTest, KeepMethodsNotCompiledAgain) {
+  std::unique_ptr<const DexFile> dex_file = OpenTestDexFile("Main");
+  ASSERT_TRUE(dex_file != nullptr);
+  ASSERT_GE(dex_file->NumMethodIds(), 2u);
+  const std::vector<const DexFile*> dex_files = { dex_file.get() };
+  MethodReference method_ref0(dex_file.get(), 0u);
+  MethodReference method_ref1(dex_file.get(), 1u);
+
+  CompiledMethodStorage storage(/* swap_fd= */ -1);
+  const uint8_t raw_code1[] = { 1u, 2u, 3u };
+  const uint8_t raw_code2[] = { 4u, 3u, 2u, 1u };
+  CompiledMethod* compiled_method1 =
+      storage.CreateCompiledMethod(InstructionSet::kArm64,
+                                   ArrayRef<const uint8_t>(raw_code1),
+                                   ArrayRef<const uint8_t>(),
+                                   ArrayRef<const uint8_t>(),
+                                   ArrayRef<const linker::LinkerPatch>(),
+                                   /* is_intrinsic= */ false);
+  CompiledMethod* compiled_method2 =
+      storage.CreateCompiledMethod(InstructionSet::kArm64,
+                                   ArrayRef<const uint8_t>(raw_code2),
+                                   ArrayRef<const uint8_t>(),
+                                   ArrayRef<const uint8_t>(),
+                                   ArrayRef<const linker::LinkerPatch>(),
+                                   /* is_intrinsic= */ false);
+
+  // The first invocation compiles both methods.
+  IncrementalCompilation first("fingerprint", dex_files);
+  first.Add(&storage, method_ref0, compiled_method1, /* profile_key= */ {});
+  first.Add(&storage, method_ref1, compiled_method1, /* profile_key= */ {});
+  std::vector<uint8_t> first_data = first.Encode();
+
+  // The second invocation compiles only the second method, with different code.
+  std::string error_msg;
+  IncrementalCompilation second("fingerprint", dex_files);
+  ASSERT_TRUE(second.Decode(ArrayRef<const uint8_t>(first_data), &error_msg)) << error_msg;
+  second.Add(&storage, method_ref1, compiled_method2, /* profile_key= */ {});
+  std::vector<uint8_t> second_data = second.Encode();
+
+  IncrementalCompilation third("fingerprint", dex_files);
+  ASSERT_TRUE(third.Decode(ArrayRef<const uint8_t>(second_data), &error_msg)) << error_msg;
+  EXPECT_EQ(2u, third.GetNumberOfLoadedMethods());
+  CompiledMethod* reused0 = third.Reuse(&storage, method_ref0, /* profile_key= */ {});
+  ASSERT_TRUE(reused0 != nullptr);
+  EXPECT_EQ(ArrayRef<const uint8_t>(raw_code1), reused0->GetQuickCode());
+  CompiledMethod* reused1 = third.Reuse(&storage, method_ref1, /* profile_key= */ {});
+  ASSERT_TRUE(reused1 != nullptr);
+  EXPECT_EQ(ArrayRef<const uint8_t>(raw_code2), reused1->GetQuickCode());
+
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, reused1);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, reused0);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, compiled_method2);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, compiled_method1);
+}
+
+TEST_F(IncrementalCompilationTest, KeyMethodsByTheirDexFiles) {
+  std::unique_ptr<const DexFile> dex_file = OpenTestDexFile("Main");
+  std::unique_ptr<const DexFile> other_dex_file = OpenTestDexFile("Nested");
+  ASSERT_TRUE(dex_file != nullptr);
+  ASSERT_TRUE(other_dex_file != nullptr);
+  ASSERT_GE(dex_file->NumMethodIds(), 2u);
+  ASSERT_GE(other_dex_file->NumMethodIds(), 1u);
+  MethodReference method_ref0(dex_file.get(), 0u);
+  MethodReference method_ref1(dex_file.get(), 1u);
+  MethodReference other_method_ref(other_dex_file.get(), 0u);
+
+  CompiledMethodStorage storage(/* swap_fd= */ -1);
+  const uint8_t raw_code[] = { 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u };
+  const linker::LinkerPatch raw_patches[] = {
+      linker::LinkerPatch::RelativeMethodPatch(4u, other_dex_file.get(), 0u, 0u),
+  };
+  CompiledMethod* compiled_method =
+      storage.CreateCompiledMethod(InstructionSet::kArm64,
+                                   ArrayRef<const uint8_t>(raw_code),
+                                   ArrayRef<const uint8_t>(),
+                                   ArrayRef<const uint8_t>(),
+                                   ArrayRef<const linker::LinkerPatch>(),
+                                   /* is_intrinsic= */ false);
+  CompiledMethod* compiled_method_with_patch =
+      storage.CreateCompiledMethod(InstructionSet::kArm64,
+                                   ArrayRef<const uint8_t>(raw_code),
+                                   ArrayRef<const uint8_t>(),
+                                   ArrayRef<const uint8_t>(),
+                                   ArrayRef<const linker::LinkerPatch>(raw_patches),
+                                   /* is_intrinsic= */ false);
+
+  // The first method has no patches, the second references the other dex file.
+  IncrementalCompilation saved("fingerprint", { dex_file.get(), other_dex_file.get() });
+  saved.Add(&storage, method_ref0, compiled_method, /* profile_key= */ {});
+  saved.Add(&storage, method_ref1, compiled_method_with_patch, /* profile_key= */ {});
+  saved.Add(&storage, other_method_ref, compiled_method, /* profile_key= */ {});
+  std::vector<uint8_t> data = saved.Encode();
+
+  // Dex files are matched by contents, not by their order.
+  std::string error_msg;
+  IncrementalCompilation reordered("fingerprint", { other_dex_file.get(), dex_file.get() });
+  ASSERT_TRUE(reordered.Decode(ArrayRef<const uint8_t>(data), &error_msg)) << error_msg;
+  EXPECT_EQ(3u, reordered.GetNumberOfLoadedMethods());
+  CompiledMethod* reused = reordered.Reuse(&storage, method_ref1, /* profile_key= */ {});
+  ASSERT_TRUE(reused != nullptr);
+  EXPECT_TRUE(ArrayRef<const linker::LinkerPatch>(raw_patches) == reused->GetPatches());
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, reused);
+
+  // Without the other dex file, only the method that does not depend on it is reused.
+  IncrementalCompilation changed("fingerprint", { dex_file.get() });
+  ASSERT_TRUE(changed.Decode(ArrayRef<const uint8_t>(data), &error_msg)) << error_msg;
+  EXPECT_EQ(1u, changed.GetNumberOfLoadedMethods());
+  EXPECT_TRUE(changed.Reuse(&storage, method_ref1, /* profile_key= */ {}) == nullptr);
+  reused = changed.Reuse(&storage, method_ref0, /* profile_key= */ {});
+  ASSERT_TRUE(reused != nullptr);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, reused);
+
+  // The state can be split by dex file.
+  IncrementalCompilation other_dex_file_only("fingerprint",
+                                             { dex_file.get(), other_dex_file.get() });
+  ASSERT_TRUE(other_dex_file_only.Decode(
+      ArrayRef<const uint8_t>(saved.Encode(other_dex_file.get())), &error_msg)) << error_msg;
+  EXPECT_EQ(1u, other_dex_file_only.GetNumberOfLoadedMethods());
+  reused = other_dex_file_only.Reuse(&storage, other_method_ref, /* profile_key= */ {});
+  ASSERT_TRUE(reused != nullptr);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, reused);
+
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, compiled_method_with_patch);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, compiled_method);
+}
+
+TEST_F(IncrementalCompilationTest, ProfileKeyOrdersInlineCacheClassesByDescriptor) {
+  std::unique_ptr<const DexFile> dex_file = OpenTestDexFile("Main");
+  std::unique_ptr<const DexFile> other_dex_file = OpenTestDexFile("Nested");
+  ASSERT_TRUE(dex_file != nullptr);
+  ASSERT_TRUE(other_dex_file != nullptr);
+  ASSERT_GE(dex_file->NumMethodIds(), 2u);
+  const dex::TypeId* type_id_nested = other_dex_file->FindTypeId("LNested;");
+  const dex::TypeId* type_id_inner = other_dex_file->FindTypeId("LNested$Inner;");
+  ASSERT_TRUE(type_id_nested != nullptr);
+  ASSERT_TRUE(type_id_inner != nullptr);
+  TypeReference nested_class(other_dex_file.get(),
+                             other_dex_file->GetIndexForTypeId(*type_id_nested));
+  TypeReference inner_class(other_dex_file.get(),
+                            other_dex_file->GetIndexForTypeId(*type_id_inner));
+  MethodReference method_ref0(dex_file.get(), 0u);
+  MethodReference method_ref1(dex_file.get(), 1u);
+  using Hotness = ProfileCompilationInfo::MethodHotness;
+  using InlineCache = ProfileMethodInfo::ProfileInlineCache;
+
+  // The classes are not in the method's dex file, so the profiles number them in the order
+  // in which they are first seen, which differs between the two profiles.
+  const InlineCache inline_cache(
+      /* pc= */ 0u, /* missing_types= */ false, { nested_class, inner_class });
+  ProfileCompilationInfo profile;
+  ASSERT_TRUE(profile.AddMethod(ProfileMethodInfo(method_ref0, { inline_cache }),
+                                Hotness::kFlagHot));
+  ProfileCompilationInfo other_profile;
+  ASSERT_TRUE(other_profile.AddMethod(
+      ProfileMethodInfo(method_ref1,
+                        { InlineCache(/* pc= */ 0u, /* missing_types= */ false, { inner_class }) }),
+      Hotness::kFlagHot));
+  ASSERT_TRUE(other_profile.AddMethod(ProfileMethodInfo(method_ref0, { inline_cache }),
+                                      Hotness::kFlagHot));
+
+  EXPECT_EQ(IncrementalCompilation::GetProfileKey(&profile, method_ref0),
+            IncrementalCompilation::GetProfileKey(&other_profile, method_ref0));
+  EXPECT_NE(IncrementalCompilation::GetProfileKey(&other_profile, method_ref0),
+            IncrementalCompilation::GetProfileKey(&other_profile, method_ref1));
+}
+
+TEST_F(IncrementalCompilationTest, TrimCacheDirectory) {
+  ScratchDir cache_dir;
+  const std::string data(100u, 'x');
+  const char* const kFilenames[] = { "a.cmc", "b.cmc", "c.cmc", "d.cmc.123.tmp" };
+  for (size_t i = 0; i != std::size(kFilenames); ++i) {
+    std::string filename = cache_dir.GetPath() + kFilenames[i];
+    ASSERT_TRUE(android::base::WriteStringToFile(data, filename));
+    // Make "a.cmc" the least recently used file.
+    struct timespec times[2] = { { static_cast<time_t>(1000 + i), 0 },
+                                 { static_cast<time_t>(1000 + i), 0 } };
+    ASSERT_EQ(0, utimensat(AT_FDCWD, filename.c_str(), times, /* flags= */ 0));
+  }
+  auto exists = [&](const char* filename) {
+    return OS::FileExists((cache_dir.GetPath() + filename).c_str());
+  };
+
+  // Temporary files are not counted nor deleted.
+  IncrementalCompilation::TrimCacheDirectory(cache_dir.GetPath(), /* max_size= */ 300u);
+  EXPECT_TRUE(exists("a.cmc"));
+  IncrementalCompilation::TrimCacheDirectory(cache_dir.GetPath(), /* max_size= */ 250u);
+  EXPECT_FALSE(exists("a.cmc"));
+  EXPECT_TRUE(exists("b.cmc"));
+  EXPECT_TRUE(exists("c.cmc"));
+  EXPECT_TRUE(exists("d.cmc.123.tmp"));
+  IncrementalCompilation::TrimCacheDirectory(cache_dir.GetPath(), /* max_size= */ 0u);
+  EXPECT_FALSE(exists("b.cmc"));
+  EXPECT_FALSE(exists("c.cmc"));
+  EXPECT_TRUE(exists("d.cmc.123.tmp"));
+}
+
+}  // namespace art
@@ -35,7 +35,9 @@ class ArmBaseRelativePatcher::ThunkData {
         debug_name_(debug_name),
         offsets_(),
         max_next_offset_(max_next_offset),
-        pending_offset_(0u) {
+        pending_offset_(0u),
+        shared_with_oat_file_start_(0u),
+        shared_recorded_for_oat_file_start_(0u) {
     DCHECK(NeedsNextThunk());  // The data is constructed only when we expect to need the thunk.
   }
 
@@ -146,12 +148,35 @@ class ArmBaseRelativePatcher::ThunkData {
     return offsets_[index];
   }
 
+  // Record that the oat file starting at `oat_file_start_offset` uses a thunk from a previous
+  // oat file.
+  void MarkSharedWithOatFile(uint32_t oat_file_start_offset) {
+    DCHECK_NE(oat_file_start_offset, 0u);
+    shared_with_oat_file_start_ = oat_file_start_offset;
+  }
+
+  bool IsSharedWithOatFile(uint32_t oat_file_start_offset) const {
+    return shared_with_oat_file_start_ == oat_file_start_offset;
+  }
+
+  // Record that the sharing with the oat file starting at `oat_file_start_offset` was counted
+  // in the statistics, so that it is not counted again at the next ReserveSpaceEnd().
+  bool MarkSharedRecorded(uint32_t oat_file_start_offset) {
+    if (shared_recorded_for_oat_file_start_ == oat_file_start_offset) {
+      return false;
+    }
+    shared_recorded_for_oat_file_start_ = oat_file_start_offset;
+    return true;
+  }
+
  private:
   const ArrayRef<const uint8_t> code_;  // The code of the thunk.
   const std::string debug_name_;        // The debug name of the thunk.
   std::vector<uint32_t> offsets_;       // Offsets at which the thunk needs to be written.
   uint32_t max_next_offset_;            // The maximum offset at which the next thunk can be placed.
   uint32_t pending_offset_;             // The index of the next offset to write.
+  uint32_t shared_with_oat_file_start_; // The last oat file that shares the thunk, see above.
+  uint32_t shared_recorded_for_oat_file_start_;  // The last oat file whose sharing was counted.
 };
 
 class ArmBaseRelativePatcher::PendingThunkComparator {
@@ -171,6 +196,11 @@ uint32_t ArmBaseRelativePatcher::ReserveSpace(uint32_t offset,
   return ReserveSpaceInternal(offset, compiled_method, method_ref, 0u);
 }
 
+void ArmBaseRelativePatcher::StartOatFile(uint32_t offset) {
+  DCHECK_GE(offset, oat_file_start_offset_);
+  oat_file_start_offset_ = offset;
+}
+
 uint32_t ArmBaseRelativePatcher::ReserveSpaceEnd(uint32_t offset) {
   // For multi-oat compilations (boot image), ReserveSpaceEnd() is called for each oat file.
   // Since we do not know here whether this is the last file or whether the next opportunity
@@ -184,6 +214,17 @@ uint32_t ArmBaseRelativePatcher::ReserveSpaceEnd(uint32_t offset) {
     offset = data->ReserveOffset(thunk_offset);
   }
   unreserved_thunks_.clear();
+  // Record thunks used by this oat file that did not need a copy in this oat file.
+  if (oat_file_start_offset_ != 0u) {
+    for (auto& entry : thunks_) {
+      ThunkData& data = entry.second;
+      if (data.IsSharedWithOatFile(oat_file_start_offset_) &&
+          data.LastReservedOffset() < oat_file_start_offset_ &&
+          data.MarkSharedRecorded(oat_file_start_offset_)) {
+        RecordSharedThunk(data.CodeSize());
+      }
+    }
+  }
   // We also need to delay initiating the pending_thunks_ until the call to WriteThunks().
   // Check that the `pending_thunks_.capacity()` indicates that no WriteThunks() has taken place.
   DCHECK_EQ(pending_thunks_.capacity(), 0u);
@@ -281,6 +322,7 @@ ArmBaseRelativePatcher::ArmBaseRelativePatcher(RelativePatcherThunkProvider* thu
       thunks_(),
       unprocessed_method_call_patches_(),
       method_call_thunk_(nullptr),
+      oat_file_start_offset_(0u),
       pending_thunks_() {
 }
 
@@ -448,6 +490,10 @@ void ArmBaseRelativePatcher::ProcessPatches(const CompiledMethod* compiled_metho
             patch_offset - old_data->LastReservedOffset() > MaxNegativeDisplacement(key)) {
           old_data->SetMaxNextOffset(CalculateMaxNextOffset(patch_offset, key));
           AddUnreservedThunk(old_data);
+        } else if (simple_thunk_patch && old_data->LastReservedOffset() < oat_file_start_offset_) {
+          // The patch reaches the thunk in a previous oat file. (We do not record method call
+          // thunks as the call may reach its target directly.)
+          old_data->MarkSharedWithOatFile(oat_file_start_offset_);
         }
       }
     }
@@ -29,6 +29,7 @@ namespace linker {
 
 class ArmBaseRelativePatcher : public RelativePatcher {
  public:
+  void StartOatFile(uint32_t offset) override;
   uint32_t ReserveSpace(uint32_t offset,
                         const CompiledMethod* compiled_method,
                         MethodReference method_ref) override;
@@ -145,6 +146,11 @@ class ArmBaseRelativePatcher : public RelativePatcher {
   // Thunks
   std::deque<ThunkData*> unreserved_thunks_;
 
+  // The start of the current oat file, used for statistics about thunks shared with
+  // previous oat files of a multi-oat compilation. Set by StartOatFile(), and not by
+  // ReserveSpaceEnd() which is also called at the end of the hot code of an oat file.
+  uint32_t oat_file_start_offset_;
+
   class PendingThunkComparator;
   std::vector<ThunkData*> pending_thunks_;  // Heap with the PendingThunkComparator.
 
@@ -1052,6 +1052,40 @@ TEST_F(Arm64RelativePatcherTestDefault, EntrypointCall) {
   EXPECT_EQ(br_ip0, GetOutputInsn(thunk_offset + 4u));
 }
 
+TEST_F(Arm64RelativePatcherTestDefault, EntrypointCallThunkSharedWithPreviousOatFile) {
+  constexpr uint32_t kEntrypointOffset = 512;
+  const LinkerPatch patches[] = {
+      LinkerPatch::CallEntrypointPatch(0u, kEntrypointOffset),
+  };
+  AddCompiledMethod(MethodRef(1u), kCallCode, ArrayRef<const LinkerPatch>(patches));
+  AddCompiledMethod(MethodRef(2u), kCallCode, ArrayRef<const LinkerPatch>(patches));
+
+  // Reserve space for each method as if it was in a separate oat file of a multi-oat
+  // compilation. The thunk is placed at the end of the first oat file.
+  uint32_t offset = kTrampolineSize;
+  offset = patcher_->ReserveSpace(offset, compiled_methods_[0].get(), MethodRef(1u));
+  offset += CodeAlignmentSize(offset) + sizeof(OatQuickMethodHeader) + kCallCode.size();
+  uint32_t thunk_offset = CompiledCode::AlignCode(offset, InstructionSet::kArm64);
+  uint32_t end1_offset = patcher_->ReserveSpaceEnd(offset);
+  ASSERT_LT(thunk_offset, end1_offset);
+  uint32_t thunk_size = end1_offset - thunk_offset;
+  EXPECT_EQ(0u, patcher_->SharedThunksSize());
+
+  // The second oat file reaches the thunk in the first oat file and needs no copy.
+  uint32_t oat_file2_start = RoundUp(end1_offset, kElfSegmentAlignment);
+  patcher_->StartOatFile(oat_file2_start);
+  uint32_t method2_start = oat_file2_start + kElfSegmentAlignment;
+  offset = patcher_->ReserveSpace(method2_start, compiled_methods_[1].get(), MethodRef(2u));
+  ASSERT_EQ(method2_start, offset);
+  offset += CodeAlignmentSize(offset) + sizeof(OatQuickMethodHeader) + kCallCode.size();
+  EXPECT_EQ(offset, patcher_->ReserveSpaceEnd(offset));
+  EXPECT_EQ(thunk_size, patcher_->SharedThunksSize());
+
+  // Ending the hot code of the second oat file does not count the shared thunk again.
+  EXPECT_EQ(offset, patcher_->ReserveSpaceEnd(offset));
+  EXPECT_EQ(thunk_size, patcher_->SharedThunksSize());
+}
+
 void Arm64RelativePatcherTest::TestBakerField(uint32_t offset,
                                               uint32_t ref_reg,
                                               bool implicit_null_checks) {
@@ -1250,6 +1284,44 @@ TEST_F(Arm64RelativePatcherTestDefault, BakerOffsetThunkBeforeFiller) {
   ASSERT_TRUE(CheckLinkedMethod(MethodRef(1), ArrayRef<const uint8_t>(expected_code1)));
 }
 
+TEST_F(Arm64RelativePatcherTestDefault, BakerOffsetThunkBeforeHotCodePadding) {
+  // The hot code is padded to a huge page boundary. The thunk used by the hot method must be
+  // placed before the padding, the CBNZ cannot branch over 2MiB.
+  // Use offset = 0, base_reg = 0, ref_reg = 0, the LDR is simply `kLdrWInsn`.
+  constexpr uint32_t kLiteralOffset = 0;
+  const std::vector<uint8_t> raw_code = RawCode({kCbnzIP1Plus0Insn, kLdrWInsn, kNopInsn});
+  ArrayRef<const uint8_t> code(raw_code);
+  uint32_t encoded_data = EncodeBakerReadBarrierFieldData(/* base_reg */ 0, /* holder_reg */ 0);
+  const LinkerPatch patches[] = {
+      LinkerPatch::BakerReadBarrierBranchPatch(kLiteralOffset, encoded_data),
+  };
+  AddCompiledMethod(MethodRef(1u), code, ArrayRef<const LinkerPatch>(patches));
+  // The cold method uses the same thunk.
+  AddCodeGap(kHugePageSize);
+  AddCompiledMethod(MethodRef(2u), code, ArrayRef<const LinkerPatch>(patches));
+
+  Link();
+
+  uint32_t method1_offset = GetMethodOffset(1u);
+  uint32_t method2_offset = GetMethodOffset(2u);
+  ASSERT_LT(method1_offset, kHugePageSize);
+  ASSERT_GE(method2_offset, kHugePageSize);
+  // Both methods branch to a thunk right after their code.
+  const uint32_t cbnz_offset = RoundUp(raw_code.size(), kArm64CodeAlignment) - kLiteralOffset;
+  const uint32_t cbnz = kCbnzIP1Plus0Insn | (cbnz_offset << (5 - 2));
+  const std::vector<uint8_t> expected_code = RawCode({cbnz, kLdrWInsn, kNopInsn});
+  ASSERT_TRUE(CheckLinkedMethod(MethodRef(1), ArrayRef<const uint8_t>(expected_code)));
+  ASSERT_TRUE(CheckLinkedMethod(MethodRef(2), ArrayRef<const uint8_t>(expected_code)));
+  std::vector<uint8_t> expected_thunk =
+      CompileBakerOffsetThunk(/* base_reg */ 0, /* holder_reg */ 0);
+  for (uint32_t method_offset : {method1_offset, method2_offset}) {
+    uint32_t thunk_offset = method_offset + cbnz_offset;
+    ASSERT_GE(output_.size() - thunk_offset, expected_thunk.size());
+    ArrayRef<const uint8_t> compiled_thunk(output_.data() + thunk_offset, expected_thunk.size());
+    EXPECT_EQ(ArrayRef<const uint8_t>(expected_thunk), compiled_thunk);
+  }
+}
+
 TEST_F(Arm64RelativePatcherTestDefault, BakerOffsetThunkInTheMiddleUnreachableFromLast) {
   // Based on the BakerOffsetThunkInTheMiddle but the CBNZ in the last method is preceded
   // by NOP and cannot reach the thunk in the middle, so we emit an extra thunk at the end.
@@ -46,14 +46,16 @@ class DebugInfoTask : public Task {
                 size_t text_section_size,
                 uint64_t dex_section_address,
                 size_t dex_section_size,
-                const debug::DebugInfo& debug_info)
+                const debug::DebugInfo& debug_info,
+                ThreadPool* compression_thread_pool)
       : isa_(isa),
         instruction_set_features_(features),
         text_section_address_(text_section_address),
         text_section_size_(text_section_size),
         dex_section_address_(dex_section_address),
         dex_section_size_(dex_section_size),
-        debug_info_(debug_info) {
+        debug_info_(debug_info),
+        compression_thread_pool_(compression_thread_pool) {
   }
 
   void Run(Thread*) override {
@@ -63,7 +65,8 @@ class DebugInfoTask : public Task {
                                        text_section_size_,
                                        dex_section_address_,
                                        dex_section_size_,
-                                       debug_info_);
+                                       debug_info_,
+                                       compression_thread_pool_);
   }
 
   std::vector<uint8_t>* GetResult() {
@@ -78,6 +81,7 @@ class DebugInfoTask : public Task {
   uint64_t dex_section_address_;
   size_t dex_section_size_;
   const debug::DebugInfo& debug_info_;
+  ThreadPool* compression_thread_pool_;
   std::vector<uint8_t> result_;
 };
 
@@ -85,7 +89,8 @@ template <typename ElfTypes>
 class ElfWriterQuick final : public ElfWriter {
  public:
   ElfWriterQuick(const CompilerOptions& compiler_options,
-                 File* elf_file);
+                 File* elf_file,
+                 size_t thread_count);
   ~ElfWriterQuick();
 
   void Start() override;
@@ -118,6 +123,7 @@ class ElfWriterQuick final : public ElfWriter {
  private:
   const CompilerOptions& compiler_options_;
   File* const elf_file_;
+  const size_t thread_count_;
   size_t rodata_size_;
   size_t text_size_;
   size_t data_bimg_rel_ro_size_;
@@ -126,6 +132,8 @@ class ElfWriterQuick final : public ElfWriter {
   std::unique_ptr<BufferedOutputStream> output_stream_;
   std::unique_ptr<ElfBuilder<ElfTypes>> builder_;
   std::unique_ptr<DebugInfoTask> debug_info_task_;
+  // Threads helping the mini-debug-info writer with the compression.
+  std::unique_ptr<ThreadPool> debug_info_compression_thread_pool_;
   std::unique_ptr<ThreadPool> debug_info_thread_pool_;
 
   void ComputeFileBuildId(uint8_t (*build_id)[ElfBuilder<ElfTypes>::kBuildIdLen]);
@@ -134,19 +142,23 @@ class ElfWriterQuick final : public ElfWriter {
 };
 
 std::unique_ptr<ElfWriter> CreateElfWriterQuick(const CompilerOptions& compiler_options,
-                                                File* elf_file) {
+                                                File* elf_file,
+                                                size_t thread_count) {
   if (Is64BitInstructionSet(compiler_options.GetInstructionSet())) {
-    return std::make_unique<ElfWriterQuick<ElfTypes64>>(compiler_options, elf_file);
+    return std::make_unique<ElfWriterQuick<ElfTypes64>>(compiler_options, elf_file, thread_count);
   } else {
-    return std::make_unique<ElfWriterQuick<ElfTypes32>>(compiler_options, elf_file);
+    return std::make_unique<ElfWriterQuick<ElfTypes32>>(compiler_options, elf_file, thread_count);
   }
 }
 
 template <typename ElfTypes>
-ElfWriterQuick<ElfTypes>::ElfWriterQuick(const CompilerOptions& compiler_options, File* elf_file)
+ElfWriterQuick<ElfTypes>::ElfWriterQuick(const CompilerOptions& compiler_options,
+                                         File* elf_file,
+                                         size_t thread_count)
     : ElfWriter(),
       compiler_options_(compiler_options),
       elf_file_(elf_file),
+      thread_count_(thread_count),
       rodata_size_(0u),
       text_size_(0u),
       data_bimg_rel_ro_size_(0u),
@@ -187,6 +199,10 @@ void ElfWriterQuick<ElfTypes>::PrepareDynamicSection(size_t rodata_size,
   bss_size_ = bss_size;
   DCHECK_EQ(dex_section_size_, 0u);
   dex_section_size_ = dex_section_size;
+  if (compiler_options_.GetHugePageHotCode() && text_size_ != 0u) {
+    // The OatWriter aligned the code for huge pages, let the loader know.
+    builder_->GetText()->SetAlignment(kHugePageSize);
+  }
   builder_->PrepareDynamicSection(elf_file_->GetPath(),
                                   rodata_size_,
                                   text_size_,
@@ -246,6 +262,10 @@ void ElfWriterQuick<ElfTypes>::PrepareDebugInfo(const debug::DebugInfo& debug_in
   if (compiler_options_.GetGenerateMiniDebugInfo()) {
     // Prepare the mini-debug-info in background while we do other I/O.
     Thread* self = Thread::Current();
+    if (thread_count_ > 1u) {
+      debug_info_compression_thread_pool_.reset(
+          ThreadPool::Create("Mini-debug-info compression", thread_count_ - 1u));
+    }
     debug_info_task_ = std::make_unique<DebugInfoTask>(
         builder_->GetIsa(),
         compiler_options_.GetInstructionSetFeatures(),
@@ -253,7 +273,8 @@ void ElfWriterQuick<ElfTypes>::PrepareDebugInfo(const debug::DebugInfo& debug_in
         text_size_,
         builder_->GetDex()->Exists() ? builder_->GetDex()->GetAddress() : 0,
         dex_section_size_,
-        debug_info);
+        debug_info,
+        debug_info_compression_thread_pool_.get());
     debug_info_thread_pool_.reset(ThreadPool::Create("Mini-debug-info writer", 1));
     debug_info_thread_pool_->AddTask(self, debug_info_task_.get());
     debug_info_thread_pool_->StartWorkers(self);
@@ -271,6 +292,7 @@ void ElfWriterQuick<ElfTypes>::WriteDebugInfo(const debug::DebugInfo& debug_info
     Thread* self = Thread::Current();
     DCHECK(debug_info_thread_pool_ != nullptr);
     debug_info_thread_pool_->Wait(self, true, false);
+    debug_info_compression_thread_pool_.reset();
     builder_->WriteSection(".gnu_debugdata", debug_info_task_->GetResult());
   }
   // The Strip method expects debug info to be last (mini-debug-info is not stripped).
@@ -85,6 +85,7 @@
 #include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
 #include "subtype_check.h"
+#include "thread_pool.h"
 #include "well_known_classes-inl.h"
 
 using ::art::mirror::Class;
@@ -96,6 +97,9 @@ using ::art::mirror::String;
 namespace art {
 namespace linker {
 
+// Number of objects copied and fixed up by a single task of the image writer thread pool.
+static constexpr size_t kParallelCopyChunkSize = 1024u;
+
 // The actual value of `kImageClassTableMinLoadFactor` is irrelevant because image class tables
 // are never resized, but we still need to pass a reasonable value to the constructor.
 constexpr double kImageClassTableMinLoadFactor = 0.5;
@@ -566,6 +570,9 @@ bool ImageWriter::Write(int image_fd,
 
   Thread* const self = Thread::Current();
   ScopedDebugDisallowReadBarriers sddrb(self);
+  if (thread_count_ > 1u) {
+    thread_pool_.reset(ThreadPool::Create("Image writer thread pool", thread_count_ - 1u));
+  }
   {
     ScopedObjectAccess soa(self);
     for (size_t i = 0; i < oat_filenames_.size(); ++i) {
@@ -580,6 +587,7 @@ bool ImageWriter::Write(int image_fd,
     Runtime::Current()->GetHeap()->DisableObjectValidation();
     CopyAndFixupObjects();
   }
+  thread_pool_.reset();
 
   if (compiler_options_.IsAppImage()) {
     CopyMetadata();
@@ -2894,73 +2902,107 @@ void ImageWriter::CopyAndFixupImtConflictTable(ImtConflictTable* orig, ImtConfli
   }
 }
 
-void ImageWriter::CopyAndFixupNativeData(size_t oat_index) {
-  const ImageInfo& image_info = GetImageInfo(oat_index);
-  // Copy ArtFields and methods to their locations and update the array for convenience.
-  for (auto& pair : native_object_relocations_) {
-    NativeObjectRelocation& relocation = pair.second;
-    // Only work with fields and methods that are in the current oat file.
-    if (relocation.oat_index != oat_index) {
-      continue;
+template <typename Visitor>
+void ImageWriter::ForEachRangeInParallel(Thread* self, size_t count, const Visitor& visitor) {
+  if (thread_pool_ == nullptr || count <= kParallelCopyChunkSize) {
+    visitor(0u, count);
+    return;
+  }
+  // Let the workers and this thread run the tasks with the mutator lock held.
+  ScopedThreadSuspension sts(self, ThreadState::kNative);
+  for (size_t begin = 0u; begin < count; begin += kParallelCopyChunkSize) {
+    size_t end = std::min(count, begin + kParallelCopyChunkSize);
+    thread_pool_->AddTask(self, new FunctionTask([&visitor, begin, end](Thread* thread) {
+      ScopedObjectAccess soa(thread);
+      ScopedDebugDisallowReadBarriers sddrb(thread);
+      visitor(begin, end);
+    }));
+  }
+  thread_pool_->StartWorkers(self);
+  thread_pool_->Wait(self, /* do_work= */ true, /* may_hold_locks= */ false);
+  thread_pool_->StopWorkers(self);
+}
+
+void ImageWriter::CopyAndFixupNativeObject(void* orig, const NativeObjectRelocation& relocation) {
+  const ImageInfo& image_info = GetImageInfo(relocation.oat_index);
+  auto* dest = image_info.image_.Begin() + relocation.offset;
+  DCHECK_GE(dest, image_info.image_.Begin() + image_info.image_end_);
+  DCHECK(!IsInBootImage(orig));
+  switch (relocation.type) {
+    case NativeObjectRelocationType::kRuntimeMethod:
+    case NativeObjectRelocationType::kArtMethodClean:
+    case NativeObjectRelocationType::kArtMethodDirty: {
+      CopyAndFixupMethod(reinterpret_cast<ArtMethod*>(orig),
+                         reinterpret_cast<ArtMethod*>(dest),
+                         relocation.oat_index);
+      break;
     }
-    auto* dest = image_info.image_.Begin() + relocation.offset;
-    DCHECK_GE(dest, image_info.image_.Begin() + image_info.image_end_);
-    DCHECK(!IsInBootImage(pair.first));
-    switch (relocation.type) {
-      case NativeObjectRelocationType::kRuntimeMethod:
-      case NativeObjectRelocationType::kArtMethodClean:
-      case NativeObjectRelocationType::kArtMethodDirty: {
-        CopyAndFixupMethod(reinterpret_cast<ArtMethod*>(pair.first),
-                           reinterpret_cast<ArtMethod*>(dest),
-                           oat_index);
-        break;
-      }
-      case NativeObjectRelocationType::kArtFieldArray: {
-        // Copy and fix up the entire field array.
-        auto* src_array = reinterpret_cast<LengthPrefixedArray<ArtField>*>(pair.first);
-        auto* dest_array = reinterpret_cast<LengthPrefixedArray<ArtField>*>(dest);
-        size_t size = src_array->size();
-        memcpy(dest_array, src_array, LengthPrefixedArray<ArtField>::ComputeSize(size));
-        for (size_t i = 0; i != size; ++i) {
-          CopyAndFixupReference(
-              dest_array->At(i).GetDeclaringClassAddressWithoutBarrier(),
-              src_array->At(i).GetDeclaringClass<kWithoutReadBarrier>());
-        }
-        break;
-      }
-      case NativeObjectRelocationType::kArtMethodArrayClean:
-      case NativeObjectRelocationType::kArtMethodArrayDirty: {
-        // For method arrays, copy just the header since the elements will
-        // get copied by their corresponding relocations.
-        size_t size = ArtMethod::Size(target_ptr_size_);
-        size_t alignment = ArtMethod::Alignment(target_ptr_size_);
-        memcpy(dest, pair.first, LengthPrefixedArray<ArtMethod>::ComputeSize(0, size, alignment));
-        // Clear padding to avoid non-deterministic data in the image.
-        // Historical note: We also did that to placate Valgrind.
-        reinterpret_cast<LengthPrefixedArray<ArtMethod>*>(dest)->ClearPadding(size, alignment);
-        break;
-      }
-      case NativeObjectRelocationType::kIMTable: {
-        ImTable* orig_imt = reinterpret_cast<ImTable*>(pair.first);
-        ImTable* dest_imt = reinterpret_cast<ImTable*>(dest);
-        CopyAndFixupImTable(orig_imt, dest_imt);
-        break;
-      }
-      case NativeObjectRelocationType::kIMTConflictTable: {
-        auto* orig_table = reinterpret_cast<ImtConflictTable*>(pair.first);
-        CopyAndFixupImtConflictTable(
-            orig_table,
-            new(dest)ImtConflictTable(orig_table->NumEntries(target_ptr_size_), target_ptr_size_));
-        break;
-      }
-      case NativeObjectRelocationType::kGcRootPointer: {
-        auto* orig_pointer = reinterpret_cast<GcRoot<mirror::Object>*>(pair.first);
-        auto* dest_pointer = reinterpret_cast<GcRoot<mirror::Object>*>(dest);
-        CopyAndFixupReference(dest_pointer->AddressWithoutBarrier(), orig_pointer->Read());
-        break;
+    case NativeObjectRelocationType::kArtFieldArray: {
+      // Copy and fix up the entire field array.
+      auto* src_array = reinterpret_cast<LengthPrefixedArray<ArtField>*>(orig);
+      auto* dest_array = reinterpret_cast<LengthPrefixedArray<ArtField>*>(dest);
+      size_t size = src_array->size();
+      memcpy(dest_array, src_array, LengthPrefixedArray<ArtField>::ComputeSize(size));
+      for (size_t i = 0; i != size; ++i) {
+        CopyAndFixupReference(
+            dest_array->At(i).GetDeclaringClassAddressWithoutBarrier(),
+            src_array->At(i).GetDeclaringClass<kWithoutReadBarrier>());
       }
+      break;
+    }
+    case NativeObjectRelocationType::kArtMethodArrayClean:
+    case NativeObjectRelocationType::kArtMethodArrayDirty: {
+      // For method arrays, copy just the header since the elements will
+      // get copied by their corresponding relocations.
+      size_t size = ArtMethod::Size(target_ptr_size_);
+      size_t alignment = ArtMethod::Alignment(target_ptr_size_);
+      memcpy(dest, orig, LengthPrefixedArray<ArtMethod>::ComputeSize(0, size, alignment));
+      // Clear padding to avoid non-deterministic data in the image.
+      // Historical note: We also did that to placate Valgrind.
+      reinterpret_cast<LengthPrefixedArray<ArtMethod>*>(dest)->ClearPadding(size, alignment);
+      break;
+    }
+    case NativeObjectRelocationType::kIMTable: {
+      ImTable* orig_imt = reinterpret_cast<ImTable*>(orig);
+      ImTable* dest_imt = reinterpret_cast<ImTable*>(dest);
+      CopyAndFixupImTable(orig_imt, dest_imt);
+      break;
+    }
+    case NativeObjectRelocationType::kIMTConflictTable: {
+      auto* orig_table = reinterpret_cast<ImtConflictTable*>(orig);
+      CopyAndFixupImtConflictTable(
+          orig_table,
+          new(dest)ImtConflictTable(orig_table->NumEntries(target_ptr_size_), target_ptr_size_));
+      break;
+    }
+    case NativeObjectRelocationType::kGcRootPointer: {
+      auto* orig_pointer = reinterpret_cast<GcRoot<mirror::Object>*>(orig);
+      auto* dest_pointer = reinterpret_cast<GcRoot<mirror::Object>*>(dest);
+      CopyAndFixupReference(dest_pointer->AddressWithoutBarrier(), orig_pointer->Read());
+      break;
     }
   }
+}
+
+void ImageWriter::CopyAndFixupNativeData(size_t oat_index) {
+  const ImageInfo& image_info = GetImageInfo(oat_index);
+  // Copy ArtFields and methods to their locations and update the array for convenience.
+  // Only work with fields and methods that are in the current oat file. Each of them is
+  // copied to its own location, so they can be processed in any order.
+  std::vector<const std::pair<void*, NativeObjectRelocation>*> relocations;
+  for (const auto& pair : native_object_relocations_) {
+    if (pair.second.oat_index == oat_index) {
+      relocations.push_back(&pair);
+    }
+  }
+  ForEachRangeInParallel(
+      Thread::Current(),
+      relocations.size(),
+      [&](size_t begin, size_t end) REQUIRES_SHARED(Locks::mutator_lock_) {
+        for (size_t i = begin; i != end; ++i) {
+          CopyAndFixupNativeObject(relocations[i]->first, relocations[i]->second);
+        }
+      });
   // Fixup the image method roots.
   auto* image_header = reinterpret_cast<ImageHeader*>(image_info.image_.Begin());
   for (size_t i = 0; i < ImageHeader::kImageMethodsCount; ++i) {
@@ -3078,7 +3120,9 @@ inline Object* ImageWriter::CopyObject(Object* obj) {
   DCHECK_LT(offset, image_info.image_end_);
   const auto* src = reinterpret_cast<const uint8_t*>(obj);
 
-  bool done = image_info.image_bitmap_.Set(dst);  // Mark the obj as live.
+  // Mark the obj as live. Objects are copied concurrently, so neighbouring bits of the
+  // bitmap may be set by other threads.
+  bool done = image_info.image_bitmap_.AtomicTestAndSet(dst);
   // Check if the object was already copied, unless the caller indicated that it was not.
   if (kCheckIfDone && done) {
     return nullptr;
@@ -3172,11 +3216,22 @@ void ImageWriter::CopyAndFixupObjects() {
     }
   }
 
+  // Each object is copied to its own slot and only its copy is fixed up, so the objects
+  // can be processed in any order without affecting the output.
+  std::vector<Object*> objects;
   auto visitor = [&](Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
     DCHECK(obj != nullptr);
-    CopyAndFixupObject(obj);
+    objects.push_back(obj);
   };
   Runtime::Current()->GetHeap()->VisitObjects(visitor);
+  ForEachRangeInParallel(
+      Thread::Current(),
+      objects.size(),
+      [&](size_t begin, size_t end) REQUIRES_SHARED(Locks::mutator_lock_) {
+        for (size_t i = begin; i != end; ++i) {
+          CopyAndFixupObject(objects[i]);
+        }
+      });
 
   // Fill the padding objects since they are required for in order traversal of the image space.
   for (ImageInfo& image_info : image_infos_) {
@@ -3676,7 +3731,8 @@ ImageWriter::ImageWriter(const CompilerOptions& compiler_options,
                          const std::vector<std::string>& oat_filenames,
                          const HashMap<const DexFile*, size_t>& dex_file_oat_index_map,
                          jobject class_loader,
-                         const std::vector<std::string>* dirty_image_objects)
+                         const std::vector<std::string>* dirty_image_objects,
+                         size_t thread_count)
     : compiler_options_(compiler_options),
       boot_image_begin_(Runtime::Current()->GetHeap()->GetBootImagesStartAddress()),
       boot_image_size_(Runtime::Current()->GetHeap()->GetBootImagesSize()),
@@ -3692,7 +3748,9 @@ ImageWriter::ImageWriter(const CompilerOptions& compiler_options,
       image_storage_mode_(image_storage_mode),
       oat_filenames_(oat_filenames),
       dex_file_oat_index_map_(dex_file_oat_index_map),
-      dirty_image_objects_(dirty_image_objects) {
+      dirty_image_objects_(dirty_image_objects),
+      thread_count_(thread_count) {
+  DCHECK_NE(thread_count, 0u);
   DCHECK(compiler_options.IsBootImage() ||
          compiler_options.IsBootImageExtension() ||
          compiler_options.IsAppImage());
@@ -70,6 +70,7 @@ template<class T> class Handle;
 class ImTable;
 class ImtConflictTable;
 class JavaVMExt;
+class ThreadPool;
 class TimingLogger;
 
 namespace linker {
@@ -83,7 +84,8 @@ class ImageWriter final {
               const std::vector<std::string>& oat_filenames,
               const HashMap<const DexFile*, size_t>& dex_file_oat_index_map,
               jobject class_loader,
-              const std::vector<std::string>* dirty_image_objects);
+              const std::vector<std::string>* dirty_image_objects,
+              size_t thread_count);
   ~ImageWriter();
 
   /*
@@ -463,6 +465,13 @@ class ImageWriter final {
   void CopyAndFixupImtConflictTable(ImtConflictTable* orig, ImtConflictTable* copy)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Calls `visitor(begin, end)` for consecutive ranges covering [0, count), using the
+  // thread pool when there is one. The visitor must only write to the image copies of
+  // the objects in its range, so that the result does not depend on the scheduling.
+  template <typename Visitor>
+  void ForEachRangeInParallel(Thread* self, size_t count, const Visitor& visitor)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   /*
    * Copies metadata from the heap into a buffer that will be compressed and
    * written to the image.
@@ -532,6 +541,10 @@ class ImageWriter final {
 
   NativeObjectRelocation GetNativeRelocation(void* obj) REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Copies a native object to its location in the image and adjusts its pointers.
+  void CopyAndFixupNativeObject(void* orig, const NativeObjectRelocation& relocation)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Location of where the object will be when the image is loaded at runtime.
   template <typename T>
   T* NativeLocationInImage(T* obj) REQUIRES_SHARED(Locks::mutator_lock_);
@@ -687,6 +700,12 @@ class ImageWriter final {
   // Region alignment bytes wasted.
   size_t region_alignment_wasted_ = 0u;
 
+  // Number of threads used to copy and fix up the image, including the calling thread.
+  const size_t thread_count_;
+
+  // Pool of `thread_count_ - 1` workers, only alive while copying the image.
+  std::unique_ptr<ThreadPool> thread_pool_;
+
   class FixupClassVisitor;
   class FixupRootVisitor;
   class FixupVisitor;
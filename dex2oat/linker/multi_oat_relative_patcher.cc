@@ -46,16 +46,19 @@ MultiOatRelativePatcher::MultiOatRelativePatcher(InstructionSet instruction_set,
       instruction_set_(instruction_set),
       start_size_code_alignment_(0u),
       start_size_relative_call_thunks_(0u),
-      start_size_misc_thunks_(0u) {
+      start_size_misc_thunks_(0u),
+      start_size_shared_thunks_(0u) {
 }
 
 void MultiOatRelativePatcher::StartOatFile(uint32_t adjustment) {
   DCHECK_ALIGNED(adjustment, kElfSegmentAlignment);
   adjustment_ = adjustment;
+  relative_patcher_->StartOatFile(adjustment);
 
   start_size_code_alignment_ = relative_patcher_->CodeAlignmentSize();
   start_size_relative_call_thunks_ = relative_patcher_->RelativeCallThunksSize();
   start_size_misc_thunks_ = relative_patcher_->MiscThunksSize();
+  start_size_shared_thunks_ = relative_patcher_->SharedThunksSize();
 }
 
 uint32_t MultiOatRelativePatcher::CodeAlignmentSize() const {
@@ -73,6 +76,11 @@ uint32_t MultiOatRelativePatcher::MiscThunksSize() const {
   return relative_patcher_->MiscThunksSize() - start_size_misc_thunks_;
 }
 
+uint32_t MultiOatRelativePatcher::SharedThunksSize() const {
+  DCHECK_GE(relative_patcher_->SharedThunksSize(), start_size_shared_thunks_);
+  return relative_patcher_->SharedThunksSize() - start_size_shared_thunks_;
+}
+
 std::pair<bool, uint32_t> MultiOatRelativePatcher::MethodOffsetMap::FindMethodOffset(
     MethodReference ref) {
   auto it = map.find(ref);
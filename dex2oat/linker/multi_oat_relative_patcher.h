@@ -137,6 +137,7 @@ class MultiOatRelativePatcher final {
   uint32_t CodeAlignmentSize() const;
   uint32_t RelativeCallThunksSize() const;
   uint32_t MiscThunksSize() const;
+  uint32_t SharedThunksSize() const;
 
  private:
   class ThunkProvider : public RelativePatcherThunkProvider {
@@ -169,6 +170,7 @@ class MultiOatRelativePatcher final {
   uint32_t start_size_code_alignment_;
   uint32_t start_size_relative_call_thunks_;
   uint32_t start_size_misc_thunks_;
+  uint32_t start_size_shared_thunks_;
 
   friend class MultiOatRelativePatcherTest;
 
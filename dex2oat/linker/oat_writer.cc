@@ -899,6 +899,10 @@ struct OatWriter::BssMappingInfo {
 //
 // See also OrderedMethodVisitor.
 struct OatWriter::OrderedMethodData {
+  static constexpr uint32_t kHotBit = 1u;
+  static constexpr uint32_t kStartupBit = 2u;
+  static constexpr uint32_t kPostStartupBit = 4u;
+
   uint32_t hotness_bits;
   OatClass* oat_class;
   CompiledMethod* compiled_method;
@@ -918,6 +922,10 @@ struct OatWriter::OrderedMethodData {
     return debug_info_idx != kDebugInfoIdxInvalid;
   }
 
+  bool IsHot() const {
+    return (hotness_bits & kHotBit) != 0u;
+  }
+
   // Bin each method according to the profile flags.
   //
   // Groups by e.g.
@@ -1067,16 +1075,16 @@ class OatWriter::LayoutCodeMethodVisitor final : public OatDexMethodVisitor {
         // Note: Bin-to-bin order does not matter. If the kernel does or does not read-ahead
         // any memory, it only goes into the buffer cache and does not grow the PSS until the
         // first time that memory is referenced in the process.
-        constexpr uint32_t kHotBit = 1u;
-        constexpr uint32_t kStartupBit = 2u;
-        constexpr uint32_t kPostStartupBit = 4u;
         hotness_bits =
-            (pci->IsHotMethod(profile_index_, method_index) ? kHotBit : 0u) |
-            (pci->IsStartupMethod(profile_index_, method_index) ? kStartupBit : 0u) |
-            (pci->IsPostStartupMethod(profile_index_, method_index) ? kPostStartupBit : 0u);
+            (pci->IsHotMethod(profile_index_, method_index)
+                 ? OrderedMethodData::kHotBit : 0u) |
+            (pci->IsStartupMethod(profile_index_, method_index)
+                 ? OrderedMethodData::kStartupBit : 0u) |
+            (pci->IsPostStartupMethod(profile_index_, method_index)
+                 ? OrderedMethodData::kPostStartupBit : 0u);
         if (kIsDebugBuild) {
           // Check for bins that are always-empty given a real profile.
-          if (hotness_bits == kHotBit) {
+          if (hotness_bits == OrderedMethodData::kHotBit) {
             // This is not fatal, so only warn.
             LOG(WARNING) << "Method " << method_ref.PrettyMethod() << " was hot but wasn't marked "
                          << "either start-up or post-startup. Possible corrupted profile?";
@@ -1119,6 +1127,15 @@ class OatWriter::LayoutCodeMethodVisitor final : public OatDexMethodVisitor {
       DCHECK(std::is_sorted(ordered_methods_.begin(), ordered_methods_.end()));
     }
 
+    if (writer_->GetCompilerOptions().GetHugePageHotCode()) {
+      // Move all hot methods to the start, to be mapped with huge pages.
+      std::stable_partition(ordered_methods_.begin(),
+                            ordered_methods_.end(),
+                            [](const OrderedMethodData& method_data) {
+                              return method_data.IsHot();
+                            });
+    }
+
     return std::move(ordered_methods_);
   }
 
@@ -1144,8 +1161,19 @@ class OatWriter::LayoutReserveOffsetCodeMethodVisitor : public OrderedMethodVisi
                                              std::move(ordered_methods)) {
   }
 
+  bool VisitStart() override {
+    hot_code_start_ = offset_;
+    return true;
+  }
+
   bool VisitComplete() override {
     offset_ = writer_->relative_patcher_->ReserveSpaceEnd(offset_);
+    if (in_hot_code_ && offset_ != hot_code_start_) {
+      // All methods are hot. The hot code is not padded, the runtime clips the huge page
+      // mapping to the end of the code.
+      uint32_t hot_code_end = writer_->GetHugePageAlignedOffset(offset_);
+      writer_->oat_header_->SetHotCodeSize(hot_code_end - executable_offset_);
+    }
     if (generate_debug_info_) {
       std::vector<debug::MethodDebugInfo> thunk_infos =
           relative_patcher_->GenerateThunkDebugInfo(executable_offset_);
@@ -1169,6 +1197,19 @@ class OatWriter::LayoutReserveOffsetCodeMethodVisitor : public OrderedMethodVisi
 
     DCHECK(HasCompiledCode(compiled_method)) << method_ref.PrettyMethod();
 
+    if (UNLIKELY(in_hot_code_) && !method_data.IsHot()) {
+      // End of the hot code, pad it to the next huge page boundary.
+      in_hot_code_ = false;
+      if (offset_ != hot_code_start_) {
+        // Place the thunks pending for the hot code before the padding, the branches to them
+        // may not reach over it. The relative patcher resumes after the gap as it does for
+        // the next oat file of a multi-image compilation.
+        offset_ = writer_->relative_patcher_->ReserveSpaceEnd(offset_);
+        offset_ = writer_->GetHugePageAlignedOffset(offset_);
+        writer_->oat_header_->SetHotCodeSize(offset_ - executable_offset_);
+      }
+    }
+
     // Derived from CompiledMethod.
     uint32_t quick_code_offset = 0;
 
@@ -1281,7 +1322,9 @@ class OatWriter::LayoutReserveOffsetCodeMethodVisitor : public OrderedMethodVisi
         executable_offset_(writer->oat_header_->GetExecutableOffset()),
         debuggable_(compiler_options.GetDebuggable()),
         native_debuggable_(compiler_options.GetNativeDebuggable()),
-        generate_debug_info_(compiler_options.GenerateAnyDebugInfo()) {}
+        generate_debug_info_(compiler_options.GenerateAnyDebugInfo()),
+        in_hot_code_(compiler_options.GetHugePageHotCode()),
+        hot_code_start_(0u) {}
 
   struct CodeOffsetsKeyComparator {
     bool operator()(const CompiledMethod* lhs, const CompiledMethod* rhs) const {
@@ -1328,6 +1371,11 @@ class OatWriter::LayoutReserveOffsetCodeMethodVisitor : public OrderedMethodVisi
   const bool debuggable_;
   const bool native_debuggable_;
   const bool generate_debug_info_;
+
+  // Whether we are still laying out the hot methods placed at the start for huge pages,
+  // and where their code starts.
+  bool in_hot_code_;
+  size_t hot_code_start_;
 };
 
 template <bool kDeduplicate>
@@ -1544,6 +1592,7 @@ class OatWriter::WriteCodeMethodVisitor : public OrderedMethodVisitor {
         file_offset_(file_offset),
         class_linker_(Runtime::Current()->GetClassLinker()),
         dex_cache_(nullptr),
+        in_hot_code_(writer->GetCompilerOptions().GetHugePageHotCode()),
         no_thread_suspension_("OatWriter patching") {
     patched_code_.reserve(16 * KB);
     if (writer_->GetCompilerOptions().IsBootImage() ||
@@ -1602,6 +1651,30 @@ class OatWriter::WriteCodeMethodVisitor : public OrderedMethodVisitor {
     ArrayRef<const uint8_t> quick_code = compiled_method->GetQuickCode();
     uint32_t code_size = quick_code.size() * sizeof(uint8_t);
 
+    if (UNLIKELY(in_hot_code_) && !method_data.IsHot()) {
+      // Skip the padding after the hot code, see LayoutReserveOffsetCodeMethodVisitor.
+      in_hot_code_ = false;
+      uint32_t hot_code_size = writer_->oat_header_->GetHotCodeSize();
+      if (hot_code_size != 0u) {
+        // Write the thunks reserved before the padding.
+        offset_ = writer_->relative_patcher_->WriteThunks(out, offset_);
+        if (offset_ == 0u) {
+          ReportWriteFailure("relative call thunk", method_ref);
+          return false;
+        }
+        size_t hot_code_end = writer_->oat_header_->GetExecutableOffset() + hot_code_size;
+        DCHECK_LE(offset_, hot_code_end);
+        size_t padding_size = hot_code_end - offset_;
+        off_t new_offset = out->Seek(padding_size, kSeekCurrent);
+        if (static_cast<size_t>(new_offset) != file_offset + hot_code_end) {
+          ReportWriteFailure("hot code padding", method_ref);
+          return false;
+        }
+        writer_->size_hot_code_alignment_ += padding_size;
+        offset_ = hot_code_end;
+      }
+    }
+
     // Deduplicate code arrays.
     const OatMethodOffsets& method_offsets = oat_class->method_offsets_[method_offsets_index];
     if (method_offsets.code_offset_ > offset_) {
@@ -1817,6 +1890,8 @@ class OatWriter::WriteCodeMethodVisitor : public OrderedMethodVisitor {
   ClassLinker* const class_linker_;
   ObjPtr<mirror::DexCache> dex_cache_;
   std::vector<uint8_t> patched_code_;
+  // Whether we are still writing the hot methods placed at the start for huge pages.
+  bool in_hot_code_;
   const ScopedAssertNoThreadSuspension no_thread_suspension_;
 
   void ReportWriteFailure(const char* what, const MethodReference& method_ref) {
@@ -2247,6 +2322,10 @@ size_t OatWriter::InitOatCode(size_t offset) {
   size_t old_offset = offset;
   // required to be on a new page boundary
   offset = RoundUp(offset, kElfSegmentAlignment);
+  if (GetCompilerOptions().GetHugePageHotCode()) {
+    // The hot code at the start must be aligned to a huge page in the file and in memory.
+    offset = GetHugePageAlignedOffset(offset);
+  }
   oat_header_->SetExecutableOffset(offset);
   size_executable_offset_alignment_ = offset - old_offset;
   InstructionSet instruction_set = compiler_options_.GetInstructionSet();
@@ -2319,6 +2398,7 @@ size_t OatWriter::InitOatCodeDexFiles(size_t offset) {
     success = layout_reserve_code_visitor.Visit();
     DCHECK(success);
     offset = layout_reserve_code_visitor.GetOffset();
+    size_shared_thunks_ = relative_patcher_->SharedThunksSize();
 
     // Save the method order because the WriteCodeMethodVisitor will need this
     // order again.
@@ -2502,6 +2582,7 @@ bool OatWriter::WriteRodata(OutputStream* out) {
 }
 
 void OatWriter::WriteVerifierDeps(verifier::VerifierDeps* verifier_deps,
+                                  ThreadPool* thread_pool,
                                   /*out*/std::vector<uint8_t>* buffer) {
   if (verifier_deps == nullptr) {
     // Nothing to write. Record the offset, but no need
@@ -2513,7 +2594,7 @@ void OatWriter::WriteVerifierDeps(verifier::VerifierDeps* verifier_deps,
   TimingLogger::ScopedTiming split("VDEX verifier deps", timings_);
 
   DCHECK(buffer->empty());
-  verifier_deps->Encode(*dex_files_, buffer);
+  verifier_deps->Encode(*dex_files_, buffer, thread_pool);
   size_verifier_deps_ = buffer->size();
 
   // Verifier deps data should be 4 byte aligned.
@@ -2629,6 +2710,7 @@ bool OatWriter::CheckOatSize(OutputStream* out, size_t file_offset, size_t relat
     DO_STAT(size_method_header_);
     DO_STAT(size_code_);
     DO_STAT(size_code_alignment_);
+    DO_STAT(size_hot_code_alignment_);
     DO_STAT(size_data_bimg_rel_ro_);
     DO_STAT(size_data_bimg_rel_ro_alignment_);
     DO_STAT(size_relative_call_thunks_);
@@ -2675,6 +2757,8 @@ bool OatWriter::CheckOatSize(OutputStream* out, size_t file_offset, size_t relat
     #undef DO_STAT
 
     VLOG(compiler) << "size_total=" << PrettySize(size_total) << " (" << size_total << "B)";
+    VLOG(compiler) << "size_shared_thunks_ (saved)=" << PrettySize(size_shared_thunks_)
+                   << " (" << size_shared_thunks_ << "B)";
 
     CHECK_EQ(vdex_size_ + oat_size_, size_total);
     CHECK_EQ(file_offset + size_total - vdex_size_, static_cast<size_t>(oat_end_file_offset));
@@ -3179,6 +3263,13 @@ size_t OatWriter::WriteDataBimgRelRo(OutputStream* out,
   return relative_offset;
 }
 
+size_t OatWriter::GetHugePageAlignedOffset(size_t offset) const {
+  // The .rodata starts at the same offset in the file and in memory, so aligning the
+  // file offset of the code also aligns its address.
+  DCHECK_NE(oat_data_offset_, 0u);
+  return RoundUp(oat_data_offset_ + offset, kHugePageSize) - oat_data_offset_;
+}
+
 bool OatWriter::RecordOatDataOffset(OutputStream* out) {
   // Get the elf file offset of the oat file.
   const off_t raw_file_offset = out->Seek(0, kSeekCurrent);
@@ -3674,11 +3765,13 @@ void OatWriter::WriteTypeLookupTables(/*out*/std::vector<uint8_t>* buffer) {
   }
 }
 
-bool OatWriter::FinishVdexFile(File* vdex_file, verifier::VerifierDeps* verifier_deps) {
+bool OatWriter::FinishVdexFile(File* vdex_file,
+                               verifier::VerifierDeps* verifier_deps,
+                               ThreadPool* thread_pool) {
   size_t old_vdex_size = vdex_size_;
   std::vector<uint8_t> buffer;
   buffer.reserve(64 * KB);
-  WriteVerifierDeps(verifier_deps, &buffer);
+  WriteVerifierDeps(verifier_deps, thread_pool, &buffer);
   WriteTypeLookupTables(&buffer);
   DCHECK_EQ(vdex_size_, old_vdex_size + buffer.size());
 
@@ -47,6 +47,7 @@ class DexContainer;
 class OatHeader;
 class OutputStream;
 class ProfileCompilationInfo;
+class ThreadPool;
 class TimingLogger;
 class TypeLookupTable;
 class VdexFile;
@@ -177,7 +178,11 @@ class OatWriter {
   void Initialize(const CompilerDriver* compiler_driver,
                   ImageWriter* image_writer,
                   const std::vector<const DexFile*>& dex_files);
-  bool FinishVdexFile(File* vdex_file, verifier::VerifierDeps* verifier_deps);
+  // Write the verifier deps and type lookup tables. The verifier deps are encoded using
+  // `thread_pool` if not null; the output is the same either way.
+  bool FinishVdexFile(File* vdex_file,
+                      verifier::VerifierDeps* verifier_deps,
+                      ThreadPool* thread_pool = nullptr);
 
   // Prepare layout of remaining data.
   void PrepareLayout(MultiOatRelativePatcher* relative_patcher);
@@ -290,6 +295,7 @@ class OatWriter {
                     /*out*/ std::vector<std::unique_ptr<const DexFile>>* opened_dex_files);
   void WriteTypeLookupTables(/*out*/std::vector<uint8_t>* buffer);
   void WriteVerifierDeps(verifier::VerifierDeps* verifier_deps,
+                         ThreadPool* thread_pool,
                          /*out*/std::vector<uint8_t>* buffer);
 
   size_t InitOatHeader(uint32_t num_dex_files, SafeMap<std::string, std::string>* key_value_store);
@@ -340,6 +346,8 @@ class OatWriter {
                                     /*inout*/ uint32_t& method_type_bss_mapping_offset);
 
   bool RecordOatDataOffset(OutputStream* out);
+  // Round up `offset` so that its file offset is aligned to `kHugePageSize`.
+  size_t GetHugePageAlignedOffset(size_t offset) const;
   void InitializeTypeLookupTables(
       const std::vector<std::unique_ptr<const DexFile>>& opened_dex_files);
   bool WriteDexLayoutSections(OutputStream* oat_rodata,
@@ -530,10 +538,13 @@ class OatWriter {
   uint32_t size_method_header_ = 0;
   uint32_t size_code_ = 0;
   uint32_t size_code_alignment_ = 0;
+  uint32_t size_hot_code_alignment_ = 0;
   uint32_t size_data_bimg_rel_ro_ = 0;
   uint32_t size_data_bimg_rel_ro_alignment_ = 0;
   uint32_t size_relative_call_thunks_ = 0;
   uint32_t size_misc_thunks_ = 0;
+  // Not part of the file, the size of thunks shared with previous oat files.
+  uint32_t size_shared_thunks_ = 0;
   uint32_t size_vmap_table_ = 0;
   uint32_t size_method_info_ = 0;
   uint32_t size_oat_dex_file_location_size_ = 0;
@@ -110,6 +110,16 @@ class RelativePatcher {
     return size_misc_thunks_;
   }
 
+  // The size of thunks that did not need to be emitted for an oat file of a multi-oat
+  // compilation because references from that oat file reach a thunk in a previous one.
+  uint32_t SharedThunksSize() const {
+    return size_shared_thunks_;
+  }
+
+  // Called when starting an oat file of a multi-oat compilation, with the global offset
+  // before which all code belongs to previous oat files. Only used for statistics.
+  virtual void StartOatFile([[maybe_unused]] uint32_t offset) { }
+
   // Reserve space for thunks if needed before a method, return adjusted offset.
   virtual uint32_t ReserveSpace(uint32_t offset,
                                 const CompiledMethod* compiled_method,
@@ -154,17 +164,23 @@ class RelativePatcher {
   RelativePatcher()
       : size_code_alignment_(0u),
         size_relative_call_thunks_(0u),
-        size_misc_thunks_(0u) {
+        size_misc_thunks_(0u),
+        size_shared_thunks_(0u) {
   }
 
   bool WriteCodeAlignment(OutputStream* out, uint32_t aligned_code_delta);
   bool WriteThunk(OutputStream* out, const ArrayRef<const uint8_t>& thunk);
   bool WriteMiscThunk(OutputStream* out, const ArrayRef<const uint8_t>& thunk);
 
+  void RecordSharedThunk(size_t thunk_size) {
+    size_shared_thunks_ += thunk_size;
+  }
+
  private:
   uint32_t size_code_alignment_;
   uint32_t size_relative_call_thunks_;
   uint32_t size_misc_thunks_;
+  uint32_t size_shared_thunks_;
 
   DISALLOW_COPY_AND_ASSIGN(RelativePatcher);
 };
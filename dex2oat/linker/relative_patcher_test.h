@@ -71,6 +71,8 @@ class RelativePatcherTest : public testing::Test {
     method_index_to_offset_map_.clear();
     compiled_method_refs_.clear();
     compiled_methods_.clear();
+    gap_alignments_.clear();
+    next_gap_alignment_ = 0u;
     patched_code_.clear();
     output_.clear();
     out_.reset();
@@ -90,6 +92,8 @@ class RelativePatcherTest : public testing::Test {
     method_index_to_offset_map_.clear();
     compiled_method_refs_.clear();
     compiled_methods_.clear();
+    gap_alignments_.clear();
+    next_gap_alignment_ = 0u;
     patched_code_.clear();
     output_.clear();
     out_.reset(new VectorOutputStream("test output stream", &output_));
@@ -105,6 +109,8 @@ class RelativePatcherTest : public testing::Test {
       const ArrayRef<const uint8_t>& code,
       const ArrayRef<const LinkerPatch>& patches = ArrayRef<const LinkerPatch>()) {
     compiled_method_refs_.push_back(method_ref);
+    gap_alignments_.push_back(next_gap_alignment_);
+    next_gap_alignment_ = 0u;
     compiled_methods_.emplace_back(new CompiledMethod(
         &storage_,
         instruction_set_,
@@ -114,6 +120,12 @@ class RelativePatcherTest : public testing::Test {
         patches));
   }
 
+  // Leave a gap in the code before the next added method, up to the given alignment, like the
+  // padding that the oat writer inserts after the hot code.
+  void AddCodeGap(uint32_t alignment) {
+    next_gap_alignment_ = alignment;
+  }
+
   uint32_t CodeAlignmentSize(uint32_t header_offset_to_align) {
     // We want to align the code rather than the preheader.
     uint32_t unaligned_code_offset = header_offset_to_align + sizeof(OatQuickMethodHeader);
@@ -128,6 +140,10 @@ class RelativePatcherTest : public testing::Test {
     uint32_t offset = kTrampolineSize;
     size_t idx = 0u;
     for (auto& compiled_method : compiled_methods_) {
+      if (gap_alignments_[idx] != 0u) {
+        offset = patcher_->ReserveSpaceEnd(offset);
+        offset = RoundUp(offset, gap_alignments_[idx]);
+      }
       offset = patcher_->ReserveSpace(offset, compiled_method.get(), compiled_method_refs_[idx]);
 
       uint32_t alignment_size = CodeAlignmentSize(offset);
@@ -156,8 +172,15 @@ class RelativePatcherTest : public testing::Test {
     };
     uint8_t fake_header[sizeof(OatQuickMethodHeader)];
     memset(fake_header, 0, sizeof(fake_header));
+    idx = 0u;
     for (auto& compiled_method : compiled_methods_) {
       offset = patcher_->WriteThunks(out_.get(), offset);
+      if (gap_alignments_[idx] != 0u) {
+        std::vector<uint8_t> gap(RoundUp(offset, gap_alignments_[idx]) - offset, 0u);
+        out_->WriteFully(gap.data(), gap.size());
+        offset += gap.size();
+      }
+      ++idx;
 
       uint32_t alignment_size = CodeAlignmentSize(offset);
       CHECK_LE(alignment_size, sizeof(kPadding));
@@ -403,6 +426,8 @@ class RelativePatcherTest : public testing::Test {
   SafeMap<uint32_t, uint32_t> method_index_to_offset_map_;
   std::vector<MethodReference> compiled_method_refs_;
   std::vector<std::unique_ptr<CompiledMethod>> compiled_methods_;
+  std::vector<uint32_t> gap_alignments_;  // Indexed like `compiled_methods_`, 0 for no gap.
+  uint32_t next_gap_alignment_ = 0u;
   std::vector<uint8_t> patched_code_;
   std::vector<uint8_t> output_;
   std::unique_ptr<VectorOutputStream> out_;
@@ -19,6 +19,7 @@
 #include <sys/mman.h>
 
 #include <algorithm>
+#include <atomic>
 #include <numeric>
 
 #include "base/bit_utils.h"
@@ -32,6 +33,17 @@ namespace art {
 // The chunk size by which the swap file is increased and mapped.
 static constexpr size_t kMinimumMapSize = 16 * MB;
 
+// The size of the per-thread allocation buffers. Larger allocations bypass the buffers.
+static constexpr size_t kThreadBufferSize = 256 * KB;
+static constexpr size_t kMaxThreadBufferAllocation = kThreadBufferSize / 4;
+
+// The number of bytes handed out between page-outs of the swap file.
+static constexpr size_t kEvictionInterval = 64 * MB;
+
+static std::atomic<uint64_t> gNextSwapSpaceId(1u);
+
+thread_local SwapSpace::ThreadBuffer SwapSpace::thread_buffer_ = { 0u, nullptr, nullptr };
+
 static constexpr bool kCheckFreeMaps = false;
 
 template <typename FreeBySizeSet>
@@ -61,8 +73,12 @@ inline void SwapSpace::InsertChunk(const SpaceChunk& chunk) {
 }
 
 SwapSpace::SwapSpace(int fd, size_t initial_size)
-    : fd_(fd),
+    : id_(gNextSwapSpaceId.fetch_add(1u, std::memory_order_relaxed)),
+      fd_(fd),
       size_(0),
+      allocated_since_eviction_(0u),
+      eviction_pending_(false),
+      eviction_supported_(true),
       lock_("SwapSpace lock", static_cast<LockLevel>(LockLevel::kDefaultMutexLevel - 1)) {
   // Assume that the file is unlinked.
 
@@ -70,9 +86,9 @@ SwapSpace::SwapSpace(int fd, size_t initial_size)
 }
 
 SwapSpace::~SwapSpace() {
-  // Unmap all mmapped chunks. Nothing should be allocated anymore at
-  // this point, so there should be only full size chunks in free_by_start_.
-  for (const SpaceChunk& chunk : free_by_start_) {
+  // Unmap all mmapped chunks. Nothing should be allocated anymore at this point
+  // but thread buffers may still hold unused parts of the mappings.
+  for (const SpaceChunk& chunk : maps_) {
     if (munmap(chunk.ptr, chunk.size) != 0) {
       PLOG(ERROR) << "Failed to unmap swap space chunk at "
           << static_cast<const void*>(chunk.ptr) << " size=" << chunk.size;
@@ -107,8 +123,68 @@ static size_t CollectFree(const FreeByStartSet& free_by_start, const FreeBySizeS
 }
 
 void* SwapSpace::Alloc(size_t size) {
-  MutexLock lock(Thread::Current(), lock_);
   size = RoundUp(size, 8U);
+  if (size <= kMaxThreadBufferAllocation) {
+    ThreadBuffer* buffer = &thread_buffer_;
+    if (buffer->space_id == id_ && static_cast<size_t>(buffer->end - buffer->pos) >= size) {
+      void* result = buffer->pos;
+      buffer->pos += size;
+      return result;
+    }
+    return RefillThreadBuffer(buffer, size);
+  }
+  void* result;
+  {
+    MutexLock lock(Thread::Current(), lock_);
+    result = AllocLocked(size);
+  }
+  MaybeEvict();
+  return result;
+}
+
+void* SwapSpace::RefillThreadBuffer(ThreadBuffer* buffer, size_t size) {
+  DCHECK_LE(size, kThreadBufferSize);
+  uint8_t* start;
+  {
+    MutexLock lock(Thread::Current(), lock_);
+    if (buffer->space_id == id_ && buffer->pos != buffer->end) {
+      // Return the unused rest of the old buffer.
+      FreeLocked(SpaceChunk { buffer->pos, static_cast<size_t>(buffer->end - buffer->pos) });
+    }
+    // Free chunks smaller than a thread buffer are never used for refills or large
+    // allocations. Use the smallest one that fits as the new buffer, so that the memory freed
+    // by small allocations is reused instead of fragmenting the file.
+    auto it = free_by_start_.empty()
+        ? free_by_size_.end()
+        : free_by_size_.lower_bound(FreeBySizeEntry { size, free_by_start_.begin() });
+    size_t buffer_size = kThreadBufferSize;
+    if (it != free_by_size_.end() && it->size < kThreadBufferSize) {
+      SpaceChunk chunk = *it->free_by_start_entry;
+      RemoveChunk(it);
+      CountAllocatedLocked(chunk.size);
+      start = chunk.ptr;
+      buffer_size = chunk.size;
+    } else {
+      start = reinterpret_cast<uint8_t*>(AllocLocked(kThreadBufferSize));
+    }
+    buffer->space_id = id_;
+    buffer->pos = start + size;
+    buffer->end = start + buffer_size;
+  }
+  MaybeEvict();
+  return start;
+}
+
+void SwapSpace::CountAllocatedLocked(size_t size) {
+  allocated_since_eviction_ += size;
+  if (allocated_since_eviction_ >= kEvictionInterval) {
+    allocated_since_eviction_ = 0u;
+    eviction_pending_.store(true, std::memory_order_relaxed);
+  }
+}
+
+void* SwapSpace::AllocLocked(size_t size) {
+  CountAllocatedLocked(size);
 
   // Check the free list for something that fits.
   // TODO: Smarter implementation. Global biggest chunk, ...
@@ -165,6 +241,7 @@ SwapSpace::SpaceChunk SwapSpace::NewFileChunk(size_t min_size) {
   }
   size_ += next_part;
   SpaceChunk new_chunk = {ptr, next_part};
+  maps_.push_back(new_chunk);
   return new_chunk;
 #else
   UNUSED(min_size, kMinimumMapSize);
@@ -173,17 +250,25 @@ SwapSpace::SpaceChunk SwapSpace::NewFileChunk(size_t min_size) {
 #endif
 }
 
-// TODO: Full coalescing.
 void SwapSpace::Free(void* ptr, size_t size) {
   MutexLock lock(Thread::Current(), lock_);
   size = RoundUp(size, 8U);
+  FreeLocked(SpaceChunk { reinterpret_cast<uint8_t*>(ptr), size });
+}
+
+// TODO: Full coalescing.
+void SwapSpace::FreeLocked(const SpaceChunk& freed_chunk) {
+  size_t size = freed_chunk.size;
+  if (size == 0u) {
+    return;
+  }
 
   size_t free_before = 0;
   if (kCheckFreeMaps) {
     free_before = CollectFree(free_by_start_, free_by_size_);
   }
 
-  SpaceChunk chunk = { reinterpret_cast<uint8_t*>(ptr), size };
+  SpaceChunk chunk = freed_chunk;
   auto it = free_by_start_.lower_bound(chunk);
   if (it != free_by_start_.begin()) {
     auto prev = it;
@@ -222,4 +307,40 @@ void SwapSpace::Free(void* ptr, size_t size) {
   }
 }
 
+void SwapSpace::MaybeEvict() {
+  if (LIKELY(!eviction_pending_.load(std::memory_order_relaxed))) {
+    return;
+  }
+  Evict();
+}
+
+void SwapSpace::Evict() {
+  std::vector<SpaceChunk> maps;
+  {
+    MutexLock lock(Thread::Current(), lock_);
+    allocated_since_eviction_ = 0u;
+    eviction_pending_.store(false, std::memory_order_relaxed);
+    if (!eviction_supported_) {
+      return;
+    }
+    // Mappings are only unmapped by the destructor, so the snapshot stays valid.
+    maps = maps_;
+  }
+#if defined(MADV_PAGEOUT)
+  // Writing back the dirty pages can take a while, do not block allocations meanwhile.
+  for (const SpaceChunk& map : maps) {
+    if (madvise(map.ptr, map.size, MADV_PAGEOUT) != 0) {
+      // MADV_PAGEOUT is supported only since Linux 5.4.
+      PLOG(WARNING) << "Unable to page out swap file, continuing without eviction";
+      MutexLock lock(Thread::Current(), lock_);
+      eviction_supported_ = false;
+      return;
+    }
+  }
+#else
+  MutexLock lock(Thread::Current(), lock_);
+  eviction_supported_ = false;
+#endif
+}
+
 }  // namespace art
@@ -19,6 +19,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <atomic>
 #include <cstdlib>
 #include <list>
 #include <set>
@@ -33,6 +34,14 @@
 namespace art {
 
 // An arena pool that creates arenas backed by an mmaped file.
+//
+// Small allocations are bump-allocated without locking from a buffer owned by the
+// allocating thread, so that the data of each thread is written sequentially to the file.
+// Freed memory is kept in free lists that are used for refilling the thread buffers and for
+// large allocations. Free chunks smaller than a thread buffer become thread buffers of their
+// own. Every `kEvictionInterval` bytes handed out, the mapped file is paged out with
+// MADV_PAGEOUT outside of the lock, so that the resident memory used by the swap space stays
+// bounded regardless of how much data is swapped.
 class SwapSpace {
  public:
   SwapSpace(int fd, size_t initial_size);
@@ -40,6 +49,10 @@ class SwapSpace {
   void* Alloc(size_t size) REQUIRES(!lock_);
   void Free(void* ptr, size_t size) REQUIRES(!lock_);
 
+  // Write the dirty pages of the mapped file back to the file and drop them from memory.
+  // The data stays accessible and is read back from the file on the next access.
+  void Evict() REQUIRES(!lock_);
+
   size_t GetSize() {
     return size_;
   }
@@ -90,14 +103,42 @@ class SwapSpace {
   };
   using FreeBySizeSet = std::set<FreeBySizeEntry, FreeBySizeComparator>;
 
+  // Per-thread buffer for lock-free bump allocation.
+  struct ThreadBuffer {
+    // The `id_` of the SwapSpace that owns the buffer.
+    uint64_t space_id;
+    uint8_t* pos;
+    uint8_t* end;
+  };
+
+  void* AllocLocked(size_t size) REQUIRES(lock_);
+  void FreeLocked(const SpaceChunk& chunk) REQUIRES(lock_);
+  void* RefillThreadBuffer(ThreadBuffer* buffer, size_t size) REQUIRES(!lock_);
+  void CountAllocatedLocked(size_t size) REQUIRES(lock_);
+  void MaybeEvict() REQUIRES(!lock_);
+
   SpaceChunk NewFileChunk(size_t min_size) REQUIRES(lock_);
 
   void RemoveChunk(FreeBySizeSet::const_iterator free_by_size_pos) REQUIRES(lock_);
   void InsertChunk(const SpaceChunk& chunk) REQUIRES(lock_);
 
+  static thread_local ThreadBuffer thread_buffer_;
+
+  // Unique id of this SwapSpace, used to recognize the thread buffers it owns.
+  const uint64_t id_;
   int fd_;
   size_t size_;
 
+  // All mappings of the swap file.
+  std::vector<SpaceChunk> maps_ GUARDED_BY(lock_);
+
+  // Bytes handed out since the last eviction.
+  size_t allocated_since_eviction_ GUARDED_BY(lock_);
+  // Whether `kEvictionInterval` bytes were handed out and the next allocation should evict.
+  std::atomic<bool> eviction_pending_;
+  // Whether the kernel supports MADV_PAGEOUT.
+  bool eviction_supported_ GUARDED_BY(lock_);
+
   // NOTE: Boost.Bimap would be useful for the two following members.
 
   // Map start of a free chunk to its size.
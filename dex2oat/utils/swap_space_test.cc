@@ -21,6 +21,9 @@
 #include <sys/types.h>
 
 #include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -79,4 +82,80 @@ TEST_F(SwapSpaceTest, Swap) {
   SwapTest(true);
 }
 
+TEST_F(SwapSpaceTest, ThreadBuffersAndEviction) {
+  ScratchFile scratch;
+  int fd = scratch.GetFd();
+  unlink(scratch.GetFilename().c_str());
+
+  SwapSpace pool(fd, 1 * MB);
+  static constexpr size_t kNumThreads = 4u;
+  static constexpr size_t kNumAllocations = 10000u;
+  struct Allocation {
+    uint8_t* ptr;
+    size_t size;
+    uint8_t value;
+  };
+  std::vector<std::vector<Allocation>> allocations(kNumThreads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t != kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i != kNumAllocations; ++i) {
+        // Mix small allocations from the thread buffer with large ones.
+        size_t size = (i % 100u == 0u) ? 128 * KB + i : 1u + i % 200u;
+        uint8_t* ptr = reinterpret_cast<uint8_t*>(pool.Alloc(size));
+        uint8_t value = static_cast<uint8_t>(t * 31u + i);
+        memset(ptr, value, size);
+        allocations[t].push_back({ptr, size, value});
+        if (i % 3u == 0u) {
+          pool.Free(ptr, size);
+          allocations[t].pop_back();
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  // The data is read back from the file after eviction.
+  pool.Evict();
+  for (size_t t = 0; t != kNumThreads; ++t) {
+    for (const Allocation& allocation : allocations[t]) {
+      for (size_t i = 0; i != allocation.size; ++i) {
+        ASSERT_EQ(allocation.value, allocation.ptr[i]);
+      }
+      pool.Free(allocation.ptr, allocation.size);
+    }
+  }
+
+  scratch.Close();
+}
+
+TEST_F(SwapSpaceTest, SmallFreeChunksReused) {
+  ScratchFile scratch;
+  int fd = scratch.GetFd();
+  unlink(scratch.GetFilename().c_str());
+
+  SwapSpace pool(fd, 1 * MB);
+  // The first small allocation gets a thread buffer, the large ones come after it.
+  void* small = pool.Alloc(100u);
+  void* large1 = pool.Alloc(100 * KB);
+  void* large2 = pool.Alloc(100 * KB);
+  // Free the first large allocation, leaving a chunk smaller than a thread buffer.
+  pool.Free(large1, 100 * KB);
+
+  // Exhaust the thread buffer with small allocations. The refill reuses the small free chunk
+  // instead of taking a new buffer after the second large allocation.
+  void* last = nullptr;
+  for (size_t i = 0; i != 4u; ++i) {
+    last = pool.Alloc(64 * KB);
+  }
+  EXPECT_LT(reinterpret_cast<uintptr_t>(last), reinterpret_cast<uintptr_t>(large2));
+
+  pool.Free(last, 64 * KB);
+  pool.Free(large2, 100 * KB);
+  pool.Free(small, 100u);
+  scratch.Close();
+}
+
 }  // namespace art
@@ -34,6 +34,7 @@
 #include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread.h"
+#include "thread_pool.h"
 #include "utils/atomic_dex_ref_map-inl.h"
 #include "verifier/method_verifier-inl.h"
 
@@ -367,6 +368,30 @@ TEST_F(VerifierDepsTest, StringToId) {
   ASSERT_NE(id_Main1, id_Lorem1);
 }
 
+TEST_F(VerifierDepsTest, SortExtraStrings) {
+  ScopedObjectAccess soa(Thread::Current());
+  LoadDexFile(soa);
+
+  // Record extra strings in reverse order.
+  const DexFile& dex_file = *primary_dex_file_;
+  dex::StringIndex id_b = verifier_deps_->GetIdFromString(dex_file, "Lorem ipsum b");
+  dex::StringIndex id_a = verifier_deps_->GetIdFromString(dex_file, "Lorem ipsum a");
+  dex::StringIndex id_Main = verifier_deps_->GetIdFromString(dex_file, "LMain;");
+  ASSERT_GT(id_a, id_b);
+  auto& assignable_types = verifier_deps_->GetDexFileDeps(dex_file)->assignable_types_;
+  assignable_types[0].emplace(id_b, id_Main);
+  assignable_types[0].emplace(id_Main, id_a);
+
+  verifier_deps_->SortExtraStrings(dex_files_);
+  uint32_t num_ids_in_dex = dex_file.NumStringIds();
+  EXPECT_EQ(dex::StringIndex(num_ids_in_dex),
+            verifier_deps_->GetIdFromString(dex_file, "Lorem ipsum a"));
+  EXPECT_EQ(dex::StringIndex(num_ids_in_dex + 1u),
+            verifier_deps_->GetIdFromString(dex_file, "Lorem ipsum b"));
+  EXPECT_TRUE(HasAssignable("Lorem ipsum b", "LMain;"));
+  EXPECT_TRUE(HasAssignable("LMain;", "Lorem ipsum a"));
+}
+
 TEST_F(VerifierDepsTest, Assignable_BothInBoot) {
   ASSERT_TRUE(TestAssignabilityRecording(/* dst= */ "Ljava/util/TimeZone;",
                                          /* src= */ "Ljava/util/SimpleTimeZone;"));
@@ -519,6 +544,21 @@ TEST_F(VerifierDepsTest, EncodeDecodeMulti) {
   decoded_deps.Dump(&os);
 }
 
+TEST_F(VerifierDepsTest, EncodeParallel) {
+  VerifyDexFile("MultiDex");
+
+  ASSERT_GT(NumberOfCompiledDexFiles(), 1u);
+  std::vector<uint8_t> buffer;
+  verifier_deps_->Encode(dex_files_, &buffer);
+  ASSERT_FALSE(buffer.empty());
+
+  // Encoding with a thread pool produces the same data.
+  std::unique_ptr<ThreadPool> thread_pool(ThreadPool::Create("Verifier deps test pool", 2u));
+  std::vector<uint8_t> parallel_buffer;
+  verifier_deps_->Encode(dex_files_, &parallel_buffer, thread_pool.get());
+  ASSERT_EQ(buffer, parallel_buffer);
+}
+
 TEST_F(VerifierDepsTest, UnverifiedClasses) {
   VerifyDexFile();
   ASSERT_FALSE(HasUnverifiedClass("LMyThread;"));
@@ -55,6 +55,10 @@ static constexpr size_t kMaxPageSize = kMinPageSize;
 // this is the value to be used in images files for aligning contents to page size.
 static constexpr size_t kElfSegmentAlignment = kMaxPageSize;
 
+// Size of a transparent huge page (PMD-sized). Code that should be mapped with huge pages
+// is aligned to this size both in the file and in memory.
+static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
 // Clion, clang analyzer, etc can falsely believe that "if (kIsDebugBuild)" always
 // returns the same value. By wrapping into a call to another constexpr function, we force it
 // to realize that is not actually always evaluating to the same value.
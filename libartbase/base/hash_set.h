@@ -368,6 +368,18 @@ class HashSet {
     return offset;
   }
 
+  // Returns a set that shares the data of this set without owning it. The view is not affected
+  // by moving this set but the data must outlive the view and this set must not be modified
+  // in a way that reallocates the data while the view is in use.
+  HashSet MakeView() const {
+    HashSet view(min_load_factor_, max_load_factor_, hashfn_, pred_, allocfn_);
+    view.num_elements_ = num_elements_;
+    view.num_buckets_ = num_buckets_;
+    view.elements_until_expand_ = elements_until_expand_;
+    view.data_ = data_;
+    return view;
+  }
+
   ~HashSet() {
     DeallocateStorage();
   }
@@ -854,6 +866,7 @@ class HashSet {
 
   ART_FRIEND_TEST(InternTableTest, CrossHash);
   ART_FRIEND_TEST(HashSetTest, Preallocated);
+  ART_FRIEND_TEST(HashSetTest, MakeView);
 };
 
 template <class T, class EmptyFn, class HashFn, class Pred, class Alloc>
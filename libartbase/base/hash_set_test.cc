@@ -394,6 +394,23 @@ TEST_F(HashSetTest, Preallocated) {
   ASSERT_TRUE(hash_set.owns_data_);
 }
 
+TEST_F(HashSetTest, MakeView) {
+  HashSet<std::string> hash_set;
+  hash_set.insert("foo");
+  hash_set.insert("bar");
+  HashSet<std::string> view = hash_set.MakeView();
+  ASSERT_FALSE(view.owns_data_);
+  ASSERT_EQ(2u, view.size());
+  // The view still refers to the data after the set is moved.
+  HashSet<std::string> moved_set(std::move(hash_set));
+  ASSERT_TRUE(view.find("foo") != view.end());
+  ASSERT_TRUE(view.find("bar") != view.end());
+  ASSERT_TRUE(view.find("baz") == view.end());
+  // Modifications that do not reallocate the data are visible through the view.
+  moved_set.erase(moved_set.find("bar"));
+  ASSERT_TRUE(view.find("bar") == view.end());
+}
+
 class SmallIndexEmptyFn {
  public:
   void MakeEmpty(uint16_t& item) const {
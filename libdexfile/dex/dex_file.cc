@@ -216,6 +216,15 @@ bool DexFile::Init(std::string* error_msg) {
                                 expected_header_size);
       return false;
     }
+    // Dex files in a container are opened one after the other before they are verified,
+    // so make sure that each of them takes up some space.
+    if (header_->file_size_ < header_->header_size_) {
+      *error_msg = StringPrintf("Unable to open '%s' : File size is %u but the header size is %u",
+                                location_.c_str(),
+                                header_->file_size_,
+                                header_->header_size_);
+      return false;
+    }
   }
   if (container_size < header_->file_size_) {
     *error_msg = StringPrintf("Unable to open '%s' : File size is %zu but the header expects %u",
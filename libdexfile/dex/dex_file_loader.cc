@@ -18,8 +18,11 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <optional>
+#include <thread>
 
 #include "android-base/stringprintf.h"
 #include "base/bit_utils.h"
@@ -51,6 +54,9 @@ namespace {
 // seems an excessive number.
 static constexpr size_t kWarnOnManyDexFilesThreshold = 100;
 
+// Maximum number of threads used to verify the dex files of a multidex container.
+static constexpr size_t kMaxVerificationThreads = 4;
+
 using android::base::StringPrintf;
 
 class VectorContainer : public DexFileContainer {
@@ -371,13 +377,15 @@ bool DexFileLoader::Open(bool verify,
       DCHECK(!error_msg->empty());
       return false;
     }
+    // The dex files are verified in parallel once they are all open.
+    size_t first_opened_index = dex_files->size();
     size_t multidex_count = 0;
     for (size_t i = 0;; ++i) {
       std::string name = GetMultiDexClassesDexName(i);
       bool ok = OpenFromZipEntry(*zip_archive,
                                  name.c_str(),
                                  location_,
-                                 verify,
+                                 /*verify=*/ false,
                                  verify_checksum,
                                  &multidex_count,
                                  error_code,
@@ -386,9 +394,15 @@ bool DexFileLoader::Open(bool verify,
       if (!ok) {
         // We keep opening consecutive dex entries as long as we can (until entry is not found).
         if (*error_code == DexFileLoaderErrorCode::kEntryNotFound) {
+          if (!VerifyOpenedDexFiles(
+                  verify, verify_checksum, first_opened_index, error_code, error_msg, dex_files)) {
+            return false;
+          }
           // Success if we loaded at least one entry, or if empty zip is explicitly allowed.
           return i > 0 || allow_no_dex_files;
         }
+        VerifyOpenedDexFiles(
+            verify, verify_checksum, first_opened_index, error_code, error_msg, dex_files);
         return false;
       }
       if (i == kWarnOnManyDexFilesThreshold) {
@@ -403,6 +417,8 @@ bool DexFileLoader::Open(bool verify,
       return false;
     }
     DCHECK(root_container_ != nullptr);
+    // The dex files are verified in parallel once they are all open.
+    size_t first_opened_index = dex_files->size();
     size_t header_offset = 0;
     for (size_t i = 0;; i++) {
       std::string multidex_location = GetMultiDexLocation(i, location_.c_str());
@@ -413,11 +429,13 @@ bool DexFileLoader::Open(bool verify,
                      multidex_location,
                      /*location_checksum*/ {},  // Use default checksum from dex header.
                      /*oat_dex_file=*/nullptr,
-                     verify,
+                     /*verify=*/ false,
                      verify_checksum,
                      error_msg,
                      error_code);
       if (dex_file == nullptr) {
+        VerifyOpenedDexFiles(
+            verify, verify_checksum, first_opened_index, error_code, error_msg, dex_files);
         return false;
       }
       dex_files->push_back(std::move(dex_file));
@@ -428,7 +446,8 @@ bool DexFileLoader::Open(bool verify,
         break;
       }
     }
-    return true;
+    return VerifyOpenedDexFiles(
+        verify, verify_checksum, first_opened_index, error_code, error_msg, dex_files);
   }
   *error_msg = StringPrintf("Expected valid zip or dex file");
   return false;
@@ -490,6 +509,90 @@ std::unique_ptr<DexFile> DexFileLoader::OpenCommon(std::shared_ptr<DexFileContai
   return dex_file;
 }
 
+bool DexFileLoader::VerifyDexFiles(ArrayRef<const std::unique_ptr<const DexFile>> dex_files,
+                                   bool verify_checksum,
+                                   /*out*/ size_t* num_verified,
+                                   /*out*/ std::string* error_msg) {
+  const size_t num_dex_files = dex_files.size();
+  if (num_dex_files == 0u) {
+    *num_verified = 0u;
+    return true;
+  }
+  std::vector<std::string> error_msgs(num_dex_files);
+  std::atomic<size_t> next_index(0u);
+  std::atomic<size_t> first_failed_index(num_dex_files);
+  auto verify = [&]() {
+    while (true) {
+      size_t index = next_index.fetch_add(1u, std::memory_order_relaxed);
+      // Once a dex file failed verification, the dex files after it do not need verifying.
+      size_t failed_index = first_failed_index.load(std::memory_order_relaxed);
+      if (index >= failed_index) {
+        return;
+      }
+      const DexFile* dex_file = dex_files[index].get();
+      // NB: Dex verifier does not understand the compact dex format.
+      if (dex_file->IsCompactDexFile()) {
+        continue;
+      }
+      DEXFILE_SCOPED_TRACE(std::string("Verify dex file ") + dex_file->GetLocation());
+      if (!dex::Verify(
+              dex_file, dex_file->GetLocation().c_str(), verify_checksum, &error_msgs[index])) {
+        while (index < failed_index &&
+               !first_failed_index.compare_exchange_weak(failed_index, index)) {
+          // Retry with the reloaded `failed_index`.
+        }
+      }
+    }
+  };
+  // The calling thread verifies too, so one thread fewer is started.
+  size_t num_threads = std::min<size_t>(
+      {num_dex_files, kMaxVerificationThreads, std::max(std::thread::hardware_concurrency(), 1u)});
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1u);
+  for (size_t i = 1u; i < num_threads; ++i) {
+    threads.emplace_back(verify);
+  }
+  verify();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  // All dex files before the first failed one have been verified successfully, so the error is
+  // the same as if the dex files were verified one at a time in order.
+  *num_verified = first_failed_index.load(std::memory_order_relaxed);
+  if (*num_verified != num_dex_files) {
+    *error_msg = std::move(error_msgs[*num_verified]);
+    return false;
+  }
+  return true;
+}
+
+bool DexFileLoader::VerifyOpenedDexFiles(
+    bool verify,
+    bool verify_checksum,
+    size_t first_opened_index,
+    /*inout*/ DexFileLoaderErrorCode* error_code,
+    /*inout*/ std::string* error_msg,
+    /*inout*/ std::vector<std::unique_ptr<const DexFile>>* dex_files) {
+  DCHECK_LE(first_opened_index, dex_files->size());
+  if (!verify || first_opened_index == dex_files->size()) {
+    return true;
+  }
+  size_t num_verified;
+  std::string verify_error_msg;
+  if (!VerifyDexFiles(ArrayRef<const std::unique_ptr<const DexFile>>(*dex_files)
+                          .SubArray(first_opened_index),
+                      verify_checksum,
+                      &num_verified,
+                      &verify_error_msg)) {
+    // Keep only the dex files that would have been opened if each was verified when opened.
+    dex_files->resize(first_opened_index + num_verified);
+    *error_code = DexFileLoaderErrorCode::kVerifyError;
+    *error_msg = std::move(verify_error_msg);
+    return false;
+  }
+  return true;
+}
+
 bool DexFileLoader::OpenFromZipEntry(const ZipArchive& zip_archive,
                                      const char* entry_name,
                                      const std::string& location,
@@ -528,8 +631,9 @@ bool DexFileLoader::OpenFromZipEntry(const ZipArchive& zip_archive,
         LOG(WARNING) << "Can't mmap dex file " << location << "!" << entry_name << " directly; "
                      << "is your ZIP file corrupted? Falling back to extraction.";
         // Try again with Extraction which still has a chance of recovery.
+      } else {
+        is_file_map = true;
       }
-      is_file_map = true;
     }
   }
   if (!map.IsValid()) {
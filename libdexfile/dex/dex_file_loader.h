@@ -25,6 +25,7 @@
 #include <string_view>
 #include <vector>
 
+#include "base/array_ref.h"
 #include "base/os.h"
 #include "base/unix_file/fd_file.h"
 #include "dex_file.h"
@@ -264,6 +265,14 @@ class DexFileLoader {
                 dex_files);
   }
 
+  // Verify dex files in parallel on a few threads. On failure, `num_verified`
+  // is the index of the first dex file that failed verification and `error_msg` its error,
+  // exactly as if the dex files were verified one at a time in order.
+  static bool VerifyDexFiles(ArrayRef<const std::unique_ptr<const DexFile>> dex_files,
+                             bool verify_checksum,
+                             /*out*/ size_t* num_verified,
+                             /*out*/ std::string* error_msg);
+
  protected:
   static const File kInvalidFile;  // Used for "no file descriptor" (-1).
 
@@ -310,6 +319,16 @@ class DexFileLoader {
                                              std::unique_ptr<DexFileContainer> container,
                                              VerifyResult* verify_result);
 
+  // Verify the dex files opened by `Open()` from `first_opened_index` onwards, if `verify`.
+  // On failure, drop the dex files starting with the first one that failed verification.
+  static bool VerifyOpenedDexFiles(
+      bool verify,
+      bool verify_checksum,
+      size_t first_opened_index,
+      /*inout*/ DexFileLoaderErrorCode* error_code,
+      /*inout*/ std::string* error_msg,
+      /*inout*/ std::vector<std::unique_ptr<const DexFile>>* dex_files);
+
   // Open .dex files from the entry_name in a zip archive.
   bool OpenFromZipEntry(const ZipArchive& zip_archive,
                         const char* entry_name,
@@ -23,6 +23,7 @@
 #include "descriptors_names.h"
 #include "dex_file-inl.h"
 #include "dex_file_loader.h"
+#include "dex_file_verifier.h"
 #include "gtest/gtest.h"
 
 namespace art {
@@ -673,4 +674,51 @@ TEST_F(DexFileLoaderTest, FileSizeTooSmallInHeader) {
   OpenAndVerify(kFileSizeTooSmallInHeader, /*expected_success=*/false);
 }
 
+
+TEST_F(DexFileLoaderTest, VerifyDexFilesReportsFirstFailure) {
+  std::vector<uint8_t> good_bytes;
+  std::vector<uint8_t> bad_bytes1;
+  std::vector<uint8_t> bad_bytes2;
+  DecodeDexFile(kRawDex, &good_bytes);
+  DecodeDexFile(kRawDexCodeItemOOB, &bad_bytes1);
+  DecodeDexFile(kRawDexStringDataOOB, &bad_bytes2);
+  std::vector<std::unique_ptr<const DexFile>> dex_files;
+  auto open = [&](std::vector<uint8_t>* bytes, const std::string& location) {
+    std::string error_msg;
+    DexFileLoader dex_file_loader(bytes->data(), bytes->size(), location);
+    std::unique_ptr<const DexFile> dex_file = dex_file_loader.Open(/*location_checksum=*/ 0u,
+                                                                   /*verify=*/ false,
+                                                                   /*verify_checksum=*/ true,
+                                                                   &error_msg);
+    ASSERT_TRUE(dex_file != nullptr) << error_msg;
+    dex_files.push_back(std::move(dex_file));
+  };
+  for (size_t i = 0; i != 8u; ++i) {
+    open(&good_bytes, "good" + std::to_string(i));
+  }
+  std::string error_msg;
+  size_t num_verified;
+  ASSERT_TRUE(DexFileLoader::VerifyDexFiles(
+      ArrayRef<const std::unique_ptr<const DexFile>>(dex_files),
+      /*verify_checksum=*/ true,
+      &num_verified,
+      &error_msg)) << error_msg;
+  EXPECT_EQ(8u, num_verified);
+
+  // The error is the one of the first bad dex file, whichever thread verifies it.
+  open(&bad_bytes1, "bad1");
+  open(&good_bytes, "good8");
+  open(&bad_bytes2, "bad2");
+  std::string expected_error_msg;
+  ASSERT_FALSE(dex::Verify(
+      dex_files[8].get(), "bad1", /*verify_checksum=*/ true, &expected_error_msg));
+  ASSERT_FALSE(DexFileLoader::VerifyDexFiles(
+      ArrayRef<const std::unique_ptr<const DexFile>>(dex_files),
+      /*verify_checksum=*/ true,
+      &num_verified,
+      &error_msg));
+  EXPECT_EQ(8u, num_verified);
+  EXPECT_EQ(expected_error_msg, error_msg);
+}
+
 }  // namespace art
@@ -16,10 +16,19 @@
 
 #include "utf.h"
 
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
 
+#include "base/bit_utils.h"
 #include "base/casts.h"
 #include "utf-inl.h"
 
@@ -27,6 +36,93 @@ namespace art {
 
 using android::base::StringAppendF;
 
+// The vectorized helpers below use SSE2 on x86-64 and NEON on arm64, which are part of the
+// baseline of these architectures, so there is no need to check the CPU features at runtime.
+// Other architectures use 8-byte words.
+
+// Returns the number of leading ASCII bytes in `[utf8, utf8 + byte_count)`.
+static inline size_t CountAsciiPrefix(const char* utf8, size_t byte_count) {
+  size_t i = 0u;
+#if defined(__SSE2__)
+  for (; byte_count - i >= 16u; i += 16u) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8 + i));
+    uint32_t non_ascii_mask = static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+    if (non_ascii_mask != 0u) {
+      return i + CTZ(non_ascii_mask);
+    }
+  }
+#elif defined(__aarch64__)
+  for (; byte_count - i >= 16u; i += 16u) {
+    uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(utf8 + i));
+    if (vmaxvq_u8(bytes) >= 0x80u) {
+      break;  // Find the non-ASCII byte below.
+    }
+  }
+#endif
+  for (; byte_count - i >= 8u; i += 8u) {
+    uint64_t word;
+    memcpy(&word, utf8 + i, sizeof(word));
+    uint64_t non_ascii_bits = word & UINT64_C(0x8080808080808080);
+    if (non_ascii_bits != 0u) {
+      // Little-endian, the first non-ASCII byte has the lowest set bit.
+      return i + CTZ(non_ascii_bits) / 8u;
+    }
+  }
+  for (; i != byte_count; ++i) {
+    if ((static_cast<uint8_t>(utf8[i]) & 0x80u) != 0u) {
+      break;
+    }
+  }
+  return i;
+}
+
+// Widens `count` ASCII bytes to UTF-16.
+static inline void ConvertAsciiToUtf16(uint16_t* utf16_out, const char* ascii_in, size_t count) {
+  size_t i = 0u;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; count - i >= 16u; i += 16u) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ascii_in + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(utf16_out + i), _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(utf16_out + i + 8u),
+                     _mm_unpackhi_epi8(bytes, zero));
+  }
+#elif defined(__aarch64__)
+  for (; count - i >= 16u; i += 16u) {
+    uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(ascii_in + i));
+    vst1q_u16(utf16_out + i, vmovl_u8(vget_low_u8(bytes)));
+    vst1q_u16(utf16_out + i + 8u, vmovl_high_u8(bytes));
+  }
+#endif
+  for (; i != count; ++i) {
+    // Safe even if char is signed because ASCII characters always have
+    // the high bit cleared.
+    utf16_out[i] = dchecked_integral_cast<uint16_t>(ascii_in[i]);
+  }
+}
+
+// Narrows `count` UTF-16 characters in the ASCII range to bytes.
+static inline void ConvertUtf16ToAscii(char* ascii_out, const uint16_t* utf16_in, size_t count) {
+  size_t i = 0u;
+#if defined(__SSE2__)
+  for (; count - i >= 16u; i += 16u) {
+    __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf16_in + i));
+    __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf16_in + i + 8u));
+    // The characters are below 0x80, so the unsigned saturation does not change them.
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ascii_out + i), _mm_packus_epi16(low, high));
+  }
+#elif defined(__aarch64__)
+  for (; count - i >= 16u; i += 16u) {
+    uint16x8_t low = vld1q_u16(utf16_in + i);
+    uint16x8_t high = vld1q_u16(utf16_in + i + 8u);
+    vst1q_u8(reinterpret_cast<uint8_t*>(ascii_out + i), vmovn_high_u16(vmovn_u16(low), high));
+  }
+#endif
+  for (; i != count; ++i) {
+    ascii_out[i] = dchecked_integral_cast<char>(utf16_in[i]);
+  }
+}
+
 // This is used only from debugger and test code.
 size_t CountModifiedUtf8Chars(const char* utf8) {
   return CountModifiedUtf8Chars(utf8, strlen(utf8));
@@ -53,11 +149,15 @@ size_t CountModifiedUtf8Chars(const char* utf8, size_t byte_count) {
   const char* end = utf8 + byte_count;
   for (; utf8 < end; ++utf8) {
     int ic = *utf8;
-    len++;
     if (LIKELY((ic & 0x80) == 0)) {
-      // One-byte encoding.
+      // One-byte encoding. Skip the following one-byte encodings in bulk.
+      size_t ascii_count = CountAsciiPrefix(utf8, end - utf8);
+      DCHECK_NE(ascii_count, 0u);
+      len += ascii_count;
+      utf8 += ascii_count - 1u;
       continue;
     }
+    len++;
     // Two- or three-byte encoding.
     utf8++;
     if ((ic & 0x20) == 0) {
@@ -100,16 +200,15 @@ void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_data_out, size_t out_chars,
 
   if (LIKELY(out_chars == in_bytes)) {
     // Common case where all characters are ASCII.
-    for (const char *p = in_start; p < in_end;) {
-      // Safe even if char is signed because ASCII characters always have
-      // the high bit cleared.
-      *out_p++ = dchecked_integral_cast<uint16_t>(*p++);
-    }
+    ConvertAsciiToUtf16(out_p, in_start, in_bytes);
     return;
   }
 
-  // String contains non-ASCII characters.
-  for (const char *p = in_start; p < in_end;) {
+  // String contains non-ASCII characters. Convert the ASCII prefix in bulk.
+  size_t ascii_count = CountAsciiPrefix(in_start, in_bytes);
+  ConvertAsciiToUtf16(out_p, in_start, ascii_count);
+  out_p += ascii_count;
+  for (const char *p = in_start + ascii_count; p < in_end;) {
     const uint32_t ch = GetUtf16FromUtf8(&p);
     const uint16_t leading = GetLeadingUtf16Char(ch);
     const uint16_t trailing = GetTrailingUtf16Char(ch);
@@ -125,10 +224,7 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
                                 const uint16_t* utf16_in, size_t char_count) {
   if (LIKELY(byte_count == char_count)) {
     // Common case where all characters are ASCII.
-    const uint16_t *utf16_end = utf16_in + char_count;
-    for (const uint16_t *p = utf16_in; p < utf16_end;) {
-      *utf8_out++ = dchecked_integral_cast<char>(*p++);
-    }
+    ConvertUtf16ToAscii(utf8_out, utf16_in, char_count);
     return;
   }
 
@@ -158,12 +254,8 @@ int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8, size_t utf16_length)
 }
 
 uint32_t ComputeModifiedUtf8Hash(const char* chars) {
-  uint32_t hash = StartModifiedUtf8Hash();
-  while (*chars != '\0') {
-    hash = UpdateModifiedUtf8Hash(hash, *chars);
-    ++chars;
-  }
-  return hash;
+  // Find the length first, so that the hash can be computed several characters at a time.
+  return ComputeModifiedUtf8Hash(std::string_view(chars));
 }
 
 uint32_t ComputeModifiedUtf8Hash(std::string_view chars) {
@@ -130,8 +130,21 @@ inline uint32_t UpdateModifiedUtf8Hash(uint32_t hash, char c) {
 // Update a modified UTF-8 hash with characters of a `std::string_view`.
 ALWAYS_INLINE
 inline uint32_t UpdateModifiedUtf8Hash(uint32_t hash, std::string_view chars) {
-  for (char c : chars) {
-    hash = UpdateModifiedUtf8Hash(hash, c);
+  // Hash four characters at a time to shorten the dependency chain of multiply-adds.
+  // This yields the same result since unsigned arithmetic is modular.
+  constexpr uint32_t k31Pow2 = 31u * 31u;
+  constexpr uint32_t k31Pow3 = k31Pow2 * 31u;
+  constexpr uint32_t k31Pow4 = k31Pow3 * 31u;
+  size_t i = 0u;
+  for (; chars.size() - i >= 4u; i += 4u) {
+    hash = hash * k31Pow4 +
+           static_cast<uint8_t>(chars[i]) * k31Pow3 +
+           static_cast<uint8_t>(chars[i + 1u]) * k31Pow2 +
+           static_cast<uint8_t>(chars[i + 2u]) * 31u +
+           static_cast<uint8_t>(chars[i + 3u]);
+  }
+  for (; i != chars.size(); ++i) {
+    hash = UpdateModifiedUtf8Hash(hash, chars[i]);
   }
   return hash;
 }
@@ -17,6 +17,7 @@
 #include "utf.h"
 
 #include <map>
+#include <string>
 #include <vector>
 
 #include <android-base/stringprintf.h>
@@ -387,6 +388,39 @@ TEST_F(UtfTest, NonAscii) {
   EXPECT_EQ(static_cast<uint8_t>(kNonAsciiCharacter), hash);
 }
 
+// Check the bulk processing of ASCII characters against character-by-character conversion,
+// with a non-ASCII character at each position of strings longer than the vector width.
+TEST_F(UtfTest, AsciiFastPaths) {
+  for (size_t length = 0u; length != 70u; ++length) {
+    for (size_t non_ascii_pos = 0u; non_ascii_pos <= length; ++non_ascii_pos) {
+      std::string utf8;
+      for (size_t i = 0u; i != length; ++i) {
+        utf8 += (i == non_ascii_pos) ? "\xc3\xa9" : std::string(1u, 'a' + i % 26u);
+      }
+      std::vector<uint16_t> expected;
+      for (const char* p = utf8.c_str(); *p != '\0';) {
+        expected.push_back(GetLeadingUtf16Char(GetUtf16FromUtf8(&p)));
+      }
+      ASSERT_EQ(length, expected.size());
+      uint32_t expected_hash = StartModifiedUtf8Hash();
+      for (char c : utf8) {
+        expected_hash = UpdateModifiedUtf8Hash(expected_hash, c);
+      }
+
+      EXPECT_EQ(length, CountModifiedUtf8Chars(utf8.c_str(), utf8.size()));
+      std::vector<uint16_t> utf16(length);
+      ConvertModifiedUtf8ToUtf16(utf16.data(), length, utf8.c_str(), utf8.size());
+      EXPECT_EQ(expected, utf16);
+      ASSERT_EQ(utf8.size(), CountModifiedUtf8BytesInUtf16(utf16.data(), length));
+      std::string converted(utf8.size(), '\0');
+      ConvertUtf16ToModifiedUtf8(converted.data(), converted.size(), utf16.data(), length);
+      EXPECT_EQ(utf8, converted);
+      EXPECT_EQ(expected_hash, ComputeModifiedUtf8Hash(utf8.c_str()));
+      EXPECT_EQ(expected_hash, ComputeModifiedUtf8Hash(std::string_view(utf8)));
+    }
+  }
+}
+
 TEST_F(UtfTest, PrintableStringUtf8) {
   // Note: This is UTF-8, not Modified-UTF-8.
   const uint8_t kTestSequence[] = { 0xf0, 0x90, 0x80, 0x80, 0 };
@@ -147,6 +147,15 @@ class ElfBuilder final {
       owner_->current_section_ = nullptr;
     }
 
+    // Increase the alignment of this section, both in the file and in memory, e.g. to allow
+    // mapping it with huge pages. Must be called before the section is added.
+    void SetAlignment(Elf_Word align) {
+      CHECK(!Exists());
+      CHECK(IsPowerOfTwo(align));
+      CHECK_GE(align, header_.sh_addralign);
+      header_.sh_addralign = align;
+    }
+
     // Get the number of bytes written so far.
     // Only valid while writing the section.
     Elf_Word GetPosition() const {
@@ -202,7 +211,8 @@ class ElfBuilder final {
         std::vector<Section*>& sections = owner_->sections_;
         Elf_Word last = sections.empty() ? PF_R : sections.back()->phdr_flags_;
         if (phdr_flags_ != last) {
-          header_.sh_addralign = kElfSegmentAlignment;  // Page-align if R/W/X flags changed.
+          // Page-align if R/W/X flags changed.
+          header_.sh_addralign = std::max<Elf_Word>(header_.sh_addralign, kElfSegmentAlignment);
         }
         sections.push_back(this);
         section_index_ = sections.size();  // First ELF section has index 1.
@@ -939,7 +949,7 @@ class ElfBuilder final {
           prev.p_memsz  = size;
         } else {
           // If we are adding new load, it must be aligned.
-          CHECK_EQ(shdr.sh_addralign, (Elf_Word)kElfSegmentAlignment);
+          CHECK_ALIGNED_PARAM(shdr.sh_addralign, kElfSegmentAlignment);
           phdrs.push_back(load);
         }
       }
@@ -41,16 +41,20 @@ static void XzInitCrc() {
   });
 }
 
-void XzCompress(ArrayRef<const uint8_t> src,
-                std::vector<uint8_t>* dst,
-                int level,
-                size_t block_size) {
+// Compress `src` into `dst` as a single XZ stream. The encoder configuration depends only on
+// `level`, `block_size` and `total_size`, the size of all the data being compressed, so the
+// blocks are encoded the same way whether or not they are compressed in the same stream.
+static void XzEncode(ArrayRef<const uint8_t> src,
+                     std::vector<uint8_t>* dst,
+                     int level,
+                     size_t block_size,
+                     size_t total_size) {
   // Configure the compression library.
   XzInitCrc();
   CLzma2EncProps lzma2Props;
   Lzma2EncProps_Init(&lzma2Props);
   lzma2Props.lzmaProps.level = level;
-  lzma2Props.lzmaProps.reduceSize = src.size();  // Size of data that will be compressed.
+  lzma2Props.lzmaProps.reduceSize = total_size;  // Size of data that will be compressed.
   lzma2Props.blockSize = block_size;
   Lzma2EncProps_Normalize(&lzma2Props);
   CXzProps props;
@@ -88,16 +92,109 @@ void XzCompress(ArrayRef<const uint8_t> src,
   // Compress.
   SRes res = Xz_Encode(&callbacks, &callbacks, &props, &callbacks);
   CHECK_EQ(res, SZ_OK);
+}
 
+static void XzCheckDecompressed(ArrayRef<const uint8_t> src, const std::vector<uint8_t>& dst) {
   // Decompress the data back and check that we get the original.
   if (kIsDebugBuild) {
     std::vector<uint8_t> decompressed;
-    XzDecompress(ArrayRef<const uint8_t>(*dst), &decompressed);
+    XzDecompress(ArrayRef<const uint8_t>(dst), &decompressed);
     DCHECK_EQ(decompressed.size(), src.size());
     DCHECK_EQ(memcmp(decompressed.data(), src.data(), src.size()), 0);
   }
 }
 
+void XzCompress(ArrayRef<const uint8_t> src,
+                std::vector<uint8_t>* dst,
+                int level,
+                size_t block_size) {
+  XzEncode(src, dst, level, block_size, /*total_size=*/ src.size());
+  XzCheckDecompressed(src, *dst);
+}
+
+static void XzAppendUint32(std::vector<uint8_t>* dst, uint32_t value) {
+  for (size_t i = 0; i != sizeof(uint32_t); ++i) {
+    dst->push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+void XzCompressBlocks(ArrayRef<const uint8_t> src,
+                      std::vector<uint8_t>* dst,
+                      const XzForEachBlock& for_each_block,
+                      int level,
+                      size_t block_size) {
+  size_t num_blocks = RoundUp(src.size(), block_size) / block_size;
+  if (num_blocks <= 1u) {
+    XzCompress(src, dst, level, block_size);
+    return;
+  }
+
+  // Each block is compressed into its own stream, with the same configuration as when
+  // compressing all of `src` in one stream. The XZ encoder starts every block from a clean
+  // state, so the blocks are the same as in that single stream.
+  std::vector<std::vector<uint8_t>> streams(num_blocks);
+  for_each_block(num_blocks, [&](size_t i) {
+    size_t begin = i * block_size;
+    size_t size = std::min(block_size, src.size() - begin);
+    XzEncode(src.SubArray(begin, size), &streams[i], level, block_size, src.size());
+  });
+
+  // Combine the streams: the stream header, the blocks, the index and the stream footer.
+  // See the .xz file format specification for the layout of these parts.
+  static constexpr size_t kStreamHeaderSize = 12u;
+  static constexpr size_t kStreamFooterSize = 12u;
+  std::vector<uint8_t> index;
+  index.push_back(0u);  // Index indicator.
+  EncodeUnsignedLeb128(&index, num_blocks);
+  for (size_t i = 0; i != num_blocks; ++i) {
+    const std::vector<uint8_t>& stream = streams[i];
+    CHECK_GT(stream.size(), kStreamHeaderSize + kStreamFooterSize);
+    if (i == 0u) {
+      dst->insert(dst->end(), stream.begin(), stream.begin() + kStreamHeaderSize);
+    }
+    // The backward size in the footer locates the index of the single block stream.
+    const uint8_t* footer = stream.data() + stream.size() - kStreamFooterSize;
+    uint32_t backward_size = 0u;
+    for (size_t j = 0; j != sizeof(uint32_t); ++j) {
+      backward_size |= static_cast<uint32_t>(footer[4u + j]) << (8 * j);
+    }
+    size_t index_size = (static_cast<size_t>(backward_size) + 1u) * 4u;
+    CHECK_GT(stream.size(), kStreamHeaderSize + index_size + kStreamFooterSize);
+    size_t blocks_end = stream.size() - kStreamFooterSize - index_size;
+    dst->insert(dst->end(), stream.begin() + kStreamHeaderSize, stream.begin() + blocks_end);
+    // Copy the record of the block, i.e. its unpadded and uncompressed sizes, from the index.
+    const uint8_t* record = stream.data() + blocks_end;
+    const uint8_t* index_end = record + index_size;
+    CHECK_EQ(record[0], 0u);  // Index indicator.
+    ++record;
+    uint32_t num_records;
+    CHECK(DecodeUnsignedLeb128Checked(&record, index_end, &num_records));
+    CHECK_EQ(num_records, 1u);
+    const uint8_t* record_start = record;
+    for (size_t j = 0; j != 2u; ++j) {
+      do {
+        CHECK_LT(record, index_end);
+      } while ((*record++ & 0x80u) != 0u);
+    }
+    index.insert(index.end(), record_start, record);
+  }
+  // Index padding and CRC32.
+  index.resize(RoundUp(index.size(), 4u), 0u);
+  XzAppendUint32(&index, CrcCalc(index.data(), index.size()));
+  dst->insert(dst->end(), index.begin(), index.end());
+  // Stream footer with the same stream flags as the stream header.
+  std::vector<uint8_t> footer;
+  XzAppendUint32(&footer, static_cast<uint32_t>(index.size() / 4u - 1u));
+  footer.push_back((*dst)[6]);
+  footer.push_back((*dst)[7]);
+  XzAppendUint32(dst, CrcCalc(footer.data(), footer.size()));
+  dst->insert(dst->end(), footer.begin(), footer.end());
+  dst->push_back('Y');
+  dst->push_back('Z');
+
+  XzCheckDecompressed(src, *dst);
+}
+
 void XzDecompress(ArrayRef<const uint8_t> src, std::vector<uint8_t>* dst) {
   const size_t page_size = MemMap::GetPageSize();
 
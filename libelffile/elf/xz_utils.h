@@ -17,6 +17,7 @@
 #ifndef ART_LIBELFFILE_ELF_XZ_UTILS_H_
 #define ART_LIBELFFILE_ELF_XZ_UTILS_H_
 
+#include <functional>
 #include <vector>
 
 #include "base/array_ref.h"
@@ -31,6 +32,17 @@ void XzCompress(ArrayRef<const uint8_t> src,
                 int level = 1 /* speed */,
                 size_t block_size = kXzDefaultBlockSize);
 
+// Calls `fn(i)` exactly once for each `i` in [0, `count`), possibly concurrently.
+using XzForEachBlock = std::function<void(size_t count, const std::function<void(size_t)>& fn)>;
+
+// Produce the same output as XzCompress(), but compress each block separately using
+// `for_each_block`, so that the blocks can be compressed in parallel.
+void XzCompressBlocks(ArrayRef<const uint8_t> src,
+                      std::vector<uint8_t>* dst,
+                      const XzForEachBlock& for_each_block,
+                      int level = 1 /* speed */,
+                      size_t block_size = kXzDefaultBlockSize);
+
 void XzDecompress(ArrayRef<const uint8_t> src, std::vector<uint8_t>* dst);
 
 }  // namespace art
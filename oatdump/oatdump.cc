@@ -473,6 +473,9 @@ class OatDumper {
                            GetNterpTrampolineOffset);
 #undef DUMP_OAT_HEADER_OFFSET
 
+    os << "HOT CODE SIZE:\n";
+    os << StringPrintf("0x%08x\n\n", oat_header.GetHotCodeSize());
+
     // Print the key-value store.
     {
       os << "KEY VALUE STORE:\n";
@@ -155,6 +155,7 @@
 #include "transaction.h"
 #include "vdex_file.h"
 #include "verifier/class_verifier.h"
+#include "verifier/verifier_compiler_binding.h"
 #include "verifier/verifier_deps.h"
 #include "well_known_classes.h"
 
@@ -616,6 +617,8 @@ ClassLinker::ClassLinker(InternTable* intern_table, bool fast_class_not_found_ex
       visibly_initialize_classes_with_membarier_(RegisterMemBarrierForClassInitialization()),
       critical_native_code_with_clinit_check_lock_("critical native code with clinit check lock"),
       critical_native_code_with_clinit_check_(),
+      methods_pending_verification_lock_("methods pending verification lock"),
+      methods_pending_verification_(),
       cha_(Runtime::Current()->IsAotCompiler() ? nullptr : new ClassHierarchyAnalysis()) {
   // For CHA disabled during Aot, see b/34193647.
 
@@ -2683,6 +2686,17 @@ void ClassLinker::PrepareToDeleteClassLoader(Thread* self,
       }
     }
   }
+  {
+    MutexLock lock(self, methods_pending_verification_lock_);
+    auto end = methods_pending_verification_.end();
+    for (auto it = methods_pending_verification_.begin(); it != end; ) {
+      if (data.allocator->ContainsUnsafe(it->first)) {
+        it = methods_pending_verification_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
 }
 
 ObjPtr<mirror::PointerArray> ClassLinker::AllocPointerArray(Thread* self, size_t length) {
@@ -3137,9 +3151,18 @@ bool ClassLinker::FindClassInBaseDexClassLoaderClassPath(
          IsDelegateLastClassLoader(class_loader))
       << "Unexpected class loader for descriptor " << descriptor;
 
+  // Classes that are repeatedly looked up but not defined by the class loader, for example
+  // when probing for optional dependencies, are rejected by the filter in its class table.
+  ClassTable* const class_table = class_loader->GetClassTable();
+  StackHandleScope<1> hs(self);
+  Handle<mirror::Object> dex_elements = hs.NewHandle(GetClassLoaderDexElements(class_loader));
+  if (class_table != nullptr &&
+      !class_table->MayContainDexFileClass(dex_elements.Get(), static_cast<uint32_t>(hash))) {
+    return true;
+  }
+
   const DexFile* dex_file = nullptr;
   const dex::ClassDef* class_def = nullptr;
-  ObjPtr<mirror::Class> ret;
   auto find_class_def = [&](const DexFile* cp_dex_file) REQUIRES_SHARED(Locks::mutator_lock_) {
     const dex::ClassDef* cp_class_def = OatDexFile::FindClassDef(*cp_dex_file, descriptor, hash);
     if (cp_class_def != nullptr) {
@@ -3159,6 +3182,17 @@ bool ClassLinker::FindClassInBaseDexClassLoaderClassPath(
     } else {
       DCHECK(!self->IsExceptionPending());
     }
+  } else if (class_table != nullptr && dex_elements != nullptr) {
+    // We visited all dex files without finding the class. Build the filter, or rebuild it
+    // if the class loader has new dex files, so that the next miss does not visit them again.
+    std::vector<const DexFile*> cp_dex_files;
+    VisitClassLoaderDexFiles(self,
+                             class_loader,
+                             [&](const DexFile* cp_dex_file) REQUIRES_SHARED(Locks::mutator_lock_) {
+                               cp_dex_files.push_back(cp_dex_file);
+                               return true;  // Continue with the next DexFile.
+                             });
+    class_table->SetDexFileClassFilter(dex_elements.Get(), cp_dex_files);
   }
   // A BaseDexClassLoader is always a known lookup.
   return true;
@@ -4977,17 +5011,142 @@ verifier::FailureKind ClassLinker::PerformClassVerification(Thread* self,
   StackHandleScope<2> hs(self);
   Handle<mirror::DexCache> dex_cache(hs.NewHandle(klass->GetDexCache()));
   Handle<mirror::ClassLoader> class_loader(hs.NewHandle(klass->GetClassLoader()));
-  return verifier::ClassVerifier::VerifyClass(self,
-                                              verifier_deps,
-                                              dex_cache->GetDexFile(),
-                                              klass,
-                                              dex_cache,
-                                              class_loader,
-                                              *klass->GetClassDef(),
-                                              runtime->GetCompilerCallbacks(),
-                                              log_level,
-                                              Runtime::Current()->GetTargetSdkVersion(),
-                                              error_msg);
+  // With `-Xverify:lazy`, defer the verification of methods of dex files without an oat
+  // file, as these methods can only be executed by the interpreter or compiled by the JIT.
+  // Interfaces are verified eagerly: implementing classes execute copies of default methods,
+  // which were made when linking the class and do not carry the pending verification flags.
+  const OatDexFile* oat_dex_file = dex_cache->GetDexFile()->GetOatDexFile();
+  bool verify_methods_lazily = runtime->IsVerificationLazy() &&
+                               !runtime->IsAotCompiler() &&
+                               !klass->IsInterface() &&
+                               (oat_dex_file == nullptr || oat_dex_file->GetOatFile() == nullptr);
+  std::vector<uint32_t> deferred_method_indexes;
+  verifier::FailureKind failure =
+      verifier::ClassVerifier::VerifyClass(self,
+                                           verifier_deps,
+                                           dex_cache->GetDexFile(),
+                                           klass,
+                                           dex_cache,
+                                           class_loader,
+                                           *klass->GetClassDef(),
+                                           runtime->GetCompilerCallbacks(),
+                                           log_level,
+                                           Runtime::Current()->GetTargetSdkVersion(),
+                                           error_msg,
+                                           verify_methods_lazily ? &deferred_method_indexes
+                                                                 : nullptr);
+  if (failure != verifier::FailureKind::kHardFailure && !deferred_method_indexes.empty()) {
+    DeferMethodVerification(self, klass, std::move(deferred_method_indexes));
+  }
+  return failure;
+}
+
+void ClassLinker::DeferMethodVerification(Thread* self,
+                                          Handle<mirror::Class> klass,
+                                          std::vector<uint32_t>&& method_indexes) {
+  std::sort(method_indexes.begin(), method_indexes.end());
+  MutexLock lock(self, methods_pending_verification_lock_);
+  for (ArtMethod& method : klass->GetDeclaredMethods(image_pointer_size_)) {
+    if (std::binary_search(
+            method_indexes.begin(), method_indexes.end(), method.GetDexMethodIndex())) {
+      // Keep the method in the switch interpreter and away from the JIT until it is verified.
+      // `SetMustCountLocks()` also clears the flag for skipping access checks.
+      method.SetDontCompile();
+      method.SetMustCountLocks();
+      methods_pending_verification_.emplace(&method, std::string());
+    }
+  }
+}
+
+bool ClassLinker::VerifyDeferredMethod(Thread* self, ArtMethod* method) {
+  if (!Runtime::Current()->IsVerificationLazy()) {
+    return true;
+  }
+  // Pending methods are recorded by their declaration, not by their copies.
+  method = method->GetCanonicalMethod(image_pointer_size_);
+  {
+    MutexLock lock(self, methods_pending_verification_lock_);
+    auto it = methods_pending_verification_.find(method);
+    if (it == methods_pending_verification_.end()) {
+      return true;
+    }
+    if (!it->second.empty()) {
+      // The method already failed verification, throw the recorded error.
+      ThrowVerifyError(method->GetDeclaringClass(), "%s", it->second.c_str());
+      return false;
+    }
+  }
+
+  // Verify without holding the lock, as the verifier may need to load classes. Another
+  // thread may verify the same method concurrently, which is benign.
+  uint32_t failure_types = 0u;
+  std::string error_msg;
+  verifier::FailureKind failure =
+      verifier::ClassVerifier::VerifyMethod(self,
+                                            method,
+                                            verifier::HardFailLogMode::kLogNone,
+                                            Runtime::Current()->GetTargetSdkVersion(),
+                                            &failure_types,
+                                            &error_msg);
+  if (failure == verifier::FailureKind::kHardFailure) {
+    VLOG(verifier) << "Verification failed on method " << method->PrettyMethod()
+                   << " because: " << error_msg;
+    DCHECK(!error_msg.empty());
+    {
+      // Record the error, so that later invocations throw it without verifying the
+      // method again. The method keeps its kAccMustCountLocks flag and never leaves
+      // the switch interpreter.
+      MutexLock lock(self, methods_pending_verification_lock_);
+      auto it = methods_pending_verification_.find(method);
+      if (it != methods_pending_verification_.end() && it->second.empty()) {
+        it->second = error_msg;
+      }
+    }
+    ThrowVerifyError(method->GetDeclaringClass(), "%s", error_msg.c_str());
+    return false;
+  }
+
+  {
+    MutexLock lock(self, methods_pending_verification_lock_);
+    auto it = methods_pending_verification_.find(method);
+    if (it == methods_pending_verification_.end()) {
+      return true;  // Verified by another thread.
+    }
+    // Update the flags like the class verifier would have. Other threads that see
+    // the cleared kAccMustCountLocks flag execute the method without checking the
+    // pending set, so clear it last.
+    if (verifier::CanCompilerHandleVerificationFailure(failure_types)) {
+      method->ClearDontCompile();
+    }
+    if (failure == verifier::FailureKind::kNoFailure) {
+      method->SetSkipAccessChecks();
+    }
+    if ((failure_types & verifier::VerifyError::VERIFY_ERROR_LOCKING) == 0) {
+      method->ClearMustCountLocks();
+    }
+    methods_pending_verification_.erase(it);
+  }
+
+  // Now that the method has passed verification, try to use nterp for it.
+  if (interpreter::CanRuntimeUseNterp() &&
+      IsQuickToInterpreterBridge(method->GetEntryPointFromQuickCompiledCode())) {
+    Runtime::Current()->GetInstrumentation()->InitializeMethodsCode(method, /*aot_code=*/nullptr);
+  }
+  return true;
+}
+
+bool ClassLinker::HasMethodsPendingVerification(Thread* self, ObjPtr<mirror::Class> klass) {
+  if (!Runtime::Current()->IsVerificationLazy()) {
+    return false;
+  }
+  ArraySlice<ArtMethod> methods = klass->GetDeclaredMethods(image_pointer_size_);
+  if (methods.empty()) {
+    return false;
+  }
+  // Declared methods are a contiguous chunk of memory, so use the ordering of the set.
+  MutexLock lock(self, methods_pending_verification_lock_);
+  auto lb = methods_pending_verification_.lower_bound(&methods[0]);
+  return lb != methods_pending_verification_.end() && lb->first <= &methods[methods.size() - 1u];
 }
 
 bool ClassLinker::VerifyClassUsingOatFile(Thread* self,
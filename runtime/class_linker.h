@@ -604,6 +604,20 @@ class EXPORT ClassLinker {
                                ClassStatus& oat_file_class_status)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::dex_lock_);
+
+  // Verify a method whose verification was deferred with `-Xverify:lazy`, if it was not
+  // verified yet. Returns false with a pending VerifyError if the method fails verification.
+  // The error of a failed method is recorded and thrown again on later invocations.
+  // Such methods are marked as needing to count locks until they are verified, so that they
+  // are executed only by the switch interpreter, which calls this before executing them.
+  bool VerifyDeferredMethod(Thread* self, ArtMethod* method)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!methods_pending_verification_lock_);
+
+  // Returns whether `klass` has methods whose verification was deferred and not done yet.
+  bool HasMethodsPendingVerification(Thread* self, ObjPtr<mirror::Class> klass)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!methods_pending_verification_lock_);
   void ResolveClassExceptionHandlerTypes(Handle<mirror::Class> klass)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::dex_lock_);
@@ -897,6 +911,13 @@ class EXPORT ClassLinker {
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::dex_lock_);
 
+  // Mark the methods of `klass` whose verification was deferred by the class verifier.
+  void DeferMethodVerification(Thread* self,
+                               Handle<mirror::Class> klass,
+                               std::vector<uint32_t>&& method_indexes)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!methods_pending_verification_lock_);
+
   virtual verifier::FailureKind PerformClassVerification(Thread* self,
                                                          verifier::VerifierDeps* verifier_deps,
                                                          Handle<mirror::Class> klass,
@@ -1410,6 +1431,12 @@ class EXPORT ClassLinker {
   std::map<ArtMethod*, void*> critical_native_code_with_clinit_check_
       GUARDED_BY(critical_native_code_with_clinit_check_lock_);
 
+  // Methods of verified classes that have not been verified yet, see `VerifyDeferredMethod()`.
+  // Methods that failed verification stay here, mapped to their error message.
+  Mutex methods_pending_verification_lock_;
+  std::map<ArtMethod*, std::string> methods_pending_verification_
+      GUARDED_BY(methods_pending_verification_lock_);
+
   std::unique_ptr<ClassHierarchyAnalysis> cha_;
 
   class FindVirtualMethodHolderVisitor;
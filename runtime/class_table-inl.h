@@ -81,6 +81,7 @@ void ClassTable::VisitRoots(Visitor& visitor, bool skip_classes) {
   for (GcRoot<mirror::Object>& root : strong_roots_) {
     visitor.VisitRoot(root.AddressWithoutBarrier());
   }
+  visitor.VisitRootIfNonNull(dex_file_class_filter_dex_elements_.AddressWithoutBarrier());
   for (const OatFile* oat_file : oat_files_) {
     for (GcRoot<mirror::Object>& root : oat_file->GetBssGcRoots()) {
       visitor.VisitRootIfNonNull(root.AddressWithoutBarrier());
@@ -101,6 +102,7 @@ void ClassTable::VisitRoots(const Visitor& visitor, bool skip_classes) {
   for (GcRoot<mirror::Object>& root : strong_roots_) {
     visitor.VisitRoot(root.AddressWithoutBarrier());
   }
+  visitor.VisitRootIfNonNull(dex_file_class_filter_dex_elements_.AddressWithoutBarrier());
   for (const OatFile* oat_file : oat_files_) {
     for (GcRoot<mirror::Object>& root : oat_file->GetBssGcRoots()) {
       visitor.VisitRootIfNonNull(root.AddressWithoutBarrier());
@@ -150,6 +152,7 @@ void ClassTable::VisitClassesAndRoots(Visitor& visitor) {
   for (GcRoot<mirror::Object>& root : strong_roots_) {
     visitor.VisitRoot(root.AddressWithoutBarrier());
   }
+  visitor.VisitRootIfNonNull(dex_file_class_filter_dex_elements_.AddressWithoutBarrier());
   for (const OatFile* oat_file : oat_files_) {
     for (GcRoot<mirror::Object>& root : oat_file->GetBssGcRoots()) {
       visitor.VisitRootIfNonNull(root.AddressWithoutBarrier());
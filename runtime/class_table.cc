@@ -16,19 +16,41 @@
 
 #include "class_table-inl.h"
 
+#include <algorithm>
+
+#include "base/bit_utils.h"
 #include "base/stl_util.h"
+#include "dex/dex_file-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/string-inl.h"
 #include "oat/oat_file.h"
 
 namespace art HIDDEN {
 
-ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock) {
+ClassTable::ClassTable()
+    : lock_("Class loader classes", kClassLoaderClassesLock), frozen_class_sets_(nullptr) {
   Runtime* const runtime = Runtime::Current();
   classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
                               runtime->GetHashTableMaxLoadFactor()));
 }
 
+ClassTable::~ClassTable() {
+  const FrozenClassSet* frozen_set = frozen_class_sets_.load(std::memory_order_relaxed);
+  while (frozen_set != nullptr) {
+    const FrozenClassSet* next = frozen_set->next;
+    delete frozen_set;
+    frozen_set = next;
+  }
+}
+
+void ClassTable::PublishFrozenClassSet() {
+  DCHECK_GE(classes_.size(), 2u);
+  const FrozenClassSet* frozen_sets = frozen_class_sets_.load(std::memory_order_relaxed);
+  DCHECK_EQ(frozen_sets != nullptr ? frozen_sets->num_frozen_sets : 0u, classes_.size() - 2u);
+  frozen_class_sets_.store(new FrozenClassSet(classes_[classes_.size() - 2u], frozen_sets),
+                           std::memory_order_release);
+}
+
 void ClassTable::FreezeSnapshot() {
   WriterMutexLock mu(Thread::Current(), lock_);
   // Propagate the min/max load factor from the old active set.
@@ -36,6 +58,7 @@ void ClassTable::FreezeSnapshot() {
   const ClassSet& last_set = classes_.back();
   ClassSet new_set(last_set.GetMinLoadFactor(), last_set.GetMaxLoadFactor());
   classes_.push_back(std::move(new_set));
+  PublishFrozenClassSet();
 }
 
 ObjPtr<mirror::Class> ClassTable::UpdateClass(const char* descriptor,
@@ -106,13 +129,28 @@ size_t ClassTable::NumReferencedNonZygoteClasses() const {
 
 ObjPtr<mirror::Class> ClassTable::Lookup(const char* descriptor, size_t hash) {
   DescriptorHashPair pair(descriptor, hash);
-  ReaderMutexLock mu(Thread::Current(), lock_);
-  // Search from the last table, assuming that apps shall search for their own classes
-  // more often than for boot image classes. For prebuilt boot images, this also helps
-  // by searching the large table from the framework boot image extension compiled as
+  // Search the frozen sets without the lock first. Most lookups after the zygote fork are for
+  // boot class path classes that are in frozen sets from boot images or the zygote snapshot.
+  // Search from the most recently frozen set. For prebuilt boot images, this helps by
+  // searching the large table from the framework boot image extension compiled as
   // single-image before the individual small tables from the primary boot image
   // compiled as multi-image.
-  for (ClassSet& class_set : ReverseRange(classes_)) {
+  const FrozenClassSet* frozen_sets = frozen_class_sets_.load(std::memory_order_acquire);
+  for (const FrozenClassSet* frozen_set = frozen_sets;
+       frozen_set != nullptr;
+       frozen_set = frozen_set->next) {
+    auto it = frozen_set->set.FindWithHash(pair, hash);
+    if (it != frozen_set->set.end()) {
+      return it->Read();
+    }
+  }
+  // Sets frozen after we loaded `frozen_sets` keep their positions after the searched ones.
+  size_t num_searched_frozen_sets = (frozen_sets != nullptr) ? frozen_sets->num_frozen_sets : 0u;
+  ReaderMutexLock mu(Thread::Current(), lock_);
+  DCHECK_LT(num_searched_frozen_sets, classes_.size());
+  for (ClassSet& class_set :
+       ReverseRange(MakeIterationRange(classes_.begin() + num_searched_frozen_sets,
+                                       classes_.end()))) {
     auto it = class_set.FindWithHash(pair, hash);
     if (it != class_set.end()) {
       return it->Read();
@@ -175,16 +213,73 @@ void ClassTable::AddClassSet(ClassSet&& set) {
   WriterMutexLock mu(Thread::Current(), lock_);
   // Insert before the last (unfrozen) table since we add new classes into the back.
   // Keep the order of previous frozen tables unchanged, so that we can can remember
-  // the number of searched frozen tables and not search them again.
-  // TODO: Make use of this in `ClassLinker::FindClass()`.
+  // the number of searched frozen tables and not search them again in `Lookup()`.
   DCHECK(!classes_.empty());
   classes_.insert(classes_.end() - 1, std::move(set));
+  PublishFrozenClassSet();
+}
+
+// Bit positions of a descriptor hash in the dex file class filter with `num_bits`.
+static std::pair<size_t, size_t> DexFileClassFilterBits(uint32_t hash, size_t num_bits) {
+  DCHECK(IsPowerOfTwo(num_bits));
+  DCHECK_LE(num_bits, 1u << 24);
+  uint64_t mixed = static_cast<uint64_t>(hash) * UINT64_C(0x9e3779b97f4a7c15);
+  return {static_cast<size_t>(mixed >> 40) & (num_bits - 1u),
+          static_cast<size_t>(mixed >> 16) & (num_bits - 1u)};
+}
+
+bool ClassTable::MayContainDexFileClass(ObjPtr<mirror::Object> dex_elements,
+                                        uint32_t hash) const {
+  ReaderMutexLock mu(Thread::Current(), lock_);
+  if (dex_file_class_filter_.empty() ||
+      dex_elements == nullptr ||
+      dex_file_class_filter_dex_elements_.Read() != dex_elements) {
+    return true;
+  }
+  auto [bit1, bit2] = DexFileClassFilterBits(hash, dex_file_class_filter_.size() * 64u);
+  return (dex_file_class_filter_[bit1 / 64u] & (UINT64_C(1) << (bit1 % 64u))) != 0u &&
+         (dex_file_class_filter_[bit2 / 64u] & (UINT64_C(1) << (bit2 % 64u))) != 0u;
+}
+
+void ClassTable::SetDexFileClassFilter(ObjPtr<mirror::Object> dex_elements,
+                                       const std::vector<const DexFile*>& dex_files) {
+  DCHECK(dex_elements != nullptr);
+  {
+    ReaderMutexLock mu(Thread::Current(), lock_);
+    if (!dex_file_class_filter_.empty() &&
+        dex_file_class_filter_dex_elements_.Read() == dex_elements) {
+      return;  // Keep the filter built by another thread or before a false positive.
+    }
+  }
+  size_t num_classes = 0u;
+  for (const DexFile* dex_file : dex_files) {
+    num_classes += dex_file->NumClassDefs();
+  }
+  // Use 8 to 16 bits per class for a false positive rate of a few percent with two probes.
+  static constexpr size_t kMinBits = 64u;
+  static constexpr size_t kMaxBits = 1u << 24;
+  size_t num_bits =
+      std::clamp(RoundUpToPowerOfTwo(std::max<size_t>(num_classes, 1u) * 8u), kMinBits, kMaxBits);
+  std::vector<uint64_t> filter(num_bits / 64u, 0u);
+  for (const DexFile* dex_file : dex_files) {
+    for (const dex::ClassDef& class_def : dex_file->GetClasses()) {
+      uint32_t hash = ComputeModifiedUtf8Hash(dex_file->GetClassDescriptor(class_def));
+      auto [bit1, bit2] = DexFileClassFilterBits(hash, num_bits);
+      filter[bit1 / 64u] |= UINT64_C(1) << (bit1 % 64u);
+      filter[bit2 / 64u] |= UINT64_C(1) << (bit2 % 64u);
+    }
+  }
+  WriterMutexLock mu(Thread::Current(), lock_);
+  dex_file_class_filter_ = std::move(filter);
+  dex_file_class_filter_dex_elements_ = GcRoot<mirror::Object>(dex_elements);
 }
 
 void ClassTable::ClearStrongRoots() {
   WriterMutexLock mu(Thread::Current(), lock_);
   oat_files_.clear();
   strong_roots_.clear();
+  dex_file_class_filter_.clear();
+  dex_file_class_filter_dex_elements_ = GcRoot<mirror::Object>();
 }
 
 }  // namespace art
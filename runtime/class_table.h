@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_CLASS_TABLE_H_
 #define ART_RUNTIME_CLASS_TABLE_H_
 
+#include <atomic>
 #include <string>
 #include <utility>
 #include <vector>
@@ -30,6 +31,7 @@
 
 namespace art HIDDEN {
 
+class DexFile;
 class OatFile;
 
 namespace linker {
@@ -154,6 +156,7 @@ class ClassTable {
                            GcRootArenaAllocator<TableSlot, kAllocatorTagClassTable>>;
 
   EXPORT ClassTable();
+  EXPORT ~ClassTable();
 
   // Freeze the current class tables by allocating a new table and never updating or modifying the
   // existing table. This helps prevents dirty pages after caused by inserting after zygote fork.
@@ -223,6 +226,9 @@ class ClassTable {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Return the first class that matches the descriptor. Returns null if there are none.
+  // Frozen class sets are searched without taking the `lock_`. The last class set, which
+  // receives the inserts, is still searched under the reader lock, so lookups of classes
+  // defined after the last freeze still contend with inserts.
   ObjPtr<mirror::Class> Lookup(const char* descriptor, size_t hash)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -261,6 +267,23 @@ class ClassTable {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Returns false if no class with the descriptor `hash` is defined by the dex files of the
+  // class loader, as recorded by `SetDexFileClassFilter()` for the same `dex_elements` array
+  // of its `DexPathList`. Returns true if there may be such a class or if there is no filter
+  // for `dex_elements`, for example because a dex path was added to the class loader.
+  bool MayContainDexFileClass(ObjPtr<mirror::Object> dex_elements, uint32_t hash) const
+      REQUIRES(!lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Record the descriptor hashes of the classes defined by `dex_files`, which are all dex files
+  // in the `dex_elements` array of the class loader, so that lookups of classes that are not
+  // there can be rejected quickly by `MayContainDexFileClass()`. Does nothing if there is
+  // already a filter for `dex_elements`.
+  void SetDexFileClassFilter(ObjPtr<mirror::Object> dex_elements,
+                             const std::vector<const DexFile*>& dex_files)
+      REQUIRES(!lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Clear strong roots (other than classes themselves).
   void ClearStrongRoots()
       REQUIRES(!lock_)
@@ -287,16 +310,41 @@ class ClassTable {
       REQUIRES(lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // View of a frozen class set for lookups without the `lock_`. Classes are only inserted into
+  // the last set, so the sets before it are never modified other than by updating the class
+  // references in their slots, which are atomic. The views form a list from the most recently
+  // frozen set, published with release semantics, and are deleted only with the table.
+  struct FrozenClassSet {
+    FrozenClassSet(const ClassSet& class_set, const FrozenClassSet* next_set)
+        : set(class_set.MakeView()),
+          next(next_set),
+          num_frozen_sets(next_set != nullptr ? next_set->num_frozen_sets + 1u : 1u) {}
+
+    const ClassSet set;
+    const FrozenClassSet* const next;
+    const size_t num_frozen_sets;
+  };
+
+  // Publish a view of the class set which was just frozen, i.e. the second to last one.
+  void PublishFrozenClassSet() REQUIRES(lock_);
+
   // Lock to guard inserting and removing.
   mutable ReaderWriterMutex lock_;
   // We have a vector to help prevent dirty pages after the zygote forks by calling FreezeSnapshot.
   std::vector<ClassSet> classes_ GUARDED_BY(lock_);
+  // Views of `classes_[0]` to `classes_[classes_.size() - 2]`, see `FrozenClassSet`.
+  std::atomic<const FrozenClassSet*> frozen_class_sets_;
   // Extra strong roots that can be either dex files or dex caches. Dex files used by the class
   // loader which may not be owned by the class loader must be held strongly live. Also dex caches
   // are held live to prevent them being unloading once they have classes in them.
   std::vector<GcRoot<mirror::Object>> strong_roots_ GUARDED_BY(lock_);
   // Keep track of oat files with GC roots associated with dex caches in `strong_roots_`.
   std::vector<const OatFile*> oat_files_ GUARDED_BY(lock_);
+  // Bloom filter of the descriptor hashes of classes defined by the dex files of the class
+  // loader, valid for the `dex_file_class_filter_dex_elements_` array. The `DexPathList`
+  // replaces the array when adding dex files, which makes the filter stale.
+  std::vector<uint64_t> dex_file_class_filter_ GUARDED_BY(lock_);
+  GcRoot<mirror::Object> dex_file_class_filter_dex_elements_ GUARDED_BY(lock_);
 
   friend class linker::ImageWriter;  // for InsertWithoutLocks.
 };
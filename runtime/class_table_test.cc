@@ -112,6 +112,14 @@ TEST_F(ClassTableTest, ClassTable) {
   EXPECT_EQ(table.NumZygoteClasses(class_loader.Get()), 1u);
   EXPECT_EQ(table.NumNonZygoteClasses(class_loader.Get()), 1u);
 
+  // Classes in all frozen sets are found.
+  table.FreezeSnapshot();
+  EXPECT_OBJ_PTR_EQ(table.LookupByDescriptor(h_X.Get()), h_X.Get());
+  EXPECT_OBJ_PTR_EQ(table.LookupByDescriptor(h_Y.Get()), h_Y.Get());
+  EXPECT_TRUE(table.Lookup("NOT_THERE", ComputeModifiedUtf8Hash("NOT_THERE")) == nullptr);
+  EXPECT_EQ(table.NumZygoteClasses(class_loader.Get()), 2u);
+  EXPECT_EQ(table.NumNonZygoteClasses(class_loader.Get()), 0u);
+
   // Test adding / clearing strong roots.
   EXPECT_TRUE(table.InsertStrongRoot(obj_X.Get()));
   EXPECT_FALSE(table.InsertStrongRoot(obj_X.Get()));
@@ -161,5 +169,47 @@ TEST_F(ClassTableTest, ClassTable) {
   // TODO: Add tests for UpdateClass, InsertOatFile.
 }
 
+TEST_F(ClassTableTest, DexFileClassFilter) {
+  ScopedObjectAccess soa(Thread::Current());
+  jobject jclass_loader = LoadDex("XandY");
+  VariableSizedHandleScope hs(soa.Self());
+  Handle<ClassLoader> class_loader(hs.NewHandle(soa.Decode<ClassLoader>(jclass_loader)));
+  Handle<mirror::Class> h_X(
+      hs.NewHandle(class_linker_->FindClass(soa.Self(), "LX;", class_loader)));
+  ASSERT_TRUE(h_X != nullptr);
+  // Any objects can stand for the `DexPathList` element arrays.
+  Handle<mirror::Object> dex_elements = hs.NewHandle(h_X->AllocObject(soa.Self()));
+  Handle<mirror::Object> new_dex_elements = hs.NewHandle(h_X->AllocObject(soa.Self()));
+  ASSERT_TRUE(dex_elements != nullptr);
+  ASSERT_TRUE(new_dex_elements != nullptr);
+  const uint32_t hash_x = ComputeModifiedUtf8Hash("LX;");
+  const uint32_t hash_y = ComputeModifiedUtf8Hash("LY;");
+
+  ClassTable table;
+  // Without a filter, any class may be there.
+  EXPECT_TRUE(table.MayContainDexFileClass(dex_elements.Get(), hash_x));
+  EXPECT_TRUE(table.MayContainDexFileClass(dex_elements.Get(), ComputeModifiedUtf8Hash("LZ;")));
+
+  table.SetDexFileClassFilter(dex_elements.Get(), {&h_X->GetDexFile()});
+  EXPECT_TRUE(table.MayContainDexFileClass(dex_elements.Get(), hash_x));
+  EXPECT_TRUE(table.MayContainDexFileClass(dex_elements.Get(), hash_y));
+  size_t num_rejected = 0u;
+  for (size_t i = 0; i != 100u; ++i) {
+    std::string descriptor = "LNotThere" + std::to_string(i) + ";";
+    if (!table.MayContainDexFileClass(dex_elements.Get(),
+                                      ComputeModifiedUtf8Hash(descriptor.c_str()))) {
+      ++num_rejected;
+    }
+  }
+  EXPECT_GE(num_rejected, 90u);
+
+  // The filter does not apply to a different set of dex files or after clearing strong roots.
+  EXPECT_TRUE(table.MayContainDexFileClass(new_dex_elements.Get(),
+                                           ComputeModifiedUtf8Hash("LNotThere0;")));
+  table.ClearStrongRoots();
+  EXPECT_TRUE(table.MayContainDexFileClass(dex_elements.Get(),
+                                           ComputeModifiedUtf8Hash("LNotThere0;")));
+}
+
 }  // namespace mirror
 }  // namespace art
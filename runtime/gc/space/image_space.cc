@@ -1364,72 +1364,106 @@ class ImageSpace::Loader {
         }
       }
 
-      // Fixup objects may read fields in the boot image so we hold the mutator lock (although it is
-      // probably not required).
-      TimingLogger::ScopedTiming timing("Fixup objects", &logger);
-      ScopedObjectAccess soa(Thread::Current());
-      // Need to update the image to be at the target base.
-      uintptr_t objects_begin = reinterpret_cast<uintptr_t>(target_base + objects_section.Offset());
-      uintptr_t objects_end = reinterpret_cast<uintptr_t>(target_base + objects_section.End());
-      FixupObjectVisitor<ForwardObject> fixup_object_visitor(&visited_bitmap, forward_object);
-      bitmap->VisitMarkedRange(objects_begin, objects_end, fixup_object_visitor);
-      // Fixup image roots.
-      CHECK(app_image_objects.InSource(reinterpret_cast<uintptr_t>(
-          image_header->GetImageRoots<kWithoutReadBarrier>().Ptr())));
-      image_header->RelocateImageReferences(app_image_objects.Delta());
-      image_header->RelocateBootImageReferences(boot_image.Delta());
-      CHECK_EQ(image_header->GetImageBegin(), target_base);
-
-      // Fix up dex cache arrays.
-      ObjPtr<mirror::ObjectArray<mirror::DexCache>> dex_caches =
-          image_header->GetImageRoot<kWithoutReadBarrier>(ImageHeader::kDexCaches)
-              ->AsObjectArray<mirror::DexCache, kVerifyNone>();
-      for (int32_t i = 0, count = dex_caches->GetLength(); i < count; ++i) {
-        ObjPtr<mirror::DexCache> dex_cache =
-            dex_caches->GetWithoutChecks<kVerifyNone, kWithoutReadBarrier>(i);
-        patch_object_visitor.VisitDexCacheArrays(dex_cache);
-      }
-    }
-    {
-      // Only touches objects in the app image, no need for mutator lock.
-      TimingLogger::ScopedTiming timing("Fixup methods", &logger);
-      image_header->VisitPackedArtMethods([&](ArtMethod& method) NO_THREAD_SAFETY_ANALYSIS {
-        // TODO: Consider a separate visitor for runtime vs normal methods.
-        if (UNLIKELY(method.IsRuntimeMethod())) {
-          ImtConflictTable* table = method.GetImtConflictTable(kPointerSize);
-          if (table != nullptr) {
-            ImtConflictTable* new_table = forward_metadata(table);
-            if (table != new_table) {
-              method.SetImtConflictTable(new_table, kPointerSize);
-            }
-          }
-          const void* old_code = method.GetEntryPointFromQuickCompiledCodePtrSize(kPointerSize);
-          const void* new_code = forward_code(old_code);
-          if (old_code != new_code) {
-            method.SetEntryPointFromQuickCompiledCodePtrSize(new_code, kPointerSize);
+      // The objects and the native structures (methods, fields, IMTs and IMT conflict tables)
+      // occupy disjoint memory and their fixups only read the boot image and the classes fixed
+      // up above, so run them in parallel if the startup thread pool is still available.
+      {
+        TimingLogger::ScopedTiming timing("Fixup objects and native structures", &logger);
+        Runtime::ScopedThreadPoolUsage stpu;
+        ThreadPool* const pool = stpu.GetThreadPool();
+        Thread* const self = Thread::Current();
+        auto run = [&](std::function<void(Thread*)>&& function) {
+          if (pool != nullptr) {
+            pool->AddTask(self, new FunctionTask(std::move(function)));
+          } else {
+            function(self);
           }
-        } else {
-          patch_object_visitor.PatchGcRoot(&method.DeclaringClassRoot());
-          method.UpdateEntrypoints(forward_code, kPointerSize);
+        };
+
+        // Split the objects into chunks covering whole words of the visited bitmap, so that
+        // the chunks do not race when marking objects as visited.
+        static constexpr size_t kObjectChunkAlignment = kObjectAlignment * kBitsPerIntPtrT;
+        static constexpr size_t kMinObjectChunkSize = 256 * KB;
+        uintptr_t objects_begin =
+            reinterpret_cast<uintptr_t>(target_base + objects_section.Offset());
+        uintptr_t objects_end = reinterpret_cast<uintptr_t>(target_base + objects_section.End());
+        size_t num_chunks = (pool != nullptr) ? pool->GetThreadCount() + 1u : 1u;
+        size_t chunk_size = RoundUp(
+            std::max(RoundUp(objects_end - objects_begin, num_chunks) / num_chunks,
+                     kMinObjectChunkSize),
+            kObjectChunkAlignment);
+        for (uintptr_t chunk_begin = objects_begin; chunk_begin < objects_end; ) {
+          uintptr_t chunk_end =
+              std::min(RoundUp(chunk_begin + chunk_size, kObjectChunkAlignment), objects_end);
+          run([&, chunk_begin, chunk_end](Thread*) NO_THREAD_SAFETY_ANALYSIS {
+            ScopedTrace trace("Fixup app image objects");
+            FixupObjectVisitor<ForwardObject> fixup_object_visitor(&visited_bitmap,
+                                                                   forward_object);
+            bitmap->VisitMarkedRange(chunk_begin, chunk_end, fixup_object_visitor);
+          });
+          chunk_begin = chunk_end;
+        }
+        run([&](Thread*) NO_THREAD_SAFETY_ANALYSIS {
+          ScopedTrace trace("Fixup app image methods");
+          image_header->VisitPackedArtMethods([&](ArtMethod& method) NO_THREAD_SAFETY_ANALYSIS {
+            // TODO: Consider a separate visitor for runtime vs normal methods.
+            if (UNLIKELY(method.IsRuntimeMethod())) {
+              ImtConflictTable* table = method.GetImtConflictTable(kPointerSize);
+              if (table != nullptr) {
+                ImtConflictTable* new_table = forward_metadata(table);
+                if (table != new_table) {
+                  method.SetImtConflictTable(new_table, kPointerSize);
+                }
+              }
+              const void* old_code = method.GetEntryPointFromQuickCompiledCodePtrSize(kPointerSize);
+              const void* new_code = forward_code(old_code);
+              if (old_code != new_code) {
+                method.SetEntryPointFromQuickCompiledCodePtrSize(new_code, kPointerSize);
+              }
+            } else {
+              patch_object_visitor.PatchGcRoot(&method.DeclaringClassRoot());
+              method.UpdateEntrypoints(forward_code, kPointerSize);
+            }
+          }, target_base, kPointerSize);
+        });
+        run([&](Thread*) NO_THREAD_SAFETY_ANALYSIS {
+          ScopedTrace trace("Fixup app image fields");
+          image_header->VisitPackedArtFields([&](ArtField& field) NO_THREAD_SAFETY_ANALYSIS {
+            patch_object_visitor.template PatchGcRoot</*kMayBeNull=*/ false>(
+                &field.DeclaringClassRoot());
+          }, target_base);
+        });
+        run([&](Thread*) {
+          ScopedTrace trace("Fixup app image IMTs");
+          image_header->VisitPackedImTables(forward_metadata, target_base, kPointerSize);
+          image_header->VisitPackedImtConflictTables(forward_metadata, target_base, kPointerSize);
+        });
+        if (pool != nullptr) {
+          ScopedTrace trace("Waiting for workers");
+          // Go to native since we don't want to suspend while holding the mutator lock.
+          ScopedThreadSuspension sts(self, ThreadState::kNative);
+          pool->Wait(self, /*do_work=*/ true, /*may_hold_locks=*/ false);
         }
-      }, target_base, kPointerSize);
-    }
-    if (fixup_image) {
-      {
-        // Only touches objects in the app image, no need for mutator lock.
-        TimingLogger::ScopedTiming timing("Fixup fields", &logger);
-        image_header->VisitPackedArtFields([&](ArtField& field) NO_THREAD_SAFETY_ANALYSIS {
-          patch_object_visitor.template PatchGcRoot</*kMayBeNull=*/ false>(
-              &field.DeclaringClassRoot());
-        }, target_base);
-      }
-      {
-        TimingLogger::ScopedTiming timing("Fixup imt", &logger);
-        image_header->VisitPackedImTables(forward_metadata, target_base, kPointerSize);
       }
+
       {
-        TimingLogger::ScopedTiming timing("Fixup conflict tables", &logger);
-        image_header->VisitPackedImtConflictTables(forward_metadata, target_base, kPointerSize);
+        // Fixup image roots and dex cache arrays. This reads the dex caches fixed up above.
+        TimingLogger::ScopedTiming timing("Fixup dex cache arrays", &logger);
+        ScopedObjectAccess soa(Thread::Current());
+        CHECK(app_image_objects.InSource(reinterpret_cast<uintptr_t>(
+            image_header->GetImageRoots<kWithoutReadBarrier>().Ptr())));
+        image_header->RelocateImageReferences(app_image_objects.Delta());
+        image_header->RelocateBootImageReferences(boot_image.Delta());
+        CHECK_EQ(image_header->GetImageBegin(), target_base);
+
+        ObjPtr<mirror::ObjectArray<mirror::DexCache>> dex_caches =
+            image_header->GetImageRoot<kWithoutReadBarrier>(ImageHeader::kDexCaches)
+                ->AsObjectArray<mirror::DexCache, kVerifyNone>();
+        for (int32_t i = 0, count = dex_caches->GetLength(); i < count; ++i) {
+          ObjPtr<mirror::DexCache> dex_cache =
+              dex_caches->GetWithoutChecks<kVerifyNone, kWithoutReadBarrier>(i);
+          patch_object_visitor.VisitDexCacheArrays(dex_cache);
+        }
       }
       // Fix up the intern table.
       const auto& intern_table_section = image_header->GetInternedStringsSection();
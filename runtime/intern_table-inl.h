@@ -113,14 +113,15 @@ inline size_t InternTable::AddTableFromMemory(const uint8_t* ptr,
     // Visit the unordered set, may remove elements.
     visitor(set);
     if (!set.empty()) {
-      strong_interns_.AddInternStrings(std::move(set), is_boot_image);
+      strong_interns_.AddInternStrings(std::move(set), is_boot_image, ptr);
     }
   }
   return read_count;
 }
 
 inline void InternTable::Table::AddInternStrings(UnorderedSet&& intern_strings,
-                                                 bool is_boot_image) {
+                                                 bool is_boot_image,
+                                                 const uint8_t* ptr) {
   if (kIsDebugBuild) {
     // Avoid doing read barriers since the space might not yet be added to the heap.
     // See b/117803941
@@ -138,7 +139,13 @@ inline void InternTable::Table::AddInternStrings(UnorderedSet&& intern_strings,
   // Keep the order of previous frozen tables unchanged, so that we can can remember
   // the number of searched frozen tables and not search them again.
   DCHECK(!tables_.empty());
-  tables_.insert(tables_.end() - 1, InternalTable(std::move(intern_strings), is_boot_image));
+  const ImageTableView* views = image_table_views_.load(std::memory_order_relaxed);
+  size_t image_index = (views != nullptr) ? views->num_image_tables : 0u;
+  tables_.insert(tables_.end() - 1,
+                 InternalTable(std::move(intern_strings), is_boot_image, image_index));
+  // Publish the view for lookups without the lock. The view reads the same memory as the
+  // table, including any modifications done by the visitor in `AddTableFromMemory()`.
+  image_table_views_.store(new ImageTableView(ptr, views), std::memory_order_release);
 }
 
 template <typename Visitor>
@@ -102,10 +102,47 @@ void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
   // Note: we deliberately don't visit the weak_interns_ table and the immutable image roots.
 }
 
+// NO_THREAD_SAFETY_ANALYSIS: The image tables of `strong_interns_` are read without the
+// `Locks::intern_table_lock_`, see `Table::ImageTableView`.
+template <typename Key>
+ObjPtr<mirror::String> InternTable::LookupStrongInImageTables(const Key& key,
+                                                              uint32_t hash,
+                                                              size_t* num_searched_image_tables)
+    NO_THREAD_SAFETY_ANALYSIS {
+  return strong_interns_.FindInImageTables(key, hash, num_searched_image_tables);
+}
+
+bool InternTable::CanReadWithoutLock(Thread* self) const {
+  // The GC disables weak root access in a pause before it sweeps the weak interns and releases
+  // the retired storage. Readers check it before each lookup and do not suspend during it.
+  return gUseReadBarrier
+      ? self->GetWeakRefAccessEnabled()
+      : weak_root_state_.load(std::memory_order_acquire) == gc::kWeakRootStateNormal;
+}
+
+// NO_THREAD_SAFETY_ANALYSIS: The runtime tables are read without the
+// `Locks::intern_table_lock_`, see `Table::RuntimeTableViews`.
+template <typename Key>
+ObjPtr<mirror::String> InternTable::LookupInRuntimeTables(Thread* self,
+                                                          const Table& table,
+                                                          const Key& key,
+                                                          uint32_t hash)
+    NO_THREAD_SAFETY_ANALYSIS {
+  if (!CanReadWithoutLock(self)) {
+    return nullptr;
+  }
+  return table.FindInRuntimeTables(key, hash);
+}
+
 ObjPtr<mirror::String> InternTable::LookupWeak(Thread* self, ObjPtr<mirror::String> s) {
   DCHECK(s != nullptr);
   // `String::GetHashCode()` ensures that the stored hash is calculated.
   uint32_t hash = static_cast<uint32_t>(s->GetHashCode());
+  ObjPtr<mirror::String> result =
+      LookupInRuntimeTables(self, weak_interns_, GcRoot<mirror::String>(s), hash);
+  if (result != nullptr) {
+    return result;
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
   return weak_interns_.Find(s, hash);
 }
@@ -114,16 +151,37 @@ ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self, ObjPtr<mirror::St
   DCHECK(s != nullptr);
   // `String::GetHashCode()` ensures that the stored hash is calculated.
   uint32_t hash = static_cast<uint32_t>(s->GetHashCode());
+  size_t num_searched_image_tables;
+  ObjPtr<mirror::String> result = LookupStrongInImageTables(s, hash, &num_searched_image_tables);
+  if (result != nullptr) {
+    return result;
+  }
+  result = LookupInRuntimeTables(self, strong_interns_, GcRoot<mirror::String>(s), hash);
+  if (result != nullptr) {
+    return result;
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
-  return strong_interns_.Find(s, hash);
+  return strong_interns_.Find(
+      s, hash, /*num_searched_frozen_tables=*/ 0u, num_searched_image_tables);
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
                                                  uint32_t utf16_length,
                                                  const char* utf8_data) {
   uint32_t hash = Utf8String::Hash(utf16_length, utf8_data);
+  Utf8String string(utf16_length, utf8_data);
+  size_t num_searched_image_tables;
+  ObjPtr<mirror::String> result =
+      LookupStrongInImageTables(string, hash, &num_searched_image_tables);
+  if (result != nullptr) {
+    return result;
+  }
+  result = LookupInRuntimeTables(self, strong_interns_, string, hash);
+  if (result != nullptr) {
+    return result;
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
-  return strong_interns_.Find(Utf8String(utf16_length, utf8_data), hash);
+  return strong_interns_.Find(string, hash, num_searched_image_tables);
 }
 
 ObjPtr<mirror::String> InternTable::LookupWeakLocked(ObjPtr<mirror::String> s) {
@@ -190,7 +248,9 @@ void InternTable::WaitUntilAccessible(Thread* self) {
   {
     ScopedThreadSuspension sts(self, ThreadState::kWaitingWeakGcRootRead);
     MutexLock mu(self, *Locks::intern_table_lock_);
-    while ((!gUseReadBarrier && weak_root_state_ == gc::kWeakRootStateNoReadsOrWrites) ||
+    while ((!gUseReadBarrier &&
+            weak_root_state_.load(std::memory_order_relaxed) ==
+                gc::kWeakRootStateNoReadsOrWrites) ||
            (gUseReadBarrier && !self->GetWeakRefAccessEnabled())) {
       weak_intern_condition_.Wait(self);
     }
@@ -206,6 +266,28 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
   DCHECK_EQ(hash, static_cast<uint32_t>(s->GetStoredHashCode()));
   DCHECK_IMPLIES(hash == 0u, s->ComputeHashCode() == 0);
   Thread* const self = Thread::Current();
+  // Most interned strings are found in the boot image, check the image tables without the lock.
+  // If the caller searched the frozen tables, it also searched the image tables before them.
+  size_t num_searched_image_tables = 0u;
+  if (num_searched_strong_frozen_tables == 0u) {
+    ObjPtr<mirror::String> strong = LookupStrongInImageTables(s, hash, &num_searched_image_tables);
+    if (strong != nullptr) {
+      return strong;
+    }
+  }
+  // Strings interned at runtime are usually found without the lock as well. A weak intern found
+  // for a strong insertion must be promoted with the lock held below.
+  ObjPtr<mirror::String> found =
+      LookupInRuntimeTables(self, strong_interns_, GcRoot<mirror::String>(s), hash);
+  if (found != nullptr) {
+    return found;
+  }
+  if (!is_strong) {
+    found = LookupInRuntimeTables(self, weak_interns_, GcRoot<mirror::String>(s), hash);
+    if (found != nullptr) {
+      return found;
+    }
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
   if (kDebugLocking) {
     Locks::mutator_lock_->AssertSharedHeld(self);
@@ -213,13 +295,14 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
   }
   while (true) {
     // Check the strong table for a match.
-    ObjPtr<mirror::String> strong =
-        strong_interns_.Find(s, hash, num_searched_strong_frozen_tables);
+    ObjPtr<mirror::String> strong = strong_interns_.Find(
+        s, hash, num_searched_strong_frozen_tables, num_searched_image_tables);
     if (strong != nullptr) {
       return strong;
     }
     if (gUseReadBarrier ? self->GetWeakRefAccessEnabled()
-                        : weak_root_state_ != gc::kWeakRootStateNoReadsOrWrites) {
+                        : weak_root_state_.load(std::memory_order_relaxed) !=
+                              gc::kWeakRootStateNoReadsOrWrites) {
       break;
     }
     num_searched_strong_frozen_tables = strong_interns_.tables_.size() - 1u;
@@ -231,7 +314,7 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
     WaitUntilAccessible(self);
   }
   if (!gUseReadBarrier) {
-    CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
+    CHECK_EQ(weak_root_state_.load(std::memory_order_relaxed), gc::kWeakRootStateNormal);
   } else {
     CHECK(self->GetWeakRefAccessEnabled());
   }
@@ -253,14 +336,23 @@ ObjPtr<mirror::String> InternTable::InternStrong(uint32_t utf16_length, const ch
   DCHECK(utf8_data != nullptr);
   uint32_t hash = Utf8String::Hash(utf16_length, utf8_data);
   Thread* self = Thread::Current();
-  ObjPtr<mirror::String> s;
+  Utf8String string(utf16_length, utf8_data);
+  size_t num_searched_image_tables;
+  ObjPtr<mirror::String> s = LookupStrongInImageTables(string, hash, &num_searched_image_tables);
+  if (s != nullptr) {
+    return s;
+  }
+  s = LookupInRuntimeTables(self, strong_interns_, string, hash);
+  if (s != nullptr) {
+    return s;
+  }
   size_t num_searched_strong_frozen_tables;
   {
     // Try to avoid allocation. If we need to allocate, release the mutex before the allocation.
     MutexLock mu(self, *Locks::intern_table_lock_);
     DCHECK(!strong_interns_.tables_.empty());
     num_searched_strong_frozen_tables = strong_interns_.tables_.size() - 1u;
-    s = strong_interns_.Find(Utf8String(utf16_length, utf8_data), hash);
+    s = strong_interns_.Find(string, hash, num_searched_image_tables);
   }
   if (s != nullptr) {
     return s;
@@ -314,8 +406,18 @@ ObjPtr<mirror::String> InternTable::InternWeak(ObjPtr<mirror::String> s) {
 }
 
 void InternTable::SweepInternTableWeaks(IsMarkedVisitor* visitor) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  Thread* self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
   weak_interns_.SweepWeaks(visitor);
+  // No thread can be searching the tables without the lock while weak root access is disabled,
+  // and any thread that did so before it was disabled has finished its lookup.
+  bool weak_root_access_disabled = gUseReadBarrier
+      ? !self->GetWeakRefAccessEnabled()
+      : weak_root_state_.load(std::memory_order_relaxed) == gc::kWeakRootStateNoReadsOrWrites;
+  if (weak_root_access_disabled || Locks::mutator_lock_->IsExclusiveHeld(self)) {
+    weak_interns_.ReleaseRetiredStorage();
+    strong_interns_.ReleaseRetiredStorage();
+  }
 }
 
 void InternTable::Table::Remove(ObjPtr<mirror::String> s, uint32_t hash) {
@@ -331,10 +433,67 @@ void InternTable::Table::Remove(ObjPtr<mirror::String> s, uint32_t hash) {
   LOG(FATAL) << "Attempting to remove non-interned string " << s->ToModifiedUtf8();
 }
 
+template <typename Key>
+ObjPtr<mirror::String> InternTable::Table::FindInImageTables(
+    const Key& key, uint32_t hash, size_t* num_searched_image_tables) const {
+  const ImageTableView* views = image_table_views_.load(std::memory_order_acquire);
+  *num_searched_image_tables = (views != nullptr) ? views->num_image_tables : 0u;
+  // Search from the most recently added image, like `Find()` below.
+  for (const ImageTableView* view = views; view != nullptr; view = view->next) {
+    auto it = view->set.FindWithHash(key, hash);
+    if (it != view->set.end()) {
+      return it->Read();
+    }
+  }
+  return nullptr;
+}
+
+template <typename Key>
+ObjPtr<mirror::String> InternTable::Table::FindInRuntimeTables(const Key& key,
+                                                               uint32_t hash) const {
+  const RuntimeTableViews* views = runtime_table_views_.load(std::memory_order_acquire);
+  if (views == nullptr) {
+    return nullptr;
+  }
+  // Search from the last table, like `Find()` below.
+  for (const UnorderedSet& set : ReverseRange(views->sets)) {
+    auto it = set.FindWithHash(key, hash);
+    if (it != set.end()) {
+      return it->Read();
+    }
+  }
+  return nullptr;
+}
+
+void InternTable::Table::ReleaseRetiredStorage() {
+  retired_sets_.clear();
+  retired_runtime_table_views_.clear();
+}
+
+void InternTable::Table::PublishRuntimeTableViews() {
+  // The compiler modifies and rolls back the tables in transactions and the image writer
+  // rewrites them, so it always searches with the lock and nothing is published.
+  if (Runtime::Current()->IsAotCompiler()) {
+    return;
+  }
+  std::unique_ptr<RuntimeTableViews> views(new RuntimeTableViews());
+  for (const InternalTable& table : tables_) {
+    if (!table.IsImage()) {
+      views->sets.push_back(table.set_.MakeView());
+    }
+  }
+  const RuntimeTableViews* old_views =
+      runtime_table_views_.exchange(views.release(), std::memory_order_release);
+  if (old_views != nullptr) {
+    retired_runtime_table_views_.emplace_back(old_views);
+  }
+}
+
 FLATTEN
 ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s,
                                                 uint32_t hash,
-                                                size_t num_searched_frozen_tables) {
+                                                size_t num_searched_frozen_tables,
+                                                size_t num_searched_image_tables) {
   Locks::intern_table_lock_->AssertHeld(Thread::Current());
   auto mid = tables_.begin() + num_searched_frozen_tables;
   for (Table::InternalTable& table : MakeIterationRange(tables_.begin(), mid)) {
@@ -343,6 +502,10 @@ ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s,
   // Search from the last table, assuming that apps shall search for their own
   // strings more often than for boot image strings.
   for (Table::InternalTable& table : ReverseRange(MakeIterationRange(mid, tables_.end()))) {
+    if (table.IsImage() && table.image_index_ < num_searched_image_tables) {
+      DCHECK(table.set_.FindWithHash(GcRoot<mirror::String>(s), hash) == table.set_.end());
+      continue;
+    }
     auto it = table.set_.FindWithHash(GcRoot<mirror::String>(s), hash);
     if (it != table.set_.end()) {
       return it->Read();
@@ -352,11 +515,16 @@ ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s,
 }
 
 FLATTEN
-ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string, uint32_t hash) {
+ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string,
+                                                uint32_t hash,
+                                                size_t num_searched_image_tables) {
   Locks::intern_table_lock_->AssertHeld(Thread::Current());
   // Search from the last table, assuming that apps shall search for their own
   // strings more often than for boot image strings.
   for (InternalTable& table : ReverseRange(tables_)) {
+    if (table.IsImage() && table.image_index_ < num_searched_image_tables) {
+      continue;
+    }
     auto it = table.set_.FindWithHash(string, hash);
     if (it != table.set_.end()) {
       return it->Read();
@@ -372,13 +540,35 @@ void InternTable::Table::AddNewTable() {
   InternalTable new_table;
   new_table.set_.SetLoadFactor(last_set.GetMinLoadFactor(), last_set.GetMaxLoadFactor());
   tables_.push_back(std::move(new_table));
+  PublishRuntimeTableViews();
 }
 
 void InternTable::Table::Insert(ObjPtr<mirror::String> s, uint32_t hash) {
   // Always insert the last table, the image tables are before and we avoid inserting into these
   // to prevent dirty pages.
   DCHECK(!tables_.empty());
-  tables_.back().set_.PutWithHash(GcRoot<mirror::String>(s), hash);
+  UnorderedSet& set = tables_.back().set_;
+  bool publish = runtime_table_views_.load(std::memory_order_relaxed) == nullptr;
+  if (set.size() >= set.ElementsUntilExpand()) {
+    // The set would expand and free its storage which readers without the lock may be using.
+    // Move the elements to new storage instead and retire the old one.
+    UnorderedSet new_set(set.GetMinLoadFactor(), set.GetMaxLoadFactor(), set.get_allocator());
+    new_set.reserve(
+        static_cast<size_t>(set.size() * set.GetMaxLoadFactor() / set.GetMinLoadFactor()));
+    for (const GcRoot<mirror::String>& root : set) {
+      new_set.Put(root);
+    }
+    set.swap(new_set);
+    retired_sets_.push_back(std::move(new_set));
+    publish = true;
+  }
+  DCHECK_LT(set.size(), set.ElementsUntilExpand());
+  // Make the string contents visible to readers that find the string without the lock.
+  std::atomic_thread_fence(std::memory_order_release);
+  set.PutWithHash(GcRoot<mirror::String>(s), hash);
+  if (publish) {
+    PublishRuntimeTableViews();
+  }
 }
 
 void InternTable::Table::VisitRoots(RootVisitor* visitor) {
@@ -430,13 +620,13 @@ void InternTable::ChangeWeakRootState(gc::WeakRootState new_state) {
 
 void InternTable::ChangeWeakRootStateLocked(gc::WeakRootState new_state) {
   CHECK(!gUseReadBarrier);
-  weak_root_state_ = new_state;
+  weak_root_state_.store(new_state, std::memory_order_release);
   if (new_state != gc::kWeakRootStateNoReadsOrWrites) {
     weak_intern_condition_.Broadcast(Thread::Current());
   }
 }
 
-InternTable::Table::Table() {
+InternTable::Table::Table() : image_table_views_(nullptr), runtime_table_views_(nullptr) {
   Runtime* const runtime = Runtime::Current();
   InternalTable initial_table;
   initial_table.set_.SetLoadFactor(runtime->GetHashTableMinLoadFactor(),
@@ -444,4 +634,14 @@ InternTable::Table::Table() {
   tables_.push_back(std::move(initial_table));
 }
 
+InternTable::Table::~Table() {
+  const ImageTableView* view = image_table_views_.load(std::memory_order_relaxed);
+  while (view != nullptr) {
+    const ImageTableView* next = view->next;
+    delete view;
+    view = next;
+  }
+  delete runtime_table_views_.load(std::memory_order_relaxed);
+}
+
 }  // namespace art
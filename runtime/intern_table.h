@@ -17,6 +17,9 @@
 #ifndef ART_RUNTIME_INTERN_TABLE_H_
 #define ART_RUNTIME_INTERN_TABLE_H_
 
+#include <atomic>
+#include <memory>
+
 #include "base/dchecked_vector.h"
 #include "base/gc_visited_arena_pool.h"
 #include "base/hash_set.h"
@@ -142,7 +145,8 @@ class InternTable {
   void SweepInternTableWeaks(IsMarkedVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::intern_table_lock_);
 
-  // Lookup a strong intern, returns null if not found.
+  // Lookup a strong intern, returns null if not found. Strings that are found are usually
+  // found without taking the intern table lock, see `Table::FindInRuntimeTables()`.
   ObjPtr<mirror::String> LookupStrong(Thread* self, ObjPtr<mirror::String> s)
       REQUIRES(!Locks::intern_table_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -152,7 +156,8 @@ class InternTable {
   ObjPtr<mirror::String> LookupStrongLocked(ObjPtr<mirror::String> s)
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
 
-  // Lookup a weak intern, returns null if not found.
+  // Lookup a weak intern, returns null if not found. Strings that are found are usually
+  // found without taking the intern table lock, see `Table::FindInRuntimeTables()`.
   ObjPtr<mirror::String> LookupWeak(Thread* self, ObjPtr<mirror::String> s)
       REQUIRES(!Locks::intern_table_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -210,9 +215,11 @@ class InternTable {
    public:
     class InternalTable {
      public:
+      static constexpr size_t kNoImageIndex = static_cast<size_t>(-1);
+
       InternalTable() = default;
-      InternalTable(UnorderedSet&& set, bool is_boot_image)
-          : set_(std::move(set)), is_boot_image_(is_boot_image) {}
+      InternalTable(UnorderedSet&& set, bool is_boot_image, size_t image_index)
+          : set_(std::move(set)), is_boot_image_(is_boot_image), image_index_(image_index) {}
 
       bool Empty() const {
         return set_.empty();
@@ -226,9 +233,15 @@ class InternTable {
         return is_boot_image_;
       }
 
+      bool IsImage() const {
+        return image_index_ != kNoImageIndex;
+      }
+
      private:
       UnorderedSet set_;
       bool is_boot_image_ = false;
+      // Index of the table among the tables read from images, in the order they were added.
+      size_t image_index_ = kNoImageIndex;
 
       friend class InternTable;
       friend class linker::ImageWriter;
@@ -237,12 +250,36 @@ class InternTable {
     };
 
     Table();
+    ~Table();
+    // Find the string, skipping the first `num_searched_frozen_tables` tables and the image
+    // tables with index below `num_searched_image_tables` which the caller already searched.
     ObjPtr<mirror::String> Find(ObjPtr<mirror::String> s,
                                 uint32_t hash,
-                                size_t num_searched_frozen_tables = 0u)
+                                size_t num_searched_frozen_tables = 0u,
+                                size_t num_searched_image_tables = 0u)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-    ObjPtr<mirror::String> Find(const Utf8String& string, uint32_t hash)
+    ObjPtr<mirror::String> Find(const Utf8String& string,
+                                uint32_t hash,
+                                size_t num_searched_image_tables = 0u)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+    // Find the string in the tables read from images without holding the intern table lock.
+    // The image tables are never modified once added, so this is safe to call concurrently
+    // with insertions. Returns the number of searched image tables in the output argument.
+    template <typename Key>
+    ObjPtr<mirror::String> FindInImageTables(const Key& key,
+                                             uint32_t hash,
+                                             /*out*/ size_t* num_searched_image_tables) const
+        REQUIRES_SHARED(Locks::mutator_lock_);
+    // Find the string in the tables that were not read from images without holding the intern
+    // table lock, using the last published `RuntimeTableViews`. The caller must check that it
+    // can read weak roots with `InternTable::CanReadWithoutLock()`. A string that is being
+    // inserted or removed concurrently may be missed, so callers fall back to `Find()`.
+    template <typename Key>
+    ObjPtr<mirror::String> FindInRuntimeTables(const Key& key, uint32_t hash) const
+        REQUIRES_SHARED(Locks::mutator_lock_);
+    // Free the storage retired since the last call. Must only be called when no thread can be
+    // searching the tables without the intern table lock.
+    void ReleaseRetiredStorage() REQUIRES(Locks::intern_table_lock_);
     void Insert(ObjPtr<mirror::String> s, uint32_t hash)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
     void Remove(ObjPtr<mirror::String> s, uint32_t hash)
@@ -266,19 +303,79 @@ class InternTable {
     void SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
 
-    // Add a table to the front of the tables vector.
-    void AddInternStrings(UnorderedSet&& intern_strings, bool is_boot_image)
+    // Lock-free view of an image table. Views form a list from the most recently added one,
+    // published with release semantics, so that readers see fully initialized views. The views
+    // alias the image memory and are only used for lookups, so the number of elements they
+    // read from the image header may be stale if the visitor removed some strings.
+    struct ImageTableView {
+      ImageTableView(const uint8_t* ptr, const ImageTableView* next_view)
+          : set(ptr, /*make_copy_of_data=*/ false, &unused_read_count),
+            next(next_view),
+            num_image_tables(next_view != nullptr ? next_view->num_image_tables + 1u : 1u) {}
+
+      size_t unused_read_count;
+      const UnorderedSet set;
+      const ImageTableView* const next;
+      const size_t num_image_tables;
+    };
+
+    // Views of the tables that were not read from images, for lookups without the intern table
+    // lock. The views share the storage of the tables, so concurrent insertions and removals
+    // are visible to readers but the storage must not be freed while readers may use it.
+    // When a table needs to grow, its elements are moved to new storage and new views are
+    // published, while the old storage and views are retired until `ReleaseRetiredStorage()`.
+    // That is called when sweeping weak interns, after all threads stopped reading weak roots,
+    // so that no reader that saw the old views can still be running.
+    struct RuntimeTableViews {
+      dchecked_vector<UnorderedSet> sets;
+    };
+
+    // Publish views of the current tables that were not read from images.
+    void PublishRuntimeTableViews() REQUIRES(Locks::intern_table_lock_);
+
+    // Add a table read from `ptr` to the front of the tables vector.
+    void AddInternStrings(UnorderedSet&& intern_strings, bool is_boot_image, const uint8_t* ptr)
         REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
     // We call AddNewTable when we create the zygote to reduce private dirty pages caused by
     // modifying the zygote intern table. The back of table is modified when strings are interned.
     dchecked_vector<InternalTable> tables_;
 
+    // Views of the image tables for lookups without the intern table lock, see `ImageTableView`.
+    // Written with the intern table lock held, views are deleted only with the `Table`.
+    std::atomic<const ImageTableView*> image_table_views_;
+
+    // Views of the other tables for lookups without the intern table lock, and the storage and
+    // views retired since the last `ReleaseRetiredStorage()`, see `RuntimeTableViews`.
+    std::atomic<const RuntimeTableViews*> runtime_table_views_;
+    dchecked_vector<UnorderedSet> retired_sets_;
+    dchecked_vector<std::unique_ptr<const RuntimeTableViews>> retired_runtime_table_views_;
+
     friend class InternTable;
     friend class linker::ImageWriter;
     ART_FRIEND_TEST(InternTableTest, CrossHash);
   };
 
+  // Lookup a strong intern in the image tables without taking the intern table lock.
+  template <typename Key>
+  ObjPtr<mirror::String> LookupStrongInImageTables(const Key& key,
+                                                   uint32_t hash,
+                                                   /*out*/ size_t* num_searched_image_tables)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Whether the tables that were not read from images can be searched without the intern table
+  // lock, i.e. whether weak roots can be read and are not being swept.
+  bool CanReadWithoutLock(Thread* self) const;
+
+  // Lookup an intern in `table` without taking the intern table lock, returns null if not found
+  // or if the table cannot be searched without the lock at this time.
+  template <typename Key>
+  ObjPtr<mirror::String> LookupInRuntimeTables(Thread* self,
+                                               const Table& table,
+                                               const Key& key,
+                                               uint32_t hash)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Insert if non null, otherwise return null. Must be called holding the mutator lock.
   ObjPtr<mirror::String> Insert(ObjPtr<mirror::String> s,
                                 uint32_t hash,
@@ -322,13 +419,15 @@ class InternTable {
   // not directly access the strings in it. Use functions that contain
   // read barriers.
   Table weak_interns_ GUARDED_BY(Locks::intern_table_lock_);
-  // Weak root state, used for concurrent system weak processing and more.
-  gc::WeakRootState weak_root_state_ GUARDED_BY(Locks::intern_table_lock_);
+  // Weak root state, used for concurrent system weak processing and more. Written with the
+  // intern table lock held, read without it by `CanReadWithoutLock()`.
+  std::atomic<gc::WeakRootState> weak_root_state_;
 
   friend class gc::space::ImageSpace;
   friend class linker::ImageWriter;
   friend class Transaction;
   ART_FRIEND_TEST(InternTableTest, CrossHash);
+  ART_FRIEND_TEST(InternTableTest, ImageTable);
   DISALLOW_COPY_AND_ASSIGN(InternTable);
 };
 
@@ -19,10 +19,12 @@
 #include "base/hash_set.h"
 #include "common_runtime_test.h"
 #include "dex/utf.h"
+#include "gc/heap.h"
 #include "gc_root-inl.h"
 #include "handle_scope-inl.h"
 #include "mirror/object.h"
 #include "mirror/string.h"
+#include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
 
 namespace art HIDDEN {
@@ -263,4 +265,98 @@ TEST_F(InternTableTest, InternStrongFrozenWeak) {
   ASSERT_TRUE(strong_foo == foo.Get());
 }
 
+TEST_F(InternTableTest, LookupWithoutLock) {
+  // Use the runtime's intern table so that the GC visits and sweeps it. Intern enough strings
+  // for the tables to grow several times, so that the storage seen by lookups without the lock
+  // is replaced and the old storage is released by the GC.
+  static constexpr size_t kNumStrings = 3000u;
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable* intern_table = Runtime::Current()->GetInternTable();
+  VariableSizedHandleScope hs(soa.Self());
+  std::vector<std::string> strong_data;
+  std::vector<Handle<mirror::String>> strong;
+  std::vector<Handle<mirror::String>> weak;
+  for (size_t i = 0; i != kNumStrings; ++i) {
+    strong_data.push_back("LookupWithoutLock strong " + std::to_string(i));
+    const std::string& data = strong_data.back();
+    strong.push_back(hs.NewHandle(intern_table->InternStrong(data.length(), data.c_str())));
+    ASSERT_TRUE(strong.back() != nullptr);
+    std::string weak_data = "LookupWithoutLock weak " + std::to_string(i);
+    Handle<mirror::String> s =
+        hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), weak_data.c_str()));
+    ASSERT_TRUE(s != nullptr);
+    weak.push_back(hs.NewHandle(intern_table->InternWeak(s.Get())));
+    EXPECT_OBJ_PTR_EQ(s.Get(), weak.back().Get());
+  }
+  auto check = [&]() REQUIRES_SHARED(Locks::mutator_lock_) {
+    for (size_t i = 0; i != kNumStrings; ++i) {
+      const std::string& data = strong_data[i];
+      EXPECT_OBJ_PTR_EQ(strong[i].Get(),
+                        intern_table->LookupStrong(soa.Self(), data.length(), data.c_str()));
+      EXPECT_OBJ_PTR_EQ(strong[i].Get(), intern_table->LookupStrong(soa.Self(), strong[i].Get()));
+      EXPECT_OBJ_PTR_EQ(strong[i].Get(), intern_table->InternStrong(strong[i].Get()));
+      EXPECT_OBJ_PTR_EQ(weak[i].Get(), intern_table->LookupWeak(soa.Self(), weak[i].Get()));
+      EXPECT_OBJ_PTR_EQ(weak[i].Get(), intern_table->InternWeak(weak[i].Get()));
+      EXPECT_TRUE(intern_table->LookupStrong(soa.Self(), weak[i].Get()) == nullptr);
+    }
+  };
+  check();
+  // The GC releases the storage retired while the tables grew.
+  Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references= */ false);
+  check();
+
+  // A weak intern found for a strong insertion is promoted.
+  EXPECT_OBJ_PTR_EQ(weak[0].Get(), intern_table->InternStrong(weak[0].Get()));
+  EXPECT_OBJ_PTR_EQ(weak[0].Get(), intern_table->LookupStrong(soa.Self(), weak[0].Get()));
+  EXPECT_TRUE(intern_table->LookupWeak(soa.Self(), weak[0].Get()) == nullptr);
+}
+
+TEST_F(InternTableTest, ImageTable) {
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable intern_table;
+  StackHandleScope<3> hs(soa.Self());
+  Handle<mirror::String> foo(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "foo")));
+  Handle<mirror::String> bar(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "bar")));
+  ASSERT_TRUE(foo != nullptr);
+  ASSERT_TRUE(bar != nullptr);
+
+  // Write a table with "foo" and "bar" to memory, as in an image.
+  InternTable::UnorderedSet image_set;
+  image_set.PutWithHash(GcRoot<mirror::String>(foo.Get()),
+                        static_cast<uint32_t>(foo->GetHashCode()));
+  image_set.PutWithHash(GcRoot<mirror::String>(bar.Get()),
+                        static_cast<uint32_t>(bar->GetHashCode()));
+  std::vector<uint64_t> memory(RoundUp(image_set.WriteToMemory(nullptr), sizeof(uint64_t)) /
+                               sizeof(uint64_t));
+  image_set.WriteToMemory(reinterpret_cast<uint8_t*>(memory.data()));
+
+  // Remove "bar" while adding the table, like conflicting strings of an app image.
+  intern_table.AddTableFromMemory(reinterpret_cast<const uint8_t*>(memory.data()),
+                                  [&](InternTable::UnorderedSet& interns)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    auto it = interns.FindWithHash(GcRoot<mirror::String>(bar.Get()),
+                                   static_cast<uint32_t>(bar->GetHashCode()));
+    ASSERT_TRUE(it != interns.end());
+    interns.erase(it);
+  }, /*is_boot_image=*/ true);
+
+  // The image string is found without and with the lock.
+  EXPECT_OBJ_PTR_EQ(foo.Get(), intern_table.LookupStrong(soa.Self(), 3, "foo"));
+  EXPECT_OBJ_PTR_EQ(foo.Get(), intern_table.InternStrong(3, "foo"));
+  {
+    MutexLock mu(soa.Self(), *Locks::intern_table_lock_);
+    EXPECT_OBJ_PTR_EQ(foo.Get(), intern_table.LookupStrongLocked(foo.Get()));
+  }
+
+  // The removed string is not found and gets interned in the active table.
+  EXPECT_TRUE(intern_table.LookupStrong(soa.Self(), 3, "bar") == nullptr);
+  Handle<mirror::String> new_bar(hs.NewHandle(intern_table.InternStrong(3, "bar")));
+  ASSERT_TRUE(new_bar != nullptr);
+  EXPECT_NE(bar.Get(), new_bar.Get());
+  EXPECT_OBJ_PTR_EQ(new_bar.Get(), intern_table.LookupStrong(soa.Self(), bar.Get()));
+  EXPECT_EQ(2u, intern_table.StrongSize());
+}
+
 }  // namespace art
@@ -271,6 +271,14 @@ static inline JValue Execute(
     }
     ArtMethod *method = shadow_frame.GetMethod();
 
+    // Methods whose verification was deferred with `-Xverify:lazy` are marked as needing
+    // to count locks, so they always come here. Verify them before their first execution.
+    if (UNLIKELY(method->MustCountLocks()) &&
+        !Runtime::Current()->GetClassLinker()->VerifyDeferredMethod(self, method)) {
+      DCHECK(self->IsExceptionPending());
+      return JValue();
+    }
+
     // If we can continue in JIT and have JITed code available execute JITed code.
     if (!stay_in_interpreter &&
         !self->IsForceInterpreter() &&
@@ -63,6 +63,12 @@ namespace jit {
 
 static constexpr bool kEnableOnStackReplacement = true;
 
+// Maximum number of methods of a class compiled together in a batch.
+static constexpr size_t kMaxClassBatchSize = 16;
+
+// Maximum number of threads compiling the methods of a batch, including the JIT thread.
+static constexpr size_t kMaxBatchCompilationThreads = 4;
+
 // JIT compiler
 JitCompilerInterface* Jit::jit_compiler_ = nullptr;
 
@@ -153,7 +159,8 @@ bool Jit::TryPatternMatch(ArtMethod* method_to_compile, CompilationKind compilat
 bool Jit::CompileMethodInternal(ArtMethod* method,
                                 Thread* self,
                                 CompilationKind compilation_kind,
-                                bool prejit) {
+                                bool prejit,
+                                JitCommitBatch* batch) {
   DCHECK(Runtime::Current()->UseJitCompilation());
   DCHECK(!method->IsRuntimeMethod());
 
@@ -224,7 +231,8 @@ bool Jit::CompileMethodInternal(ArtMethod* method,
   VLOG(jit) << "Compiling method "
             << ArtMethod::PrettyMethod(method_to_compile)
             << " kind=" << compilation_kind;
-  bool success = jit_compiler_->CompileMethod(self, region, method_to_compile, compilation_kind);
+  bool success =
+      jit_compiler_->CompileMethod(self, region, method_to_compile, compilation_kind, batch);
   code_cache_->DoneCompiling(method_to_compile, self);
   if (!success) {
     VLOG(jit) << "Failed to compile method "
@@ -666,7 +674,13 @@ class JitCompileTask final : public Task {
       switch (kind_) {
         case TaskKind::kCompile:
         case TaskKind::kPreCompile: {
-          Runtime::Current()->GetJit()->CompileMethodInternal(
+          Jit* jit = Runtime::Current()->GetJit();
+          if (kind_ == TaskKind::kCompile &&
+              compilation_kind_ == CompilationKind::kOptimized &&
+              jit->MaybeCompileClassInBatch(self, method_)) {
+            break;
+          }
+          jit->CompileMethodInternal(
               method_,
               self,
               compilation_kind_,
@@ -702,6 +716,73 @@ class JitCompileTask final : public Task {
   DISALLOW_IMPLICIT_CONSTRUCTORS(JitCompileTask);
 };
 
+// Compiles one method of a batch. The last task of the batch to finish commits the code
+// of the whole batch.
+class JitBatchCompileTask final : public Task {
+ public:
+  JitBatchCompileTask(JitCommitBatch* batch,
+                      ArtMethod* method,
+                      CompilationKind compilation_kind)
+      : batch_(batch),
+        method_(method),
+        compilation_kind_(compilation_kind) {
+  }
+
+  void Run(Thread* self) override {
+    ScopedObjectAccess soa(self);
+    Jit* jit = Runtime::Current()->GetJit();
+    jit->CompileMethodInternal(method_, self, compilation_kind_, /* prejit= */ false, batch_);
+    batch_->Leave(self, jit->GetCodeCache());
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  JitCommitBatch* const batch_;
+  ArtMethod* const method_;
+  const CompilationKind compilation_kind_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(JitBatchCompileTask);
+};
+
+// Compiles the methods of a batch in parallel. Runs on the JIT thread pool, which has a
+// single thread, and spreads the compilations over a short-lived pool of its own.
+class JitBatchTask final : public Task {
+ public:
+  JitBatchTask(Jit* jit, std::shared_ptr<JitCommitBatch> batch, CompilationKind compilation_kind)
+      : jit_(jit),
+        batch_(std::move(batch)),
+        compilation_kind_(compilation_kind),
+        ran_(false) {
+  }
+
+  void Run(Thread* self) override {
+    jit_->CompileBatch(self, batch_.get(), compilation_kind_);
+    ran_ = true;
+    ProfileSaver::NotifyJitActivity();
+  }
+
+  void Finalize() override {
+    if (!ran_) {
+      // The task was dropped, for example because the JIT got suspended or is shutting
+      // down. Nothing was compiled, let the methods be compiled again.
+      jit_->OnBatchCompileDone(Thread::Current(), batch_.get());
+    }
+    delete this;
+  }
+
+ private:
+  // The task may be finalized while the runtime is deleting the JIT.
+  Jit* const jit_;
+  const std::shared_ptr<JitCommitBatch> batch_;
+  const CompilationKind compilation_kind_;
+  bool ran_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(JitBatchTask);
+};
+
 static std::string GetProfileFile(const std::string& dex_location) {
   // Hardcoded assumption where the profile file is.
   // TODO(ngeoffray): this is brittle and we would need to change change if we
@@ -1192,6 +1273,120 @@ void Jit::AddCompileTask(Thread* self,
   thread_pool_->AddTask(self, method, compilation_kind);
 }
 
+std::shared_ptr<JitCommitBatch> Jit::AddBatchCompileTasks(
+    Thread* self,
+    const std::vector<ArtMethod*>& methods,
+    CompilationKind compilation_kind) {
+  if (thread_pool_ == nullptr || methods.empty()) {
+    return nullptr;
+  }
+  if (kIsDebugBuild) {
+    for (ArtMethod* method : methods) {
+      DCHECK(!method->IsNative()) << method->PrettyMethod();
+    }
+  }
+  std::shared_ptr<JitCommitBatch> batch = std::make_shared<JitCommitBatch>(self, methods);
+  {
+    MutexLock mu(self, lock_);
+    batched_methods_.insert(methods.begin(), methods.end());
+  }
+  thread_pool_->AddTask(self, new JitBatchTask(this, batch, compilation_kind));
+  return batch;
+}
+
+void Jit::CompileBatch(Thread* self, JitCommitBatch* batch, CompilationKind compilation_kind) {
+  const std::vector<ArtMethod*>& methods = batch->GetMethods();
+  std::vector<std::unique_ptr<JitBatchCompileTask>> tasks;
+  tasks.reserve(methods.size());
+  for (ArtMethod* method : methods) {
+    tasks.push_back(std::make_unique<JitBatchCompileTask>(batch, method, compilation_kind));
+  }
+  // The calling JIT thread compiles too, so the pool only needs the other threads.
+  size_t num_workers = std::min(methods.size(), kMaxBatchCompilationThreads) - 1u;
+  std::unique_ptr<ThreadPool> pool;
+  if (num_workers != 0u && !Runtime::Current()->IsShuttingDown(self)) {
+    pool.reset(ThreadPool::Create("Jit batch thread pool", num_workers));
+    pool->SetPthreadPriority(Runtime::Current()->IsZygote()
+        ? options_->GetZygoteThreadPoolPthreadPriority()
+        : options_->GetThreadPoolPthreadPriority());
+  }
+  if (pool != nullptr) {
+    for (std::unique_ptr<JitBatchCompileTask>& task : tasks) {
+      pool->AddTask(self, task.release());
+    }
+    pool->StartWorkers(self);
+    pool->Wait(self, /* do_work= */ true, /* may_hold_locks= */ false);
+    pool->StopWorkers(self);
+  } else {
+    for (std::unique_ptr<JitBatchCompileTask>& task : tasks) {
+      task->Run(self);
+    }
+  }
+  OnBatchCompileDone(self, batch);
+}
+
+void Jit::OnBatchCompileDone(Thread* self, JitCommitBatch* batch) {
+  MutexLock mu(self, lock_);
+  for (ArtMethod* method : batch->GetMethods()) {
+    batched_methods_.erase(method);
+  }
+}
+
+bool Jit::IsMethodInPendingBatch(Thread* self, ArtMethod* method) {
+  MutexLock mu(self, lock_);
+  return batched_methods_.find(method) != batched_methods_.end();
+}
+
+bool Jit::MaybeCompileClassInBatch(Thread* self, ArtMethod* method) {
+  if (!options_->UseBatchCompilation() || method->IsNative()) {
+    return false;
+  }
+  {
+    MutexLock mu(self, lock_);
+    if (batched_methods_.find(method) != batched_methods_.end()) {
+      // A pending batch already compiles the method.
+      return true;
+    }
+  }
+  // Look for other methods of the class which still run baseline code and have done at
+  // least half the work to become hot. They are likely to be hot soon, and compiling them
+  // now lets the code cache commit them with a single synchronization of the cores.
+  std::vector<ArtMethod*> methods = { method };
+  uint16_t warm_count = ProfilingInfo::GetOptimizeThreshold() / 2u;
+  for (ArtMethod& other : method->GetDeclaringClass()->GetDeclaredMethods(kRuntimePointerSize)) {
+    if (methods.size() == kMaxClassBatchSize) {
+      break;
+    }
+    if (&other == method || other.IsNative() || other.IsAbstract() || !other.IsCompilable()) {
+      continue;
+    }
+    const void* entry_point = other.GetEntryPointFromQuickCompiledCode();
+    if (!code_cache_->ContainsPc(entry_point) ||
+        !CodeInfo::IsBaseline(
+            OatQuickMethodHeader::FromEntryPoint(entry_point)->GetOptimizedCodeInfoPtr())) {
+      continue;
+    }
+    ProfilingInfo* info = code_cache_->GetProfilingInfo(&other, self);
+    if (info == nullptr || info->GetBaselineHotnessCount() > warm_count) {
+      continue;
+    }
+    {
+      MutexLock mu(self, lock_);
+      if (batched_methods_.find(&other) != batched_methods_.end()) {
+        continue;
+      }
+    }
+    methods.push_back(&other);
+  }
+  if (methods.size() < 2u) {
+    return false;
+  }
+  VLOG(jit) << "Compiling " << methods.size() << " methods of "
+            << method->GetDeclaringClass()->PrettyClass() << " in a batch";
+  AddBatchCompileTasks(self, methods, CompilationKind::kOptimized);
+  return true;
+}
+
 bool Jit::CompileMethodFromProfile(Thread* self,
                                    ClassLinker* class_linker,
                                    uint32_t method_idx,
@@ -1723,18 +1918,21 @@ JitThreadPool::~JitThreadPool() {
 }
 
 void JitThreadPool::AddTask(Thread* self, Task* task) {
-  MutexLock mu(self, task_queue_lock_);
-  // We don't want to enqueue any new tasks when thread pool has stopped. This simplifies
-  // the implementation of redefinition feature in jvmti.
-  if (!started_) {
-    task->Finalize();
-    return;
-  }
-  generic_queue_.push_back(task);
-  // If we have any waiters, signal one.
-  if (waiting_count_ != 0) {
-    task_queue_condition_.Signal(self);
+  {
+    MutexLock mu(self, task_queue_lock_);
+    // We don't want to enqueue any new tasks when thread pool has stopped. This simplifies
+    // the implementation of redefinition feature in jvmti.
+    if (started_) {
+      generic_queue_.push_back(task);
+      // If we have any waiters, signal one.
+      if (waiting_count_ != 0) {
+        task_queue_condition_.Signal(self);
+      }
+      return;
+    }
   }
+  // Finalize outside the task queue lock, tasks may take other locks to clean up.
+  task->Finalize();
 }
 
 void JitThreadPool::AddTask(Thread* self, ArtMethod* method, CompilationKind kind) {
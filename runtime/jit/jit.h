@@ -17,6 +17,8 @@
 #ifndef ART_RUNTIME_JIT_JIT_H_
 #define ART_RUNTIME_JIT_JIT_H_
 
+#include <memory>
+#include <set>
 #include <unordered_set>
 
 #include <android-base/unique_fd.h>
@@ -54,7 +56,10 @@ class String;
 
 namespace jit {
 
+class JitBatchCompileTask;
+class JitBatchTask;
 class JitCodeCache;
+class JitCommitBatch;
 class JitCompileTask;
 class JitMemoryRegion;
 class JitOptions;
@@ -66,8 +71,13 @@ static constexpr int16_t kJitHotnessDisabled = -2;
 class JitCompilerInterface {
  public:
   virtual ~JitCompilerInterface() {}
-  virtual bool CompileMethod(
-      Thread* self, JitMemoryRegion* region, ArtMethod* method, CompilationKind compilation_kind)
+  // Compile `method`. If `batch` is not null, the code is committed with the other
+  // methods of the batch.
+  virtual bool CompileMethod(Thread* self,
+                             JitMemoryRegion* region,
+                             ArtMethod* method,
+                             CompilationKind compilation_kind,
+                             JitCommitBatch* batch)
       REQUIRES_SHARED(Locks::mutator_lock_) = 0;
   virtual void TypesLoaded(mirror::Class**, size_t count)
       REQUIRES_SHARED(Locks::mutator_lock_) = 0;
@@ -390,6 +400,20 @@ class Jit {
   EXPORT void MaybeEnqueueCompilation(ArtMethod* method, Thread* self)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Enqueue a task on the JIT thread pool compiling `methods` in parallel, and commit the
+  // code of all of them to the code cache together once they are compiled. Meant for groups
+  // of related methods becoming hot at the same time, for example the methods of a class.
+  // Native methods are not supported. Returns null if there is no JIT thread pool.
+  EXPORT std::shared_ptr<JitCommitBatch> AddBatchCompileTasks(
+      Thread* self,
+      const std::vector<ArtMethod*>& methods,
+      CompilationKind compilation_kind)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Whether `method` belongs to a batch which is not compiled yet.
+  EXPORT bool IsMethodInPendingBatch(Thread* self, ArtMethod* method) REQUIRES(!lock_);
+
   EXPORT static bool TryPatternMatch(ArtMethod* method, CompilationKind compilation_kind)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -417,10 +441,26 @@ class Jit {
                       ArtMethod* method,
                       CompilationKind compilation_kind);
 
+  // If batch compilation is enabled and other methods of the declaring class of `method` are
+  // about to get hot, compile them together with `method` in a batch. Returns whether
+  // `method` is compiled with a batch.
+  bool MaybeCompileClassInBatch(Thread* self, ArtMethod* method)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Compile the methods of `batch` on the calling JIT thread and a short-lived pool of
+  // up to `kMaxBatchCompilationThreads - 1` other threads.
+  void CompileBatch(Thread* self, JitCommitBatch* batch, CompilationKind compilation_kind)
+      REQUIRES(!lock_, !Locks::mutator_lock_);
+
+  // Called once `batch` is committed, or dropped without being compiled.
+  void OnBatchCompileDone(Thread* self, JitCommitBatch* batch) REQUIRES(!lock_);
+
   bool CompileMethodInternal(ArtMethod* method,
                              Thread* self,
                              CompilationKind compilation_kind,
-                             bool prejit)
+                             bool prejit,
+                             JitCommitBatch* batch = nullptr)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // JIT compiler
@@ -466,6 +506,11 @@ class Jit {
   // between the zygote and apps.
   std::map<ArtMethod*, uint16_t> shared_method_counters_;
 
+  // Methods of batches which are not committed yet.
+  std::set<ArtMethod*> batched_methods_ GUARDED_BY(lock_);
+
+  friend class art::jit::JitBatchCompileTask;
+  friend class art::jit::JitBatchTask;
   friend class art::jit::JitCompileTask;
 
   DISALLOW_COPY_AND_ASSIGN(Jit);
@@ -49,6 +49,7 @@
 #include "jit/jit.h"
 #include "jit/profiling_info.h"
 #include "jit/jit_scoped_code_cache_write.h"
+#include "jni/java_vm_ext.h"
 #include "linear_alloc.h"
 #include "oat/oat_file-inl.h"
 #include "oat/oat_quick_method_header.h"
@@ -457,6 +458,10 @@ void JitCodeCache::SweepRootTables(IsMarkedVisitor* visitor) {
           if (new_klass != klass) {
             cache->classes_[j] = GcRoot<mirror::Class>(new_klass);
           }
+          if (new_klass == nullptr) {
+            // The entry can be reused by another class, drop the stale count.
+            cache->counts_[j] = 0u;
+          }
         }
       }
     }
@@ -614,17 +619,22 @@ void JitCodeCache::DisallowInlineCacheAccess() {
 
 void JitCodeCache::CopyInlineCacheInto(
     const InlineCache& ic,
-    /*out*/StackHandleScope<InlineCache::kIndividualCacheSize>* classes) {
+    /*out*/StackHandleScope<InlineCache::kIndividualCacheSize>* classes,
+    /*out*/uint32_t* counts) {
   static_assert(arraysize(ic.classes_) == InlineCache::kIndividualCacheSize);
+  static_assert(arraysize(ic.counts_) == InlineCache::kIndividualCacheSize);
   DCHECK_EQ(classes->Capacity(), InlineCache::kIndividualCacheSize);
   DCHECK_EQ(classes->Size(), 0u);
   WaitUntilInlineCacheAccessible(Thread::Current());
   // Note that we don't need to lock `lock_` here, the compiler calling
   // this method has already ensured the inline cache will not be deleted.
-  for (const GcRoot<mirror::Class>& root : ic.classes_) {
-    mirror::Class* object = root.Read();
+  for (size_t i = 0; i < InlineCache::kIndividualCacheSize; ++i) {
+    mirror::Class* object = ic.classes_[i].Read();
     if (object != nullptr) {
       DCHECK_LT(classes->Size(), classes->Capacity());
+      if (counts != nullptr) {
+        counts[classes->Size()] = ic.counts_[i];
+      }
       classes->NewHandle(object);
     }
   }
@@ -664,146 +674,377 @@ bool JitCodeCache::Commit(Thread* self,
                           const std::vector<uint8_t>& debug_info,
                           bool is_full_debug_info,
                           CompilationKind compilation_kind,
-                          const ArenaSet<ArtMethod*>& cha_single_implementation_list) {
+                          const ArenaSet<ArtMethod*>& cha_single_implementation_list,
+                          JitCommitBatch* batch) {
   DCHECK_IMPLIES(method->IsNative(), (compilation_kind != CompilationKind::kOsr));
-
-  if (!method->IsNative()) {
-    // We need to do this before grabbing the lock_ because it needs to be able to see the string
-    // InternTable. Native methods do not have roots.
-    DCheckRootsAreValid(roots, IsSharedRegion(*region));
+  std::vector<ArtMethod*> cha_methods(cha_single_implementation_list.begin(),
+                                      cha_single_implementation_list.end());
+  JitCommitRequest request = {
+      method,
+      reserved_code,
+      code,
+      reserved_data,
+      &roots,
+      stack_map,
+      &debug_info,
+      is_full_debug_info,
+      compilation_kind,
+      ArrayRef<ArtMethod* const>(cha_methods),
+      /*committed=*/ false
+  };
+  if (batch != nullptr) {
+    batch->Add(self, region, request);
+    return true;
+  }
+  JitCommitRequest* requests[] = { &request };
+  CommitBatch(self, region, ArrayRef<JitCommitRequest* const>(requests));
+  return request.committed;
+}
+
+void JitCodeCache::CommitBatch(Thread* self,
+                               JitMemoryRegion* region,
+                               ArrayRef<JitCommitRequest* const> requests) {
+  for (JitCommitRequest* request : requests) {
+    DCHECK(!request->committed);
+    if (!request->method->IsNative()) {
+      // We need to do this before grabbing the lock_ because it needs to be able to see the
+      // string InternTable. Native methods do not have roots.
+      DCheckRootsAreValid(*request->roots, IsSharedRegion(*region));
+    }
   }
 
-  const uint8_t* roots_data = reserved_data.data();
-  size_t root_table_size = ComputeRootTableSize(roots.size());
-  const uint8_t* stack_map_data = roots_data + root_table_size;
-
-  OatQuickMethodHeader* method_header = nullptr;
   {
     MutexLock mu(self, *Locks::jit_lock_);
     // We need to make sure that there will be no jit-gcs going on and wait for any ongoing one to
     // finish.
     WaitForPotentialCollectionToCompleteRunnable(self);
-    const uint8_t* code_ptr = region->CommitCode(reserved_code, code, stack_map_data);
-    if (code_ptr == nullptr) {
-      return false;
-    }
-    method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
 
-    // Commit roots and stack maps before updating the entry point.
-    if (!region->CommitData(reserved_data, roots, stack_map)) {
-      return false;
+    // Copy the code and data of all methods first, so that the cores only need to be
+    // synchronized once before any of the new entry points becomes visible.
+    std::vector<const uint8_t*> code_ptrs(requests.size(), nullptr);
+    bool has_code = false;
+    for (size_t i = 0; i != requests.size(); ++i) {
+      const JitCommitRequest& request = *requests[i];
+      const uint8_t* roots_data = request.reserved_data.data();
+      size_t root_table_size = ComputeRootTableSize(request.roots->size());
+      const uint8_t* stack_map_data = roots_data + root_table_size;
+      const uint8_t* code_ptr = region->CommitCode(
+          request.reserved_code, request.code, stack_map_data, /*sync_cores=*/ false);
+      if (code_ptr == nullptr) {
+        continue;
+      }
+      // Commit roots and stack maps before updating the entry point.
+      if (!region->CommitData(request.reserved_data, *request.roots, request.stack_map)) {
+        continue;
+      }
+      code_ptrs[i] = code_ptr;
+      has_code = true;
     }
-
-    switch (compilation_kind) {
-      case CompilationKind::kOsr:
-        number_of_osr_compilations_++;
-        break;
-      case CompilationKind::kBaseline:
-        number_of_baseline_compilations_++;
-        break;
-      case CompilationKind::kOptimized:
-        number_of_optimized_compilations_++;
-        break;
+    if (has_code) {
+      JitMemoryRegion::SyncCores();
     }
 
-    // We need to update the debug info before the entry point gets set.
-    // At the same time we want to do under JIT lock so that debug info and JIT maps are in sync.
-    if (!debug_info.empty()) {
-      // NB: Don't allow packing of full info since it would remove non-backtrace data.
-      AddNativeDebugInfoForJit(code_ptr, debug_info, /*allow_packing=*/ !is_full_debug_info);
+    for (size_t i = 0; i != requests.size(); ++i) {
+      if (code_ptrs[i] != nullptr) {
+        requests[i]->committed = PublishCodeLocked(self, region, *requests[i], code_ptrs[i]);
+      }
     }
+  }
 
-    // The following needs to be guarded by cha_lock_ also. Otherwise it's possible that the
-    // compiled code is considered invalidated by some class linking, but below we still make the
-    // compiled code valid for the method.  Need cha_lock_ for checking all single-implementation
-    // flags and register dependencies.
-    {
-      ScopedDebugDisallowReadBarriers sddrb(self);
-      MutexLock cha_mu(self, *Locks::cha_lock_);
-      bool single_impl_still_valid = true;
-      for (ArtMethod* single_impl : cha_single_implementation_list) {
-        if (!single_impl->HasSingleImplementation()) {
-          // Simply discard the compiled code. Clear the counter so that it may be recompiled later.
-          // Hopefully the class hierarchy will be more stable when compilation is retried.
-          single_impl_still_valid = false;
-          ClearMethodCounter(method, /*was_warm=*/ false);
-          break;
-        }
+  if (kIsDebugBuild) {
+    for (JitCommitRequest* request : requests) {
+      if (!request->committed) {
+        continue;
       }
+      ArtMethod* method = request->method;
+      const uint8_t* code_ptr =
+          request->reserved_code.data() + OatQuickMethodHeader::InstructionAlignedSize();
+      OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
+      uintptr_t entry_point = reinterpret_cast<uintptr_t>(method_header->GetEntryPoint());
+      DCHECK_EQ(LookupMethodHeader(entry_point, method), method_header) << method->PrettyMethod();
+      DCHECK_EQ(LookupMethodHeader(entry_point + method_header->GetCodeSize() - 1, method),
+                method_header) << method->PrettyMethod();
+    }
+  }
+}
 
-      // Discard the code if any single-implementation assumptions are now invalid.
-      if (UNLIKELY(!single_impl_still_valid)) {
-        VLOG(jit) << "JIT discarded jitted code due to invalid single-implementation assumptions.";
-        return false;
-      }
-      DCHECK(cha_single_implementation_list.empty() || !Runtime::Current()->IsJavaDebuggable())
-          << "Should not be using cha on debuggable apps/runs!";
+bool JitCodeCache::PublishCodeLocked(Thread* self,
+                                     JitMemoryRegion* region,
+                                     const JitCommitRequest& request,
+                                     const uint8_t* code_ptr) {
+  ArtMethod* method = request.method;
+  CompilationKind compilation_kind = request.compilation_kind;
+  OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
 
-      ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
-      for (ArtMethod* single_impl : cha_single_implementation_list) {
-        class_linker->GetClassHierarchyAnalysis()->AddDependency(
-            single_impl, method, method_header);
+  switch (compilation_kind) {
+    case CompilationKind::kOsr:
+      number_of_osr_compilations_++;
+      break;
+    case CompilationKind::kBaseline:
+      number_of_baseline_compilations_++;
+      break;
+    case CompilationKind::kOptimized:
+      number_of_optimized_compilations_++;
+      break;
+  }
+
+  // We need to update the debug info before the entry point gets set.
+  // At the same time we want to do under JIT lock so that debug info and JIT maps are in sync.
+  if (!request.debug_info->empty()) {
+    // NB: Don't allow packing of full info since it would remove non-backtrace data.
+    AddNativeDebugInfoForJit(
+        code_ptr, *request.debug_info, /*allow_packing=*/ !request.is_full_debug_info);
+  }
+
+  // The following needs to be guarded by cha_lock_ also. Otherwise it's possible that the
+  // compiled code is considered invalidated by some class linking, but below we still make the
+  // compiled code valid for the method.  Need cha_lock_ for checking all single-implementation
+  // flags and register dependencies.
+  {
+    ScopedDebugDisallowReadBarriers sddrb(self);
+    MutexLock cha_mu(self, *Locks::cha_lock_);
+    bool single_impl_still_valid = true;
+    for (ArtMethod* single_impl : request.cha_single_implementation_list) {
+      if (!single_impl->HasSingleImplementation()) {
+        // Simply discard the compiled code. Clear the counter so that it may be recompiled later.
+        // Hopefully the class hierarchy will be more stable when compilation is retried.
+        single_impl_still_valid = false;
+        ClearMethodCounter(method, /*was_warm=*/ false);
+        break;
       }
     }
 
-    if (UNLIKELY(method->IsNative())) {
+    // Discard the code if any single-implementation assumptions are now invalid.
+    if (UNLIKELY(!single_impl_still_valid)) {
+      VLOG(jit) << "JIT discarded jitted code due to invalid single-implementation assumptions.";
+      return false;
+    }
+    DCHECK(request.cha_single_implementation_list.empty() ||
+           !Runtime::Current()->IsJavaDebuggable())
+        << "Should not be using cha on debuggable apps/runs!";
+
+    ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+    for (ArtMethod* single_impl : request.cha_single_implementation_list) {
+      class_linker->GetClassHierarchyAnalysis()->AddDependency(
+          single_impl, method, method_header);
+    }
+  }
+
+  if (UNLIKELY(method->IsNative())) {
+    ScopedDebugDisallowReadBarriers sddrb(self);
+    auto it = jni_stubs_map_.find(JniStubKey(method));
+    DCHECK(it != jni_stubs_map_.end())
+        << "Entry inserted in NotifyCompilationOf() should be alive.";
+    JniStubData* data = &it->second;
+    DCHECK(ContainsElement(data->GetMethods(), method))
+        << "Entry inserted in NotifyCompilationOf() should contain this method.";
+    data->SetCode(code_ptr);
+    data->UpdateEntryPoints(method_header->GetEntryPoint());
+  } else {
+    if (method->IsPreCompiled() && IsSharedRegion(*region)) {
       ScopedDebugDisallowReadBarriers sddrb(self);
-      auto it = jni_stubs_map_.find(JniStubKey(method));
-      DCHECK(it != jni_stubs_map_.end())
-          << "Entry inserted in NotifyCompilationOf() should be alive.";
-      JniStubData* data = &it->second;
-      DCHECK(ContainsElement(data->GetMethods(), method))
-          << "Entry inserted in NotifyCompilationOf() should contain this method.";
-      data->SetCode(code_ptr);
-      data->UpdateEntryPoints(method_header->GetEntryPoint());
+      zygote_map_.Put(code_ptr, method);
     } else {
-      if (method->IsPreCompiled() && IsSharedRegion(*region)) {
-        ScopedDebugDisallowReadBarriers sddrb(self);
-        zygote_map_.Put(code_ptr, method);
-      } else {
-        ScopedDebugDisallowReadBarriers sddrb(self);
-        method_code_map_.Put(code_ptr, method);
-      }
-      if (compilation_kind == CompilationKind::kOsr) {
-        ScopedDebugDisallowReadBarriers sddrb(self);
-        osr_code_map_.Put(method, code_ptr);
-      } else if (method->StillNeedsClinitCheck()) {
-        ScopedDebugDisallowReadBarriers sddrb(self);
-        // This situation currently only occurs in the jit-zygote mode.
-        DCHECK(!garbage_collect_code_);
-        DCHECK(method->IsPreCompiled());
-        // The shared region can easily be queried. For the private region, we
-        // use a side map.
-        if (!IsSharedRegion(*region)) {
-          saved_compiled_methods_map_.Put(method, code_ptr);
-        }
-      } else {
-        Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
-            method, method_header->GetEntryPoint());
+      ScopedDebugDisallowReadBarriers sddrb(self);
+      method_code_map_.Put(code_ptr, method);
+    }
+    if (compilation_kind == CompilationKind::kOsr) {
+      ScopedDebugDisallowReadBarriers sddrb(self);
+      osr_code_map_.Put(method, code_ptr);
+    } else if (method->StillNeedsClinitCheck()) {
+      ScopedDebugDisallowReadBarriers sddrb(self);
+      // This situation currently only occurs in the jit-zygote mode.
+      DCHECK(!garbage_collect_code_);
+      DCHECK(method->IsPreCompiled());
+      // The shared region can easily be queried. For the private region, we
+      // use a side map.
+      if (!IsSharedRegion(*region)) {
+        saved_compiled_methods_map_.Put(method, code_ptr);
       }
+    } else {
+      Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
+          method, method_header->GetEntryPoint());
     }
-    if (collection_in_progress_) {
-      // We need to update the live bitmap if there is a GC to ensure it sees this new
-      // code.
-      GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(code_ptr));
+  }
+  if (collection_in_progress_) {
+    // We need to update the live bitmap if there is a GC to ensure it sees this new
+    // code.
+    GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(code_ptr));
+  }
+  VLOG(jit)
+      << "JIT added (kind=" << compilation_kind << ") "
+      << ArtMethod::PrettyMethod(method) << "@" << method
+      << " ccache_size=" << PrettySize(CodeCacheSizeLocked()) << ": "
+      << " dcache_size=" << PrettySize(DataCacheSizeLocked()) << ": "
+      << reinterpret_cast<const void*>(method_header->GetEntryPoint()) << ","
+      << reinterpret_cast<const void*>(method_header->GetEntryPoint() +
+                                       method_header->GetCodeSize());
+  return true;
+}
+
+JitCommitBatch::JitCommitBatch(Thread* self, const std::vector<ArtMethod*>& methods)
+    : lock_("Jit commit batch lock", kGenericBottomLock),
+      methods_(methods),
+      classes_(),
+      remaining_(methods.size()),
+      pending_(),
+      region_(nullptr),
+      committed_(false),
+      number_of_committed_methods_(0u) {
+  JavaVMExt* vm = Runtime::Current()->GetJavaVM();
+  classes_.reserve(methods.size());
+  for (ArtMethod* method : methods) {
+    classes_.push_back(vm->AddGlobalRef(self, method->GetDeclaringClass()));
+  }
+  pending_.reserve(methods.size());
+}
+
+JitCommitBatch::~JitCommitBatch() {
+  Thread* self = Thread::Current();
+  // The code of a batch which was not committed, for example because the runtime shut down
+  // while compiling it, has its reserved memory go away with the code cache.
+  for (const PendingCommit& pending : pending_) {
+    DeleteGlobalRefs(self, pending.roots);
+  }
+  DeleteGlobalRefs(self, classes_);
+}
+
+void JitCommitBatch::DeleteGlobalRefs(Thread* self, const std::vector<jobject>& refs) {
+  JavaVMExt* vm = Runtime::Current()->GetJavaVM();
+  for (jobject ref : refs) {
+    vm->DeleteGlobalRef(self, ref);
+  }
+}
+
+void JitCommitBatch::Add(Thread* self, JitMemoryRegion* region, const JitCommitRequest& request) {
+  DCHECK(ContainsElement(methods_, request.method));
+  // Native methods share their code between methods with the same shorty, and are not batched.
+  DCHECK(!request.method->IsNative());
+  JavaVMExt* vm = Runtime::Current()->GetJavaVM();
+  std::vector<jobject> roots;
+  roots.reserve(request.roots->size());
+  for (Handle<mirror::Object> root : *request.roots) {
+    roots.push_back(vm->AddGlobalRef(self, root.Get()));
+  }
+  PendingCommit pending = {
+      request.method,
+      request.reserved_code,
+      std::vector<uint8_t>(request.code.begin(), request.code.end()),
+      request.reserved_data,
+      std::move(roots),
+      std::vector<uint8_t>(request.stack_map.begin(), request.stack_map.end()),
+      *request.debug_info,
+      request.is_full_debug_info,
+      request.compilation_kind,
+      std::vector<ArtMethod*>(request.cha_single_implementation_list.begin(),
+                              request.cha_single_implementation_list.end()),
+      /*commit_callback=*/ nullptr
+  };
+  MutexLock mu(self, lock_);
+  DCHECK(!committed_);
+  DCHECK(region_ == nullptr || region_ == region);
+  region_ = region;
+  pending_.push_back(std::move(pending));
+  DCHECK_LE(pending_.size(), remaining_);
+}
+
+void JitCommitBatch::SetCommitCallback(Thread* self,
+                                       ArtMethod* method,
+                                       std::function<void()>&& callback) {
+  MutexLock mu(self, lock_);
+  for (PendingCommit& pending : pending_) {
+    if (pending.method == method) {
+      DCHECK(pending.commit_callback == nullptr);
+      pending.commit_callback = std::move(callback);
+      return;
     }
-    VLOG(jit)
-        << "JIT added (kind=" << compilation_kind << ") "
-        << ArtMethod::PrettyMethod(method) << "@" << method
-        << " ccache_size=" << PrettySize(CodeCacheSizeLocked()) << ": "
-        << " dcache_size=" << PrettySize(DataCacheSizeLocked()) << ": "
-        << reinterpret_cast<const void*>(method_header->GetEntryPoint()) << ","
-        << reinterpret_cast<const void*>(method_header->GetEntryPoint() +
-                                         method_header->GetCodeSize());
   }
+  LOG(FATAL) << "No code added for " << method->PrettyMethod();
+  UNREACHABLE();
+}
 
-  if (kIsDebugBuild) {
-    uintptr_t entry_point = reinterpret_cast<uintptr_t>(method_header->GetEntryPoint());
-    DCHECK_EQ(LookupMethodHeader(entry_point, method), method_header) << method->PrettyMethod();
-    DCHECK_EQ(LookupMethodHeader(entry_point + method_header->GetCodeSize() - 1, method),
-              method_header) << method->PrettyMethod();
+void JitCommitBatch::Leave(Thread* self, JitCodeCache* code_cache) {
+  std::vector<PendingCommit> pending;
+  JitMemoryRegion* region = nullptr;
+  {
+    MutexLock mu(self, lock_);
+    DCHECK_NE(remaining_, 0u);
+    --remaining_;
+    if (remaining_ != 0u) {
+      return;
+    }
+    // We are the last compilation of the batch, commit on behalf of everyone.
+    pending.swap(pending_);
+    region = region_;
+  }
+  if (!pending.empty()) {
+    Commit(self, code_cache, region, pending);
+  }
+  MutexLock mu(self, lock_);
+  committed_ = true;
+}
+
+void JitCommitBatch::Commit(Thread* self,
+                            JitCodeCache* code_cache,
+                            JitMemoryRegion* region,
+                            const std::vector<PendingCommit>& pending) {
+  JavaVMExt* vm = Runtime::Current()->GetJavaVM();
+  VariableSizedHandleScope handles(self);
+  std::vector<std::vector<Handle<mirror::Object>>> roots(pending.size());
+  std::vector<JitCommitRequest> requests;
+  requests.reserve(pending.size());
+  for (size_t i = 0; i != pending.size(); ++i) {
+    const PendingCommit& entry = pending[i];
+    roots[i].reserve(entry.roots.size());
+    for (jobject root : entry.roots) {
+      roots[i].push_back(handles.NewHandle(vm->DecodeGlobal(root)));
+    }
+    requests.push_back(JitCommitRequest {
+        entry.method,
+        entry.reserved_code,
+        ArrayRef<const uint8_t>(entry.code),
+        entry.reserved_data,
+        &roots[i],
+        ArrayRef<const uint8_t>(entry.stack_map),
+        &entry.debug_info,
+        entry.is_full_debug_info,
+        entry.compilation_kind,
+        ArrayRef<ArtMethod* const>(entry.cha_single_implementation_list),
+        /*committed=*/ false
+    });
   }
-  return true;
+  std::vector<JitCommitRequest*> request_ptrs;
+  request_ptrs.reserve(requests.size());
+  for (JitCommitRequest& request : requests) {
+    request_ptrs.push_back(&request);
+  }
+  code_cache->CommitBatch(self, region, ArrayRef<JitCommitRequest* const>(request_ptrs));
+
+  size_t number_of_committed_methods = 0u;
+  for (size_t i = 0; i != pending.size(); ++i) {
+    if (requests[i].committed) {
+      ++number_of_committed_methods;
+      if (pending[i].commit_callback != nullptr) {
+        pending[i].commit_callback();
+      }
+    } else {
+      code_cache->Free(
+          self, region, pending[i].reserved_code.data(), pending[i].reserved_data.data());
+    }
+    DeleteGlobalRefs(self, pending[i].roots);
+  }
+  MutexLock mu(self, lock_);
+  number_of_committed_methods_ = number_of_committed_methods;
+}
+
+bool JitCommitBatch::IsCommitted() {
+  MutexLock mu(Thread::Current(), lock_);
+  return committed_;
+}
+
+size_t JitCommitBatch::GetNumberOfCommittedMethods() {
+  MutexLock mu(Thread::Current(), lock_);
+  return number_of_committed_methods_;
 }
 
 size_t JitCodeCache::CodeCacheSize() {
@@ -18,6 +18,7 @@
 #define ART_RUNTIME_JIT_JIT_CODE_CACHE_H_
 
 #include <cstdint>
+#include <functional>
 #include <iosfwd>
 #include <memory>
 #include <set>
@@ -35,6 +36,7 @@
 #include "base/safe_map.h"
 #include "compilation_kind.h"
 #include "jit_memory_region.h"
+#include "jni.h"
 #include "profiling_info.h"
 
 namespace art HIDDEN {
@@ -76,6 +78,7 @@ template<class T> class ObjectArray;
 
 namespace jit {
 
+class JitCodeCache;
 class MarkCodeClosure;
 
 // Type of bitmap used for tracking live functions in the JIT code cache for the purposes
@@ -179,6 +182,107 @@ class ZygoteMap {
   DISALLOW_COPY_AND_ASSIGN(ZygoteMap);
 };
 
+// The output of a JIT compilation, ready to be committed to the code cache.
+struct JitCommitRequest {
+  ArtMethod* method;
+  ArrayRef<const uint8_t> reserved_code;  // Uninitialized destination.
+  ArrayRef<const uint8_t> code;           // Compiler output (source).
+  ArrayRef<const uint8_t> reserved_data;  // Uninitialized destination.
+  const std::vector<Handle<mirror::Object>>* roots;
+  ArrayRef<const uint8_t> stack_map;      // Compiler output (source).
+  const std::vector<uint8_t>* debug_info;
+  bool is_full_debug_info;
+  CompilationKind compilation_kind;
+  ArrayRef<ArtMethod* const> cha_single_implementation_list;
+  // Whether the code was committed. Set by `JitCodeCache::CommitBatch()`.
+  bool committed;
+};
+
+// Collects the code of a group of methods compiled independently, possibly on different
+// threads, and commits it to the code cache with a single `JitCodeCache::CommitBatch()`
+// once every compilation of the group is done. The compiler output is copied into the
+// batch and its roots are held with global references, so compilations never wait for
+// each other.
+class JitCommitBatch {
+ public:
+  // Every method in `methods` must call `Leave()` exactly once, after its compilation,
+  // unless the batch is dropped before any compilation starts.
+  JitCommitBatch(Thread* self, const std::vector<ArtMethod*>& methods)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+  ~JitCommitBatch();
+
+  const std::vector<ArtMethod*>& GetMethods() const {
+    return methods_;
+  }
+
+  // Add the code of `request` to the batch. The batch takes ownership of the memory
+  // reserved for the request, and frees it if the code does not get committed.
+  void Add(Thread* self, JitMemoryRegion* region, const JitCommitRequest& request)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Run `callback` once the code added for `method` is published in the code cache, for
+  // example to account for it. The callback does not run if the batch discards the code.
+  // Must be called after `Add()` and before the compilation of `method` leaves the batch.
+  void SetCommitCallback(Thread* self, ArtMethod* method, std::function<void()>&& callback)
+      REQUIRES(!lock_);
+
+  // Called once for every method of the batch after its compilation, whether it added
+  // code or not. The last call commits the batch.
+  void Leave(Thread* self, JitCodeCache* code_cache)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_, !Locks::jit_lock_);
+
+  bool IsCommitted() REQUIRES(!lock_);
+
+  // Number of methods whose code was committed with the batch.
+  size_t GetNumberOfCommittedMethods() REQUIRES(!lock_);
+
+ private:
+  // A copy of the compiler output of a method, kept until the batch is committed.
+  struct PendingCommit {
+    ArtMethod* method;
+    ArrayRef<const uint8_t> reserved_code;
+    std::vector<uint8_t> code;
+    ArrayRef<const uint8_t> reserved_data;
+    std::vector<jobject> roots;
+    std::vector<uint8_t> stack_map;
+    std::vector<uint8_t> debug_info;
+    bool is_full_debug_info;
+    CompilationKind compilation_kind;
+    std::vector<ArtMethod*> cha_single_implementation_list;
+    std::function<void()> commit_callback;
+  };
+
+  void Commit(Thread* self,
+              JitCodeCache* code_cache,
+              JitMemoryRegion* region,
+              const std::vector<PendingCommit>& pending)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_, !Locks::jit_lock_);
+
+  static void DeleteGlobalRefs(Thread* self, const std::vector<jobject>& refs);
+
+  Mutex lock_;
+
+  // The methods of the batch, and global references to their declaring classes which keep
+  // the methods alive until the batch is committed.
+  const std::vector<ArtMethod*> methods_;
+  std::vector<jobject> classes_;
+
+  // Number of compilations which have not left the batch yet.
+  size_t remaining_ GUARDED_BY(lock_);
+
+  // The code added so far, and the region it was reserved in.
+  std::vector<PendingCommit> pending_ GUARDED_BY(lock_);
+  JitMemoryRegion* region_ GUARDED_BY(lock_);
+
+  bool committed_ GUARDED_BY(lock_);
+  size_t number_of_committed_methods_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(JitCommitBatch);
+};
+
 class JitCodeCache {
  public:
   static constexpr size_t kMaxCapacity = 64 * MB;
@@ -265,6 +369,9 @@ class JitCodeCache {
   // single-implementation assumptions are violated later. This needs to be done
   // even if `has_should_deoptimize_flag` is false, which can happen due to CHA
   // guard elimination.
+  //
+  // If `batch` is not null, the code is added to the batch and committed with the other
+  // methods of the batch once all of them are compiled.
   bool Commit(Thread* self,
               JitMemoryRegion* region,
               ArtMethod* method,
@@ -276,7 +383,17 @@ class JitCodeCache {
               const std::vector<uint8_t>& debug_info,
               bool is_full_debug_info,
               CompilationKind compilation_kind,
-              const ArenaSet<ArtMethod*>& cha_single_implementation_list)
+              const ArenaSet<ArtMethod*>& cha_single_implementation_list,
+              JitCommitBatch* batch = nullptr)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!Locks::jit_lock_);
+
+  // Commit all `requests` while holding the JIT lock once, and synchronize the cores only
+  // once before updating the entry points of the methods. Sets the `committed` field of
+  // each request.
+  void CommitBatch(Thread* self,
+                   JitMemoryRegion* region,
+                   ArrayRef<JitCommitRequest* const> requests)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::jit_lock_);
 
@@ -316,8 +433,11 @@ class JitCodeCache {
       REQUIRES(!Locks::jit_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Copy the classes of `ic` into `classes`. If `counts` is not null, it receives the
+  // receiver count of each copied class, in the same order as `classes`.
   void CopyInlineCacheInto(const InlineCache& ic,
-                           /*out*/StackHandleScope<InlineCache::kIndividualCacheSize>* classes)
+                           /*out*/StackHandleScope<InlineCache::kIndividualCacheSize>* classes,
+                           /*out*/uint32_t* counts = nullptr)
       REQUIRES(!Locks::jit_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -433,6 +553,16 @@ class JitCodeCache {
       REQUIRES(Locks::jit_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Register the code of `request`, previously copied to `code_ptr`, and update the entry
+  // point of its method. Returns false if the compiled code relies on single-implementation
+  // assumptions that no longer hold.
+  bool PublishCodeLocked(Thread* self,
+                         JitMemoryRegion* region,
+                         const JitCommitRequest& request,
+                         const uint8_t* code_ptr)
+      REQUIRES(Locks::jit_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // If a collection is in progress, wait for it to finish. Must be called with the mutator lock.
   // The non-mutator lock version should be used if possible. This method will release then
   // re-acquire the mutator lock.
@@ -88,11 +88,17 @@ class JitMemoryRegion {
 
   // Emit header and code into the memory pointed by `reserved_code` (despite it being const).
   // Returns pointer to copied code (within reserved_code region; after OatQuickMethodHeader).
+  // If `sync_cores` is false, the caller must call `SyncCores()` before the code can be
+  // executed; this lets a batch of methods be committed with a single synchronization.
   const uint8_t* CommitCode(ArrayRef<const uint8_t> reserved_code,
                             ArrayRef<const uint8_t> code,
-                            const uint8_t* stack_map)
+                            const uint8_t* stack_map,
+                            bool sync_cores = true)
       REQUIRES(Locks::jit_lock_);
 
+  // Ensure the instruction pipelines of all cores see the newly committed code.
+  static void SyncCores();
+
   // Emit roots and stack map into the memory pointed by `roots_data` (despite it being const).
   bool CommitData(ArrayRef<const uint8_t> reserved_data,
                   const std::vector<Handle<mirror::Object>>& roots,
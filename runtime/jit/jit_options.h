@@ -93,6 +93,11 @@ class JitOptions {
     return use_profiled_jit_compilation_;
   }
 
+  // Whether methods of a class which are hot together are compiled and committed as a batch.
+  bool UseBatchCompilation() const {
+    return use_batch_compilation_;
+  }
+
   void SetUseJitCompilation(bool b) {
     use_jit_compilation_ = b;
   }
@@ -125,6 +130,7 @@ class JitOptions {
 
   bool use_jit_compilation_;
   bool use_profiled_jit_compilation_;
+  bool use_batch_compilation_;
   bool use_baseline_compiler_;
   size_t code_cache_initial_capacity_;
   size_t code_cache_max_capacity_;
@@ -140,6 +146,7 @@ class JitOptions {
   JitOptions()
       : use_jit_compilation_(false),
         use_profiled_jit_compilation_(false),
+        use_batch_compilation_(false),
         use_baseline_compiler_(false),
         code_cache_initial_capacity_(0),
         code_cache_max_capacity_(0),
@@ -42,6 +42,11 @@ class Class;
 
 // Structure to store the classes seen at runtime for a specific instruction.
 // Once the classes_ array is full, we consider the INVOKE to be megamorphic.
+//
+// Each class entry has a counter of the receivers seen with that class. Once the
+// cache is megamorphic, the last entry holds the most recently seen class and its
+// counter accumulates all receivers not matching one of the other entries. The
+// counters are incremented without synchronization, so they are only estimates.
 class InlineCache {
  public:
   // This is hard coded in the assembly stub art_quick_update_inline_cache.
@@ -51,6 +56,10 @@ class InlineCache {
     return MemberOffset(OFFSETOF_MEMBER(InlineCache, classes_));
   }
 
+  static constexpr MemberOffset CountsOffset() {
+    return MemberOffset(OFFSETOF_MEMBER(InlineCache, counts_));
+  }
+
   // Encode the list of `dex_pcs` to fit into an uint32_t.
   static uint32_t EncodeDexPc(ArtMethod* method,
                               const std::vector<uint32_t>& dex_pcs,
@@ -66,6 +75,7 @@ class InlineCache {
  private:
   uint32_t dex_pc_;
   GcRoot<mirror::Class> classes_[kIndividualCacheSize];
+  uint32_t counts_[kIndividualCacheSize];
 
   friend class jit::JitCodeCache;
   friend class ProfilingInfo;
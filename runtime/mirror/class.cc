@@ -1460,7 +1460,11 @@ void Class::ClearDontCompileFlagOnAllMethods(PointerSize pointer_size) {
 void Class::SetSkipAccessChecksFlagOnAllMethods(PointerSize pointer_size) {
   DCHECK(IsVerified());
   for (auto& m : GetMethods(pointer_size)) {
-    if (m.IsManagedAndInvokable()) {
+    // Methods that must count locks, including those whose verification was deferred,
+    // always run with access checks. Copied methods follow the method they were copied from.
+    if (m.IsManagedAndInvokable() &&
+        !m.MustCountLocks() &&
+        !(m.IsCopied() && m.GetCanonicalMethod(pointer_size)->MustCountLocks())) {
       m.SetSkipAccessChecks();
     }
   }
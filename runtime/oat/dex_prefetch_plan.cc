@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dex_prefetch_plan.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "android-base/file.h"
+#include "android-base/stringprintf.h"
+#include "android-base/unique_fd.h"
+#include "app_info.h"
+#include "base/bit_utils.h"
+#include "base/casts.h"
+#include "base/file_utils.h"
+#include "base/globals.h"
+#include "base/logging.h"  // For VLOG.
+#include "base/mutex.h"
+#include "base/systrace.h"
+#include "class_linker.h"
+#include "dex/dex_file.h"
+#include "dex/dex_file_loader.h"
+#include "mirror/dex_cache-inl.h"
+#include "runtime.h"
+#include "runtime_image.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-current-inl.h"
+
+namespace art HIDDEN {
+
+using android::base::StringPrintf;
+
+static constexpr char kMagic[] = { 'd', 'p', 'p', '\n' };
+static constexpr uint32_t kVersion = 1u;
+
+// From https://www.kernel.org/doc/Documentation/vm/pagemap.txt:
+//  * Bit  61    page is file-page or shared-anon (since 3.5)
+//  * Bit  63    page present
+static constexpr uint64_t kPagemapFilePage = UINT64_C(1) << 61;
+static constexpr uint64_t kPagemapPresent = UINT64_C(1) << 63;
+
+std::string DexPrefetchPlan::GetPath(const std::string& dex_location) {
+  return ReplaceFileExtension(RuntimeImage::GetRuntimeImagePath(dex_location), "prefetch");
+}
+
+DexPrefetchPlan DexPrefetchPlan::Record(ArrayRef<const DexFile* const> dex_files) {
+  ScopedTrace trace("Record dex prefetch plan");
+  DexPrefetchPlan plan;
+  android::base::unique_fd pagemap(open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC));
+  if (pagemap == -1) {
+    PLOG(WARNING) << "Could not open /proc/self/pagemap";
+    return plan;
+  }
+  std::vector<uint64_t> entries;
+  for (const DexFile* dex_file : dex_files) {
+    uintptr_t begin = reinterpret_cast<uintptr_t>(AlignDown(dex_file->Begin(), gPageSize));
+    uintptr_t end = reinterpret_cast<uintptr_t>(
+        AlignUp(dex_file->Begin() + dex_file->Size(), gPageSize));
+    size_t num_pages = (end - begin) / gPageSize;
+    entries.resize(num_pages);
+    off_t offset = static_cast<off_t>((begin / gPageSize) * sizeof(uint64_t));
+    size_t bytes = num_pages * sizeof(uint64_t);
+    if (!android::base::ReadFullyAtOffset(pagemap.get(), entries.data(), bytes, offset)) {
+      PLOG(WARNING) << "Could not read pagemap of " << dex_file->GetLocation();
+      continue;
+    }
+    // Only pages of a file mapping can be read ahead. Dex files that were extracted or
+    // decompressed to anonymous memory have no such pages and are not recorded.
+    DexFilePages pages = { dex_file->GetLocationChecksum(),
+                           static_cast<uint32_t>(dex_file->Size()),
+                           /* ranges= */ {} };
+    for (size_t i = 0; i != num_pages; ++i) {
+      if ((entries[i] & (kPagemapPresent | kPagemapFilePage)) !=
+              (kPagemapPresent | kPagemapFilePage)) {
+        continue;
+      }
+      if (!pages.ranges.empty() &&
+          pages.ranges.back().first_page + pages.ranges.back().num_pages == i) {
+        ++pages.ranges.back().num_pages;
+      } else {
+        pages.ranges.push_back({ static_cast<uint32_t>(i), 1u });
+      }
+    }
+    if (!pages.ranges.empty()) {
+      plan.dex_files_.push_back(std::move(pages));
+    }
+  }
+  return plan;
+}
+
+bool DexPrefetchPlan::RecordPrimaryApk(std::string* error_msg) {
+  Runtime* runtime = Runtime::Current();
+  std::string data_dir = runtime->GetProcessDataDirectory();
+  if (data_dir.empty()) {
+    *error_msg = "No data directory to record a dex prefetch plan";
+    return false;
+  }
+
+  class CollectDexFilesVisitor : public DexCacheVisitor {
+   public:
+    void Visit(ObjPtr<mirror::DexCache> dex_cache)
+        REQUIRES_SHARED(Locks::dex_lock_, Locks::mutator_lock_) override {
+      dex_files_.push_back(dex_cache->GetDexFile());
+    }
+
+    std::vector<const DexFile*> dex_files_;
+  };
+
+  CollectDexFilesVisitor visitor;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    ReaderMutexLock mu(soa.Self(), *Locks::dex_lock_);
+    runtime->GetClassLinker()->VisitDexCaches(&visitor);
+  }
+
+  // Find the primary APK, then take all of its dex files.
+  AppInfo* app_info = runtime->GetAppInfo();
+  std::string dex_location;
+  for (const DexFile* dex_file : visitor.dex_files_) {
+    if (app_info->GetRegisteredCodeType(dex_file->GetLocation()) ==
+            AppInfo::CodeType::kPrimaryApk) {
+      dex_location = DexFileLoader::GetBaseLocation(dex_file->GetLocation());
+      break;
+    }
+  }
+  if (dex_location.empty()) {
+    *error_msg = "Did not find the dex files of the primary APK";
+    return false;
+  }
+  std::vector<const DexFile*> dex_files;
+  for (const DexFile* dex_file : visitor.dex_files_) {
+    if (DexFileLoader::GetBaseLocation(dex_file->GetLocation()) == dex_location) {
+      dex_files.push_back(dex_file);
+    }
+  }
+
+  DexPrefetchPlan plan = Record(ArrayRef<const DexFile* const>(dex_files));
+  if (plan.dex_files_.empty()) {
+    *error_msg = "No file-backed dex pages to record for " + dex_location;
+    return false;
+  }
+
+  std::string path = GetPath(dex_location);
+  if (!RuntimeImage::EnsureDirectoryExists(RuntimeImage::GetRuntimeImageDir(data_dir),
+                                           error_msg) ||
+      !RuntimeImage::EnsureDirectoryExists(android::base::Dirname(path), error_msg)) {
+    return false;
+  }
+  if (!plan.WriteToFile(path, error_msg)) {
+    return false;
+  }
+  VLOG(oat) << "Recorded " << plan.GetNumberOfPages() << " dex pages in " << path;
+  return true;
+}
+
+static void AppendUint32(std::string* data, uint32_t value) {
+  data->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool DexPrefetchPlan::WriteToFile(const std::string& path, std::string* error_msg) const {
+  std::string data(kMagic, sizeof(kMagic));
+  AppendUint32(&data, kVersion);
+  AppendUint32(&data, dchecked_integral_cast<uint32_t>(gPageSize));
+  AppendUint32(&data, dchecked_integral_cast<uint32_t>(dex_files_.size()));
+  for (const DexFilePages& pages : dex_files_) {
+    AppendUint32(&data, pages.checksum);
+    AppendUint32(&data, pages.size);
+    AppendUint32(&data, dchecked_integral_cast<uint32_t>(pages.ranges.size()));
+    for (const PageRange& range : pages.ranges) {
+      AppendUint32(&data, range.first_page);
+      AppendUint32(&data, range.num_pages);
+    }
+  }
+
+  // Write to a temporary file first so that readers never see a partial plan.
+  const std::string temp_path = path + "." + std::to_string(getpid()) + ".tmp";
+  if (!android::base::WriteStringToFile(data, temp_path)) {
+    *error_msg = StringPrintf("Could not write %s: %s", temp_path.c_str(), strerror(errno));
+    unlink(temp_path.c_str());
+    return false;
+  }
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    *error_msg = StringPrintf("Could not move %s to %s: %s",
+                              temp_path.c_str(),
+                              path.c_str(),
+                              strerror(errno));
+    unlink(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool DexPrefetchPlan::ReadFromFile(const std::string& path, std::string* error_msg) {
+  dex_files_.clear();
+  std::string data;
+  if (!android::base::ReadFileToString(path, &data)) {
+    *error_msg = StringPrintf("Could not read %s: %s", path.c_str(), strerror(errno));
+    return false;
+  }
+  size_t pos = 0u;
+  auto read_uint32 = [&](uint32_t* value) {
+    if (data.size() - pos < sizeof(*value)) {
+      return false;
+    }
+    memcpy(value, data.data() + pos, sizeof(*value));
+    pos += sizeof(*value);
+    return true;
+  };
+
+  if (data.size() < sizeof(kMagic) || memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+    *error_msg = "Invalid dex prefetch plan magic in " + path;
+    return false;
+  }
+  pos = sizeof(kMagic);
+  uint32_t version;
+  uint32_t page_size;
+  uint32_t num_dex_files;
+  if (!read_uint32(&version) || version != kVersion ||
+      !read_uint32(&page_size) || page_size != gPageSize ||
+      !read_uint32(&num_dex_files)) {
+    *error_msg = "Unsupported dex prefetch plan header in " + path;
+    return false;
+  }
+  std::vector<DexFilePages> dex_files;
+  for (uint32_t i = 0; i != num_dex_files; ++i) {
+    DexFilePages pages;
+    uint32_t num_ranges;
+    if (!read_uint32(&pages.checksum) || !read_uint32(&pages.size) || !read_uint32(&num_ranges)) {
+      *error_msg = "Truncated dex prefetch plan " + path;
+      return false;
+    }
+    // The ranges start and end within the pages of the dex file and are sorted.
+    size_t max_pages = RoundUp(pages.size, page_size) / page_size + 1u;
+    size_t next_page = 0u;
+    for (uint32_t j = 0; j != num_ranges; ++j) {
+      PageRange range;
+      if (!read_uint32(&range.first_page) || !read_uint32(&range.num_pages)) {
+        *error_msg = "Truncated dex prefetch plan " + path;
+        return false;
+      }
+      if (range.num_pages == 0u ||
+          range.first_page < next_page ||
+          range.first_page >= max_pages ||
+          range.num_pages > max_pages - range.first_page) {
+        *error_msg = "Invalid page range in dex prefetch plan " + path;
+        return false;
+      }
+      next_page = range.first_page + range.num_pages;
+      pages.ranges.push_back(range);
+    }
+    dex_files.push_back(std::move(pages));
+  }
+  if (pos != data.size()) {
+    *error_msg = "Trailing data in dex prefetch plan " + path;
+    return false;
+  }
+  dex_files_ = std::move(dex_files);
+  return true;
+}
+
+size_t DexPrefetchPlan::Apply(ArrayRef<const DexFile* const> dex_files, size_t size_limit) const {
+  ScopedTrace trace("Apply dex prefetch plan");
+  size_t advised = 0u;
+  for (const DexFile* dex_file : dex_files) {
+    auto it = std::find_if(dex_files_.begin(),
+                           dex_files_.end(),
+                           [dex_file](const DexFilePages& pages) {
+                             return pages.checksum == dex_file->GetLocationChecksum() &&
+                                    pages.size == dex_file->Size();
+                           });
+    if (it == dex_files_.end()) {
+      continue;
+    }
+    const uint8_t* begin = AlignDown(dex_file->Begin(), gPageSize);
+    const uint8_t* end = AlignUp(dex_file->Begin() + dex_file->Size(), gPageSize);
+    for (const PageRange& range : it->ranges) {
+      const uint8_t* range_begin = begin + static_cast<size_t>(range.first_page) * gPageSize;
+      if (range_begin >= end || advised >= size_limit) {
+        break;
+      }
+      size_t length = std::min<size_t>(static_cast<size_t>(range.num_pages) * gPageSize,
+                                       end - range_begin);
+      if (length > size_limit - advised) {
+        // Round the remaining budget up to whole pages. It cannot overflow, being below `length`.
+        length = RoundUp(size_limit - advised, gPageSize);
+      }
+      if (madvise(const_cast<uint8_t*>(range_begin), length, MADV_WILLNEED) != 0) {
+        PLOG(WARNING) << "Failed to madvise " << dex_file->GetLocation();
+        break;
+      }
+      advised += length;
+    }
+  }
+  return advised;
+}
+
+size_t DexPrefetchPlan::GetNumberOfPages() const {
+  size_t num_pages = 0u;
+  for (const DexFilePages& pages : dex_files_) {
+    for (const PageRange& range : pages.ranges) {
+      num_pages += range.num_pages;
+    }
+  }
+  return num_pages;
+}
+
+}  // namespace art
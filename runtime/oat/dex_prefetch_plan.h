@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_OAT_DEX_PREFETCH_PLAN_H_
+#define ART_RUNTIME_OAT_DEX_PREFETCH_PLAN_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/array_ref.h"
+#include "base/macros.h"
+
+namespace art HIDDEN {
+
+class DexFile;
+
+// Records which file-backed pages of dex files a process used, so that a later run can
+// madvise(MADV_WILLNEED) exactly these pages when loading the dex files instead of faulting
+// them in one by one in the order of first use.
+class DexPrefetchPlan {
+ public:
+  // Returns the path of the plan for `dex_location`, next to the runtime app image.
+  static std::string GetPath(const std::string& dex_location);
+
+  // Records the pages of `dex_files` mapped from a file and present in this process.
+  static DexPrefetchPlan Record(ArrayRef<const DexFile* const> dex_files);
+
+  // Records the pages of the dex files of the primary APK and writes the plan to disk.
+  static bool RecordPrimaryApk(std::string* error_msg);
+
+  bool WriteToFile(const std::string& path, std::string* error_msg) const;
+  bool ReadFromFile(const std::string& path, std::string* error_msg);
+
+  // Advises the kernel to read ahead the recorded pages of the dex files that match a recorded
+  // checksum and size, up to `size_limit` bytes in total. Returns the number of bytes advised.
+  size_t Apply(ArrayRef<const DexFile* const> dex_files, size_t size_limit) const;
+
+  size_t GetNumberOfPages() const;
+
+ private:
+  struct PageRange {
+    uint32_t first_page;  // Relative to the page containing the start of the dex file.
+    uint32_t num_pages;
+  };
+
+  struct DexFilePages {
+    uint32_t checksum;
+    uint32_t size;
+    std::vector<PageRange> ranges;
+  };
+
+  std::vector<DexFilePages> dex_files_;
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_OAT_DEX_PREFETCH_PLAN_H_
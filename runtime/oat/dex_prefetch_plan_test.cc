@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dex_prefetch_plan.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "android-base/file.h"
+#include "base/stl_util.h"
+#include "common_runtime_test.h"
+#include "dex/dex_file.h"
+#include "gtest/gtest.h"
+
+namespace art HIDDEN {
+
+class DexPrefetchPlanTest : public CommonRuntimeTest {};
+
+TEST_F(DexPrefetchPlanTest, RecordAndApply) {
+  // The dex files of this jar are stored uncompressed and mapped directly from the file.
+  std::vector<std::unique_ptr<const DexFile>> dex_files =
+      OpenTestDexFiles("MultiDexUncompressedAligned");
+  ASSERT_FALSE(dex_files.empty());
+  std::vector<const DexFile*> dex_file_ptrs = MakeNonOwningPointerVector(dex_files);
+  ArrayRef<const DexFile* const> dex_file_refs(dex_file_ptrs);
+
+  // Opening the dex files reads their headers, so at least these pages are present.
+  DexPrefetchPlan plan = DexPrefetchPlan::Record(dex_file_refs);
+  EXPECT_GE(plan.GetNumberOfPages(), dex_files.size());
+
+  ScratchFile file;
+  std::string error_msg;
+  ASSERT_TRUE(plan.WriteToFile(file.GetFilename(), &error_msg)) << error_msg;
+  DexPrefetchPlan loaded;
+  ASSERT_TRUE(loaded.ReadFromFile(file.GetFilename(), &error_msg)) << error_msg;
+  EXPECT_EQ(plan.GetNumberOfPages(), loaded.GetNumberOfPages());
+
+  EXPECT_EQ(loaded.GetNumberOfPages() * gPageSize, loaded.Apply(dex_file_refs, SIZE_MAX));
+  EXPECT_EQ(gPageSize, loaded.Apply(dex_file_refs, /* size_limit= */ 1u));
+  EXPECT_EQ(std::min<size_t>(loaded.GetNumberOfPages(), 2u) * gPageSize,
+            loaded.Apply(dex_file_refs, /* size_limit= */ gPageSize + 1u));
+
+  // Dex files without a matching checksum are not advised.
+  std::unique_ptr<const DexFile> other = OpenTestDexFile("Main");
+  ASSERT_TRUE(other != nullptr);
+  const DexFile* other_ptr = other.get();
+  EXPECT_EQ(0u, loaded.Apply(ArrayRef<const DexFile* const>(&other_ptr, 1u), SIZE_MAX));
+}
+
+TEST_F(DexPrefetchPlanTest, RejectInvalidFile) {
+  std::vector<std::unique_ptr<const DexFile>> dex_files =
+      OpenTestDexFiles("MultiDexUncompressedAligned");
+  ASSERT_FALSE(dex_files.empty());
+  std::vector<const DexFile*> dex_file_ptrs = MakeNonOwningPointerVector(dex_files);
+  DexPrefetchPlan plan = DexPrefetchPlan::Record(ArrayRef<const DexFile* const>(dex_file_ptrs));
+
+  ScratchFile file;
+  std::string error_msg;
+  ASSERT_TRUE(plan.WriteToFile(file.GetFilename(), &error_msg)) << error_msg;
+  std::string data;
+  ASSERT_TRUE(android::base::ReadFileToString(file.GetFilename(), &data));
+
+  DexPrefetchPlan loaded;
+  ASSERT_TRUE(android::base::WriteStringToFile(data.substr(0u, data.size() - 1u),
+                                               file.GetFilename()));
+  EXPECT_FALSE(loaded.ReadFromFile(file.GetFilename(), &error_msg));
+
+  ASSERT_TRUE(android::base::WriteStringToFile(data + '\0', file.GetFilename()));
+  EXPECT_FALSE(loaded.ReadFromFile(file.GetFilename(), &error_msg));
+
+  std::string bad_magic = data;
+  bad_magic[0] = 'x';
+  ASSERT_TRUE(android::base::WriteStringToFile(bad_magic, file.GetFilename()));
+  EXPECT_FALSE(loaded.ReadFromFile(file.GetFilename(), &error_msg));
+  EXPECT_EQ(0u, loaded.GetNumberOfPages());
+}
+
+}  // namespace art
@@ -1150,15 +1150,31 @@ bool ElfFileImpl<ElfTypes>::Load(File* file,
         return false;
       }
       std::string reservation_name = "ElfFile reservation for " + file->GetPath();
-      MemMap local_reservation = MemMap::MapAnonymous(
-          reservation_name.c_str(),
-          (reservation != nullptr) ? reservation->Begin() : nullptr,
-          vaddr_size,
-          PROT_NONE,
-          low_4gb,
-          /* reuse= */ false,
-          reservation,
-          error_msg);
+      // Segments aligned beyond the page size, e.g. code laid out for huge pages, need
+      // an equally aligned reservation. A caller-provided reservation is used as is.
+      size_t max_alignment = 0u;
+      for (Elf_Word j = 0; j < GetProgramHeaderNum(); j++) {
+        Elf_Phdr* phdr = GetProgramHeader(j);
+        if (phdr->p_type == PT_LOAD && IsPowerOfTwo(phdr->p_align)) {
+          max_alignment = std::max<size_t>(max_alignment, phdr->p_align);
+        }
+      }
+      MemMap local_reservation =
+          (reservation == nullptr && max_alignment > MemMap::GetPageSize())
+              ? MemMap::MapAnonymousAligned(reservation_name.c_str(),
+                                            vaddr_size,
+                                            PROT_NONE,
+                                            low_4gb,
+                                            max_alignment,
+                                            error_msg)
+              : MemMap::MapAnonymous(reservation_name.c_str(),
+                                     (reservation != nullptr) ? reservation->Begin() : nullptr,
+                                     vaddr_size,
+                                     PROT_NONE,
+                                     low_4gb,
+                                     /* reuse= */ false,
+                                     reservation,
+                                     error_msg);
       if (!local_reservation.IsValid()) {
         *error_msg = StringPrintf("Failed to allocate %s: %s",
                                   reservation_name.c_str(),
@@ -76,7 +76,8 @@ OatHeader::OatHeader(InstructionSet instruction_set,
       quick_imt_conflict_trampoline_offset_(0),
       quick_resolution_trampoline_offset_(0),
       quick_to_interpreter_bridge_offset_(0),
-      nterp_trampoline_offset_(0) {
+      nterp_trampoline_offset_(0),
+      hot_code_size_(0) {
   // Don't want asserts in header as they would be checked in each file that includes it. But the
   // fields are private, so we check inside a method.
   static_assert(decltype(magic_)().size() == kOatMagic.size(),
@@ -213,6 +214,20 @@ void OatHeader::SetExecutableOffset(uint32_t executable_offset) {
   executable_offset_ = executable_offset;
 }
 
+uint32_t OatHeader::GetHotCodeSize() const {
+  DCHECK(IsValid());
+  DCHECK_ALIGNED(hot_code_size_, kHugePageSize);
+  return hot_code_size_;
+}
+
+void OatHeader::SetHotCodeSize(uint32_t hot_code_size) {
+  DCHECK_ALIGNED(hot_code_size, kHugePageSize);
+  DCHECK(IsValid());
+  DCHECK_EQ(hot_code_size_, 0U);
+
+  hot_code_size_ = hot_code_size;
+}
+
 static const void* GetTrampoline(const OatHeader& header, uint32_t offset) {
   return (offset != 0u) ? reinterpret_cast<const uint8_t*>(&header) + offset : nullptr;
 }
@@ -44,8 +44,8 @@ std::ostream& operator<<(std::ostream& stream, StubType stub_type);
 class EXPORT PACKED(4) OatHeader {
  public:
   static constexpr std::array<uint8_t, 4> kOatMagic { { 'o', 'a', 't', '\n' } };
-  // Last oat version changed reason: store resolved MethodType-s in .bss.
-  static constexpr std::array<uint8_t, 4> kOatVersion{{'2', '4', '1', '\0'}};
+  // Last oat version changed reason: add hot code size for huge page mapping.
+  static constexpr std::array<uint8_t, 4> kOatVersion{{'2', '4', '2', '\0'}};
 
   static constexpr const char* kDex2OatCmdLineKey = "dex2oat-cmdline";
   static constexpr const char* kDebuggableKey = "debuggable";
@@ -84,6 +84,10 @@ class EXPORT PACKED(4) OatHeader {
   void SetBcpBssInfoOffset(uint32_t bcp_info_offset);
   uint32_t GetExecutableOffset() const;
   void SetExecutableOffset(uint32_t executable_offset);
+  // Size of the hot code at the start of the executable code, laid out to be mapped with
+  // huge pages; a multiple of `kHugePageSize`. Zero if the code was not laid out that way.
+  uint32_t GetHotCodeSize() const;
+  void SetHotCodeSize(uint32_t hot_code_size);
 
   const void* GetJniDlsymLookupTrampoline() const;
   uint32_t GetJniDlsymLookupTrampolineOffset() const;
@@ -155,6 +159,7 @@ class EXPORT PACKED(4) OatHeader {
   uint32_t quick_resolution_trampoline_offset_;
   uint32_t quick_to_interpreter_bridge_offset_;
   uint32_t nterp_trampoline_offset_;
+  uint32_t hot_code_size_;
 
   uint32_t key_value_store_size_;
   uint8_t key_value_store_[0];  // note variable width data at end
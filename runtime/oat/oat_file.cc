@@ -27,6 +27,7 @@
 #include <cstring>
 #include <sstream>
 #include <type_traits>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 // dlopen_ext support from bionic.
@@ -177,6 +178,9 @@ class OatFileBase : public OatFile {
 
   bool Setup(const std::vector<const DexFile*>& dex_files, std::string* error_msg);
 
+  // Ask the kernel to back the hot code laid out for huge pages with transparent huge pages.
+  void AdviseHugePagesForHotCode();
+
   // Setters exposed for ElfOatFile.
 
   void SetBegin(const uint8_t* begin) {
@@ -234,6 +238,10 @@ OatFileBase* OatFileBase::OpenOatFile(int zip_fd,
     return nullptr;
   }
 
+  if (executable) {
+    ret->AdviseHugePagesForHotCode();
+  }
+
   return ret.release();
 }
 
@@ -275,6 +283,10 @@ OatFileBase* OatFileBase::OpenOatFile(int zip_fd,
     return nullptr;
   }
 
+  if (executable) {
+    ret->AdviseHugePagesForHotCode();
+  }
+
   return ret.release();
 }
 
@@ -395,6 +407,30 @@ bool OatFileBase::ComputeFields(const std::string& file_path, std::string* error
   return true;
 }
 
+void OatFileBase::AdviseHugePagesForHotCode() {
+  size_t hot_code_size = GetOatHeader().GetHotCodeSize();
+  if (hot_code_size == 0u) {
+    return;
+  }
+  uint8_t* hot_code_begin = const_cast<uint8_t*>(Begin()) + GetOatHeader().GetExecutableOffset();
+  if (!IsAligned<kHugePageSize>(hot_code_begin)) {
+    // For example loaded by a dynamic linker that does not honor the segment alignment.
+    VLOG(oat) << "Not using huge pages for the hot code of " << GetLocation()
+              << ", unaligned at " << reinterpret_cast<const void*>(hot_code_begin);
+    return;
+  }
+  // If all code is hot, the hot code size extends past the end of the code.
+  size_t code_size = RoundUp(static_cast<size_t>(End() - hot_code_begin), MemMap::GetPageSize());
+  size_t advice_size = std::min(hot_code_size, code_size);
+#ifdef MADV_HUGEPAGE
+  if (madvise(hot_code_begin, advice_size, MADV_HUGEPAGE) != 0) {
+    PLOG(WARNING) << "Failed to madvise huge pages for the hot code of " << GetLocation();
+  }
+#else
+  UNUSED(advice_size);
+#endif
+}
+
 // Read an unaligned entry from the OatDexFile data in OatFile and advance the read
 // position by the number of bytes read, i.e. sizeof(T).
 // Return true on success, false if the read would go beyond the end of the OatFile.
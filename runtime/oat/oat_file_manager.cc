@@ -34,8 +34,10 @@
 #include "base/sdk_version.h"
 #include "base/stl_util.h"
 #include "base/systrace.h"
+#include "base/timing_logger.h"
 #include "class_linker.h"
 #include "class_loader_context.h"
+#include "dex_prefetch_plan.h"
 #include "dex/art_dex_file_loader.h"
 #include "dex/dex_file-inl.h"
 #include "dex/dex_file_loader.h"
@@ -192,6 +194,27 @@ bool OatFileManager::ShouldLoadAppImage() const {
   return true;
 }
 
+// Prefetches the dex pages recorded by a previous run of the app, instead of the leading bytes
+// of each dex file. Returns false if there is no usable plan.
+static bool ApplyDexPrefetchPlan(const char* dex_location,
+                                 const std::vector<const DexFile*>& dex_files) {
+  Runtime* const runtime = Runtime::Current();
+  if (!runtime->UseDexPrefetchPlan() || runtime->GetProcessDataDirectory().empty()) {
+    return false;
+  }
+  DexPrefetchPlan plan;
+  std::string error_msg;
+  std::string path = DexPrefetchPlan::GetPath(dex_location);
+  if (!plan.ReadFromFile(path, &error_msg)) {
+    VLOG(oat) << "No dex prefetch plan: " << error_msg;
+    return false;
+  }
+  size_t advised = plan.Apply(ArrayRef<const DexFile* const>(dex_files),
+                              runtime->GetMadviseWillNeedTotalDexSize());
+  VLOG(oat) << "Madvised " << advised << " bytes of dex files using " << path;
+  return advised != 0u;
+}
+
 std::vector<std::unique_ptr<const DexFile>> OatFileManager::OpenDexFilesFromOat(
     const char* dex_location,
     jobject class_loader,
@@ -392,7 +415,8 @@ std::vector<std::unique_ptr<const DexFile>> OatFileManager::OpenDexFilesFromOat(
       if (dex_files.empty()) {
         ScopedTrace failed_to_open_dex_files("FailedToOpenDexFilesFromOat");
         error_msgs->push_back("Failed to open dex files from " + odex_location);
-      } else if (should_madvise) {
+      } else if (should_madvise &&
+                 !ApplyDexPrefetchPlan(dex_location, MakeNonOwningPointerVector(dex_files))) {
         size_t madvise_size_limit = Runtime::Current()->GetMadviseWillNeedTotalDexSize();
         for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
           // Prefetch the dex file based on vdex size limit (name should
@@ -464,18 +488,42 @@ std::vector<std::unique_ptr<const DexFile>> OatFileManager::OpenDexFilesFromOat(
   // If we arrive here with an empty dex files list, it means we fail to load
   // it/them through an .oat file.
   if (dex_files.empty()) {
+    TimingLogger logger("OpenDexFilesFromApk", /*precise=*/ true, VLOG_IS_ON(oat));
     std::string error_msg;
     static constexpr bool kVerifyChecksum = true;
     ArtDexFileLoader dex_file_loader(dex_location);
-    if (!dex_file_loader.Open(Runtime::Current()->IsVerificationEnabled(),
-                              kVerifyChecksum,
-                              /*out*/ &error_msg,
-                              &dex_files)) {
+    bool success;
+    {
+      TimingLogger::ScopedTiming timing("OpenDexFiles", &logger);
+      success = dex_file_loader.Open(/*verify=*/ false,
+                                     kVerifyChecksum,
+                                     /*out*/ &error_msg,
+                                     &dex_files);
+    }
+    // Verify the dex files that could be opened, even if a later one could not, so that
+    // the error is the same as if each dex file was verified when it was opened.
+    if (Runtime::Current()->IsVerificationEnabled() && !dex_files.empty()) {
+      TimingLogger::ScopedTiming timing("VerifyDexFiles", &logger);
+      size_t num_verified;
+      std::string verify_error_msg;
+      if (!DexFileLoader::VerifyDexFiles(ArrayRef<const std::unique_ptr<const DexFile>>(dex_files),
+                                         kVerifyChecksum,
+                                         &num_verified,
+                                         &verify_error_msg)) {
+        dex_files.resize(num_verified);
+        error_msg = std::move(verify_error_msg);
+        success = false;
+      }
+    }
+    if (!success) {
       ScopedTrace fail_to_open_dex_from_apk("FailedToOpenDexFilesFromApk");
       LOG(WARNING) << error_msg;
       error_msgs->push_back("Failed to open dex files from " + std::string(dex_location)
                             + " because: " + error_msg);
     }
+    if (VLOG_IS_ON(oat)) {
+      logger.Dump(LOG_STREAM(INFO));
+    }
   }
 
   if (Runtime::Current()->GetJit() != nullptr) {
@@ -215,6 +215,13 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:FinalizerTimeoutMs=_")
           .WithType<unsigned int>()
           .IntoKey(M::FinalizerTimeoutMs)
+      .Define("-XX:RuntimeImageUpdateIntervalMs=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::RuntimeImageUpdateIntervalMs)
+      .Define("-XX:DexPrefetchPlan=_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::DexPrefetchPlan)
       .Define("-XX:MaxSpinsBeforeThinLockInflation=_")
           .WithType<unsigned int>()
           .IntoKey(M::MaxSpinsBeforeThinLockInflation)
@@ -271,6 +278,10 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
           .IntoKey(M::UseProfiledJitCompilation)
+      .Define("-Xjitbatchcompilation:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::UseJitBatchCompilation)
       .Define("-Xjitinitialsize:_")
           .WithType<MemoryKiB>()
           .IntoKey(M::JITCodeCacheInitialCapacity)
@@ -382,7 +393,8 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
           .WithValueMap({{"none",     verifier::VerifyMode::kNone},
                          {"remote",   verifier::VerifyMode::kEnable},
                          {"all",      verifier::VerifyMode::kEnable},
-                         {"softfail", verifier::VerifyMode::kSoftFail}})
+                         {"softfail", verifier::VerifyMode::kSoftFail},
+                         {"lazy",     verifier::VerifyMode::kLazy}})
           .IntoKey(M::Verify)
       .Define("-XX:NativeBridge=_")
           .WithType<std::string>()
@@ -205,6 +205,9 @@ static constexpr double kLowMemoryMinLoadFactor = 0.5;
 static constexpr double kLowMemoryMaxLoadFactor = 0.8;
 static constexpr double kNormalMinLoadFactor = 0.4;
 static constexpr double kNormalMaxLoadFactor = 0.7;
+// Priority of the thread writing the runtime app image after startup, the Android background
+// priority.
+static constexpr int kRuntimeImageThreadPriority = 10;
 
 #ifdef ART_PAGE_SIZE_AGNOSTIC
 // Declare the constant as ALWAYS_HIDDEN to ensure it isn't visible from outside libart.so.
@@ -423,6 +426,14 @@ Runtime::~Runtime() {
   if (oat_file_manager_ != nullptr) {
     oat_file_manager_->WaitForWorkersToBeCreated();
   }
+  ThreadPool* runtime_image_thread_pool = nullptr;
+  {
+    MutexLock mu(self, *Locks::runtime_thread_pool_lock_);
+    runtime_image_thread_pool = runtime_image_thread_pool_.get();
+  }
+  if (runtime_image_thread_pool != nullptr) {
+    runtime_image_thread_pool->WaitForWorkersToBeCreated();
+  }
   // Disable GC before deleting the thread-pool and shutting down runtime as it
   // restricts attaching new threads.
   heap_->DisableGCForShutdown();
@@ -465,6 +476,13 @@ Runtime::~Runtime() {
   if (oat_file_manager_ != nullptr) {
     oat_file_manager_->DeleteThreadPool();
   }
+  {
+    std::unique_ptr<ThreadPool> runtime_image_thread_pool;
+    {
+      MutexLock mu(self, *Locks::runtime_thread_pool_lock_);
+      runtime_image_thread_pool = std::move(runtime_image_thread_pool_);
+    }
+  }
   DeleteThreadPool();
   CHECK(thread_pool_ == nullptr);
 
@@ -1643,6 +1661,9 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   image_compiler_options_ = runtime_options.ReleaseOrDefault(Opt::ImageCompilerOptions);
 
   finalizer_timeout_ms_ = runtime_options.GetOrDefault(Opt::FinalizerTimeoutMs);
+  runtime_image_update_interval_ms_ =
+      runtime_options.GetOrDefault(Opt::RuntimeImageUpdateIntervalMs);
+  use_dex_prefetch_plan_ = runtime_options.GetOrDefault(Opt::DexPrefetchPlan);
   max_spins_before_thin_lock_inflation_ =
       runtime_options.GetOrDefault(Opt::MaxSpinsBeforeThinLockInflation);
 
@@ -3232,13 +3253,18 @@ void Runtime::DisableVerifier() {
 
 bool Runtime::IsVerificationEnabled() const {
   return verify_ == verifier::VerifyMode::kEnable ||
-      verify_ == verifier::VerifyMode::kSoftFail;
+      verify_ == verifier::VerifyMode::kSoftFail ||
+      verify_ == verifier::VerifyMode::kLazy;
 }
 
 bool Runtime::IsVerificationSoftFail() const {
   return verify_ == verifier::VerifyMode::kSoftFail;
 }
 
+bool Runtime::IsVerificationLazy() const {
+  return verify_ == verifier::VerifyMode::kLazy;
+}
+
 bool Runtime::IsAsyncDeoptimizeable(ArtMethod* method, uintptr_t code) const {
   if (OatQuickMethodHeader::NterpMethodHeader != nullptr) {
     if (OatQuickMethodHeader::NterpMethodHeader->Contains(code)) {
@@ -3462,6 +3488,21 @@ bool Runtime::DeleteThreadPool() {
   return thread_pool != nullptr;
 }
 
+ThreadPool* Runtime::GetRuntimeImageThreadPool(Thread* self) {
+  if (IsShuttingDown(self)) {
+    // Not allowed to create new threads during runtime shutdown.
+    return nullptr;
+  }
+  MutexLock mu(self, *Locks::runtime_thread_pool_lock_);
+  if (runtime_image_thread_pool_ == nullptr) {
+    runtime_image_thread_pool_.reset(
+        ThreadPool::Create("Runtime image thread pool", /*num_threads=*/ 1));
+    runtime_image_thread_pool_->SetPthreadPriority(kRuntimeImageThreadPriority);
+    runtime_image_thread_pool_->StartWorkers(self);
+  }
+  return runtime_image_thread_pool_.get();
+}
+
 ThreadPool* Runtime::AcquireThreadPool() {
   MutexLock mu(Thread::Current(), *Locks::runtime_thread_pool_lock_);
   ++thread_pool_ref_count_;
@@ -398,6 +398,19 @@ class Runtime {
     return finalizer_timeout_ms_;
   }
 
+  unsigned int GetRuntimeImageUpdateIntervalMs() const {
+    return runtime_image_update_interval_ms_;
+  }
+
+  // Returns the low priority thread pool writing the runtime app image after startup, creating
+  // it on first use. Returns null if the runtime is shutting down.
+  ThreadPool* GetRuntimeImageThreadPool(Thread* self)
+      REQUIRES(!Locks::runtime_thread_pool_lock_, !Locks::runtime_shutdown_lock_);
+
+  bool UseDexPrefetchPlan() const {
+    return use_dex_prefetch_plan_;
+  }
+
   gc::Heap* GetHeap() const {
     return heap_;
   }
@@ -708,6 +721,7 @@ class Runtime {
   void DisableVerifier();
   bool IsVerificationEnabled() const;
   EXPORT bool IsVerificationSoftFail() const;
+  bool IsVerificationLazy() const;
 
   void SetHiddenApiEnforcementPolicy(hiddenapi::EnforcementPolicy policy) {
     hidden_api_policy_ = policy;
@@ -1299,6 +1313,12 @@ class Runtime {
   // Finalizers running for longer than this many milliseconds abort the runtime.
   unsigned int finalizer_timeout_ms_;
 
+  // Interval for writing the runtime app image again after startup, 0 if disabled.
+  unsigned int runtime_image_update_interval_ms_;
+
+  // Whether to record the dex pages used during startup and prefetch them in later runs.
+  bool use_dex_prefetch_plan_;
+
   gc::Heap* heap_;
 
   std::unique_ptr<ArenaPool> jit_arena_pool_;
@@ -1345,6 +1365,10 @@ class Runtime {
   std::unique_ptr<ThreadPool> thread_pool_ GUARDED_BY(Locks::runtime_thread_pool_lock_);
   size_t thread_pool_ref_count_ GUARDED_BY(Locks::runtime_thread_pool_lock_);
 
+  // Thread pool for `RuntimeImageUpdateTask`, created on first use.
+  std::unique_ptr<ThreadPool> runtime_image_thread_pool_
+      GUARDED_BY(Locks::runtime_thread_pool_lock_);
+
   // Fault message, printed when we get a SIGSEGV. Stored as a native-heap object and accessed
   // lock-free, so needs to be atomic.
   std::atomic<std::string*> fault_message_;
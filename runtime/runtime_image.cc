@@ -228,6 +228,29 @@ class RuntimeImageHelper {
     return dex_location_;
   }
 
+  // Count the initialized classes defined by the class loader of the primary APK.
+  static size_t CountInitializedClasses(Thread* self) REQUIRES_SHARED(Locks::mutator_lock_) {
+    VariableSizedHandleScope handles(self);
+    dchecked_vector<Handle<mirror::DexCache>> dex_caches;
+    FindDexCaches(self, dex_caches, handles);
+    if (dex_caches.empty()) {
+      return 0u;
+    }
+    ObjPtr<mirror::ClassLoader> loader = dex_caches[0]->GetClassLoader();
+    ClassTable* const class_table = (loader != nullptr) ? loader->GetClassTable() : nullptr;
+    if (class_table == nullptr) {
+      return 0u;
+    }
+    size_t num_initialized_classes = 0u;
+    class_table->Visit([&](ObjPtr<mirror::Class> klass) REQUIRES_SHARED(Locks::mutator_lock_) {
+      if (klass->GetClassLoader() == loader && klass->IsVisiblyInitialized()) {
+        ++num_initialized_classes;
+      }
+      return true;
+    });
+    return num_initialized_classes;
+  }
+
  private:
   bool IsInBootImage(const void* obj) const {
     return reinterpret_cast<uintptr_t>(obj) - boot_image_begin_ < boot_image_size_;
@@ -514,6 +537,11 @@ class RuntimeImageHelper {
         return false;
       }
 
+      // The image would record the class as verified without the methods still to verify.
+      if (Runtime::Current()->GetClassLinker()->HasMethodsPendingVerification(self_, cls.Get())) {
+        return false;
+      }
+
       DCHECK(!cls->IsPrimitive());
 
       if (cls->IsArrayClass()) {
@@ -1683,9 +1711,9 @@ class RuntimeImageHelper {
   };
 
   // Find dex caches corresponding to the primary APK.
-  void FindDexCaches(Thread* self,
-                     dchecked_vector<Handle<mirror::DexCache>>& dex_caches,
-                     VariableSizedHandleScope& handles)
+  static void FindDexCaches(Thread* self,
+                            dchecked_vector<Handle<mirror::DexCache>>& dex_caches,
+                            VariableSizedHandleScope& handles)
       REQUIRES_SHARED(Locks::mutator_lock_) {
     ScopedTrace trace("Find dex caches");
     DCHECK(dex_caches.empty());
@@ -1844,7 +1872,7 @@ std::string RuntimeImage::GetRuntimeImagePath(const std::string& dex_location) {
                              GetInstructionSetString(kRuntimeISA));
 }
 
-static bool EnsureDirectoryExists(const std::string& directory, std::string* error_msg) {
+bool RuntimeImage::EnsureDirectoryExists(const std::string& directory, std::string* error_msg) {
   if (!OS::DirectoryExists(directory.c_str())) {
     static constexpr mode_t kDirectoryMode = S_IRWXU | S_IRGRP | S_IXGRP| S_IROTH | S_IXOTH;
     if (mkdir(directory.c_str(), kDirectoryMode) != 0) {
@@ -1856,6 +1884,11 @@ static bool EnsureDirectoryExists(const std::string& directory, std::string* err
   return true;
 }
 
+size_t RuntimeImage::CountInitializedAppClasses() {
+  ScopedObjectAccess soa(Thread::Current());
+  return RuntimeImageHelper::CountInitializedClasses(soa.Self());
+}
+
 bool RuntimeImage::WriteImageToDisk(std::string* error_msg) {
   gc::Heap* heap = Runtime::Current()->GetHeap();
   if (!heap->HasBootImageSpace()) {
@@ -28,6 +28,10 @@ class RuntimeImage {
     // Writes an app image for the currently running process.
   static bool WriteImageToDisk(std::string* error_msg);
 
+  // Returns the number of initialized classes defined by the class loader of the primary APK.
+  // The runtime image only needs to be written again when this number grows.
+  static size_t CountInitializedAppClasses();
+
   // Gets the path where a runtime-generated app image is stored.
   //
   // If any of the arguments is a valid glob (a pattern that contains '**' or those documented in
@@ -45,6 +49,9 @@ class RuntimeImage {
   // If the argument is a valid glob (a pattern that contains '**' or those documented in glob(7)),
   // returns a valid glob.
   EXPORT static std::string GetRuntimeImageDir(const std::string& app_data_dir);
+
+  // Creates `directory` if it does not exist yet. Its parent must exist.
+  static bool EnsureDirectoryExists(const std::string& directory, std::string* error_msg);
 };
 
 }  // namespace art
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime_image_update_task.h"
+
+#include "base/logging.h"  // For VLOG.
+#include "base/systrace.h"
+#include "base/time_utils.h"
+#include "gc/heap.h"
+#include "runtime.h"
+#include "runtime_image.h"
+#include "thread_pool.h"
+
+namespace art HIDDEN {
+
+namespace {
+
+// Writes the runtime image on the runtime image thread pool, then schedules the next update.
+class RuntimeImageWriteTask final : public Task {
+ public:
+  explicit RuntimeImageWriteTask(size_t num_initialized_classes)
+      : num_initialized_classes_(num_initialized_classes) {}
+
+  void Run([[maybe_unused]] Thread* self) override {
+    std::optional<size_t> num_initialized_classes = RuntimeImageUpdateTask::Update(
+        num_initialized_classes_,
+        []() { return RuntimeImage::CountInitializedAppClasses(); },
+        [](std::string* error_msg) { return RuntimeImage::WriteImageToDisk(error_msg); });
+    if (num_initialized_classes.has_value()) {
+      RuntimeImageUpdateTask::Schedule(num_initialized_classes.value());
+    }
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  const size_t num_initialized_classes_;
+
+  DISALLOW_COPY_AND_ASSIGN(RuntimeImageWriteTask);
+};
+
+}  // namespace
+
+void RuntimeImageUpdateTask::Run(Thread* self) {
+  ThreadPool* thread_pool = Runtime::Current()->GetRuntimeImageThreadPool(self);
+  if (thread_pool == nullptr) {
+    // The runtime is shutting down.
+    return;
+  }
+  thread_pool->AddTask(self, new RuntimeImageWriteTask(num_initialized_classes_));
+}
+
+bool RuntimeImageUpdateTask::Schedule(size_t num_initialized_classes) {
+  Runtime* const runtime = Runtime::Current();
+  unsigned int interval_ms = runtime->GetRuntimeImageUpdateIntervalMs();
+  if (interval_ms == 0u) {
+    return false;
+  }
+  runtime->GetHeap()->AddHeapTask(
+      new RuntimeImageUpdateTask(NanoTime() + MsToNs(interval_ms), num_initialized_classes));
+  return true;
+}
+
+std::optional<size_t> RuntimeImageUpdateTask::Update(
+    size_t num_initialized_classes,
+    const std::function<size_t()>& count_initialized_classes,
+    const std::function<bool(std::string*)>& write_image) {
+  if (count_initialized_classes() <= num_initialized_classes) {
+    // Nothing new to put in the image.
+    return num_initialized_classes;
+  }
+  ScopedTrace trace("Updating runtime image");
+  std::string error_msg;
+  if (!write_image(&error_msg)) {
+    LOG(DEBUG) << "Could not update runtime image " << error_msg;
+    return std::nullopt;
+  }
+  // Count again, as writing the image may load classes listed in the reference profile.
+  size_t num_written_classes = count_initialized_classes();
+  VLOG(startup) << "Updated runtime image with " << num_written_classes << " initialized classes";
+  return num_written_classes;
+}
+
+}  // namespace art
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_RUNTIME_IMAGE_UPDATE_TASK_H_
+#define ART_RUNTIME_RUNTIME_IMAGE_UPDATE_TASK_H_
+
+#include <functional>
+#include <optional>
+#include <string>
+
+#include "base/macros.h"
+#include "gc/task_processor.h"
+
+namespace art HIDDEN {
+
+class Thread;
+
+// Periodically writes the runtime app image again, if classes of the primary APK were
+// initialized since the last write. The heap task only waits for the update interval; the
+// image is generated on a low priority thread so that it does not delay the other heap
+// tasks, such as concurrent GCs.
+class RuntimeImageUpdateTask : public gc::HeapTask {
+ public:
+  RuntimeImageUpdateTask(uint64_t target_run_time, size_t num_initialized_classes)
+      : gc::HeapTask(target_run_time), num_initialized_classes_(num_initialized_classes) {}
+
+  void Run(Thread* self) override;
+
+  // Schedule the next update if enabled with -XX:RuntimeImageUpdateIntervalMs. Returns
+  // whether an update was scheduled.
+  static bool Schedule(size_t num_initialized_classes);
+
+  // Write the image with `write_image` if `count_initialized_classes` returns more classes
+  // than `num_initialized_classes`, the number of initialized classes when the image was
+  // last written. Returns the number of initialized classes to compare with at the next
+  // update, or nothing if writing the image failed and updates should stop.
+  static std::optional<size_t> Update(
+      size_t num_initialized_classes,
+      const std::function<size_t()>& count_initialized_classes,
+      const std::function<bool(std::string*)>& write_image);
+
+ private:
+  // The number of initialized classes when the image was last written.
+  const size_t num_initialized_classes_;
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_RUNTIME_IMAGE_UPDATE_TASK_H_
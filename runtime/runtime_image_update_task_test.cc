@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime_image_update_task.h"
+
+#include <optional>
+#include <string>
+
+#include "common_runtime_test.h"
+#include "gtest/gtest.h"
+
+namespace art HIDDEN {
+
+class RuntimeImageUpdateTaskTest : public CommonRuntimeTest {};
+
+class RuntimeImageUpdateTaskWithIntervalTest : public CommonRuntimeTest {
+ protected:
+  void SetUpRuntimeOptions(RuntimeOptions* options) override {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-XX:RuntimeImageUpdateIntervalMs=60000", nullptr));
+  }
+};
+
+TEST_F(RuntimeImageUpdateTaskTest, SkipsWithoutNewClasses) {
+  size_t num_writes = 0u;
+  std::optional<size_t> result = RuntimeImageUpdateTask::Update(
+      /*num_initialized_classes=*/ 10u,
+      []() { return 10u; },
+      [&](std::string*) {
+        ++num_writes;
+        return true;
+      });
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(10u, result.value());
+  EXPECT_EQ(0u, num_writes);
+}
+
+TEST_F(RuntimeImageUpdateTaskTest, WritesWithNewClasses) {
+  // Writing the image may initialize more classes, the next update compares with the count
+  // taken after the write.
+  size_t num_classes = 12u;
+  size_t num_writes = 0u;
+  std::optional<size_t> result = RuntimeImageUpdateTask::Update(
+      /*num_initialized_classes=*/ 10u,
+      [&]() { return num_classes; },
+      [&](std::string*) {
+        ++num_writes;
+        num_classes = 15u;
+        return true;
+      });
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(15u, result.value());
+  EXPECT_EQ(1u, num_writes);
+}
+
+TEST_F(RuntimeImageUpdateTaskTest, StopsAfterFailedWrite) {
+  std::optional<size_t> result = RuntimeImageUpdateTask::Update(
+      /*num_initialized_classes=*/ 10u,
+      []() { return 12u; },
+      [](std::string* error_msg) {
+        *error_msg = "test failure";
+        return false;
+      });
+  EXPECT_FALSE(result.has_value());
+}
+
+TEST_F(RuntimeImageUpdateTaskTest, NotScheduledByDefault) {
+  EXPECT_EQ(0u, Runtime::Current()->GetRuntimeImageUpdateIntervalMs());
+  EXPECT_FALSE(RuntimeImageUpdateTask::Schedule(/*num_initialized_classes=*/ 0u));
+}
+
+TEST_F(RuntimeImageUpdateTaskWithIntervalTest, Scheduled) {
+  EXPECT_EQ(60000u, Runtime::Current()->GetRuntimeImageUpdateIntervalMs());
+  EXPECT_TRUE(RuntimeImageUpdateTask::Schedule(/*num_initialized_classes=*/ 0u));
+}
+
+}  // namespace art
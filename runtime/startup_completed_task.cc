@@ -26,8 +26,10 @@
 #include "linear_alloc-inl.h"
 #include "mirror/dex_cache.h"
 #include "mirror/object-inl.h"
+#include "oat/dex_prefetch_plan.h"
 #include "obj_ptr.h"
 #include "runtime_image.h"
+#include "runtime_image_update_task.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread.h"
 #include "thread_list.h"
@@ -61,10 +63,20 @@ void StartupCompletedTask::Run(Thread* self) {
         std::string error_msg;
         if (!RuntimeImage::WriteImageToDisk(&error_msg)) {
           LOG(DEBUG) << "Could not write temporary image to disk " << error_msg;
+        } else if (runtime->GetRuntimeImageUpdateIntervalMs() != 0u) {
+          RuntimeImageUpdateTask::Schedule(RuntimeImage::CountInitializedAppClasses());
         }
       }
     }
 
+    // Record the dex pages used during startup, for prefetching them in the next run.
+    if (runtime->UseDexPrefetchPlan()) {
+      std::string error_msg;
+      if (!DexPrefetchPlan::RecordPrimaryApk(&error_msg)) {
+        LOG(DEBUG) << "Could not record dex prefetch plan " << error_msg;
+      }
+    }
+
     ScopedObjectAccess soa(self);
     DeleteStartupDexCaches(self, /* called_by_gc= */ false);
   }
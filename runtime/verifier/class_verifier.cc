@@ -81,6 +81,21 @@ static void UpdateMethodFlags(uint32_t method_index,
   }
 }
 
+static void WarnAboutLockVerificationFailure(const DexFile* dex_file, uint32_t method_index) {
+  // Print a warning about expected slow-down.
+  // Use a string temporary to print one contiguous warning.
+  std::string tmp =
+      StringPrintf("Method %s failed lock verification and will run slower.",
+                   dex_file->PrettyMethod(method_index).c_str());
+  if (!gPrintedDxMonitorText) {
+    tmp +=
+        "\nCommon causes for lock verification issues are non-optimized dex code\n"
+        "and incorrect proguard optimizations.";
+    gPrintedDxMonitorText = true;
+  }
+  LOG(WARNING) << tmp;
+}
+
 FailureKind ClassVerifier::VerifyClass(Thread* self,
                                        VerifierDeps* verifier_deps,
                                        const DexFile* dex_file,
@@ -91,7 +106,8 @@ FailureKind ClassVerifier::VerifyClass(Thread* self,
                                        CompilerCallbacks* callbacks,
                                        HardFailLogMode log_level,
                                        uint32_t api_level,
-                                       std::string* error) {
+                                       std::string* error,
+                                       std::vector<uint32_t>* deferred_method_indexes) {
   // A class must not be abstract and final.
   if ((class_def.access_flags_ & (kAccAbstract | kAccFinal)) == (kAccAbstract | kAccFinal)) {
     *error = "Verifier rejected class ";
@@ -121,6 +137,15 @@ FailureKind ClassVerifier::VerifyClass(Thread* self,
       continue;
     }
     *previous_idx = method_idx;
+    // The class initializer runs when the class is initialized, so there is nothing to gain
+    // from verifying it lazily.
+    if (deferred_method_indexes != nullptr &&
+        method.GetCodeItem() != nullptr &&
+        (method.GetAccessFlags() & (kAccStatic | kAccConstructor)) !=
+            (kAccStatic | kAccConstructor)) {
+      deferred_method_indexes->push_back(method_idx);
+      continue;
+    }
     std::string hard_failure_msg;
     MethodVerifier::FailureData result =
         MethodVerifier::VerifyMethod(self,
@@ -153,18 +178,7 @@ FailureKind ClassVerifier::VerifyClass(Thread* self,
     } else if (result.kind != FailureKind::kNoFailure) {
       UpdateMethodFlags(method.GetIndex(), klass, dex_cache, callbacks, result.types);
       if ((result.types & VerifyError::VERIFY_ERROR_LOCKING) != 0) {
-        // Print a warning about expected slow-down.
-        // Use a string temporary to print one contiguous warning.
-        std::string tmp =
-            StringPrintf("Method %s failed lock verification and will run slower.",
-                         dex_file->PrettyMethod(method.GetIndex()).c_str());
-        if (!gPrintedDxMonitorText) {
-          tmp +=
-              "\nCommon causes for lock verification issues are non-optimized dex code\n"
-              "and incorrect proguard optimizations.";
-          gPrintedDxMonitorText = true;
-        }
-        LOG(WARNING) << tmp;
+        WarnAboutLockVerificationFailure(dex_file, method.GetIndex());
       }
     }
 
@@ -188,5 +202,54 @@ FailureKind ClassVerifier::VerifyClass(Thread* self,
   return failure_data.kind;
 }
 
+FailureKind ClassVerifier::VerifyMethod(Thread* self,
+                                        ArtMethod* method,
+                                        HardFailLogMode log_level,
+                                        uint32_t api_level,
+                                        /*out*/ uint32_t* failure_types,
+                                        /*out*/ std::string* error) {
+  DCHECK(!Runtime::Current()->IsAotCompiler());
+  StackHandleScope<2> hs(self);
+  Handle<mirror::DexCache> dex_cache(hs.NewHandle(method->GetDexCache()));
+  Handle<mirror::ClassLoader> class_loader(hs.NewHandle(method->GetClassLoader()));
+  const DexFile* dex_file = dex_cache->GetDexFile();
+  const uint32_t method_idx = method->GetDexMethodIndex();
+  SCOPED_TRACE << "VerifyMethod " << method->PrettyMethod();
+  metrics::AutoTimer timer{GetMetrics()->ClassVerificationTotalTime()};
+
+  std::string hard_failure_msg;
+  MethodVerifier::FailureData result =
+      MethodVerifier::VerifyMethod(self,
+                                   Runtime::Current()->GetClassLinker(),
+                                   Runtime::Current()->GetArenaPool(),
+                                   /*verifier_deps=*/ nullptr,
+                                   method_idx,
+                                   dex_file,
+                                   dex_cache,
+                                   class_loader,
+                                   method->GetClassDef(),
+                                   method->GetCodeItem(),
+                                   method->GetAccessFlags() & kAccValidMethodFlags,
+                                   log_level,
+                                   api_level,
+                                   /*aot_mode=*/ false,
+                                   &hard_failure_msg);
+  uint64_t elapsed_time_microseconds = timer.Stop();
+  VLOG(verifier) << "VerifyMethod took " << PrettyDuration(UsToNs(elapsed_time_microseconds))
+                 << ", method: " << method->PrettyMethod();
+  GetMetrics()->ClassVerificationTotalTimeDelta()->Add(elapsed_time_microseconds);
+
+  if (result.kind == FailureKind::kHardFailure) {
+    *error = "Verifier rejected method ";
+    *error += method->PrettyMethod();
+    *error += ": ";
+    *error += hard_failure_msg;
+  } else if ((result.types & VerifyError::VERIFY_ERROR_LOCKING) != 0) {
+    WarnAboutLockVerificationFailure(dex_file, method_idx);
+  }
+  *failure_types = result.types;
+  return result.kind;
+}
+
 }  // namespace verifier
 }  // namespace art
@@ -18,6 +18,7 @@
 #define ART_RUNTIME_VERIFIER_CLASS_VERIFIER_H_
 
 #include <string>
+#include <vector>
 
 #include <android-base/macros.h>
 #include <android-base/thread_annotations.h>
@@ -32,6 +33,7 @@
 
 namespace art HIDDEN {
 
+class ArtMethod;
 class ClassLinker;
 class CompilerCallbacks;
 class DexFile;
@@ -55,7 +57,9 @@ class VerifierDeps;
 class ClassVerifier {
  public:
   // The main entrypoint for class verification. During AOT, `klass` can be
-  // null.
+  // null. If `deferred_method_indexes` is not null, methods with code other than
+  // the class initializer are not verified but their indexes are added to it, to
+  // be verified with `VerifyMethod()` before they are first executed.
   EXPORT static FailureKind VerifyClass(Thread* self,
                                         VerifierDeps* verifier_deps,
                                         const DexFile* dex_file,
@@ -66,7 +70,19 @@ class ClassVerifier {
                                         CompilerCallbacks* callbacks,
                                         HardFailLogMode log_level,
                                         uint32_t api_level,
-                                        std::string* error) REQUIRES_SHARED(Locks::mutator_lock_);
+                                        std::string* error,
+                                        std::vector<uint32_t>* deferred_method_indexes = nullptr)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Verify a method whose verification was deferred by `VerifyClass()`. On success or
+  // soft failure, `failure_types` receives the `VerifyError` bits encountered.
+  static FailureKind VerifyMethod(Thread* self,
+                                  ArtMethod* method,
+                                  HardFailLogMode log_level,
+                                  uint32_t api_level,
+                                  /*out*/ uint32_t* failure_types,
+                                  /*out*/ std::string* error)
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
  private:
   DISALLOW_COPY_AND_ASSIGN(ClassVerifier);
@@ -3595,30 +3595,39 @@ bool MethodVerifier<kVerifierDebug>::CodeFlowVerifyInstruction(uint32_t* start_g
 template <bool kVerifierDebug>
 template <CheckAccess C>
 const RegType& MethodVerifier<kVerifierDebug>::ResolveClass(dex::TypeIndex class_idx) {
-  ClassLinker* linker = GetClassLinker();
-  ObjPtr<mirror::Class> klass = can_load_classes_
-      ? linker->ResolveType(class_idx, dex_cache_, class_loader_)
-      : linker->LookupResolvedType(class_idx, dex_cache_.Get(), class_loader_.Get());
-  if (can_load_classes_ && klass == nullptr) {
-    DCHECK(self_->IsExceptionPending());
-    self_->ClearException();
-  }
-  const RegType* result = nullptr;
-  if (klass != nullptr) {
-    bool precise = klass->CannotBeAssignedFromOtherTypes();
-    if (precise && !IsInstantiableOrPrimitive(klass)) {
-      const char* descriptor = dex_file_->StringByTypeIdx(class_idx);
-      UninstantiableError(descriptor);
-      precise = false;
+  // Most type indexes are resolved many times per method, so remember the result of the first
+  // resolution unless it reported an error that must be reported again.
+  const RegType* result = reg_types_.FindTypeIndex(class_idx);
+  if (result == nullptr) {
+    ClassLinker* linker = GetClassLinker();
+    ObjPtr<mirror::Class> klass = can_load_classes_
+        ? linker->ResolveType(class_idx, dex_cache_, class_loader_)
+        : linker->LookupResolvedType(class_idx, dex_cache_.Get(), class_loader_.Get());
+    if (can_load_classes_ && klass == nullptr) {
+      DCHECK(self_->IsExceptionPending());
+      self_->ClearException();
     }
-    result = reg_types_.FindClass(klass, precise);
-    if (result == nullptr) {
+    bool record = true;
+    if (klass != nullptr) {
+      bool precise = klass->CannotBeAssignedFromOtherTypes();
+      if (precise && !IsInstantiableOrPrimitive(klass)) {
+        const char* descriptor = dex_file_->StringByTypeIdx(class_idx);
+        UninstantiableError(descriptor);
+        precise = false;
+        record = false;
+      }
+      result = reg_types_.FindClass(klass, precise);
+      if (result == nullptr) {
+        const char* descriptor = dex_file_->StringByTypeIdx(class_idx);
+        result = reg_types_.InsertClass(descriptor, klass, precise);
+      }
+    } else {
       const char* descriptor = dex_file_->StringByTypeIdx(class_idx);
-      result = reg_types_.InsertClass(descriptor, klass, precise);
+      result = &reg_types_.FromDescriptor(class_loader_.Get(), descriptor, false);
+    }
+    if (record) {
+      reg_types_.RecordTypeIndex(class_idx, *result);
     }
-  } else {
-    const char* descriptor = dex_file_->StringByTypeIdx(class_idx);
-    result = &reg_types_.FromDescriptor(class_loader_.Get(), descriptor, false);
   }
   DCHECK(result != nullptr);
   if (result->IsConflict()) {
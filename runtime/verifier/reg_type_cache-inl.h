@@ -20,6 +20,7 @@
 #include "base/bit_vector-inl.h"
 #include "class_linker.h"
 #include "class_root-inl.h"
+#include "dex/utf.h"
 #include "mirror/class-inl.h"
 #include "mirror/method_handle_impl.h"
 #include "mirror/method_type.h"
@@ -185,6 +186,10 @@ template <class RegTypeType>
 inline RegTypeType& RegTypeCache::AddEntry(RegTypeType* new_entry) {
   DCHECK(new_entry != nullptr);
   entries_.push_back(new_entry);
+  if (!new_entry->descriptor_.empty()) {
+    descriptor_entries_.emplace(ComputeModifiedUtf8Hash(new_entry->descriptor_),
+                                new_entry->GetId());
+  }
   if (new_entry->HasClass()) {
     Handle<mirror::Class> klass = new_entry->GetClassHandle();
     DCHECK(!klass->IsPrimitive());
@@ -28,6 +28,7 @@
 #include "class_root-inl.h"
 #include "dex/descriptors_names.h"
 #include "dex/dex_file-inl.h"
+#include "dex/utf.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "reg_type-inl.h"
@@ -186,12 +187,18 @@ const RegType& RegTypeCache::From(ObjPtr<mirror::ClassLoader> loader,
                                   bool precise) {
   std::string_view sv_descriptor(descriptor);
   // Try looking up the class in the cache first. We use a std::string_view to avoid
-  // repeated strlen operations on the descriptor.
-  for (size_t i = kNumPrimitivesAndSmallConstants; i < entries_.size(); i++) {
-    if (MatchDescriptor(i, sv_descriptor, precise)) {
-      return *(entries_[i]);
+  // repeated strlen operations on the descriptor. If several entries match, return the
+  // oldest one, i.e. the one with the lowest id.
+  auto range = descriptor_entries_.equal_range(ComputeModifiedUtf8Hash(sv_descriptor));
+  size_t match_id = entries_.size();
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second < match_id && MatchDescriptor(it->second, sv_descriptor, precise)) {
+      match_id = it->second;
     }
   }
+  if (match_id != entries_.size()) {
+    return *(entries_[match_id]);
+  }
   // Class not found in the cache, will create a new type for that.
   // Try resolving class.
   ObjPtr<mirror::Class> klass = ResolveClass(descriptor, loader);
@@ -289,6 +296,16 @@ const RegType& RegTypeCache::FromClass(const char* descriptor,
   return *reg_type;
 }
 
+const RegType* RegTypeCache::FindTypeIndex(dex::TypeIndex type_index) const {
+  auto it = type_index_entries_.find(type_index.index_);
+  return (it != type_index_entries_.end()) ? &GetFromId(it->second) : nullptr;
+}
+
+void RegTypeCache::RecordTypeIndex(dex::TypeIndex type_index, const RegType& reg_type) {
+  DCHECK(FindTypeIndex(type_index) == nullptr);
+  type_index_entries_.emplace(type_index.index_, reg_type.GetId());
+}
+
 RegTypeCache::RegTypeCache(ClassLinker* class_linker,
                            bool can_load_classes,
                            ScopedArenaAllocator& allocator,
@@ -296,6 +313,10 @@ RegTypeCache::RegTypeCache(ClassLinker* class_linker,
                            bool can_suspend)
     : entries_(allocator.Adapter(kArenaAllocVerifier)),
       klass_entries_(allocator.Adapter(kArenaAllocVerifier)),
+      descriptor_entries_(allocator.Adapter(kArenaAllocVerifier)),
+      merged_entries_(allocator.Adapter(kArenaAllocVerifier)),
+      super_class_entries_(allocator.Adapter(kArenaAllocVerifier)),
+      type_index_entries_(allocator.Adapter(kArenaAllocVerifier)),
       allocator_(allocator),
       handles_(handles),
       class_linker_(class_linker),
@@ -316,6 +337,21 @@ RegTypeCache::RegTypeCache(ClassLinker* class_linker,
 const RegType& RegTypeCache::FromUnresolvedMerge(const RegType& left,
                                                  const RegType& right,
                                                  MethodVerifier* verifier) {
+  // Merging an unresolved type into a merged type that already contains it yields the same
+  // merged type, so return it without building the set of unresolved types again.
+  if (left.IsUnresolvedMergedReference() &&
+      right.IsUnresolvedTypes() &&
+      !right.IsUnresolvedMergedReference() &&
+      down_cast<const UnresolvedMergedType*>(&left)->GetUnresolvedTypes().IsBitSet(right.GetId())) {
+    return left;
+  }
+  if (right.IsUnresolvedMergedReference() &&
+      left.IsUnresolvedTypes() &&
+      !left.IsUnresolvedMergedReference() &&
+      down_cast<const UnresolvedMergedType*>(&right)->GetUnresolvedTypes().IsBitSet(left.GetId())) {
+    return right;
+  }
+
   ArenaBitVector types(&allocator_,
                        kDefaultArenaBitVectorBytes * kBitsPerByte,  // Allocate at least 8 bytes.
                        true);                                       // Is expandable.
@@ -383,39 +419,44 @@ const RegType& RegTypeCache::FromUnresolvedMerge(const RegType& left,
   }
 
   // Check if entry already exists.
-  for (size_t i = kNumPrimitivesAndSmallConstants; i < entries_.size(); i++) {
-    const RegType* cur_entry = entries_[i];
-    if (cur_entry->IsUnresolvedMergedReference()) {
-      const UnresolvedMergedType* cmp_type = down_cast<const UnresolvedMergedType*>(cur_entry);
-      const RegType& resolved_part = cmp_type->GetResolvedPart();
-      const BitVector& unresolved_part = cmp_type->GetUnresolvedTypes();
-      // Use SameBitsSet. "types" is expandable to allow merging in the components, but the
-      // BitVector in the final RegType will be made non-expandable.
-      if (&resolved_part == &resolved_parts_merged && types.SameBitsSet(&unresolved_part)) {
-        return *cur_entry;
-      }
+  uint32_t hash = UnresolvedMergedTypeHash(resolved_parts_merged, types);
+  auto range = merged_entries_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    const UnresolvedMergedType* cmp_type =
+        down_cast<const UnresolvedMergedType*>(entries_[it->second]);
+    const RegType& resolved_part = cmp_type->GetResolvedPart();
+    const BitVector& unresolved_part = cmp_type->GetUnresolvedTypes();
+    // Use SameBitsSet. "types" is expandable to allow merging in the components, but the
+    // BitVector in the final RegType will be made non-expandable.
+    if (&resolved_part == &resolved_parts_merged && types.SameBitsSet(&unresolved_part)) {
+      return *cmp_type;
     }
   }
+  merged_entries_.emplace(hash, entries_.size());
   return AddEntry(new (&allocator_) UnresolvedMergedType(resolved_parts_merged,
                                                          types,
                                                          this,
                                                          entries_.size()));
 }
 
+uint32_t RegTypeCache::UnresolvedMergedTypeHash(const RegType& resolved,
+                                                const BitVector& unresolved) {
+  // Hash the set bits rather than the storage, which can differ in size for equal sets.
+  uint32_t hash = resolved.GetId();
+  for (uint32_t idx : unresolved.Indexes()) {
+    hash = hash * 31u + idx;
+  }
+  return hash;
+}
+
 const RegType& RegTypeCache::FromUnresolvedSuperClass(const RegType& child) {
   // Check if entry already exists.
-  for (size_t i = kNumPrimitivesAndSmallConstants; i < entries_.size(); i++) {
-    const RegType* cur_entry = entries_[i];
-    if (cur_entry->IsUnresolvedSuperClass()) {
-      const UnresolvedSuperClass* tmp_entry =
-          down_cast<const UnresolvedSuperClass*>(cur_entry);
-      uint16_t unresolved_super_child_id =
-          tmp_entry->GetUnresolvedSuperClassChildId();
-      if (unresolved_super_child_id == child.GetId()) {
-        return *cur_entry;
-      }
-    }
+  auto it = super_class_entries_.find(child.GetId());
+  if (it != super_class_entries_.end()) {
+    DCHECK(entries_[it->second]->IsUnresolvedSuperClass());
+    return *entries_[it->second];
   }
+  super_class_entries_.emplace(child.GetId(), entries_.size());
   return AddEntry(new (&allocator_) UnresolvedSuperClass(
       null_handle_, child.GetId(), this, entries_.size()));
 }
@@ -24,6 +24,7 @@
 #include "base/casts.h"
 #include "base/macros.h"
 #include "base/scoped_arena_containers.h"
+#include "dex/dex_file_types.h"
 #include "dex/primitive.h"
 #include "gc_root.h"
 #include "handle_scope.h"
@@ -35,6 +36,7 @@ class Class;
 class ClassLoader;
 }  // namespace mirror
 
+class BitVector;
 class ClassLinker;
 class ScopedArenaAllocator;
 
@@ -102,6 +104,12 @@ class RegTypeCache {
   const RegType& FromUnresolvedSuperClass(const RegType& child)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Find the type previously recorded for a type index of the verified dex file, returns null
+  // if there is none.
+  const RegType* FindTypeIndex(dex::TypeIndex type_index) const;
+  // Record the type resolved for a type index of the verified dex file.
+  void RecordTypeIndex(dex::TypeIndex type_index, const RegType& reg_type);
+
   // Note: this should not be used outside of RegType::ClassJoin!
   const RegType& MakeUnresolvedReference() REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -185,6 +193,7 @@ class RegTypeCache {
       REQUIRES_SHARED(Locks::mutator_lock_);
   bool MatchDescriptor(size_t idx, const std::string_view& descriptor, bool precise)
       REQUIRES_SHARED(Locks::mutator_lock_);
+  static uint32_t UnresolvedMergedTypeHash(const RegType& resolved, const BitVector& unresolved);
   const ConstantType& FromCat1NonSmallConstant(int32_t value, bool precise)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -202,6 +211,18 @@ class RegTypeCache {
   // Fast lookup for quickly finding entries that have a matching class.
   ScopedArenaVector<std::pair<Handle<mirror::Class>, const RegType*>> klass_entries_;
 
+  // Descriptor hash -> ids of the entries with that descriptor.
+  ScopedArenaUnorderedMultimap<uint32_t, uint16_t> descriptor_entries_;
+
+  // Hash of the resolved part and unresolved types -> ids of the unresolved merged types.
+  ScopedArenaUnorderedMultimap<uint32_t, uint16_t> merged_entries_;
+
+  // Child id -> id of the unresolved super class of that child.
+  ScopedArenaUnorderedMap<uint16_t, uint16_t> super_class_entries_;
+
+  // Type index -> id of the type resolved for that index in the verified dex file.
+  ScopedArenaUnorderedMap<uint16_t, uint16_t> type_index_entries_;
+
   // Arena allocator.
   ScopedArenaAllocator& allocator_;
 
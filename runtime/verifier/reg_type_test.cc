@@ -462,6 +462,54 @@ TEST_F(RegTypeReferenceTest, Dump) {
   EXPECT_EQ(expected, unresolved_merged.Dump());
 }
 
+TEST_F(RegTypeReferenceTest, UnresolvedMergedTypeInterning) {
+  // Tests that merging the same unresolved types again returns the existing merged type.
+  ArenaStack stack(Runtime::Current()->GetArenaPool());
+  ScopedArenaAllocator allocator(&stack);
+  ScopedObjectAccess soa(Thread::Current());
+  VariableSizedHandleScope handles(soa.Self());
+  RegTypeCache cache(
+      Runtime::Current()->GetClassLinker(), /* can_load_classes= */ true, allocator, handles);
+  const RegType& a = cache.FromDescriptor(nullptr, "Ljava/lang/DoesNotExist;", true);
+  const RegType& b = cache.FromDescriptor(nullptr, "Ljava/lang/DoesNotExistEither;", true);
+  const RegType& c = cache.FromDescriptor(nullptr, "Ljava/lang/DoesNotExistNeither;", true);
+  const RegType& ab = cache.FromUnresolvedMerge(a, b, /* verifier= */ nullptr);
+  const RegType& abc = cache.FromUnresolvedMerge(ab, c, /* verifier= */ nullptr);
+  ASSERT_TRUE(ab.IsUnresolvedMergedReference());
+  ASSERT_TRUE(abc.IsUnresolvedMergedReference());
+  size_t cache_size = cache.GetCacheSize();
+
+  EXPECT_EQ(&ab, &cache.FromUnresolvedMerge(b, a, /* verifier= */ nullptr));
+  EXPECT_EQ(&ab, &cache.FromUnresolvedMerge(ab, a, /* verifier= */ nullptr));
+  EXPECT_EQ(&ab, &cache.FromUnresolvedMerge(b, ab, /* verifier= */ nullptr));
+  EXPECT_EQ(&abc, &cache.FromUnresolvedMerge(c, ab, /* verifier= */ nullptr));
+  EXPECT_EQ(&abc, &cache.FromUnresolvedMerge(abc, ab, /* verifier= */ nullptr));
+  EXPECT_EQ(&abc, &cache.FromUnresolvedMerge(a, abc, /* verifier= */ nullptr));
+  EXPECT_EQ(&a, &cache.FromDescriptor(nullptr, "Ljava/lang/DoesNotExist;", false));
+  EXPECT_EQ(&c, &cache.FromDescriptor(nullptr, "Ljava/lang/DoesNotExistNeither;", true));
+  EXPECT_EQ(cache_size, cache.GetCacheSize());
+}
+
+TEST_F(RegTypeReferenceTest, TypeIndex) {
+  // Tests recording the types resolved for type indexes.
+  ArenaStack stack(Runtime::Current()->GetArenaPool());
+  ScopedArenaAllocator allocator(&stack);
+  ScopedObjectAccess soa(Thread::Current());
+  VariableSizedHandleScope handles(soa.Self());
+  RegTypeCache cache(
+      Runtime::Current()->GetClassLinker(), /* can_load_classes= */ true, allocator, handles);
+  EXPECT_TRUE(cache.FindTypeIndex(dex::TypeIndex(3u)) == nullptr);
+  const RegType& string_type = cache.JavaLangString();
+  const RegType& unresolved = cache.FromDescriptor(nullptr, "Ljava/lang/DoesNotExist;", true);
+  cache.RecordTypeIndex(dex::TypeIndex(3u), string_type);
+  cache.RecordTypeIndex(dex::TypeIndex(7u), unresolved);
+  cache.RecordTypeIndex(dex::TypeIndex(8u), cache.Integer());
+  EXPECT_EQ(&string_type, cache.FindTypeIndex(dex::TypeIndex(3u)));
+  EXPECT_EQ(&unresolved, cache.FindTypeIndex(dex::TypeIndex(7u)));
+  EXPECT_EQ(&cache.Integer(), cache.FindTypeIndex(dex::TypeIndex(8u)));
+  EXPECT_TRUE(cache.FindTypeIndex(dex::TypeIndex(4u)) == nullptr);
+}
+
 TEST_F(RegTypeReferenceTest, JavalangString) {
   // Add a class to the cache then look for the same class and make sure it is  a
   // Hit the second time. Then check for the same effect when using
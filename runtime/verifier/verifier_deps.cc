@@ -16,7 +16,9 @@
 
 #include "verifier_deps.h"
 
+#include <algorithm>
 #include <cstring>
+#include <numeric>
 #include <sstream>
 
 #include "art_field-inl.h"
@@ -34,6 +36,7 @@
 #include "reg_type.h"
 #include "reg_type_cache-inl.h"
 #include "runtime.h"
+#include "thread_pool.h"
 
 namespace art HIDDEN {
 namespace verifier {
@@ -76,6 +79,67 @@ void VerifierDeps::MergeWith(std::unique_ptr<VerifierDeps> other,
   }
 }
 
+// Number of class defs merged or encoded by a single task when using a thread pool.
+static constexpr size_t kParallelChunkSize = 1024u;
+
+// Call `fn(i)` for each `i` in [0, `count`), in parallel if `thread_pool` is not null.
+template <typename Fn>
+static void RunChunks(ThreadPool* thread_pool, size_t count, const Fn& fn) {
+  if (thread_pool == nullptr || count <= 1u) {
+    for (size_t i = 0; i != count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+  Thread* self = Thread::Current();
+  for (size_t i = 0; i != count; ++i) {
+    thread_pool->AddTask(self, new FunctionTask([&fn, i]([[maybe_unused]] Thread* thread) {
+      fn(i);
+    }));
+  }
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work= */ true, /* may_hold_locks= */ false);
+  thread_pool->StopWorkers(self);
+}
+
+void VerifierDeps::MergeWith(std::vector<std::unique_ptr<VerifierDeps>> others,
+                             const std::vector<const DexFile*>& dex_files,
+                             ThreadPool* thread_pool) {
+  // Each task merges a chunk of class defs of one dex file from all of `others`, so tasks
+  // do not touch the same sets. The verified bits share words and are merged here.
+  std::vector<std::vector<DexFileDeps*>> other_deps(dex_files.size());
+  std::vector<std::tuple<size_t, size_t, size_t>> chunks;  // Dex file index, begin, end.
+  for (size_t dex_file_index = 0; dex_file_index != dex_files.size(); ++dex_file_index) {
+    const DexFile& dex_file = *dex_files[dex_file_index];
+    DexFileDeps* my_deps = GetDexFileDeps(dex_file);
+    for (const std::unique_ptr<VerifierDeps>& other : others) {
+      DCHECK(other != nullptr);
+      DCHECK_EQ(dex_deps_.size(), other->dex_deps_.size());
+      DexFileDeps* deps = other->GetDexFileDeps(dex_file);
+      // We currently collect extra strings only on the main `VerifierDeps`,
+      // which should be the one passed as `this` in this method.
+      DCHECK(deps->strings_.empty());
+      DCHECK_EQ(my_deps->assignable_types_.size(), deps->assignable_types_.size());
+      BitVectorOr(my_deps->verified_classes_, deps->verified_classes_);
+      other_deps[dex_file_index].push_back(deps);
+    }
+    size_t num_class_defs = my_deps->assignable_types_.size();
+    for (size_t begin = 0; begin < num_class_defs; begin += kParallelChunkSize) {
+      chunks.emplace_back(dex_file_index, begin, std::min(begin + kParallelChunkSize,
+                                                          num_class_defs));
+    }
+  }
+  RunChunks(thread_pool, chunks.size(), [&](size_t chunk_index) {
+    auto [dex_file_index, begin, end] = chunks[chunk_index];
+    DexFileDeps* my_deps = GetDexFileDeps(*dex_files[dex_file_index]);
+    for (DexFileDeps* deps : other_deps[dex_file_index]) {
+      for (size_t i = begin; i != end; ++i) {
+        my_deps->assignable_types_[i].merge(deps->assignable_types_[i]);
+      }
+    }
+  });
+}
+
 VerifierDeps::DexFileDeps* VerifierDeps::GetDexFileDeps(const DexFile& dex_file) {
   auto it = dex_deps_.find(&dex_file);
   return (it == dex_deps_.end()) ? nullptr : it->second.get();
@@ -172,6 +236,50 @@ dex::StringIndex VerifierDeps::GetIdFromString(const DexFile& dex_file, const st
   }
 }
 
+void VerifierDeps::SortExtraStrings(const std::vector<const DexFile*>& dex_files) {
+  for (const DexFile* dex_file : dex_files) {
+    DexFileDeps* deps = GetDexFileDeps(*dex_file);
+    DCHECK(deps != nullptr);
+    if (deps->strings_.size() <= 1u) {
+      continue;
+    }
+    std::vector<uint32_t> order(deps->strings_.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [deps](uint32_t lhs, uint32_t rhs) {
+      return deps->strings_[lhs] < deps->strings_[rhs];
+    });
+    std::vector<uint32_t> new_ids(order.size());
+    std::vector<std::string> sorted_strings;
+    sorted_strings.reserve(order.size());
+    for (size_t i = 0; i != order.size(); ++i) {
+      new_ids[order[i]] = i;
+      sorted_strings.push_back(std::move(deps->strings_[order[i]]));
+    }
+    deps->strings_ = std::move(sorted_strings);
+
+    uint32_t num_ids_in_dex = dex_file->NumStringIds();
+    auto is_extra = [num_ids_in_dex](dex::StringIndex id) {
+      return id.index_ >= num_ids_in_dex;
+    };
+    auto remap = [&](dex::StringIndex id) {
+      return is_extra(id) ? dex::StringIndex(num_ids_in_dex + new_ids[id.index_ - num_ids_in_dex])
+                          : id;
+    };
+    for (std::set<TypeAssignability>& types : deps->assignable_types_) {
+      bool has_extra = std::any_of(types.begin(), types.end(), [&](const TypeAssignability& t) {
+        return is_extra(t.GetDestination()) || is_extra(t.GetSource());
+      });
+      if (has_extra) {
+        std::set<TypeAssignability> remapped;
+        for (const TypeAssignability& t : types) {
+          remapped.emplace(remap(t.GetDestination()), remap(t.GetSource()));
+        }
+        types = std::move(remapped);
+      }
+    }
+  }
+}
+
 std::string VerifierDeps::GetStringFromId(const DexFile& dex_file,
                                           dex::StringIndex string_id) const {
   uint32_t num_ids_in_dex = dex_file.NumStringIds();
@@ -415,6 +523,27 @@ static void EncodeSetVector(std::vector<uint8_t>* out,
   SetUint32InUint8Array(out, offsets_index, class_def_index, out->size());
 }
 
+// Encode the sets of class defs [`begin`, `end`) into `out`, recording in `offsets` the
+// offset of each set in `out`, or `kNotVerifiedMarker`.
+template <typename T>
+static void EncodeSetRange(std::vector<uint8_t>* out,
+                           const std::vector<std::set<T>>& vector,
+                           const std::vector<bool>& verified_classes,
+                           size_t begin,
+                           size_t end,
+                           /*out*/ std::vector<uint32_t>* offsets) {
+  for (size_t i = begin; i != end; ++i) {
+    if (verified_classes[i]) {
+      offsets->push_back(out->size());
+      for (const T& entry : vector[i]) {
+        EncodeTuple(out, entry);
+      }
+    } else {
+      offsets->push_back(VerifierDeps::kNotVerifiedMarker);
+    }
+  }
+}
+
 template <bool kFillSet, typename T>
 static bool DecodeSetVector(const uint8_t** cursor,
                             const uint8_t* start,
@@ -513,20 +642,80 @@ static inline bool DecodeStringVector(const uint8_t** cursor,
 }  // namespace
 
 void VerifierDeps::Encode(const std::vector<const DexFile*>& dex_files,
-                          std::vector<uint8_t>* buffer) const {
+                          std::vector<uint8_t>* buffer,
+                          ThreadPool* thread_pool) const {
   DCHECK(buffer->empty());
+  if (thread_pool == nullptr) {
+    buffer->resize(dex_files.size() * sizeof(uint32_t));
+    uint32_t dex_file_index = 0;
+    for (const DexFile* dex_file : dex_files) {
+      // Four byte alignment before encoding the data.
+      buffer->resize(RoundUp(buffer->size(), sizeof(uint32_t)));
+      (reinterpret_cast<uint32_t*>(buffer->data()))[dex_file_index++] = buffer->size();
+      const DexFileDeps& deps = *GetDexFileDeps(*dex_file);
+      EncodeSetVector(buffer, deps.assignable_types_, deps.verified_classes_);
+      // Four byte alignment before encoding strings.
+      buffer->resize(RoundUp(buffer->size(), sizeof(uint32_t)));
+      EncodeStringVector(buffer, deps.strings_);
+    }
+    return;
+  }
+
+  // Encode the sets of chunks of class defs into separate buffers in parallel, then
+  // assemble them in order, producing the same data as above.
+  struct EncodedChunk {
+    size_t dex_file_index;
+    size_t begin;
+    size_t end;
+    std::vector<uint8_t> data;
+    std::vector<uint32_t> offsets;
+  };
+  std::vector<EncodedChunk> chunks;
+  for (size_t dex_file_index = 0; dex_file_index != dex_files.size(); ++dex_file_index) {
+    size_t num_class_defs = GetDexFileDeps(*dex_files[dex_file_index])->assignable_types_.size();
+    for (size_t begin = 0; begin < num_class_defs; begin += kParallelChunkSize) {
+      size_t end = std::min(begin + kParallelChunkSize, num_class_defs);
+      chunks.push_back(EncodedChunk{dex_file_index, begin, end, {}, {}});
+    }
+  }
+  RunChunks(thread_pool, chunks.size(), [&](size_t chunk_index) {
+    EncodedChunk& chunk = chunks[chunk_index];
+    const DexFileDeps& deps = *GetDexFileDeps(*dex_files[chunk.dex_file_index]);
+    EncodeSetRange(&chunk.data,
+                   deps.assignable_types_,
+                   deps.verified_classes_,
+                   chunk.begin,
+                   chunk.end,
+                   &chunk.offsets);
+  });
+
   buffer->resize(dex_files.size() * sizeof(uint32_t));
-  uint32_t dex_file_index = 0;
-  for (const DexFile* dex_file : dex_files) {
+  auto chunk_it = chunks.begin();
+  for (size_t dex_file_index = 0; dex_file_index != dex_files.size(); ++dex_file_index) {
     // Four byte alignment before encoding the data.
     buffer->resize(RoundUp(buffer->size(), sizeof(uint32_t)));
-    (reinterpret_cast<uint32_t*>(buffer->data()))[dex_file_index++] = buffer->size();
-    const DexFileDeps& deps = *GetDexFileDeps(*dex_file);
-    EncodeSetVector(buffer, deps.assignable_types_, deps.verified_classes_);
+    (reinterpret_cast<uint32_t*>(buffer->data()))[dex_file_index] = buffer->size();
+    const DexFileDeps& deps = *GetDexFileDeps(*dex_files[dex_file_index]);
+    // Make room for offsets for each class, +1 for marking the end of the
+    // assignability types data.
+    uint32_t offsets_index = buffer->size();
+    buffer->resize(buffer->size() + (deps.assignable_types_.size() + 1) * sizeof(uint32_t));
+    uint32_t class_def_index = 0;
+    for (; chunk_it != chunks.end() && chunk_it->dex_file_index == dex_file_index; ++chunk_it) {
+      uint32_t chunk_offset = buffer->size();
+      for (uint32_t offset : chunk_it->offsets) {
+        uint32_t value = (offset == kNotVerifiedMarker) ? offset : chunk_offset + offset;
+        SetUint32InUint8Array(buffer, offsets_index, class_def_index++, value);
+      }
+      buffer->insert(buffer->end(), chunk_it->data.begin(), chunk_it->data.end());
+    }
+    DCHECK_EQ(class_def_index, deps.assignable_types_.size());
+    SetUint32InUint8Array(buffer, offsets_index, class_def_index, buffer->size());
     // Four byte alignment before encoding strings.
     buffer->resize(RoundUp(buffer->size(), sizeof(uint32_t)));
     EncodeStringVector(buffer, deps.strings_);
   }
+  DCHECK(chunk_it == chunks.end());
 }
 
 template <bool kOnlyVerifiedClasses>
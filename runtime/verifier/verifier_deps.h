@@ -36,6 +36,7 @@ namespace art HIDDEN {
 class ArtField;
 class ArtMethod;
 class DexFile;
+class ThreadPool;
 class VariableIndentationOutputStream;
 
 namespace mirror {
@@ -77,6 +78,16 @@ class VerifierDeps {
   EXPORT void MergeWith(std::unique_ptr<VerifierDeps> other,
                         const std::vector<const DexFile*>& dex_files);
 
+  // Merge all of `others` into this `VerifierDeps`, splitting the class defs of each
+  // dex file into chunks merged in parallel by `thread_pool` if not null.
+  EXPORT void MergeWith(std::vector<std::unique_ptr<VerifierDeps>> others,
+                        const std::vector<const DexFile*>& dex_files,
+                        ThreadPool* thread_pool);
+
+  // Reassign the ids of the strings that are not in the dex files in the order of the
+  // strings, so that they do not depend on the order in which they were recorded.
+  EXPORT void SortExtraStrings(const std::vector<const DexFile*>& dex_files);
+
   // Record information that a class was verified.
   // Note that this function is different from MaybeRecordVerificationStatus() which
   // looks up thread-local VerifierDeps first.
@@ -114,8 +125,11 @@ class VerifierDeps {
   // Serialize the recorded dependencies and store the data into `buffer`.
   // `dex_files` provides the order of the dex files in which the dependencies
   // should be emitted.
+  // If `thread_pool` is not null, chunks of class defs are encoded in parallel. The
+  // output does not depend on it.
   EXPORT void Encode(const std::vector<const DexFile*>& dex_files,
-                     std::vector<uint8_t>* buffer) const;
+                     std::vector<uint8_t>* buffer,
+                     ThreadPool* thread_pool = nullptr) const;
 
   EXPORT void Dump(VariableIndentationOutputStream* vios) const;
 
@@ -263,6 +277,7 @@ class VerifierDeps {
 
   friend class VerifierDepsTest;
   ART_FRIEND_TEST(VerifierDepsTest, StringToId);
+  ART_FRIEND_TEST(VerifierDepsTest, SortExtraStrings);
   ART_FRIEND_TEST(VerifierDepsTest, EncodeDecode);
   ART_FRIEND_TEST(VerifierDepsTest, EncodeDecodeMulti);
   ART_FRIEND_TEST(VerifierDepsTest, VerifyDeps);
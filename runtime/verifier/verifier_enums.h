@@ -29,6 +29,8 @@ enum class VerifyMode : int8_t {
   kNone,      // Everything is assumed verified.
   kEnable,    // Standard verification, try pre-verifying at compile-time.
   kSoftFail,  // Force a soft fail, punting to the interpreter with access checks.
+  kLazy,      // Standard verification, but the methods of classes that were not pre-verified
+              // are verified when they are first invoked.
 };
 
 // The outcome of verification.
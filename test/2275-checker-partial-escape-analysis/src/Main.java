@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class Builder {
+    int value;
+    int count;
+}
+
+public class Main {
+    public static void main(String[] args) {
+        assertEquals(43, $noinline$parse(42));
+        try {
+            $noinline$parse(-1);
+            throw new Error("Expected IllegalArgumentException");
+        } catch (IllegalArgumentException expected) {
+            assertEquals("Builder(-1, 1)", expected.getMessage());
+        }
+
+        assertEquals(11, $noinline$parseRejoining(10));
+        assertEquals(0, $noinline$parseRejoining(-1));
+        assertEquals(1, sEscapes);
+    }
+
+    /// CHECK-START: int Main.$noinline$parse(int) load_store_elimination (before)
+    /// CHECK:     NewInstance
+    /// CHECK:     InstanceFieldGet
+    /// CHECK:     InstanceFieldGet
+
+    /// CHECK-START: int Main.$noinline$parse(int) load_store_elimination (after)
+    /// CHECK-NOT: InstanceFieldGet
+
+    // The builder is only allocated on the throwing path, with the field values
+    // known at that point.
+    /// CHECK-START: int Main.$noinline$parse(int) load_store_elimination (after)
+    /// CHECK:     <<Builder:l\d+>> NewInstance
+    /// CHECK-NEXT:                 InstanceFieldSet [<<Builder>>,{{i\d+}}]
+    /// CHECK-NEXT:                 InstanceFieldSet [<<Builder>>,{{i\d+}}]
+    /// CHECK:                      InvokeStaticOrDirect [<<Builder>>{{(,[ij]\d+)?}}] method_name:Main.$noinline$describe
+    /// CHECK:                      Throw
+    static int $noinline$parse(int value) {
+        Builder b = new Builder();
+        b.value = value;
+        b.count = 1;
+        if (value < 0) {
+            throw new IllegalArgumentException($noinline$describe(b));
+        }
+        return b.value + b.count;
+    }
+
+    // The escaping path rejoins the hot path, the allocation must be kept.
+    /// CHECK-START: int Main.$noinline$parseRejoining(int) load_store_elimination (after)
+    /// CHECK:     NewInstance
+    /// CHECK:     InstanceFieldGet
+    static int $noinline$parseRejoining(int value) {
+        Builder b = new Builder();
+        b.value = value;
+        b.count = 1;
+        if (value < 0) {
+            $noinline$escape(b);
+        }
+        return b.value + b.count;
+    }
+
+    static String $noinline$describe(Builder b) {
+        return "Builder(" + b.value + ", " + b.count + ")";
+    }
+
+    static void $noinline$escape(Builder b) {
+        sEscapes += b.count;
+    }
+
+    public static void assertEquals(int expected, int actual) {
+        if (expected != actual) {
+            throw new Error("Expected: " + expected + ", found: " + actual);
+        }
+    }
+
+    public static void assertEquals(String expected, String actual) {
+        if (!expected.equals(actual)) {
+            throw new Error("Expected: " + expected + ", found: " + actual);
+        }
+    }
+
+    static int sEscapes = 0;
+}
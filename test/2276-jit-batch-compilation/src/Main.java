@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  public static void main(String[] args) {
+    System.loadLibrary(args[0]);
+    String[] methods = { "sum", "product", "count" };
+    if (!dropBatchWhileJitSuspended(Batch.class, methods)) {
+      throw new Error("Expected the batch to be dropped while the JIT is suspended");
+    }
+    int committed = compileInBatch(Batch.class, methods);
+    if (committed != -1) {
+      if (committed != methods.length) {
+        throw new Error("Expected " + methods.length + " methods committed together, got " +
+            committed);
+      }
+      for (String method : methods) {
+        if (!hasJitCompiledCode(Batch.class, method)) {
+          throw new Error("Expected " + method + " to be JIT compiled");
+        }
+      }
+    }
+
+    Batch batch = new Batch();
+    assertEquals(45, batch.sum(10));
+    assertEquals(3628800, batch.product(10));
+    assertEquals(5, batch.count(10));
+    System.out.println("passed");
+  }
+
+  public static void assertEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  // Compiles the methods in a single JIT batch and returns the number of methods committed
+  // with the batch, or -1 if there is no JIT.
+  public static native int compileInBatch(Class<?> cls, String[] methodNames);
+  // Adds a JIT batch while the JIT is suspended and returns whether it was dropped without
+  // leaving the methods pending, so that they can be compiled again.
+  public static native boolean dropBatchWhileJitSuspended(Class<?> cls, String[] methodNames);
+  public static native boolean hasJitCompiledCode(Class<?> cls, String methodName);
+}
+
+class Batch {
+  public int sum(int n) {
+    int result = 0;
+    for (int i = 0; i < n; ++i) {
+      result += i;
+    }
+    return result;
+  }
+
+  public int product(int n) {
+    int result = 1;
+    for (int i = 2; i <= n; ++i) {
+      result *= i;
+    }
+    return result;
+  }
+
+  public int count(int n) {
+    int result = 0;
+    for (int i = 0; i < n; ++i) {
+      if ((i & 1) == 0) {
+        ++result;
+      }
+    }
+    return result;
+  }
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.InvocationTargetException;
+
+public class Main {
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+    // The methods of the class are verified lazily, the class itself and its class
+    // initializer are verified before the class is initialized.
+    Class<?> c = Class.forName("Deferred");
+    if (!c.getField("initialized").getBoolean(null)) {
+      throw new Error("Expected Deferred.<clinit> to have run");
+    }
+    assertTrue(isInSwitchInterpreter(c, "ok"), "ok() pending verification");
+    assertTrue(isInSwitchInterpreter(c, "fail"), "fail() pending verification");
+
+    // A method failing verification throws on every invocation.
+    for (int i = 0; i < 2; ++i) {
+      try {
+        c.getMethod("fail").invoke(null);
+        throw new Error("Expected VerifyError");
+      } catch (InvocationTargetException e) {
+        if (!(e.getCause() instanceof VerifyError)) {
+          throw new Error("Expected VerifyError", e.getCause());
+        }
+        System.out.println("fail() threw VerifyError");
+      }
+    }
+    assertTrue(isInSwitchInterpreter(c, "fail"), "fail() stays in the switch interpreter");
+
+    // A method passing verification leaves the switch interpreter.
+    int result = (Integer) c.getMethod("ok").invoke(null);
+    if (result != 42) {
+      throw new Error("Expected 42, got " + result);
+    }
+    assertTrue(!isInSwitchInterpreter(c, "ok"), "ok() verified");
+    if (canRuntimeUseNterp()) {
+      assertTrue(hasNterpEntryPoint(c, "ok"), "ok() uses nterp");
+    }
+
+    // Interfaces are verified eagerly, so that implementing classes never run unverified
+    // copies of default methods.
+    result = new GoodImpl().answer();
+    if (result != 42) {
+      throw new Error("Expected 42, got " + result);
+    }
+    assertTrue(!isInSwitchInterpreter(GoodDefaults.class, "answer"), "answer() verified");
+    try {
+      Class.forName("BadImpl");
+      throw new Error("Expected VerifyError");
+    } catch (VerifyError e) {
+      System.out.println("BadImpl threw VerifyError");
+    }
+    System.out.println("passed");
+  }
+
+  private static void assertTrue(boolean condition, String message) {
+    if (!condition) {
+      throw new Error("Expected: " + message);
+    }
+  }
+
+  private static native boolean isInSwitchInterpreter(Class<?> cls, String methodName);
+  private static native boolean hasNterpEntryPoint(Class<?> cls, String methodName);
+  private static native boolean canRuntimeUseNterp();
+}
+
+interface GoodDefaults {
+  default int answer() {
+    return 42;
+  }
+}
+
+class GoodImpl implements GoodDefaults {}
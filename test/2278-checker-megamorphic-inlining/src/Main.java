@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+abstract class Base {
+  abstract int value();
+}
+
+class Dominant extends Base {
+  int value() { return 42; }
+}
+
+class Other1 extends Base {
+  int value() { return 1; }
+}
+
+class Other2 extends Base {
+  int value() { return 2; }
+}
+
+class Other3 extends Base {
+  int value() { return 3; }
+}
+
+class Other4 extends Base {
+  int value() { return 4; }
+}
+
+class Other5 extends Base {
+  int value() { return 5; }
+}
+
+class Other6 extends Base {
+  int value() { return 6; }
+}
+
+public class Main {
+
+  /// CHECK-START: int Main.$noinline$megamorphicCall(Base) inliner (before)
+  /// CHECK:       InvokeVirtual method_name:Base.value
+
+  // The dominant receiver is inlined behind a class check, the other receivers still go
+  // through the original invoke.
+
+  /// CHECK-START: int Main.$noinline$megamorphicCall(Base) inliner (after)
+  /// CHECK-DAG:   <<DominantRet:i\d+>>  IntConstant 42
+  /// CHECK-DAG:   <<Obj:l\d+>>          NullCheck
+  /// CHECK-DAG:   <<ObjClass:l\d+>>     InstanceFieldGet [<<Obj>>] field_name:java.lang.Object.shadow$_klass_
+  /// CHECK-DAG:   <<InlineClass:l\d+>>  LoadClass class_name:Dominant
+  /// CHECK-DAG:   <<Test:z\d+>>         NotEqual [<<InlineClass>>,<<ObjClass>>]
+  /// CHECK-DAG:                         If [<<Test>>]
+  /// CHECK-DAG:   <<DefaultRet:i\d+>>   InvokeVirtual [<<Obj>>] method_name:Base.value
+  /// CHECK-DAG:   <<Ret:i\d+>>          Phi [<<DominantRet>>,<<DefaultRet>>]
+  /// CHECK-DAG:                         Return [<<Ret>>]
+
+  /// CHECK-START: int Main.$noinline$megamorphicCall(Base) inliner (after)
+  /// CHECK-NOT:                         Deoptimize
+
+  public static int $noinline$megamorphicCall(Base b) {
+    return b.value();
+  }
+
+  public static int $noinline$countReceivers(Base b) {
+    return b.value();
+  }
+
+  static Base dominant = new Dominant();
+  static Base[] others = {
+    new Other1(), new Other2(), new Other3(), new Other4(), new Other5(), new Other6()
+  };
+
+  public static void testMegamorphicInlining() {
+    ensureJitBaselineCompiled(Main.class, "$noinline$megamorphicCall");
+    // Warm up the inline cache, with nine calls out of ten on the dominant receiver.
+    for (int i = 0; i < 10000; i++) {
+      Base b = (i % 10 != 9) ? dominant : others[(i / 10) % others.length];
+      $noinline$megamorphicCall(b);
+    }
+    ensureJitCompiled(Main.class, "$noinline$megamorphicCall");
+    assertEquals(42, $noinline$megamorphicCall(dominant));
+    for (int i = 0; i < others.length; i++) {
+      assertEquals(i + 1, $noinline$megamorphicCall(others[i]));
+    }
+  }
+
+  public static void testInlineCacheCounts() {
+    ensureJitBaselineCompiled(Main.class, "$noinline$countReceivers");
+    // The first receiver takes the first entry of the cache.
+    for (int i = 0; i < 50; i++) {
+      $noinline$countReceivers(dominant);
+    }
+    // The next four receivers take the other entries.
+    for (int i = 0; i < 4; i++) {
+      $noinline$countReceivers(others[i]);
+    }
+    // The cache is full, the last entry accumulates the receivers that do not fit.
+    for (int i = 0; i < 10; i++) {
+      $noinline$countReceivers(others[4]);
+      $noinline$countReceivers(others[5]);
+    }
+    int[] counts = new int[5];
+    if (getInlineCacheCounts(Main.class, "$noinline$countReceivers", counts)) {
+      assertEquals(50, counts[0]);
+      assertEquals(1, counts[1]);
+      assertEquals(1, counts[2]);
+      assertEquals(1, counts[3]);
+      assertEquals(21, counts[4]);
+    }
+  }
+
+  public static void main(String[] args) {
+    System.loadLibrary(args[0]);
+    testMegamorphicInlining();
+    testInlineCacheCounts();
+    System.out.println("passed");
+  }
+
+  private static void assertEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  private static native void ensureJitBaselineCompiled(Class<?> cls, String methodName);
+  private static native void ensureJitCompiled(Class<?> cls, String methodName);
+  private static native boolean getInlineCacheCounts(
+      Class<?> cls, String methodName, int[] counts);
+}
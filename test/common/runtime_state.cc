@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+
 #include <android-base/logging.h>
 #include <android-base/macros.h>
 #include <sys/resource.h>
@@ -21,11 +23,15 @@
 #include "art_field.h"
 #include "art_method-inl.h"
 #include "base/enums.h"
+#include "class_linker.h"
 #include "common_throws.h"
 #include "dex/dex_file-inl.h"
 #include "dex/dex_file_types.h"
+#include "dex/dex_instruction.h"
 #include "gc/heap.h"
+#include "handle_scope-inl.h"
 #include "instrumentation.h"
+#include "interpreter/mterp/nterp.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
 #include "jit/profile_saver.h"
@@ -359,6 +365,77 @@ extern "C" JNIEXPORT void JNICALL Java_Main_ensureJitBaselineCompiled(JNIEnv* en
   ForceJitCompiled(self, method, CompilationKind::kBaseline);
 }
 
+// Compiles the methods named `method_names` in a single JIT batch and returns the number of
+// methods committed with the batch, or -1 if the batch could not be compiled.
+static std::vector<ArtMethod*> GetMethods(JNIEnv* env,
+                                          ScopedObjectAccess& soa,
+                                          jclass cls,
+                                          jobjectArray method_names)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  std::vector<ArtMethod*> methods;
+  for (jsize i = 0, length = env->GetArrayLength(method_names); i != length; ++i) {
+    jstring method_name = reinterpret_cast<jstring>(env->GetObjectArrayElement(method_names, i));
+    ScopedUtfChars chars(env, method_name);
+    methods.push_back(GetMethod(soa, cls, chars));
+    env->DeleteLocalRef(method_name);
+  }
+  return methods;
+}
+
+extern "C" JNIEXPORT jint JNICALL Java_Main_compileInBatch(JNIEnv* env,
+                                                           jclass,
+                                                           jclass cls,
+                                                           jobjectArray method_names) {
+  jit::Jit* jit = GetJitIfEnabled();
+  if (jit == nullptr || Runtime::Current()->GetInstrumentation()->EntryExitStubsInstalled()) {
+    return -1;
+  }
+
+  Thread* self = Thread::Current();
+  std::shared_ptr<jit::JitCommitBatch> batch;
+  {
+    ScopedObjectAccess soa(self);
+    std::vector<ArtMethod*> methods = GetMethods(env, soa, cls, method_names);
+    // Make sure the JIT code does not get deleted before the caller checks it.
+    jit->GetCodeCache()->SetGarbageCollectCode(false);
+    batch = jit->AddBatchCompileTasks(self, methods, CompilationKind::kOptimized);
+  }
+  if (batch == nullptr) {
+    return -1;
+  }
+  jit->WaitForCompilationToFinish(self);
+  return batch->IsCommitted() ? static_cast<jint>(batch->GetNumberOfCommittedMethods()) : -1;
+}
+
+// Adds a batch while the JIT is suspended, and returns whether the batch got dropped without
+// leaving its methods pending.
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_dropBatchWhileJitSuspended(
+    JNIEnv* env, jclass, jclass cls, jobjectArray method_names) {
+  jit::Jit* jit = GetJitIfEnabled();
+  if (jit == nullptr) {
+    return true;
+  }
+
+  Thread* self = Thread::Current();
+  jit::ScopedJitSuspend suspend;
+  ScopedObjectAccess soa(self);
+  std::vector<ArtMethod*> methods = GetMethods(env, soa, cls, method_names);
+  std::shared_ptr<jit::JitCommitBatch> batch =
+      jit->AddBatchCompileTasks(self, methods, CompilationKind::kOptimized);
+  if (batch == nullptr) {
+    return true;
+  }
+  if (batch->IsCommitted()) {
+    return false;
+  }
+  for (ArtMethod* method : methods) {
+    if (jit->IsMethodInPendingBatch(self, method)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 extern "C" JNIEXPORT jboolean JNICALL Java_Main_hasSingleImplementation(JNIEnv* env,
                                                                         jclass,
                                                                         jclass cls,
@@ -372,6 +449,35 @@ extern "C" JNIEXPORT jboolean JNICALL Java_Main_hasSingleImplementation(JNIEnv*
   return method->HasSingleImplementation();
 }
 
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_canRuntimeUseNterp(JNIEnv*, jclass) {
+  ScopedObjectAccess soa(Thread::Current());
+  return interpreter::CanRuntimeUseNterp();
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_hasNterpEntryPoint(JNIEnv* env,
+                                                                   jclass,
+                                                                   jclass cls,
+                                                                   jstring method_name) {
+  ScopedObjectAccess soa(Thread::Current());
+  ScopedUtfChars chars(env, method_name);
+  ArtMethod* method = GetMethod(soa, cls, chars);
+  return method->GetEntryPointFromQuickCompiledCode() == interpreter::GetNterpEntryPoint();
+}
+
+// Returns whether the method can only run in the switch interpreter, which is the case for
+// methods that must count locks, including those whose verification was deferred.
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_isInSwitchInterpreter(JNIEnv* env,
+                                                                      jclass,
+                                                                      jclass cls,
+                                                                      jstring method_name) {
+  ScopedObjectAccess soa(Thread::Current());
+  ScopedUtfChars chars(env, method_name);
+  ArtMethod* method = GetMethod(soa, cls, chars);
+  return method->MustCountLocks() &&
+         Runtime::Current()->GetClassLinker()->IsQuickToInterpreterBridge(
+             method->GetEntryPointFromQuickCompiledCode());
+}
+
 extern "C" JNIEXPORT int JNICALL Java_Main_getHotnessCounter(JNIEnv* env,
                                                              jclass,
                                                              jclass cls,
@@ -395,6 +501,48 @@ extern "C" JNIEXPORT int JNICALL Java_Main_getHotnessCounter(JNIEnv* env,
   return std::numeric_limits<int32_t>::min();
 }
 
+// Copies the receiver counts of the inline cache of the first virtual or interface call of
+// the method into `counts`. Returns false if the method has no such inline cache.
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_getInlineCacheCounts(JNIEnv* env,
+                                                                     jclass,
+                                                                     jclass cls,
+                                                                     jstring method_name,
+                                                                     jintArray counts) {
+  jit::Jit* jit = GetJitIfEnabled();
+  if (jit == nullptr) {
+    return false;
+  }
+  Thread* self = Thread::Current();
+  uint32_t cache_counts[InlineCache::kIndividualCacheSize] = {};
+  {
+    ScopedObjectAccess soa(self);
+    ScopedUtfChars chars(env, method_name);
+    ArtMethod* method = GetMethod(soa, cls, chars);
+    ProfilingInfo* info = jit->GetCodeCache()->GetProfilingInfo(method, self);
+    if (info == nullptr) {
+      return false;
+    }
+    InlineCache* cache = nullptr;
+    for (const DexInstructionPcPair& inst : method->DexInstructions()) {
+      if (inst->Opcode() == Instruction::INVOKE_VIRTUAL ||
+          inst->Opcode() == Instruction::INVOKE_INTERFACE) {
+        cache = info->GetInlineCache(inst.DexPc());
+        break;
+      }
+    }
+    if (cache == nullptr) {
+      return false;
+    }
+    StackHandleScope<InlineCache::kIndividualCacheSize> classes(self);
+    jit->GetCodeCache()->CopyInlineCacheInto(*cache, &classes, cache_counts);
+  }
+  jsize length = std::min<jsize>(env->GetArrayLength(counts), InlineCache::kIndividualCacheSize);
+  jint values[InlineCache::kIndividualCacheSize];
+  std::copy_n(cache_counts, length, values);
+  env->SetIntArrayRegion(counts, 0, length, values);
+  return true;
+}
+
 extern "C" JNIEXPORT int JNICALL Java_Main_numberOfDeoptimizations(JNIEnv*, jclass) {
   return Runtime::Current()->GetNumberOfDeoptimizations();
 }